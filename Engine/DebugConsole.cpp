@@ -35,7 +35,14 @@
 
 #include <Input/Window.h>
 
+#include <Rendering/Renderer/Renderer.h>
+
+#include <Resources/FileArchive.h>
+#include <Resources/ResourceManager.h>
+#include <Resources/TextureCooker.h>
+
 #include <World/WorldHandler.h>
+#include <World/WorldStreamer.h>
 #include <World/Physics/WorldPhysics.h>
 #include <GLFW/glfw3.h>
 
@@ -56,6 +63,20 @@ DebugConsole::DebugConsole(StarlightEngine *enginePtr)
 
 	cmdFuncMap["debugPhysics"] = std::make_pair("debugPhysics <0,1>", std::bind(&DebugConsole::debugPhysics, this, std::placeholders::_1));
 	cmdFuncMap["echo"] = std::make_pair("echo <string>", std::bind(&DebugConsole::echo, this, std::placeholders::_1));
+	cmdFuncMap["packArchive"] = std::make_pair("packArchive <archive_file> <directory>", std::bind(&DebugConsole::packArchive, this, std::placeholders::_1));
+	cmdFuncMap["enableMod"] = std::make_pair("enableMod <mod_name>", std::bind(&DebugConsole::enableMod, this, std::placeholders::_1));
+	cmdFuncMap["disableMod"] = std::make_pair("disableMod <mod_name>", std::bind(&DebugConsole::disableMod, this, std::placeholders::_1));
+	cmdFuncMap["cookMeshes"] = std::make_pair("cookMeshes <mesh_file>", std::bind(&DebugConsole::cookMeshes, this, std::placeholders::_1));
+	cmdFuncMap["cookDefs"] = std::make_pair("cookDefs <defs_file>", std::bind(&DebugConsole::cookDefs, this, std::placeholders::_1));
+	cmdFuncMap["cookTexture"] = std::make_pair("cookTexture <texture_file> [albedo|normal|mask] [hq]", std::bind(&DebugConsole::cookTexture, this, std::placeholders::_1));
+	cmdFuncMap["uploadStats"] = std::make_pair("uploadStats", std::bind(&DebugConsole::uploadStats, this, std::placeholders::_1));
+	cmdFuncMap["cacheStats"] = std::make_pair("cacheStats [evict]", std::bind(&DebugConsole::cacheStats, this, std::placeholders::_1));
+	cmdFuncMap["meshPoolStats"] = std::make_pair("meshPoolStats", std::bind(&DebugConsole::meshPoolStats, this, std::placeholders::_1));
+	cmdFuncMap["streamStats"] = std::make_pair("streamStats", std::bind(&DebugConsole::streamStats, this, std::placeholders::_1));
+	cmdFuncMap["pipelineCacheStats"] = std::make_pair("pipelineCacheStats", std::bind(&DebugConsole::pipelineCacheStats, this, std::placeholders::_1));
+	cmdFuncMap["benchTextureDecode"] = std::make_pair("benchTextureDecode <png_file> [layer_count]", std::bind(&DebugConsole::benchTextureDecode, this, std::placeholders::_1));
+	cmdFuncMap["benchDescriptorSets"] = std::make_pair("benchDescriptorSets [set_count]", std::bind(&DebugConsole::benchDescriptorSets, this, std::placeholders::_1));
+	cmdFuncMap["stressMeshImports"] = std::make_pair("stressMeshImports <mesh_file> [thread_count] [imports_per_thread]", std::bind(&DebugConsole::stressMeshImports, this, std::placeholders::_1));
 
 	nkCmdLineBufferLen = 0;
 	memset(nkCmdLineBuffer, 0, sizeof(nkCmdLineBuffer));
@@ -89,6 +110,243 @@ std::string DebugConsole::echo(std::vector<std::string> args)
 	return args[0];
 }
 
+std::string DebugConsole::packArchive(std::vector<std::string> args)
+{
+	if (args.size() < 2)
+		return "Not enough arguments";
+
+	// Both are relative to the working directory, and the files are stored w/ the directory as part of their path
+	std::string workingDir = FileLoader::instance()->getWorkingDir();
+	std::string dir = args[1];
+
+	if (dir.length() > 0 && dir.back() != '/')
+		dir += "/";
+
+	std::vector<std::string> files = FileLoader::instance()->getDirectoryFileList(workingDir + dir, true);
+
+	for (size_t i = 0; i < files.size(); i ++)
+		files[i] = dir + files[i];
+
+	if (!FileArchive::writeArchive(workingDir + args[0], workingDir, files))
+		return "Failed to write archive";
+
+	return "Packed " + toString(files.size()) + " files";
+}
+
+std::string DebugConsole::enableMod(std::vector<std::string> args)
+{
+	if (args.size() == 0)
+		return "Not enough arguments";
+
+	if (!FileLoader::instance()->enableMod(args[0]))
+		return "Failed to enable mod";
+
+	return "Enabled mod " + args[0];
+}
+
+std::string DebugConsole::disableMod(std::vector<std::string> args)
+{
+	if (args.size() == 0)
+		return "Not enough arguments";
+
+	FileLoader::instance()->disableMod(args[0]);
+
+	return "Disabled mod " + args[0];
+}
+
+std::string DebugConsole::cookMeshes(std::vector<std::string> args)
+{
+	if (args.size() == 0)
+		return "Not enough arguments";
+
+	return "Cooked " + toString(engine->resources->cookMeshFile(args[0])) + " meshes";
+}
+
+std::string DebugConsole::cookDefs(std::vector<std::string> args)
+{
+	if (args.size() == 0)
+		return "Not enough arguments";
+
+	return ResourceManager::cookGameDefsFile(args[0]) ? "Cooked game defs " + args[0] : "Failed to cook game defs " + args[0];
+}
+
+std::string DebugConsole::cookTexture(std::vector<std::string> args)
+{
+	if (args.size() == 0)
+		return "Not enough arguments";
+
+	TextureCookUsage usage = TextureCooker::getTextureUsageFromName(args[0]);
+
+	if (args.size() > 1)
+	{
+		if (args[1] == "albedo")
+			usage = TEXTURE_COOK_USAGE_ALBEDO;
+		else if (args[1] == "normal")
+			usage = TEXTURE_COOK_USAGE_NORMAL;
+		else if (args[1] == "mask")
+			usage = TEXTURE_COOK_USAGE_MASK;
+		else
+			return "Unknown texture usage: " + args[1];
+	}
+
+	bool highQuality = args.size() > 2 && args[2] == "hq";
+
+	return TextureCooker::cookTextureFile(args[0], usage, highQuality) ? "Cooked texture " + args[0] : "Failed to cook texture " + args[0];
+}
+
+std::string DebugConsole::uploadStats(std::vector<std::string> args)
+{
+	UploadBatcherStats stats = engine->resources->getUploadStats();
+
+	printf("%s Uploads: %u batches (%u uploads, %u KB) last frame, %u batches in flight, %.2f MB/s, %llu batches (%llu MB) total\n", INFO_PREFIX, stats.lastFrameBatchCount, stats.lastFrameUploadCount, uint32_t(stats.lastFrameUploadSize / 1024), stats.batchesInFlight,
+			stats.uploadBytesPerSecond / (1024.0 * 1024.0), (unsigned long long) stats.totalBatchCount, (unsigned long long) (stats.totalUploadSize / (1024 * 1024)));
+
+	return toString(stats.uploadBytesPerSecond / (1024.0 * 1024.0)) + " MB/s, " + toString(stats.batchesInFlight) + " batches in flight";
+}
+
+std::string DebugConsole::cacheStats(std::vector<std::string> args)
+{
+	if (args.size() > 0 && args[0] == "evict")
+		engine->resources->evictUnreferencedResources();
+
+	ResourceCacheStats stats = engine->resources->getResourceCacheStats();
+
+	printf("%s Resource cache: %llu hits (%llu on retained resources), %llu misses, %llu evictions, %u retained (%u KB CPU, %u KB VRAM)\n", INFO_PREFIX, (unsigned long long) stats.hits, (unsigned long long) stats.retainedHits,
+			(unsigned long long) stats.misses, (unsigned long long) stats.evictions, stats.retainedCount, uint32_t(stats.retainedCPUSize / 1024), uint32_t(stats.retainedVRAMSize / 1024));
+	printf("%s Texture streaming: %u streamed textures (%u KB VRAM), %u mip streams in flight\n", INFO_PREFIX, stats.streamedTextureCount, uint32_t(stats.streamedTextureVRAMSize / 1024), stats.textureMipStreamsInFlight);
+
+	return toString(stats.retainedCount) + " retained, " + toString(stats.retainedHits) + " retained hits";
+}
+
+std::string DebugConsole::meshPoolStats(std::vector<std::string> args)
+{
+	MeshPoolStats stats = engine->resources->getMeshPoolStats();
+
+	printf("%s Mesh pool: %u pages, %u meshes, %u KB used of %u KB (%.1f%%)\n", INFO_PREFIX, stats.pageCount, stats.allocationCount, uint32_t(stats.usedSize / 1024), uint32_t(stats.totalSize / 1024),
+			stats.totalSize > 0 ? double(stats.usedSize) / double(stats.totalSize) * 100.0 : 0.0);
+
+	return toString(stats.pageCount) + " pages, " + toString(stats.allocationCount) + " meshes";
+}
+
+std::string DebugConsole::streamStats(std::vector<std::string> args)
+{
+	WorldStreamerStats stats = engine->worldHandler->worldStreamer->getStats();
+
+	printf("%s World streamer: %u/%u static meshes & materials loaded, %u requests pending, %u in flight (%u KB), %u failed\n", INFO_PREFIX, stats.loadedAssetCount, stats.streamedAssetCount, stats.pendingRequestCount,
+			stats.inFlightRequestCount, uint32_t(stats.inFlightIOSize / 1024), stats.failedRequestCount);
+
+	return toString(stats.loadedAssetCount) + "/" + toString(stats.streamedAssetCount) + " loaded, " + toString(stats.pendingRequestCount) + " pending";
+}
+
+std::string DebugConsole::pipelineCacheStats(std::vector<std::string> args)
+{
+	PipelineCacheStats stats = engine->renderer->getPipelineCacheStats();
+
+	uint32_t pendingCompiles = engine->renderer->getPendingPipelineCompileJobCount();
+
+	printf("%s Pipeline cache: %u pipelines created in %.1f ms, %s cache hits, %u KB loaded from disk, %u KB now, %u compiles pending\n", INFO_PREFIX, stats.pipelinesCreated, stats.totalCreationTime,
+			stats.hitsReported ? toString(stats.cacheHits).c_str() : "unknown", uint32_t(stats.loadedCacheSize / 1024), uint32_t(stats.cacheSize / 1024), pendingCompiles);
+
+	return toString(stats.pipelinesCreated) + " pipelines, " + (stats.hitsReported ? toString(stats.cacheHits) : std::string("unknown")) + " hits, " + toString(pendingCompiles) + " pending";
+}
+
+/*
+Decodes a texture array made of the same PNG repeated <layer_count> times (32 by default) on 1, 2, 4, ... threads, up to every async
+worker plus the calling thread, to show how loadTextureArrayImmediate()'s layer decoding scales w/ the number of cores.
+*/
+std::string DebugConsole::benchTextureDecode(std::vector<std::string> args)
+{
+	if (args.size() == 0)
+		return "Not enough arguments";
+
+	uint32_t layerCount = args.size() > 1 ? (uint32_t) std::max(atoi(args[1].c_str()), 1) : 32;
+	uint32_t maxThreads = engine->resources->getAsyncWorkerCount() + 1;
+	std::vector<std::string> files(layerCount, args[0]);
+
+	double time, singleThreadTime = 0.0;
+
+	// Once first so that the file is in the OS's cache for every run
+	if (!engine->resources->timePNGTextureArrayDecode(files, maxThreads, time))
+		return "Couldn't decode " + args[0] + ", see the log";
+
+	for (uint32_t threadCount = 1; ; threadCount = std::min(threadCount * 2, maxThreads))
+	{
+		engine->resources->timePNGTextureArrayDecode(files, threadCount, time);
+
+		if (threadCount == 1)
+			singleThreadTime = time;
+
+		printf("%s Decoded %u layers of %s on %u threads in %.2f ms (%.2fx)\n", INFO_PREFIX, layerCount, args[0].c_str(), threadCount, time, singleThreadTime / time);
+
+		if (threadCount == maxThreads)
+			return "Decoded " + toString(layerCount) + " layers on up to " + toString(maxThreads) + " threads, " + toString(singleThreadTime / time) + "x faster than on one thread";
+	}
+}
+
+std::string DebugConsole::stressMeshImports(std::vector<std::string> args)
+{
+	if (args.size() == 0)
+		return "Not enough arguments";
+
+	uint32_t threadCount = args.size() > 1 ? (uint32_t) std::max(atoi(args[1].c_str()), 1) : std::max<uint32_t>(std::thread::hardware_concurrency(), 2);
+	uint32_t importsPerThread = args.size() > 2 ? (uint32_t) std::max(atoi(args[2].c_str()), 1) : 8;
+
+	if (!engine->resources->stressTestMeshImports(args[0], threadCount, importsPerThread))
+		return "Mesh imports on " + toString(threadCount) + " threads didn't match the serial imports, see the log";
+
+	return "Mesh imports on " + toString(threadCount) + " threads matched the serial imports";
+}
+
+/*
+Allocates <set_count> (10k by default) descriptor sets w/ the material set layout, first one at a time, then all at once w/
+allocateDescriptorSets(), and then all at once again after they've been freed (so they come from the freed sets). Each way
+gets a fresh pool w/ the same block size the resource manager uses.
+*/
+std::string DebugConsole::benchDescriptorSets(std::vector<std::string> args)
+{
+	uint32_t setCount = args.size() > 0 ? (uint32_t) std::max(atoi(args[0].c_str()), 1) : 10000;
+
+	std::vector<DescriptorSetLayoutBinding> layoutBindings;
+	layoutBindings.push_back({0, DESCRIPTOR_TYPE_SAMPLER, 1, SHADER_STAGE_FRAGMENT_BIT});
+	layoutBindings.push_back({1, DESCRIPTOR_TYPE_SAMPLED_IMAGE, MATERIAL_DEF_MAX_TEXTURE_NUM, SHADER_STAGE_FRAGMENT_BIT});
+
+	double singleTime, batchTime, reuseTime;
+
+	{
+		DescriptorPool pool = engine->renderer->createDescriptorPool(layoutBindings, 16);
+		std::vector<DescriptorSet> sets(setCount);
+
+		double startTime = engine->getTime();
+
+		for (uint32_t i = 0; i < setCount; i ++)
+			sets[i] = pool->allocateDescriptorSet();
+
+		singleTime = (engine->getTime() - startTime) * 1000.0;
+
+		engine->renderer->destroyDescriptorPool(pool);
+	}
+
+	{
+		DescriptorPool pool = engine->renderer->createDescriptorPool(layoutBindings, 16);
+
+		double startTime = engine->getTime();
+		std::vector<DescriptorSet> sets = pool->allocateDescriptorSets(setCount);
+		batchTime = (engine->getTime() - startTime) * 1000.0;
+
+		pool->freeDescriptorSets(sets);
+
+		startTime = engine->getTime();
+		sets = pool->allocateDescriptorSets(setCount);
+		reuseTime = (engine->getTime() - startTime) * 1000.0;
+
+		engine->renderer->destroyDescriptorPool(pool);
+	}
+
+	printf("%s Allocated %u material descriptor sets: %.2f ms one at a time, %.2f ms in one call, %.2f ms in one call from freed sets\n", INFO_PREFIX, setCount, singleTime, batchTime, reuseTime);
+
+	return toString(setCount) + " sets: " + toString(singleTime) + " ms one at a time, " + toString(batchTime) + " ms in one call";
+}
+
 void DebugConsole::updateGUI(struct nk_context *ctx, bool consoleOpen)
 {
 	uint32_t windowWidth = engine->mainWindow->getWidth();
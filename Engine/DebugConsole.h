@@ -47,6 +47,20 @@ class DebugConsole
 
 	std::string debugPhysics(std::vector<std::string> args);
 	std::string echo(std::vector<std::string> args);
+	std::string packArchive(std::vector<std::string> args);
+	std::string enableMod(std::vector<std::string> args);
+	std::string disableMod(std::vector<std::string> args);
+	std::string cookMeshes(std::vector<std::string> args);
+	std::string cookDefs(std::vector<std::string> args);
+	std::string cookTexture(std::vector<std::string> args);
+	std::string uploadStats(std::vector<std::string> args);
+	std::string cacheStats(std::vector<std::string> args);
+	std::string meshPoolStats(std::vector<std::string> args);
+	std::string streamStats(std::vector<std::string> args);
+	std::string pipelineCacheStats(std::vector<std::string> args);
+	std::string benchTextureDecode(std::vector<std::string> args);
+	std::string stressMeshImports(std::vector<std::string> args);
+	std::string benchDescriptorSets(std::vector<std::string> args);
 
 	std::string execCmd(const std::string &commandStr);
 
@@ -37,6 +37,7 @@
 #include <Rendering/PostProcess/PostProcess.h>
 
 #include <World/WorldHandler.h>
+#include <World/WorldStreamer.h>
 
 #include <Input/Window.h>
 
@@ -185,6 +186,7 @@ void GameStateInWorld::init ()
 		bridge.meshLODFiles.push_back("GameData/meshes/test-bridge.dae");
 		bridge.meshLODNames.push_back("bridge0");
 		bridge.meshLODMaxDists.push_back(8192);
+		bridge.generatedLODCount = 3;
 
 		engine->resources->addMeshDef(bridge);
 
@@ -193,6 +195,7 @@ void GameStateInWorld::init ()
 		boulder.meshLODFiles.push_back("GameData/meshes/test-boulder.dae");
 		boulder.meshLODNames.push_back("boulder");
 		boulder.meshLODMaxDists.push_back(8192);
+		boulder.generatedLODCount = 3;
 
 		engine->resources->addMeshDef(boulder);
 
@@ -218,19 +221,7 @@ void GameStateInWorld::init ()
 		engine->resources->addMeshDef(lodTest);
 	}
 
-	{
-		engine->resources->loadMaterialImmediate("dirt");
-		engine->resources->loadMaterialImmediate("slate");
-		engine->resources->loadMaterialImmediate("pavingstones");
-		engine->resources->loadMaterialImmediate("pbrTestMat");
-	}
-
-	{
-		engine->resources->loadStaticMeshImmediate("bridge");
-		engine->resources->loadStaticMeshImmediate("boulder");
-		engine->resources->loadStaticMeshImmediate("LOD Test");
-		engine->resources->loadStaticMeshImmediate("pbrTest");
-	}
+	// The materials & static meshes the level uses aren't loaded here, they're streamed in by the WorldStreamer as the camera gets near them
 
 	LevelDef testLevel = {};
 	strcpy(testLevel.uniqueName, "Test Level");
@@ -245,8 +236,8 @@ void GameStateInWorld::init ()
 	LevelData &dat = *engine->worldHandler->getActiveLevelData();
 
 	LevelStaticObjectType testObjType = {};
-	testObjType.materialDefUniqueNameHash = std::hash<std::string> {} ("pavingstones");
-	testObjType.meshDefUniqueNameHash = std::hash<std::string> {} ("bridge");
+	testObjType.materialDefUniqueNameID = AssetIDTable::getAssetID("pavingstones");
+	testObjType.meshDefUniqueNameID = AssetIDTable::getAssetID("bridge");
 	testObjType.boundingSphereRadius_maxLodDist_padding = {8, 1, 0, 0};
 
 	LevelStaticObject testObjInstance = {};
@@ -267,8 +258,8 @@ void GameStateInWorld::init ()
 
 	testObjs.clear();
 
-	testObjType.materialDefUniqueNameHash = std::hash<std::string> {} ("slate");
-	testObjType.meshDefUniqueNameHash = std::hash<std::string> {} ("boulder");
+	testObjType.materialDefUniqueNameID = AssetIDTable::getAssetID("slate");
+	testObjType.meshDefUniqueNameID = AssetIDTable::getAssetID("boulder");
 
 	for (size_t i = 0; i < 64; i ++)
 	{
@@ -284,8 +275,8 @@ void GameStateInWorld::init ()
 
 	testObjs.clear();
 
-	testObjType.materialDefUniqueNameHash = std::hash<std::string> {} ("pbrTestMat");
-	testObjType.meshDefUniqueNameHash = std::hash<std::string> {} ("pbrTest");
+	testObjType.materialDefUniqueNameID = AssetIDTable::getAssetID("pbrTestMat");
+	testObjType.meshDefUniqueNameID = AssetIDTable::getAssetID("pbrTest");
 
 	for (size_t i = 0; i < 1; i++)
 	{
@@ -301,8 +292,8 @@ void GameStateInWorld::init ()
 
 	testObjs.clear();
 
-	testObjType.materialDefUniqueNameHash = std::hash<std::string> {} ("dirt");
-	testObjType.meshDefUniqueNameHash = std::hash<std::string> {} ("bridge");
+	testObjType.materialDefUniqueNameID = AssetIDTable::getAssetID("dirt");
+	testObjType.meshDefUniqueNameID = AssetIDTable::getAssetID("bridge");
 
 	for (size_t i = 0; i < 8; i ++)
 	{
@@ -318,8 +309,8 @@ void GameStateInWorld::init ()
 
 	testObjs.clear();
 
-	testObjType.materialDefUniqueNameHash = std::hash<std::string> {} ("slate");
-	testObjType.meshDefUniqueNameHash = std::hash<std::string> {} ("LOD Test");
+	testObjType.materialDefUniqueNameID = AssetIDTable::getAssetID("slate");
+	testObjType.meshDefUniqueNameID = AssetIDTable::getAssetID("LOD Test");
 
 	for (size_t i = 0; i < 2048; i ++)
 	{
@@ -468,24 +459,17 @@ void GameStateInWorld::init ()
 	engine->resources->setPipelineRenderPass(worldRenderer->gbufferRenderPass, worldRenderer->shadowsRenderPass);
 
 	{
-		engine->resources->loadPipelineImmediate("engine.defaultMaterial");
+		engine->resources->loadPipelineAsync("engine.defaultMaterial");
 	}
+
+	// All of the pass & material pipelines compile in parallel, so this is the one place we actually wait on them
+	engine->renderer->waitForPipelineCompileJobs();
 }
 
 void GameStateInWorld::destroy ()
 {
 	engine->worldHandler->unloadLevel(engine->resources->getLevelDef("Test Level"));
 
-	engine->resources->returnMaterial("dirt");
-	engine->resources->returnMaterial("slate");
-	engine->resources->returnMaterial("pavingstones");
-	engine->resources->returnMaterial("pbrTestMat");
-
-	engine->resources->returnStaticMesh("bridge");
-	engine->resources->returnStaticMesh("boulder");
-	engine->resources->returnStaticMesh("LOD Test");
-	engine->resources->returnStaticMesh("pbrTest");
-
 	engine->resources->returnPipeline("engine.defaultMaterial");
 
 	delete testGame;
@@ -517,6 +501,8 @@ void GameStateInWorld::update (float delta)
 {
 	testGame->update(delta);
 
+	engine->worldHandler->worldStreamer->update();
+
 	worldRenderer->update();
 	skyboxRenderer->setSunDirection(engine->api->getSunDirection());
 }
@@ -119,6 +119,9 @@ void StarlightEngine::init (RendererBackend rendererBackendType)
 
 	resources = new ResourceManager(renderer);
 
+	if (std::find(launchArgs.begin(), launchArgs.end(), "-packed_vertices") != launchArgs.end())
+		resources->setRendererMeshFormat(MESH_DATA_FORMAT_IVUNT_PACKED);
+
 	createGuiRenderPass();
 	createGUITexturePassthroughPipeline();
 
@@ -306,6 +309,8 @@ void StarlightEngine::update ()
 
 	lastUpdateTime = getTime();
 
+	resources->processAsyncLoads();
+
 	worldHandler->worldPhysics->updateScenePhysics(delta, worldHandler->getActiveLevelData()->physSceneID);
 
 	nk_input_begin(ctx);
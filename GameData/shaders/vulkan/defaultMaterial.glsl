@@ -8,12 +8,15 @@
 		mat4 mvp;
 		vec4 cameraPosition;
 		vec4 cameraCellOffset;
+		vec4 vertexDecodeScale; // xyz - position scale, w - 1 if normals & tangents are octahedral encoded
+		vec4 vertexDecodeOffset; // xyz - position offset
 	} pushConsts;
 	
+	// Either plain floats or packed (see MeshDataFormat in Resources.h), both come in through the same inputs
 	layout(location = 0) in vec3 inVertex;
 	layout(location = 1) in vec2 inUV;
-	layout(location = 2) in vec3 inNormal;
-	layout(location = 3) in vec3 inTangent;
+	layout(location = 2) in vec4 inNormal; // xyz - normal, or xy - octahedral encoded normal
+	layout(location = 3) in vec4 inTangent; // xyz - tangent, or xy - octahedral encoded tangent
 	layout(location = 4) in vec4 inInstancePosition_Scale; // xyz - position, w - scale
 	layout(location = 5) in vec4 inInstanceRotation; // quaternion
 
@@ -33,10 +36,24 @@
 	{
 		return 2.0f * cross(quat.xyz, quat.w * point + cross(quat.xyz, point)) + point;
 	}
+	
+	vec3 decodeOctahedral(in vec2 e)
+	{
+		vec3 n = vec3(e.xy, 1.0f - abs(e.x) - abs(e.y));
+		float t = max(-n.z, 0.0f);
+		n.xy += vec2(n.x >= 0.0f ? -t : t, n.y >= 0.0f ? -t : t);
+		
+		return normalize(n);
+	}
+	
+	vec3 decodeDirection(in vec4 dir)
+	{
+		return pushConsts.vertexDecodeScale.w > 0.5f ? decodeOctahedral(dir.xy) : dir.xyz;
+	}
 		
 	void main()
 	{	
-		vec3 vertexPosition = inVertex;
+		vec3 vertexPosition = inVertex * pushConsts.vertexDecodeScale.xyz + pushConsts.vertexDecodeOffset.xyz;
 		vertexPosition *= inInstancePosition_Scale.w * 0.1f;
 		vertexPosition = rotateByQuaternion(vertexPosition, inInstanceRotation);
 		vertexPosition += inInstancePosition_Scale.xyz;
@@ -47,8 +64,8 @@
 		//camPos = pushConsts.cameraPosition.xyz;
 		
 		outUV = inUV;
-		outNormal = rotateByQuaternion(inNormal, inInstanceRotation);
-		outTangent = rotateByQuaternion(inTangent, inInstanceRotation);
+		outNormal = rotateByQuaternion(decodeDirection(inNormal), inInstanceRotation);
+		outTangent = rotateByQuaternion(decodeDirection(inTangent), inInstanceRotation);
 		//px = gl_Position.x;
 		
 		//texcoord = inPosition;
@@ -80,7 +97,11 @@
 		vec3 B = cross(N, T);
 		mat3 tbn = mat3(T, B, N);
 		
-		return normalize(tbn * normalize(texture(sampler2D(materialTex[1], materialSampler), texcoords).rgb * 2.0f - 1.0f));
+		// Only x & y are read, so cooked BC5 normal maps (which don't have a z) work too
+		vec2 normalXY = texture(sampler2D(materialTex[1], materialSampler), texcoords).rg * 2.0f - 1.0f;
+		vec3 normalMap = vec3(normalXY, sqrt(max(1.0f - dot(normalXY, normalXY), 0.0f)));
+		
+		return normalize(tbn * normalMap);
 	}
 	
 	vec2 encodeNormal (in vec3 normal)
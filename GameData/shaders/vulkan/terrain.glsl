@@ -229,7 +229,10 @@
 		vec3 B = cross(N, T);
 		mat3 tbn = mat3(T, B, N);
 		
-		return tbn * normalize(texNormals * 2.0f - 1.0f);
+		// Only x & y are read, so cooked BC5 normal maps (which don't have a z) work too
+		vec2 normalXY = texNormals.xy * 2.0f - 1.0f;
+		
+		return tbn * vec3(normalXY, sqrt(max(1.0f - dot(normalXY, normalXY), 0.0f)));
 	}
 
 	const float uvScale = 1;
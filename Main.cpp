@@ -25,6 +25,8 @@
  * -enable_vulkan_layers
  * -enable_d3d12_debug
  * -enable_d3d12_hw_debug
+ *
+ * -cook_textures <file> [<file> ...] (cooks the textures and exits w/o creating a window or renderer)
  */
 
 #include <common.h>
@@ -34,6 +36,8 @@
 
 #include <assimp/version.h>
 
+#include <Resources/TextureCooker.h>
+
 #include <Engine/StarlightEngine.h>
 #include <Engine/GameStateTitleScreen.h>
 #include <Engine/GameStateInWorld.h>
@@ -79,6 +83,27 @@ int main (int argc, char *argv[])
 	FileLoader::setInstance(new FileLoader());
 
 	FileLoader::instance()->setWorkingDir(workingDir);
+	FileLoader::instance()->mountArchiveDirectory("GameData/Archives/");
+	FileLoader::instance()->buildFileIndex();
+
+	// Texture cooking doesn't need a window or a renderer, so it can be done on a headless box
+	auto cookTexturesArg = std::find(launchArgs.begin(), launchArgs.end(), "-cook_textures");
+
+	if (cookTexturesArg != launchArgs.end())
+	{
+		uint32_t cookedCount = 0, textureCount = 0;
+
+		for (auto it = cookTexturesArg + 1; it != launchArgs.end() && (*it)[0] != '-'; it ++, textureCount ++)
+			if (TextureCooker::cookTextureFile(*it, TextureCooker::getTextureUsageFromName(*it)))
+				cookedCount ++;
+
+		printf("%s Cooked %u of %u textures\n", INFO_PREFIX, cookedCount, textureCount);
+
+		delete EventHandler::instance();
+		delete FileLoader::instance();
+
+		return cookedCount == textureCount ? 0 : 1;
+	}
 
 	RendererBackend rendererBackend = Renderer::chooseRendererBackend(launchArgs);
 
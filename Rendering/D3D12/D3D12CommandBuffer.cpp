@@ -111,6 +111,22 @@ void D3D12CommandBuffer::stageBuffer(StagingBuffer stagingBuffer, Buffer dstBuff
 {
 }
 
+void D3D12CommandBuffer::stageBuffer(StagingBuffer stagingBuffer, size_t srcOffset, Buffer dstBuffer, size_t dstOffset, size_t size)
+{
+}
+
+void D3D12CommandBuffer::stageBuffer(StagingBuffer stagingBuffer, Texture dstTexture, const std::vector<TextureBufferCopyInfo> &copyRegions)
+{
+}
+
+void D3D12CommandBuffer::transferBufferOwnership(Buffer buffer, size_t offset, size_t size, QueueType srcQueue, QueueType dstQueue)
+{
+}
+
+void D3D12CommandBuffer::transferTextureOwnership(Texture texture, TextureLayout oldLayout, TextureLayout newLayout, TextureSubresourceRange subresource, QueueType srcQueue, QueueType dstQueue)
+{
+}
+
 void D3D12CommandBuffer::setViewports(uint32_t firstViewport, const std::vector<Viewport>& viewports)
 {
 }
@@ -603,4 +603,11 @@ void D3D12Renderer::setSwapchainTexture(Window *wnd, TextureView texView, Sample
 	
 }
 
+PipelineCacheStats D3D12Renderer::getPipelineCacheStats()
+{
+	PipelineCacheStats stats = {};
+
+	return stats;
+}
+
 
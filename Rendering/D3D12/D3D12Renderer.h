@@ -124,6 +124,8 @@ class D3D12Renderer : public Renderer
 	void recreateSwapchain(Window *wnd);
 	void setSwapchainTexture(Window *wnd, TextureView texView, Sampler sampler, TextureLayout layout);
 
+	PipelineCacheStats getPipelineCacheStats();
+
 	private:
 
 	ID3D12Debug *debugController0;
@@ -67,9 +67,9 @@ void AtmosphereRenderer::loadPrecomputedTextures ()
 	scatteringTV = renderer->createTextureView(scatteringTexture, TEXTURE_VIEW_TYPE_3D);
 	irradianceTV = renderer->createTextureView(irradianceTexture);
 
-	std::vector<char> transmittanceBTD = FileLoader::instance()->readFileBuffer("GameData/textures/atmosphere/transmittance.btd");
-	std::vector<char> scatteringBTD = FileLoader::instance()->readFileBuffer("GameData/textures/atmosphere/scattering.btd");
-	std::vector<char> irradianceBTD = FileLoader::instance()->readFileBuffer("GameData/textures/atmosphere/irradiance.btd");
+	FileView transmittanceBTD = FileLoader::instance()->openFileView("GameData/textures/atmosphere/transmittance.btd");
+	FileView scatteringBTD = FileLoader::instance()->openFileView("GameData/textures/atmosphere/scattering.btd");
+	FileView irradianceBTD = FileLoader::instance()->openFileView("GameData/textures/atmosphere/irradiance.btd");
 
 	StagingBuffer transmittanceSB = renderer->createAndFillStagingBuffer(transmittanceBTD.size(), transmittanceBTD.data());
 	StagingBuffer scatteringSB = renderer->createAndFillStagingBuffer(scatteringBTD.size(), scatteringBTD.data());
@@ -75,7 +75,7 @@ const uint32_t lightingPcSize = (uint32_t) (sizeof(glm::mat4) + sizeof(glm::vec4
 void DeferredRenderer::lightingPassInit(RenderPass renderPass, uint32_t baseSubpass)
 {
 	atmosphereTextureSampler = engine->renderer->createSampler(SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE, SAMPLER_FILTER_LINEAR, SAMPLER_FILTER_LINEAR);
-	createDeferredLightingPipeline(renderPass, baseSubpass);
+	engine->renderer->pushPipelineCompileJob(std::bind(&DeferredRenderer::createDeferredLightingPipeline, this, renderPass, baseSubpass));
 
 	linearSampler = engine->renderer->createSampler(SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE, SAMPLER_FILTER_LINEAR, SAMPLER_FILTER_LINEAR, 1.0f, {0, 16, 0});
 	shadowsSampler = engine->renderer->createSampler(SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE, SAMPLER_FILTER_LINEAR, SAMPLER_FILTER_LINEAR);
@@ -78,7 +78,7 @@ SkyCubemapRenderer::~SkyCubemapRenderer()
 
 void SkyCubemapRenderer::skyboxGenPassInit(RenderPass renderPass, uint32_t baseSubpass)
 {
-	createCubemapPipeline(renderPass, baseSubpass);
+	renderer->pushPipelineCompileJob(std::bind(&SkyCubemapRenderer::createCubemapPipeline, this, renderPass, baseSubpass));
 
 	atmosphereSampler = renderer->createSampler(SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE);
 
@@ -226,7 +226,7 @@ void SkyCubemapRenderer::enviroSkyboxSpecIBLGenPassInit(RenderPass renderPass, u
 
 	renderer->writeDescriptorSets({enviroSamplerWrite, invMVPsBufferWrite});
 
-	createEnvironmentMapPipeline();
+	renderer->pushPipelineCompileJob(std::bind(&SkyCubemapRenderer::createEnvironmentMapPipeline, this));
 }
 
 void SkyCubemapRenderer::enviroSkyboxSpecIBLGenPassDescriptorUpdate(std::map<std::string, TextureView> views, suvec3 size)
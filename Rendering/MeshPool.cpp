@@ -0,0 +1,266 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2017 David Allen
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * MeshPool.cpp
+ */
+
+#include "Rendering/MeshPool.h"
+
+#include <Rendering/Renderer/Renderer.h>
+
+MeshPool::MeshPool (Renderer *rendererInstance)
+{
+	renderer = rendererInstance;
+
+	pendingFrees.resize(MESH_POOL_FREE_DELAY_FRAMES);
+}
+
+MeshPool::~MeshPool ()
+{
+	for (size_t i = 0; i < pages.size(); i ++)
+	{
+		renderer->destroyBuffer(pages[i]->vertexBuffer);
+		renderer->destroyBuffer(pages[i]->indexBuffer);
+
+		delete pages[i];
+	}
+}
+
+bool MeshPool::allocate (size_t vertexSize, size_t vertexAlignment, size_t indexSize, MeshPoolAllocation &allocation)
+{
+	allocation = {};
+	allocation.page = MESH_POOL_INVALID_PAGE;
+
+	// Meshes that don't fit in a normal page get a page that's just big enough for them
+	if (vertexSize > MESH_POOL_PAGE_VERTEX_SIZE || indexSize > MESH_POOL_PAGE_INDEX_SIZE)
+		createPage(std::max<size_t>(vertexSize, MESH_POOL_PAGE_VERTEX_SIZE), std::max<size_t>(indexSize, MESH_POOL_PAGE_INDEX_SIZE));
+
+	for (uint32_t pass = 0; pass < 2; pass ++)
+	{
+		for (uint32_t p = 0; p < pages.size(); p ++)
+		{
+			MeshPoolPage &page = *pages[p];
+
+			if (!allocateRange(page.vertexFreeList, vertexSize, vertexAlignment, allocation.vertexOffset))
+				continue;
+
+			if (!allocateRange(page.indexFreeList, indexSize, MESH_POOL_INDEX_ALIGNMENT, allocation.indexOffset))
+			{
+				freeRange(page.vertexFreeList, allocation.vertexOffset, vertexSize);
+
+				continue;
+			}
+
+			allocation.page = p;
+			allocation.vertexSize = vertexSize;
+			allocation.indexSize = indexSize;
+			page.allocationCount ++;
+
+			return true;
+		}
+
+		// Nothing had room, so the second pass will find it in the new page
+		if (pass == 0)
+			createPage(MESH_POOL_PAGE_VERTEX_SIZE, MESH_POOL_PAGE_INDEX_SIZE);
+	}
+
+	printf("%s Failed to allocate %u bytes of vertex data and %u bytes of index data from the mesh pool\n", ERR_PREFIX, (uint32_t) vertexSize, (uint32_t) indexSize);
+
+	return false;
+}
+
+void MeshPool::free (const MeshPoolAllocation &allocation)
+{
+	if (allocation.page >= pages.size())
+		return;
+
+	pendingFrees.back().push_back(allocation);
+}
+
+void MeshPool::update ()
+{
+	std::vector<MeshPoolAllocation> &frees = pendingFrees.front();
+
+	for (size_t i = 0; i < frees.size(); i ++)
+	{
+		MeshPoolPage &page = *pages[frees[i].page];
+
+		freeRange(page.vertexFreeList, frees[i].vertexOffset, frees[i].vertexSize);
+		freeRange(page.indexFreeList, frees[i].indexOffset, frees[i].indexSize);
+
+		page.allocationCount --;
+	}
+
+	frees.clear();
+
+	pendingFrees.push_back(std::move(frees));
+	pendingFrees.pop_front();
+}
+
+Buffer MeshPool::getVertexBuffer (uint32_t page)
+{
+	return pages[page]->vertexBuffer;
+}
+
+Buffer MeshPool::getIndexBuffer (uint32_t page)
+{
+	return pages[page]->indexBuffer;
+}
+
+MeshPoolStats MeshPool::getStats ()
+{
+	MeshPoolStats stats = {};
+	stats.pageCount = (uint32_t) pages.size();
+
+	for (size_t i = 0; i < pages.size(); i ++)
+	{
+		stats.allocationCount += pages[i]->allocationCount;
+		stats.totalSize += pages[i]->vertexFreeList.size + pages[i]->indexFreeList.size;
+		stats.usedSize += pages[i]->vertexFreeList.usedSize + pages[i]->indexFreeList.usedSize;
+	}
+
+	return stats;
+}
+
+void MeshPool::createPage (size_t vertexSize, size_t indexSize)
+{
+	MeshPoolPage *page = new MeshPoolPage();
+	page->vertexBuffer = renderer->createBuffer(vertexSize, BUFFER_USAGE_VERTEX_BUFFER, true, false, MEMORY_USAGE_GPU_ONLY, false);
+	page->indexBuffer = renderer->createBuffer(indexSize, BUFFER_USAGE_INDEX_BUFFER, true, false, MEMORY_USAGE_GPU_ONLY, false);
+	page->allocationCount = 0;
+
+	initFreeList(page->vertexFreeList, vertexSize);
+	initFreeList(page->indexFreeList, indexSize);
+
+	renderer->setObjectDebugName(page->vertexBuffer, OBJECT_TYPE_BUFFER, "Mesh pool page " + toString(pages.size()) + " vertices");
+	renderer->setObjectDebugName(page->indexBuffer, OBJECT_TYPE_BUFFER, "Mesh pool page " + toString(pages.size()) + " indices");
+
+	pages.push_back(page);
+}
+
+void MeshPool::initFreeList (MeshPoolFreeList &freeList, size_t size)
+{
+	freeList.size = size;
+	freeList.usedSize = 0;
+	freeList.freeRangesByOffset.clear();
+	freeList.freeRangesBySize.clear();
+
+	addFreeRange(freeList, 0, size);
+}
+
+/*
+ * Finds the smallest free range that still fits the size after being aligned, and splits off whatever's left on
+ * either side of the allocation back into the free list.
+ */
+bool MeshPool::allocateRange (MeshPoolFreeList &freeList, size_t size, size_t alignment, size_t &offset)
+{
+	if (size == 0)
+	{
+		offset = 0;
+
+		return true;
+	}
+
+	for (auto it = freeList.freeRangesBySize.lower_bound(size); it != freeList.freeRangesBySize.end(); it ++)
+	{
+		size_t rangeOffset = it->second;
+		size_t rangeSize = it->first;
+		size_t alignedOffset = (rangeOffset + alignment - 1) / alignment * alignment;
+
+		if (alignedOffset + size > rangeOffset + rangeSize)
+			continue;
+
+		removeFreeRange(freeList, freeList.freeRangesByOffset.find(rangeOffset));
+
+		if (alignedOffset > rangeOffset)
+			addFreeRange(freeList, rangeOffset, alignedOffset - rangeOffset);
+
+		if (alignedOffset + size < rangeOffset + rangeSize)
+			addFreeRange(freeList, alignedOffset + size, rangeOffset + rangeSize - (alignedOffset + size));
+
+		freeList.usedSize += size;
+		offset = alignedOffset;
+
+		return true;
+	}
+
+	return false;
+}
+
+/*
+ * Returns a range to the free list, merging it w/ the free ranges right before & after it so the list doesn't fragment.
+ */
+void MeshPool::freeRange (MeshPoolFreeList &freeList, size_t offset, size_t size)
+{
+	if (size == 0)
+		return;
+
+	freeList.usedSize -= size;
+
+	auto next = freeList.freeRangesByOffset.lower_bound(offset);
+
+	if (next != freeList.freeRangesByOffset.end() && next->first == offset + size)
+	{
+		size += next->second;
+		removeFreeRange(freeList, next);
+	}
+
+	auto prev = freeList.freeRangesByOffset.lower_bound(offset);
+
+	if (prev != freeList.freeRangesByOffset.begin())
+	{
+		prev --;
+
+		if (prev->first + prev->second == offset)
+		{
+			offset = prev->first;
+			size += prev->second;
+			removeFreeRange(freeList, prev);
+		}
+	}
+
+	addFreeRange(freeList, offset, size);
+}
+
+void MeshPool::addFreeRange (MeshPoolFreeList &freeList, size_t offset, size_t size)
+{
+	freeList.freeRangesByOffset[offset] = size;
+	freeList.freeRangesBySize.insert(std::make_pair(size, offset));
+}
+
+void MeshPool::removeFreeRange (MeshPoolFreeList &freeList, std::map<size_t, size_t>::iterator it)
+{
+	auto sizeRange = freeList.freeRangesBySize.equal_range(it->second);
+
+	for (auto sizeIt = sizeRange.first; sizeIt != sizeRange.second; sizeIt ++)
+	{
+		if (sizeIt->second == it->first)
+		{
+			freeList.freeRangesBySize.erase(sizeIt);
+
+			break;
+		}
+	}
+
+	freeList.freeRangesByOffset.erase(it);
+}
@@ -0,0 +1,136 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2017 David Allen
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * MeshPool.h
+ */
+
+#ifndef RENDERING_MESHPOOL_H_
+#define RENDERING_MESHPOOL_H_
+
+#include <common.h>
+#include <Rendering/Renderer/RendererEnums.h>
+#include <Rendering/Renderer/RendererObjects.h>
+
+#include <deque>
+
+class Renderer;
+
+#define MESH_POOL_PAGE_VERTEX_SIZE (64 * 1024 * 1024)
+#define MESH_POOL_PAGE_INDEX_SIZE (32 * 1024 * 1024)
+#define MESH_POOL_INDEX_ALIGNMENT 4 // So the offset of any range is a whole number of 16 or 32 bit indices
+#define MESH_POOL_FREE_DELAY_FRAMES 3 // How many update()s a freed range waits before it can be reused, so frames in flight are done w/ it
+#define MESH_POOL_INVALID_PAGE 0xFFFFFFFF // The page of an allocation that failed (or was never made)
+
+/*
+ * Where a mesh's data lives in the mesh pool. The offsets are in bytes from the start of the page's buffers.
+ */
+typedef struct MeshPoolAllocation
+{
+		uint32_t page;
+		size_t vertexOffset;
+		size_t vertexSize;
+		size_t indexOffset;
+		size_t indexSize;
+} MeshPoolAllocation;
+
+typedef struct MeshPoolStats
+{
+		uint32_t pageCount;
+		uint32_t allocationCount;
+		size_t totalSize; // Bytes of VRAM all of the pages take up, vertex & index buffers together
+		size_t usedSize;  // Bytes actually used by meshes, including alignment padding
+} MeshPoolStats;
+
+/*
+ * Holds the vertex & index data of every mesh in a few large buffers ("pages"), instead of each mesh having it's own buffer
+ * pair. Meshes get a range of a page's vertex buffer and a range of it's index buffer from a best fit free list, so most meshes
+ * can be drawn w/o binding anything new. Pages are only added when a mesh doesn't fit in any of the existing ones, and a mesh
+ * that's bigger than a page gets a page to itself.
+ *
+ * Everything in here has to be called from the main thread, like the rest of the renderer.
+ */
+class MeshPool
+{
+	public:
+
+		MeshPool (Renderer *rendererInstance);
+		virtual ~MeshPool ();
+
+		/*
+		 * Allocates space for a mesh. The vertex alignment should be a multiple of the vertex stride, so the vertex offset is
+		 * a whole number of vertices. Returns false if the space couldn't be allocated, in which case the allocation's page is
+		 * MESH_POOL_INVALID_PAGE. Freeing an allocation w/ an invalid page does nothing.
+		 */
+		bool allocate (size_t vertexSize, size_t vertexAlignment, size_t indexSize, MeshPoolAllocation &allocation);
+		void free (const MeshPoolAllocation &allocation);
+
+		/*
+		 * Returns the ranges freed MESH_POOL_FREE_DELAY_FRAMES updates ago to the free lists, has to be called once per frame.
+		 */
+		void update ();
+
+		Buffer getVertexBuffer (uint32_t page);
+		Buffer getIndexBuffer (uint32_t page);
+
+		MeshPoolStats getStats ();
+
+	private:
+
+		/*
+		 * The free ranges of one buffer, indexed both by offset (for merging neighbours when a range is freed) and by size
+		 * (for the best fit search).
+		 */
+		typedef struct MeshPoolFreeList
+		{
+				size_t size;
+				size_t usedSize;
+				std::map<size_t, size_t> freeRangesByOffset;
+				std::multimap<size_t, size_t> freeRangesBySize;
+		} MeshPoolFreeList;
+
+		typedef struct MeshPoolPage
+		{
+				Buffer vertexBuffer;
+				Buffer indexBuffer;
+				MeshPoolFreeList vertexFreeList;
+				MeshPoolFreeList indexFreeList;
+				uint32_t allocationCount;
+		} MeshPoolPage;
+
+		Renderer *renderer;
+
+		std::vector<MeshPoolPage*> pages;
+
+		// The allocations freed in each of the last few frames, the front is the oldest
+		std::deque<std::vector<MeshPoolAllocation> > pendingFrees;
+
+		void createPage (size_t vertexSize, size_t indexSize);
+
+		static void initFreeList (MeshPoolFreeList &freeList, size_t size);
+		static bool allocateRange (MeshPoolFreeList &freeList, size_t size, size_t alignment, size_t &offset);
+		static void freeRange (MeshPoolFreeList &freeList, size_t offset, size_t size);
+		static void addFreeRange (MeshPoolFreeList &freeList, size_t offset, size_t size);
+		static void removeFreeRange (MeshPoolFreeList &freeList, std::map<size_t, size_t>::iterator it);
+};
+
+#endif /* RENDERING_MESHPOOL_H_ */
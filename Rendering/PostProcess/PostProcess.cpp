@@ -54,7 +54,7 @@ PostProcess::~PostProcess ()
 
 void PostProcess::combineTonemapPassInit(RenderPass renderPass, uint32_t baseSubpass)
 {
-	createCombinePipeline(renderPass, baseSubpass);
+	renderer->pushPipelineCompileJob(std::bind(&PostProcess::createCombinePipeline, this, renderPass, baseSubpass));
 
 	combineDescriptorPool = renderer->createDescriptorPool({{
 		{0, DESCRIPTOR_TYPE_SAMPLER, 1, SHADER_STAGE_FRAGMENT_BIT},
@@ -11,12 +11,120 @@
 
 Renderer::Renderer ()
 {
-	
+	pipelineCompileThreadsRunning = true;
+	pendingPipelineCompileJobs = 0;
 }
 
 Renderer::~Renderer ()
 {
+	waitForPipelineCompileJobs();
 
+	{
+		std::unique_lock<std::mutex> lock(pipelineCompileJobs_mutex);
+		pipelineCompileThreadsRunning = false;
+	}
+
+	pipelineCompileJobs_cv.notify_all();
+
+	for (size_t i = 0; i < pipelineCompileThreads.size(); i ++)
+		pipelineCompileThreads[i].join();
+}
+
+void Renderer::pushPipelineCompileJob (const std::function<void()> &job)
+{
+	{
+		std::unique_lock<std::mutex> lock(pipelineCompileJobs_mutex);
+
+		// Renderers that never compile anything off of the main thread don't need the threads, so they're started here
+		if (pipelineCompileThreads.size() == 0)
+		{
+			uint32_t threadCount = std::max<uint32_t>(std::thread::hardware_concurrency(), 2) - 1;
+
+			for (uint32_t i = 0; i < threadCount; i ++)
+				pipelineCompileThreads.push_back(std::thread(&Renderer::pipelineCompileThreadFunc, this));
+		}
+
+		pipelineCompileJobs.push_back(job);
+		pendingPipelineCompileJobs ++;
+	}
+
+	pipelineCompileJobs_cv.notify_one();
+}
+
+/*
+ * Runs jobs on the calling thread until the queue is empty, and then waits on the jobs the compile threads are still running.
+ */
+void Renderer::waitForPipelineCompileJobs ()
+{
+	while (runPipelineCompileJob())
+		;
+
+	std::unique_lock<std::mutex> lock(pipelineCompileJobs_mutex);
+	pipelineCompileJobsDone_cv.wait(lock, [this] {return pendingPipelineCompileJobs == 0;});
+}
+
+void Renderer::pipelineCompileThreadFunc ()
+{
+	while (true)
+	{
+		std::function<void()> job;
+
+		{
+			std::unique_lock<std::mutex> lock(pipelineCompileJobs_mutex);
+			pipelineCompileJobs_cv.wait(lock, [this] {return !pipelineCompileThreadsRunning || pipelineCompileJobs.size() > 0;});
+
+			if (!pipelineCompileThreadsRunning)
+				return;
+
+			job = pipelineCompileJobs.front();
+			pipelineCompileJobs.pop_front();
+		}
+
+		job();
+		finishPipelineCompileJob();
+	}
+}
+
+/*
+ * Takes a job off of the queue and runs it on the calling thread, returns false if there weren't any left.
+ */
+bool Renderer::runPipelineCompileJob ()
+{
+	std::function<void()> job;
+
+	{
+		std::unique_lock<std::mutex> lock(pipelineCompileJobs_mutex);
+
+		if (pipelineCompileJobs.size() == 0)
+			return false;
+
+		job = pipelineCompileJobs.front();
+		pipelineCompileJobs.pop_front();
+	}
+
+	job();
+	finishPipelineCompileJob();
+
+	return true;
+}
+
+void Renderer::finishPipelineCompileJob ()
+{
+	bool allDone;
+
+	{
+		std::unique_lock<std::mutex> lock(pipelineCompileJobs_mutex);
+		pendingPipelineCompileJobs --;
+		allDone = pendingPipelineCompileJobs == 0;
+	}
+
+	if (allDone)
+		pipelineCompileJobsDone_cv.notify_all();
+}
+
+uint32_t Renderer::getPendingPipelineCompileJobCount ()
+{
+	return pendingPipelineCompileJobs;
 }
 
 /*
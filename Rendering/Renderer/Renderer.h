@@ -13,6 +13,10 @@
 #include <Rendering/Renderer/RendererEnums.h>
 #include <Rendering/Renderer/RendererObjects.h>
 
+#include <functional>
+#include <deque>
+#include <condition_variable>
+
 class Window;
 
 typedef struct RendererAllocInfo
@@ -92,6 +96,16 @@ class Renderer
 		virtual void destroyFence (Fence fence) = 0;
 		virtual void destroySemaphore (Semaphore sem) = 0;
 
+		virtual PipelineCacheStats getPipelineCacheStats () = 0;
+
+		/*
+		 * Runs a job on the pipeline compile threads. Jobs may only call createShaderModule*(), create*Pipeline() & destroyShaderModule(),
+		 * and what they create is only usable after waitForPipelineCompileJobs() returns, or once the job's resource reads "dataLoaded" as true.
+		 */
+		void pushPipelineCompileJob (const std::function<void()> &job);
+		void waitForPipelineCompileJobs ();
+		uint32_t getPendingPipelineCompileJobCount ();
+
 #if SE_RENDER_DEBUG_MARKERS
 		virtual void setObjectDebugName (void *obj, RendererObjectType objType, const std::string &name) = 0;
 #else
@@ -111,6 +125,25 @@ class Renderer
 
 		static RendererBackend chooseRendererBackend (const std::vector<std::string>& launchArgs);
 		static Renderer* allocateRenderer (const RendererAllocInfo& allocInfo);
+
+	private:
+
+		/*
+		 * The compile threads are started the first time a job is pushed (one per core, minus the main thread), and then sleep
+		 * on "pipelineCompileJobs_cv" until there's something to do. They're only stopped & joined when the renderer is destroyed.
+		 */
+		bool pipelineCompileThreadsRunning;
+		std::vector<std::thread> pipelineCompileThreads;
+
+		std::mutex pipelineCompileJobs_mutex; // Controls access of member "pipelineCompileJobs", "pipelineCompileThreadsRunning", and "pipelineCompileThreads"
+		std::condition_variable pipelineCompileJobs_cv;
+		std::condition_variable pipelineCompileJobsDone_cv; // Notified when "pendingPipelineCompileJobs" hits zero
+		std::deque<std::function<void()> > pipelineCompileJobs;
+		std::atomic<uint32_t> pendingPipelineCompileJobs; // Jobs that are queued or still running, only decremented w/ the lock held
+
+		void pipelineCompileThreadFunc ();
+		bool runPipelineCompileJob ();
+		void finishPipelineCompileJob ();
 };
 
 #endif /* RENDERING_RENDERER_H_ */
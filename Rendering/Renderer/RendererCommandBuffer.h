@@ -85,6 +85,27 @@ class RendererCommandBuffer
 		virtual void stageBuffer (StagingBuffer stagingBuffer, Texture dstTexture, TextureSubresourceLayers subresource = {0, 0, 1}, sivec3 offset = {0, 0, 0}, suvec3 extent = {std::numeric_limits<uint32_t>::max(), std::numeric_limits<uint32_t>::max(), std::numeric_limits<uint32_t>::max()}) = 0;
 		virtual void stageBuffer (StagingBuffer stagingBuffer, Buffer dstBuffer) = 0;
 
+		/*
+		 * Copies a range of a staging buffer to a range of a buffer, so several uploads can share one staging buffer.
+		 */
+		virtual void stageBuffer (StagingBuffer stagingBuffer, size_t srcOffset, Buffer dstBuffer, size_t dstOffset, size_t size) = 0;
+
+		/*
+		 * Copies several regions of a staging buffer to a texture in a single copy command, e.g. every
+		 * mip level & layer of a texture at once. The texture has to be in TEXTURE_LAYOUT_TRANSFER_DST_OPTIMAL.
+		 */
+		virtual void stageBuffer (StagingBuffer stagingBuffer, Texture dstTexture, const std::vector<TextureBufferCopyInfo> &copyRegions) = 0;
+
+		/*
+		 * Records one half of a queue ownership transfer for a resource that was written by transfer commands on one queue and
+		 * is going to be used on another, i.e. uploaded on the transfer queue & then rendered w/ on the graphics queue. The same
+		 * call has to be recorded on both queues, the release on srcQueue and then the acquire on dstQueue, w/ the acquire
+		 * waiting on the release (i.e. w/ a semaphore). If both queues are in the same family then the release does nothing
+		 * and the acquire is just a regular barrier.
+		 */
+		virtual void transferBufferOwnership (Buffer buffer, size_t offset, size_t size, QueueType srcQueue, QueueType dstQueue) = 0;
+		virtual void transferTextureOwnership (Texture texture, TextureLayout oldLayout, TextureLayout newLayout, TextureSubresourceRange subresource, QueueType srcQueue, QueueType dstQueue) = 0;
+
 		virtual void setViewports (uint32_t firstViewport, const std::vector<Viewport> &viewports) = 0;
 		virtual void setScissors (uint32_t firstScissor, const std::vector<Scissor> &scissors) = 0;
 
@@ -359,8 +359,30 @@ typedef struct TextureBlitInfo
 		sivec3 dstOffsets[2];
 } TextureBlitInfo;
 
+typedef struct TextureBufferCopyInfo
+{
+		size_t bufferOffset;
+		TextureSubresourceLayers textureSubresource;
+		sivec3 textureOffset;
+		suvec3 textureExtent;
+} TextureBufferCopyInfo;
+
 //f//
 
+/*
+ * Stats about the backend's pipeline cache, which is what keeps pipeline creation from compiling every pipeline from scratch
+ * on every launch. Hits are only known if the driver reports them, which is what "hitsReported" is for.
+ */
+typedef struct PipelineCacheStats
+{
+		uint32_t pipelinesCreated;
+		uint32_t cacheHits;
+		bool hitsReported;
+		double totalCreationTime; // In milliseconds
+		size_t loadedCacheSize;   // The size of the cache that was loaded from disk at startup, 0 if there wasn't a usable one
+		size_t cacheSize;
+} PipelineCacheStats;
+
 typedef struct RendererFence
 {
 } RendererFence;
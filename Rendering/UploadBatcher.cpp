@@ -0,0 +1,396 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2017 David Allen
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * UploadBatcher.cpp
+ */
+
+#include "Rendering/UploadBatcher.h"
+
+#include <Rendering/Renderer/Renderer.h>
+
+UploadBatcher::UploadBatcher (Renderer *rendererInstance)
+{
+	renderer = rendererInstance;
+
+	transferCommandPool = renderer->createCommandPool(QUEUE_TYPE_TRANSFER, COMMAND_POOL_TRANSIENT_BIT);
+	graphicsCommandPool = renderer->createCommandPool(QUEUE_TYPE_GRAPHICS, COMMAND_POOL_TRANSIENT_BIT);
+
+	resetPendingBatch();
+
+	stats = {};
+	frameBatchCount = 0;
+	frameUploadCount = 0;
+	frameUploadSize = 0;
+	statsPeriodUploadSize = 0;
+	statsPeriodStart = std::chrono::steady_clock::now();
+}
+
+UploadBatcher::~UploadBatcher ()
+{
+	flushAndWait();
+
+	for (size_t i = 0; i < freeStagingChunks.size(); i ++)
+		renderer->destroyStagingBuffer(freeStagingChunks[i].buffer);
+
+	renderer->destroyCommandPool(transferCommandPool);
+	renderer->destroyCommandPool(graphicsCommandPool);
+}
+
+void *UploadBatcher::uploadBuffer (Buffer dstBuffer, size_t dstOffset, size_t size)
+{
+	PendingBufferUpload upload = {};
+	upload.dstBuffer = dstBuffer;
+	upload.dstOffset = dstOffset;
+	upload.size = size;
+
+	char *stagingData = allocateStagingMemory(size, upload.stagingBuffer, upload.stagingOffset);
+
+	pendingBatch.bufferUploads.push_back(upload);
+
+	return stagingData;
+}
+
+void *UploadBatcher::uploadTexture (Texture dstTexture, size_t dataSize, const std::vector<TextureBufferCopyInfo> &copyRegions, uint32_t mipLevels, uint32_t arrayLayers, bool generateMipmaps)
+{
+	PendingTextureUpload upload = {};
+	upload.dstTexture = dstTexture;
+	upload.copyRegions = copyRegions;
+	upload.mipLevels = mipLevels;
+	upload.arrayLayers = arrayLayers;
+	upload.generateMipmaps = generateMipmaps;
+
+	size_t stagingOffset = 0;
+	char *stagingData = allocateStagingMemory(dataSize, upload.stagingBuffer, stagingOffset);
+
+	// The caller's regions are relative to it's own data, so move them to where it ended up in the staging chunk
+	for (size_t i = 0; i < upload.copyRegions.size(); i ++)
+		upload.copyRegions[i].bufferOffset += stagingOffset;
+
+	pendingBatch.textureUploads.push_back(upload);
+
+	return stagingData;
+}
+
+void UploadBatcher::addUploadCallback (const std::function<void()> &callback)
+{
+	// If nothing's been queued since the last flush, then the callback just has to wait for whatever's already in flight
+	if (pendingBatch.bufferUploads.size() == 0 && pendingBatch.textureUploads.size() == 0 && inFlightBatches.size() > 0)
+		inFlightBatches.back().callbacks.push_back(callback);
+	else
+		pendingBatch.callbacks.push_back(callback);
+}
+
+/*
+ * Records & submits every upload queued since the last flush as a single batch. The copies are done on the
+ * transfer queue, and ownership of every resource is released to the graphics queue, which acquires them
+ * (and generates mipmaps if need be) once the transfer queue signals the batch's semaphore.
+ */
+void UploadBatcher::flush ()
+{
+	if (pendingBatch.bufferUploads.size() == 0 && pendingBatch.textureUploads.size() == 0)
+	{
+		// Callbacks w/o any uploads can just be called on the next update
+		if (pendingBatch.callbacks.size() > 0)
+		{
+			UploadBatch &batch = pendingBatch;
+			batch.fence = nullptr;
+			inFlightBatches.push_back(batch);
+			resetPendingBatch();
+		}
+
+		return;
+	}
+
+	UploadBatch &batch = pendingBatch;
+
+	for (size_t i = 0; i < batch.stagingChunks.size(); i ++)
+	{
+		renderer->unmapStagingBuffer(batch.stagingChunks[i].buffer);
+		batch.stagingChunks[i].mappedData = nullptr;
+	}
+
+	batch.transferCmdBuffer = transferCommandPool->allocateCommandBuffer(COMMAND_BUFFER_LEVEL_PRIMARY);
+	batch.graphicsCmdBuffer = graphicsCommandPool->allocateCommandBuffer(COMMAND_BUFFER_LEVEL_PRIMARY);
+
+	RendererCommandBuffer *transferCmd = batch.transferCmdBuffer;
+	RendererCommandBuffer *graphicsCmd = batch.graphicsCmdBuffer;
+
+	transferCmd->beginCommands(COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+	graphicsCmd->beginCommands(COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+
+	transferCmd->beginDebugRegion("Upload Batch (" + toString(batch.bufferUploads.size() + batch.textureUploads.size()) + " uploads)");
+
+	for (size_t i = 0; i < batch.bufferUploads.size(); i ++)
+	{
+		const PendingBufferUpload &upload = batch.bufferUploads[i];
+
+		transferCmd->stageBuffer(upload.stagingBuffer, upload.stagingOffset, upload.dstBuffer, upload.dstOffset, upload.size);
+		transferCmd->transferBufferOwnership(upload.dstBuffer, upload.dstOffset, upload.size, QUEUE_TYPE_TRANSFER, QUEUE_TYPE_GRAPHICS);
+		graphicsCmd->transferBufferOwnership(upload.dstBuffer, upload.dstOffset, upload.size, QUEUE_TYPE_TRANSFER, QUEUE_TYPE_GRAPHICS);
+	}
+
+	for (size_t i = 0; i < batch.textureUploads.size(); i ++)
+	{
+		const PendingTextureUpload &upload = batch.textureUploads[i];
+
+		// W/ mipmap generation only the first level is copied, and it's handed over ready to be blitted from
+		TextureSubresourceRange copyRange = {0, upload.generateMipmaps ? 1 : upload.mipLevels, 0, upload.arrayLayers};
+		TextureLayout acquireLayout = upload.generateMipmaps ? TEXTURE_LAYOUT_TRANSFER_SRC_OPTIMAL : TEXTURE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+		transferCmd->setTextureLayout(upload.dstTexture, TEXTURE_LAYOUT_UNDEFINED, TEXTURE_LAYOUT_TRANSFER_DST_OPTIMAL, copyRange, PIPELINE_STAGE_TOP_OF_PIPE_BIT, PIPELINE_STAGE_TRANSFER_BIT);
+		transferCmd->stageBuffer(upload.stagingBuffer, upload.dstTexture, upload.copyRegions);
+		transferCmd->transferTextureOwnership(upload.dstTexture, TEXTURE_LAYOUT_TRANSFER_DST_OPTIMAL, acquireLayout, copyRange, QUEUE_TYPE_TRANSFER, QUEUE_TYPE_GRAPHICS);
+		graphicsCmd->transferTextureOwnership(upload.dstTexture, TEXTURE_LAYOUT_TRANSFER_DST_OPTIMAL, acquireLayout, copyRange, QUEUE_TYPE_TRANSFER, QUEUE_TYPE_GRAPHICS);
+
+		if (upload.generateMipmaps)
+			recordMipmapGeneration(graphicsCmd, upload);
+	}
+
+	transferCmd->endDebugRegion();
+
+	transferCmd->endCommands();
+	graphicsCmd->endCommands();
+
+	batch.transferSemaphore = renderer->createSemaphore();
+	batch.fence = renderer->createFence(false);
+
+	renderer->submitToQueue(QUEUE_TYPE_TRANSFER, {transferCmd}, {}, {}, {batch.transferSemaphore});
+	renderer->submitToQueue(QUEUE_TYPE_GRAPHICS, {graphicsCmd}, {batch.transferSemaphore}, {PIPELINE_STAGE_ALL_COMMANDS_BIT}, {}, batch.fence);
+
+	frameBatchCount ++;
+	frameUploadCount += uint32_t(batch.bufferUploads.size() + batch.textureUploads.size());
+	frameUploadSize += batch.uploadSize;
+	stats.totalBatchCount ++;
+	stats.totalUploadSize += batch.uploadSize;
+
+	inFlightBatches.push_back(batch);
+	resetPendingBatch();
+}
+
+/*
+ * Flushes the pending uploads and waits for every batch to finish. Mostly for the immediate loads, which
+ * have to have their data on the GPU before they return.
+ */
+void UploadBatcher::flushAndWait ()
+{
+	flush();
+
+	while (inFlightBatches.size() > 0)
+	{
+		UploadBatch batch = inFlightBatches.front();
+		inFlightBatches.pop_front();
+
+		if (batch.fence != nullptr)
+			renderer->waitForFence(batch.fence, 60.0);
+
+		finishBatch(batch);
+	}
+}
+
+/*
+ * Flushes the pending uploads, finishes any batches that are done on the GPU, and updates the stats. Should
+ * be called once per frame.
+ */
+void UploadBatcher::update ()
+{
+	flush();
+
+	// Every batch ends on the graphics queue, so they always finish in the order they were submitted
+	while (inFlightBatches.size() > 0 && (inFlightBatches.front().fence == nullptr || renderer->getFenceStatus(inFlightBatches.front().fence)))
+	{
+		UploadBatch batch = inFlightBatches.front();
+		inFlightBatches.pop_front();
+
+		finishBatch(batch);
+	}
+
+	stats.lastFrameBatchCount = frameBatchCount;
+	stats.lastFrameUploadCount = frameUploadCount;
+	stats.lastFrameUploadSize = frameUploadSize;
+	stats.batchesInFlight = (uint32_t) inFlightBatches.size();
+
+	frameBatchCount = 0;
+	frameUploadCount = 0;
+	frameUploadSize = 0;
+
+	double periodLength = std::chrono::duration<double>(std::chrono::steady_clock::now() - statsPeriodStart).count();
+
+	if (periodLength >= UPLOAD_BATCHER_STATS_PERIOD)
+	{
+		stats.uploadBytesPerSecond = double(statsPeriodUploadSize) / periodLength;
+
+		statsPeriodUploadSize = 0;
+		statsPeriodStart = std::chrono::steady_clock::now();
+	}
+}
+
+UploadBatcherStats UploadBatcher::getStats ()
+{
+	return stats;
+}
+
+size_t UploadBatcher::getFrameUploadSize ()
+{
+	return frameUploadSize + pendingBatch.uploadSize;
+}
+
+/*
+ * Hands out staging memory from the pending batch's current chunk, moving on to a new (or recycled) chunk when it's full. Uploads
+ * bigger than a whole chunk get a staging buffer of their own. If the pending batch has gotten too big then it's flushed first, so a
+ * big load doesn't hold on to an unbounded amount of staging memory until the end of the frame.
+ */
+char *UploadBatcher::allocateStagingMemory (size_t size, StagingBuffer &stagingBuffer, size_t &stagingOffset)
+{
+	if (pendingBatch.uploadSize + size > UPLOAD_BATCHER_MAX_BATCH_SIZE && pendingBatch.uploadSize > 0)
+		flush();
+
+	pendingBatch.uploadSize += size;
+
+	if (size > UPLOAD_BATCHER_STAGING_CHUNK_SIZE)
+	{
+		StagingChunk chunk = {};
+		chunk.buffer = renderer->createStagingBuffer(size);
+		chunk.mappedData = static_cast<char*>(renderer->mapStagingBuffer(chunk.buffer));
+		chunk.size = size;
+		chunk.used = size;
+
+		pendingBatch.stagingChunks.push_back(chunk);
+
+		stagingBuffer = chunk.buffer;
+		stagingOffset = 0;
+
+		return chunk.mappedData;
+	}
+
+	if (pendingBatchCurrentChunk >= 0)
+	{
+		StagingChunk &chunk = pendingBatch.stagingChunks[pendingBatchCurrentChunk];
+		size_t alignedOffset = (chunk.used + UPLOAD_BATCHER_STAGING_ALIGNMENT - 1) & ~size_t(UPLOAD_BATCHER_STAGING_ALIGNMENT - 1);
+
+		if (alignedOffset + size <= chunk.size)
+		{
+			chunk.used = alignedOffset + size;
+			stagingBuffer = chunk.buffer;
+			stagingOffset = alignedOffset;
+
+			return chunk.mappedData + alignedOffset;
+		}
+	}
+
+	StagingChunk chunk = {};
+
+	if (freeStagingChunks.size() > 0)
+	{
+		chunk = freeStagingChunks.back();
+		freeStagingChunks.pop_back();
+	}
+	else
+	{
+		chunk.buffer = renderer->createStagingBuffer(UPLOAD_BATCHER_STAGING_CHUNK_SIZE);
+		chunk.size = UPLOAD_BATCHER_STAGING_CHUNK_SIZE;
+	}
+
+	chunk.mappedData = static_cast<char*>(renderer->mapStagingBuffer(chunk.buffer));
+	chunk.used = size;
+
+	pendingBatch.stagingChunks.push_back(chunk);
+	pendingBatchCurrentChunk = int32_t(pendingBatch.stagingChunks.size() - 1);
+
+	stagingBuffer = chunk.buffer;
+	stagingOffset = 0;
+
+	return chunk.mappedData;
+}
+
+/*
+ * Blits every mip level from the one above it, for every layer at once. Level 0 is in TEXTURE_LAYOUT_TRANSFER_SRC_OPTIMAL when
+ * this starts, and the whole texture is in TEXTURE_LAYOUT_SHADER_READ_ONLY_OPTIMAL when it's done.
+ */
+void UploadBatcher::recordMipmapGeneration (RendererCommandBuffer *cmdBuffer, const PendingTextureUpload &upload)
+{
+	uint32_t width = upload.dstTexture->width, height = upload.dstTexture->height;
+
+	for (uint32_t i = 1; i < upload.mipLevels; i ++)
+	{
+		TextureSubresourceRange mipRange = {i, 1, 0, upload.arrayLayers};
+
+		TextureBlitInfo blitInfo = {};
+		blitInfo.srcSubresource =
+		{	i - 1, 0, upload.arrayLayers};
+		blitInfo.dstSubresource =
+		{	i, 0, upload.arrayLayers};
+		blitInfo.srcOffsets[0] =
+		{	0, 0, 0};
+		blitInfo.dstOffsets[0] =
+		{	0, 0, 0};
+		blitInfo.srcOffsets[1] =
+		{	std::max(int32_t(width >> (i - 1)), 1), std::max(int32_t(height >> (i - 1)), 1), 1};
+		blitInfo.dstOffsets[1] =
+		{	std::max(int32_t(width >> i), 1), std::max(int32_t(height >> i), 1), 1};
+
+		cmdBuffer->setTextureLayout(upload.dstTexture, TEXTURE_LAYOUT_UNDEFINED, TEXTURE_LAYOUT_TRANSFER_DST_OPTIMAL, mipRange, PIPELINE_STAGE_TRANSFER_BIT, PIPELINE_STAGE_TRANSFER_BIT);
+		cmdBuffer->blitTexture(upload.dstTexture, TEXTURE_LAYOUT_TRANSFER_SRC_OPTIMAL, upload.dstTexture, TEXTURE_LAYOUT_TRANSFER_DST_OPTIMAL, {blitInfo}, SAMPLER_FILTER_LINEAR);
+		cmdBuffer->setTextureLayout(upload.dstTexture, TEXTURE_LAYOUT_TRANSFER_DST_OPTIMAL, TEXTURE_LAYOUT_TRANSFER_SRC_OPTIMAL, mipRange, PIPELINE_STAGE_TRANSFER_BIT, PIPELINE_STAGE_TRANSFER_BIT);
+	}
+
+	cmdBuffer->setTextureLayout(upload.dstTexture, TEXTURE_LAYOUT_TRANSFER_SRC_OPTIMAL, TEXTURE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, {0, upload.mipLevels, 0, upload.arrayLayers}, PIPELINE_STAGE_TRANSFER_BIT, PIPELINE_STAGE_ALL_COMMANDS_BIT);
+}
+
+/*
+ * Frees a finished batch's command buffers & sync objects, recycles it's staging chunks, and calls it's callbacks.
+ */
+void UploadBatcher::finishBatch (UploadBatch &batch)
+{
+	if (batch.fence != nullptr)
+	{
+		transferCommandPool->freeCommandBuffer(batch.transferCmdBuffer);
+		graphicsCommandPool->freeCommandBuffer(batch.graphicsCmdBuffer);
+
+		renderer->destroySemaphore(batch.transferSemaphore);
+		renderer->destroyFence(batch.fence);
+	}
+
+	for (size_t i = 0; i < batch.stagingChunks.size(); i ++)
+	{
+		if (batch.stagingChunks[i].size == UPLOAD_BATCHER_STAGING_CHUNK_SIZE && freeStagingChunks.size() < UPLOAD_BATCHER_MAX_FREE_CHUNKS)
+			freeStagingChunks.push_back(batch.stagingChunks[i]);
+		else
+			renderer->destroyStagingBuffer(batch.stagingChunks[i].buffer);
+	}
+
+	statsPeriodUploadSize += batch.uploadSize;
+
+	for (size_t i = 0; i < batch.callbacks.size(); i ++)
+		batch.callbacks[i]();
+}
+
+void UploadBatcher::resetPendingBatch ()
+{
+	pendingBatch = UploadBatch();
+	pendingBatch.uploadSize = 0;
+	pendingBatch.transferCmdBuffer = nullptr;
+	pendingBatch.graphicsCmdBuffer = nullptr;
+	pendingBatch.transferSemaphore = nullptr;
+	pendingBatch.fence = nullptr;
+	pendingBatchCurrentChunk = -1;
+}
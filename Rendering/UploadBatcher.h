@@ -0,0 +1,169 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2017 David Allen
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * UploadBatcher.h
+ */
+
+#ifndef RENDERING_UPLOADBATCHER_H_
+#define RENDERING_UPLOADBATCHER_H_
+
+#include <common.h>
+#include <Rendering/Renderer/RendererEnums.h>
+#include <Rendering/Renderer/RendererObjects.h>
+
+#include <functional>
+#include <deque>
+
+class Renderer;
+class RendererCommandPool;
+class RendererCommandBuffer;
+
+#define UPLOAD_BATCHER_STAGING_CHUNK_SIZE (32 * 1024 * 1024)
+#define UPLOAD_BATCHER_STAGING_ALIGNMENT 16
+#define UPLOAD_BATCHER_MAX_FREE_CHUNKS 4
+#define UPLOAD_BATCHER_MAX_BATCH_SIZE (128 * 1024 * 1024)
+#define UPLOAD_BATCHER_STATS_PERIOD 1.0
+
+typedef struct UploadBatcherStats
+{
+		uint32_t lastFrameBatchCount;   // Batches submitted during the last update()
+		uint32_t lastFrameUploadCount;  // Buffer & texture uploads submitted during the last update()
+		size_t lastFrameUploadSize;     // Bytes submitted during the last update()
+		uint32_t batchesInFlight;       // Batches submitted but not finished on the GPU yet
+		double uploadBytesPerSecond;    // Bytes of finished uploads per second, averaged over UPLOAD_BATCHER_STATS_PERIOD
+		uint64_t totalBatchCount;
+		uint64_t totalUploadSize;
+} UploadBatcherStats;
+
+/*
+ * Collects buffer & texture uploads into batches, instead of each upload being it's own command buffer & queue stall.
+ * Upload data is packed into large staging chunks (which are recycled), the copies are recorded & submitted on the transfer
+ * queue once per flush, and ownership is then handed to the graphics queue (w/ a semaphore between the two) where any
+ * mipmap generation is done too. Nothing waits on the GPU, finished batches are found by polling their fences in update(),
+ * at which point their staging memory is recycled and their callbacks are called.
+ *
+ * Everything in here has to be called from the same thread (the main thread), like the rest of the renderer.
+ */
+class UploadBatcher
+{
+	public:
+
+		UploadBatcher (Renderer *rendererInstance);
+		virtual ~UploadBatcher ();
+
+		/*
+		 * Queues a copy into a buffer and returns "size" bytes of staging memory to write the data to. The memory is
+		 * only valid until the next call into the batcher, so it has to be filled right away.
+		 */
+		void *uploadBuffer (Buffer dstBuffer, size_t dstOffset, size_t size);
+
+		/*
+		 * Same as uploadBuffer(), but for a texture. The copy region offsets are relative to the returned staging memory.
+		 * The texture is in TEXTURE_LAYOUT_SHADER_READ_ONLY_OPTIMAL once the upload is done. If generateMipmaps is set then
+		 * only mip level 0 should be uploaded, and the rest of the levels are blitted from it on the graphics queue.
+		 */
+		void *uploadTexture (Texture dstTexture, size_t dataSize, const std::vector<TextureBufferCopyInfo> &copyRegions, uint32_t mipLevels, uint32_t arrayLayers, bool generateMipmaps = false);
+
+		/*
+		 * Adds a callback that's called (from update()) once every upload queued so far has finished on the GPU.
+		 */
+		void addUploadCallback (const std::function<void()> &callback);
+
+		void flush ();
+		void flushAndWait ();
+		void update ();
+
+		UploadBatcherStats getStats ();
+
+		/*
+		 * Returns the bytes queued since the last update(), including any that haven't been flushed yet.
+		 */
+		size_t getFrameUploadSize ();
+
+	private:
+
+		typedef struct StagingChunk
+		{
+				StagingBuffer buffer;
+				char *mappedData;
+				size_t size;
+				size_t used;
+		} StagingChunk;
+
+		typedef struct PendingBufferUpload
+		{
+				StagingBuffer stagingBuffer;
+				size_t stagingOffset;
+				Buffer dstBuffer;
+				size_t dstOffset;
+				size_t size;
+		} PendingBufferUpload;
+
+		typedef struct PendingTextureUpload
+		{
+				StagingBuffer stagingBuffer;
+				Texture dstTexture;
+				std::vector<TextureBufferCopyInfo> copyRegions;
+				uint32_t mipLevels;
+				uint32_t arrayLayers;
+				bool generateMipmaps;
+		} PendingTextureUpload;
+
+		typedef struct UploadBatch
+		{
+				std::vector<StagingChunk> stagingChunks;
+				std::vector<PendingBufferUpload> bufferUploads;
+				std::vector<PendingTextureUpload> textureUploads;
+				std::vector<std::function<void()> > callbacks;
+				size_t uploadSize;
+
+				RendererCommandBuffer *transferCmdBuffer;
+				RendererCommandBuffer *graphicsCmdBuffer;
+				Semaphore transferSemaphore;
+				Fence fence;
+		} UploadBatch;
+
+		Renderer *renderer;
+
+		RendererCommandPool *transferCommandPool;
+		RendererCommandPool *graphicsCommandPool;
+
+		UploadBatch pendingBatch;
+		int32_t pendingBatchCurrentChunk;
+		std::deque<UploadBatch> inFlightBatches;
+		std::vector<StagingChunk> freeStagingChunks;
+
+		UploadBatcherStats stats;
+		uint32_t frameBatchCount;
+		uint32_t frameUploadCount;
+		size_t frameUploadSize;
+		size_t statsPeriodUploadSize;
+		std::chrono::steady_clock::time_point statsPeriodStart;
+
+		char *allocateStagingMemory (size_t size, StagingBuffer &stagingBuffer, size_t &stagingOffset);
+		void recordMipmapGeneration (RendererCommandBuffer *cmdBuffer, const PendingTextureUpload &upload);
+		void finishBatch (UploadBatch &batch);
+		void resetPendingBatch ();
+};
+
+#endif /* RENDERING_UPLOADBATCHER_H_ */
@@ -35,6 +35,8 @@
 VulkanCommandBuffer::VulkanCommandBuffer()
 {
 	bufferHandle = nullptr;
+	queue = QUEUE_TYPE_GRAPHICS;
+	deviceQueueInfo = nullptr;
 	context_currentBoundPipeline = nullptr;
 }
 
@@ -360,6 +362,149 @@ void VulkanCommandBuffer::stageBuffer (StagingBuffer stagingBuffer, Buffer dstBu
 	vkCmdCopyBuffer(bufferHandle, static_cast<VulkanStagingBuffer*>(stagingBuffer)->bufferHandle, static_cast<VulkanBuffer*>(dstBuffer)->bufferHandle, 1, &bufferCopyRegion);
 }
 
+void VulkanCommandBuffer::stageBuffer (StagingBuffer stagingBuffer, size_t srcOffset, Buffer dstBuffer, size_t dstOffset, size_t size)
+{
+	VkBufferCopy bufferCopyRegion = {};
+	bufferCopyRegion.dstOffset = dstOffset;
+	bufferCopyRegion.srcOffset = srcOffset;
+	bufferCopyRegion.size = size;
+
+	vkCmdCopyBuffer(bufferHandle, static_cast<VulkanStagingBuffer*>(stagingBuffer)->bufferHandle, static_cast<VulkanBuffer*>(dstBuffer)->bufferHandle, 1, &bufferCopyRegion);
+}
+
+void VulkanCommandBuffer::stageBuffer (StagingBuffer stagingBuffer, Texture dstTexture, const std::vector<TextureBufferCopyInfo> &copyRegions)
+{
+	std::vector<VkBufferImageCopy> imgCopyRegions(copyRegions.size());
+
+	for (size_t i = 0; i < copyRegions.size(); i ++)
+	{
+		const TextureBufferCopyInfo &copyRegion = copyRegions[i];
+		VkBufferImageCopy &imgCopyRegion = imgCopyRegions[i];
+
+		imgCopyRegion.bufferOffset = copyRegion.bufferOffset;
+		imgCopyRegion.bufferRowLength = 0;
+		imgCopyRegion.bufferImageHeight = 0;
+		imgCopyRegion.imageSubresource.aspectMask = isDepthFormat(dstTexture->textureFormat) ? VK_IMAGE_ASPECT_DEPTH_BIT : VK_IMAGE_ASPECT_COLOR_BIT;
+		imgCopyRegion.imageSubresource.mipLevel = copyRegion.textureSubresource.mipLevel;
+		imgCopyRegion.imageSubresource.baseArrayLayer = copyRegion.textureSubresource.baseArrayLayer;
+		imgCopyRegion.imageSubresource.layerCount = copyRegion.textureSubresource.layerCount;
+		imgCopyRegion.imageOffset =
+		{	copyRegion.textureOffset.x, copyRegion.textureOffset.y, copyRegion.textureOffset.z};
+		imgCopyRegion.imageExtent =
+		{	copyRegion.textureExtent.x, copyRegion.textureExtent.y, copyRegion.textureExtent.z};
+	}
+
+	vkCmdCopyBufferToImage(bufferHandle, static_cast<VulkanStagingBuffer*>(stagingBuffer)->bufferHandle, static_cast<VulkanTexture*>(dstTexture)->imageHandle, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, (uint32_t) imgCopyRegions.size(), imgCopyRegions.data());
+}
+
+inline uint32_t getQueueFamilyIndex (const DeviceQueues *deviceQueueInfo, QueueType queue)
+{
+	switch (queue)
+	{
+		case QUEUE_TYPE_GRAPHICS:
+			return (uint32_t) deviceQueueInfo->graphicsFamily;
+		case QUEUE_TYPE_COMPUTE:
+			return (uint32_t) deviceQueueInfo->computeFamily;
+		case QUEUE_TYPE_TRANSFER:
+			return (uint32_t) deviceQueueInfo->transferFamily;
+		default:
+			return VK_QUEUE_FAMILY_IGNORED;
+	}
+}
+
+void VulkanCommandBuffer::transferBufferOwnership (Buffer buffer, size_t offset, size_t size, QueueType srcQueue, QueueType dstQueue)
+{
+	uint32_t srcFamily = getQueueFamilyIndex(deviceQueueInfo, srcQueue);
+	uint32_t dstFamily = getQueueFamilyIndex(deviceQueueInfo, dstQueue);
+	bool isRelease = (queue == srcQueue);
+
+	// W/ a single queue family there's no ownership to transfer, so the acquire just has to make the transfer writes visible
+	if (srcFamily == dstFamily && isRelease)
+		return;
+
+	VkBufferMemoryBarrier barrier = {};
+	barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+	barrier.srcQueueFamilyIndex = (srcFamily == dstFamily) ? VK_QUEUE_FAMILY_IGNORED : srcFamily;
+	barrier.dstQueueFamilyIndex = (srcFamily == dstFamily) ? VK_QUEUE_FAMILY_IGNORED : dstFamily;
+	barrier.buffer = static_cast<VulkanBuffer*>(buffer)->bufferHandle;
+	barrier.offset = offset;
+	barrier.size = size;
+
+	VkPipelineStageFlags srcStage, dstStage;
+
+	if (isRelease)
+	{
+		barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.dstAccessMask = 0;
+		srcStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
+		dstStage = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+	}
+	else
+	{
+		barrier.srcAccessMask = (srcFamily == dstFamily) ? VK_ACCESS_TRANSFER_WRITE_BIT : 0;
+		barrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT | VK_ACCESS_UNIFORM_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+		srcStage = (srcFamily == dstFamily) ? VK_PIPELINE_STAGE_TRANSFER_BIT : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+		dstStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+	}
+
+	vkCmdPipelineBarrier(bufferHandle, srcStage, dstStage, 0, 0, nullptr, 1, &barrier, 0, nullptr);
+}
+
+void VulkanCommandBuffer::transferTextureOwnership (Texture texture, TextureLayout oldLayout, TextureLayout newLayout, TextureSubresourceRange subresource, QueueType srcQueue, QueueType dstQueue)
+{
+	uint32_t srcFamily = getQueueFamilyIndex(deviceQueueInfo, srcQueue);
+	uint32_t dstFamily = getQueueFamilyIndex(deviceQueueInfo, dstQueue);
+	bool isRelease = (queue == srcQueue);
+
+	// Same as buffers, except the layout transition still has to happen on the acquiring queue
+	if (srcFamily == dstFamily && isRelease)
+		return;
+
+	VkImageMemoryBarrier barrier = {};
+	barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	barrier.oldLayout = toVkImageLayout(oldLayout);
+	barrier.newLayout = toVkImageLayout(newLayout);
+	barrier.srcQueueFamilyIndex = (srcFamily == dstFamily) ? VK_QUEUE_FAMILY_IGNORED : srcFamily;
+	barrier.dstQueueFamilyIndex = (srcFamily == dstFamily) ? VK_QUEUE_FAMILY_IGNORED : dstFamily;
+	barrier.image = static_cast<VulkanTexture*>(texture)->imageHandle;
+	barrier.subresourceRange =
+	{ VkImageAspectFlags(isDepthFormat(texture->textureFormat) ? VK_IMAGE_ASPECT_DEPTH_BIT : VK_IMAGE_ASPECT_COLOR_BIT), subresource.baseMipLevel, subresource.levelCount, subresource.baseArrayLayer, subresource.layerCount};
+
+	VkPipelineStageFlags srcStage, dstStage;
+
+	if (isRelease)
+	{
+		barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.dstAccessMask = 0;
+		srcStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
+		dstStage = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+	}
+	else
+	{
+		barrier.srcAccessMask = (srcFamily == dstFamily) ? VK_ACCESS_TRANSFER_WRITE_BIT : 0;
+		srcStage = (srcFamily == dstFamily) ? VK_PIPELINE_STAGE_TRANSFER_BIT : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+		dstStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+
+		switch (newLayout)
+		{
+			case TEXTURE_LAYOUT_TRANSFER_SRC_OPTIMAL:
+				barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+				break;
+			case TEXTURE_LAYOUT_TRANSFER_DST_OPTIMAL:
+				barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+				break;
+			case TEXTURE_LAYOUT_SHADER_READ_ONLY_OPTIMAL:
+				barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+				break;
+			default:
+				barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+				break;
+		}
+	}
+
+	vkCmdPipelineBarrier(bufferHandle, srcStage, dstStage, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+}
+
 void VulkanCommandBuffer::setViewports (uint32_t firstViewport, const std::vector<Viewport> &viewports)
 {
 	// Generic viewports have the same data struct as vulkan viewports, so they map directly
@@ -35,11 +35,15 @@
 #include <Rendering/Renderer/RendererEnums.h>
 #include <Rendering/Renderer/RendererObjects.h>
 
+class DeviceQueues;
+
 class VulkanCommandBuffer : public RendererCommandBuffer
 {
 	public:
 
 		VkCommandBuffer bufferHandle;
+		QueueType queue;
+		const DeviceQueues *deviceQueueInfo;
 
 		VulkanCommandBuffer ();
 		virtual ~VulkanCommandBuffer ();
@@ -69,6 +73,11 @@ class VulkanCommandBuffer : public RendererCommandBuffer
 
 		void stageBuffer (StagingBuffer stagingBuffer, Texture dstTexture, TextureSubresourceLayers subresource, sivec3 offset, suvec3 extent);
 		void stageBuffer (StagingBuffer stagingBuffer, Buffer dstBuffer);
+		void stageBuffer (StagingBuffer stagingBuffer, size_t srcOffset, Buffer dstBuffer, size_t dstOffset, size_t size);
+		void stageBuffer (StagingBuffer stagingBuffer, Texture dstTexture, const std::vector<TextureBufferCopyInfo> &copyRegions);
+
+		void transferBufferOwnership (Buffer buffer, size_t offset, size_t size, QueueType srcQueue, QueueType dstQueue);
+		void transferTextureOwnership (Texture texture, TextureLayout oldLayout, TextureLayout newLayout, TextureSubresourceRange subresource, QueueType srcQueue, QueueType dstQueue);
 
 		void setViewports (uint32_t firstViewport, const std::vector<Viewport> &viewports);
 		void setScissors (uint32_t firstScissor, const std::vector<Scissor> &scissors);
@@ -62,6 +62,8 @@ std::vector<RendererCommandBuffer*> VulkanCommandPool::allocateCommandBuffers (C
 		VulkanCommandBuffer* vkCmdBuffer = new VulkanCommandBuffer();
 		vkCmdBuffer->level = level;
 		vkCmdBuffer->bufferHandle = vkCommandBuffers[i];
+		vkCmdBuffer->queue = queue;
+		vkCmdBuffer->deviceQueueInfo = deviceQueueInfo;
 
 		commandBuffers.push_back(vkCmdBuffer);
 	}
@@ -35,11 +35,14 @@
 #include <Rendering/Renderer/RendererEnums.h>
 #include <Rendering/Renderer/RendererObjects.h>
 
+class DeviceQueues;
+
 class VulkanCommandPool : public RendererCommandPool
 {
 	public:
 		VkCommandPool poolHandle;
 		VkDevice device;
+		const DeviceQueues *deviceQueueInfo;
 
 		virtual ~VulkanCommandPool ();
 
@@ -39,80 +39,82 @@ DescriptorSet VulkanDescriptorPool::allocateDescriptorSet ()
 	return allocateDescriptorSets(1)[0];
 }
 
-bool VulkanRenderer_tryAllocFromDescriptorPoolObject (VulkanRenderer *renderer, VulkanDescriptorPool *pool, uint32_t poolObjIndex, VulkanDescriptorSet* &outSet)
+/*
+ * Takes up to "setCount" sets from one of the pool's blocks and appends them to "outSets", returns how many it took. Sets that were
+ * freed back to the block are reused first, and whatever's left is allocated all at once w/ a single vkAllocateDescriptorSets.
+ */
+uint32_t VulkanRenderer_allocFromDescriptorPoolObject (VulkanRenderer *renderer, VulkanDescriptorPool *pool, uint32_t poolObjIndex, uint32_t setCount, std::vector<DescriptorSet> &outSets)
 {
 	VulkanDescriptorPoolObject &poolObj = pool->descriptorPools[poolObjIndex];
 
-	if (poolObj.unusedPoolSets.size() == 0)
-		return false;
+	uint32_t takenSetCount = 0, newSetCount = 0;
 
-	// TODO Change vulkan descriptor sets to allocate in chunks rather than invididually
+	while (takenSetCount < setCount && poolObj.unusedPoolSets.size() > 0)
+	{
+		bool setIsAllocated = poolObj.unusedPoolSets.back().second;
 
-	bool setIsAllocated = poolObj.unusedPoolSets.back().second;
+		if (setIsAllocated)
+		{
+			VulkanDescriptorSet *vulkanDescSet = poolObj.unusedPoolSets.back().first;
 
-	if (setIsAllocated)
-	{
-		outSet = poolObj.unusedPoolSets.back().first;
+			DEBUG_ASSERT(vulkanDescSet != nullptr);
 
-		DEBUG_ASSERT(outSet != nullptr);
+			poolObj.usedPoolSets.push_back(vulkanDescSet);
+			outSets.push_back(vulkanDescSet);
+		}
+		else
+			newSetCount ++;
 
-		poolObj.usedPoolSets.push_back(poolObj.unusedPoolSets.back().first);
 		poolObj.unusedPoolSets.pop_back();
+		takenSetCount ++;
 	}
-	else
-	{
-		VulkanDescriptorSet *vulkanDescSet = new VulkanDescriptorSet();
-		vulkanDescSet->descriptorPoolObjectIndex = poolObjIndex;
 
-		VkDescriptorSetLayout descLayout = renderer->pipelineHandler->createDescriptorSetLayout(pool->layoutBindings);
+	if (newSetCount > 0)
+	{
+		std::vector<VkDescriptorSetLayout> setLayouts(newSetCount, pool->setLayout);
+		std::vector<VkDescriptorSet> setHandles(newSetCount);
 
 		VkDescriptorSetAllocateInfo descSetAllocInfo = {};
 		descSetAllocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
 		descSetAllocInfo.descriptorPool = poolObj.pool;
-		descSetAllocInfo.descriptorSetCount = 1;
-		descSetAllocInfo.pSetLayouts = &descLayout;
+		descSetAllocInfo.descriptorSetCount = newSetCount;
+		descSetAllocInfo.pSetLayouts = setLayouts.data();
 
-		VK_CHECK_RESULT(vkAllocateDescriptorSets(renderer->device, &descSetAllocInfo, &vulkanDescSet->setHandle));
+		VK_CHECK_RESULT(vkAllocateDescriptorSets(renderer->device, &descSetAllocInfo, setHandles.data()));
 
-		poolObj.usedPoolSets.push_back(vulkanDescSet);
-		poolObj.unusedPoolSets.pop_back();
+		for (uint32_t i = 0; i < newSetCount; i ++)
+		{
+			VulkanDescriptorSet *vulkanDescSet = new VulkanDescriptorSet();
+			vulkanDescSet->descriptorPoolObjectIndex = poolObjIndex;
+			vulkanDescSet->setHandle = setHandles[i];
 
-		outSet = vulkanDescSet;
+			poolObj.usedPoolSets.push_back(vulkanDescSet);
+			outSets.push_back(vulkanDescSet);
+		}
 	}
 
-	return true;
+	return takenSetCount;
 }
 
-
 std::vector<DescriptorSet> VulkanDescriptorPool::allocateDescriptorSets (uint32_t setCount)
 {
 	DEBUG_ASSERT(setCount > 0);
 
-	std::vector<DescriptorSet> vulkanSets = std::vector<DescriptorSet>(setCount);
+	std::vector<DescriptorSet> vulkanSets;
+	vulkanSets.reserve(setCount);
 
-	for (uint32_t i = 0; i < setCount; i ++)
-	{
-		//printf("-- %u --\n", i);
-		VulkanDescriptorSet *vulkanSet = nullptr;
+	uint32_t setsLeft = setCount;
 
-		// Iterate over each pool object to see if there's one we can alloc from
-		for (size_t p = 0; p < descriptorPools.size(); p ++)
-		{
-			if (VulkanRenderer_tryAllocFromDescriptorPoolObject(renderer, this, p, vulkanSet))
-			{
-				break;
-			}
-		}
+	// Take as many sets as we can from each pool object that's already been created
+	for (size_t p = 0; p < descriptorPools.size() && setsLeft > 0; p ++)
+		setsLeft -= VulkanRenderer_allocFromDescriptorPoolObject(renderer, this, p, setsLeft, vulkanSets);
 
-		// If the set is still nullptr, then we'll have to create a new pool to allocate from
-		if (vulkanSet == nullptr)
-		{
-			descriptorPools.push_back(renderer->createDescPoolObject(vulkanPoolSizes, poolBlockAllocSize));
-
-			VulkanRenderer_tryAllocFromDescriptorPoolObject(renderer, this, descriptorPools.size() - 1, vulkanSet);
-		}
+	// If there's still sets left, then we'll have to create new pools to allocate from
+	while (setsLeft > 0)
+	{
+		descriptorPools.push_back(renderer->createDescPoolObject(vulkanPoolSizes, poolBlockAllocSize));
 
-		vulkanSets[i] = vulkanSet;
+		setsLeft -= VulkanRenderer_allocFromDescriptorPoolObject(renderer, this, descriptorPools.size() - 1, setsLeft, vulkanSets);
 	}
 
 	return vulkanSets;
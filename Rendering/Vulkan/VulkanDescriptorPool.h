@@ -55,6 +55,7 @@ class VulkanDescriptorPool : public RendererDescriptorPool
 		uint32_t poolBlockAllocSize; // The .maxSets value for each pool created, should not exceed 1024 (arbitrary, but usefully arbitrary :D)
 
 		std::vector<DescriptorSetLayoutBinding> layoutBindings; // The layout bindings of each set the pool allocates
+		VkDescriptorSetLayout setLayout; // The layout from the layout cache for "layoutBindings", it's looked up once when the pool's created
 		std::vector<VkDescriptorPoolSize> vulkanPoolSizes; // Just so that it's faster/easier to create new vulkan descriptor pool objects
 
 		// A list of all the local pool/blocks that have been created & their own allocation data
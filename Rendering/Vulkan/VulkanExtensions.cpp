@@ -42,6 +42,9 @@ void VulkanExtensions::getProcAddresses (VkDevice device)
 	}
 }
 
+// Doesn't need any functions, it just fills in structs we pass w/ the pipeline create infos
+bool VulkanExtensions::enabled_VK_EXT_pipeline_creation_feedback = false;
+
 #if SE_VULKAN_DEBUG_MARKERS
 
 bool VulkanExtensions::enabled_VK_EXT_debug_marker = false;
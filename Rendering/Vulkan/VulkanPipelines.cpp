@@ -13,13 +13,17 @@
 VulkanPipelines::VulkanPipelines (VulkanRenderer *parentVulkanRenderer)
 {
 	renderer = parentVulkanRenderer;
+
+	pipelinesCreated = 0;
+	pipelineCacheHits = 0;
+	totalPipelineCreationTime = 0;
 }
 
 VulkanPipelines::~VulkanPipelines ()
 {
 	for (auto descriptorSetLayout : descriptorSetLayoutCache)
 	{
-		vkDestroyDescriptorSetLayout(renderer->device, descriptorSetLayout.second, nullptr);
+		vkDestroyDescriptorSetLayout(renderer->device, descriptorSetLayout.second.second, nullptr);
 	}
 }
 
@@ -215,7 +219,33 @@ Pipeline VulkanPipelines::createGraphicsPipeline (const GraphicsPipelineInfo &pi
 
 	pipelineCreateInfo.layout = vulkanPipeline->pipelineLayoutHandle;
 
-	VK_CHECK_RESULT(vkCreateGraphicsPipelines(renderer->device, VK_NULL_HANDLE, 1, &pipelineCreateInfo, nullptr, &vulkanPipeline->pipelineHandle));
+	bool cacheHit = false;
+
+#ifdef VK_EXT_pipeline_creation_feedback
+	VkPipelineCreationFeedbackEXT creationFeedback = {};
+	std::vector<VkPipelineCreationFeedbackEXT> stageCreationFeedbacks(pipelineShaderStages.size());
+
+	VkPipelineCreationFeedbackCreateInfoEXT creationFeedbackInfo = {};
+
+	if (VulkanExtensions::enabled_VK_EXT_pipeline_creation_feedback)
+	{
+		creationFeedbackInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CREATION_FEEDBACK_CREATE_INFO_EXT;
+		creationFeedbackInfo.pPipelineCreationFeedback = &creationFeedback;
+		creationFeedbackInfo.pipelineStageCreationFeedbackCount = static_cast<uint32_t>(stageCreationFeedbacks.size());
+		creationFeedbackInfo.pPipelineStageCreationFeedbacks = stageCreationFeedbacks.data();
+		pipelineCreateInfo.pNext = &creationFeedbackInfo;
+	}
+#endif
+
+	std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+	VK_CHECK_RESULT(vkCreateGraphicsPipelines(renderer->device, renderer->pipelineCache, 1, &pipelineCreateInfo, nullptr, &vulkanPipeline->pipelineHandle));
+
+#ifdef VK_EXT_pipeline_creation_feedback
+	cacheHit = (creationFeedback.flags & VK_PIPELINE_CREATION_FEEDBACK_APPLICATION_PIPELINE_CACHE_HIT_BIT_EXT) != 0;
+#endif
+
+	countPipelineCreation(startTime, cacheHit);
 
 	return vulkanPipeline;
 }
@@ -270,11 +300,60 @@ Pipeline VulkanPipelines::createComputePipeline(const ComputePipelineInfo &pipel
 
 	pipelineCreateInfo.layout = vulkanPipeline->pipelineLayoutHandle;
 
-	VK_CHECK_RESULT(vkCreateComputePipelines(renderer->device, VK_NULL_HANDLE, 1, &pipelineCreateInfo, nullptr, &vulkanPipeline->pipelineHandle));
+	bool cacheHit = false;
+
+#ifdef VK_EXT_pipeline_creation_feedback
+	VkPipelineCreationFeedbackEXT creationFeedback = {};
+	VkPipelineCreationFeedbackEXT stageCreationFeedback = {};
+
+	VkPipelineCreationFeedbackCreateInfoEXT creationFeedbackInfo = {};
+
+	if (VulkanExtensions::enabled_VK_EXT_pipeline_creation_feedback)
+	{
+		creationFeedbackInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CREATION_FEEDBACK_CREATE_INFO_EXT;
+		creationFeedbackInfo.pPipelineCreationFeedback = &creationFeedback;
+		creationFeedbackInfo.pipelineStageCreationFeedbackCount = 1;
+		creationFeedbackInfo.pPipelineStageCreationFeedbacks = &stageCreationFeedback;
+		pipelineCreateInfo.pNext = &creationFeedbackInfo;
+	}
+#endif
+
+	std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+	VK_CHECK_RESULT(vkCreateComputePipelines(renderer->device, renderer->pipelineCache, 1, &pipelineCreateInfo, nullptr, &vulkanPipeline->pipelineHandle));
+
+#ifdef VK_EXT_pipeline_creation_feedback
+	cacheHit = (creationFeedback.flags & VK_PIPELINE_CREATION_FEEDBACK_APPLICATION_PIPELINE_CACHE_HIT_BIT_EXT) != 0;
+#endif
+
+	countPipelineCreation(startTime, cacheHit);
 
 	return vulkanPipeline;
 }
 
+void VulkanPipelines::countPipelineCreation (std::chrono::steady_clock::time_point startTime, bool cacheHit)
+{
+	pipelinesCreated ++;
+	totalPipelineCreationTime += (uint64_t) std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime).count();
+
+	if (cacheHit)
+		pipelineCacheHits ++;
+}
+
+/*
+ * Gets the stats for the pipelines that have been created. The cache size fields are filled in by the renderer.
+ */
+PipelineCacheStats VulkanPipelines::getPipelineCreationStats ()
+{
+	PipelineCacheStats stats = {};
+	stats.pipelinesCreated = pipelinesCreated;
+	stats.cacheHits = pipelineCacheHits;
+	stats.hitsReported = VulkanExtensions::enabled_VK_EXT_pipeline_creation_feedback;
+	stats.totalCreationTime = totalPipelineCreationTime / 1000.0;
+
+	return stats;
+}
+
 VkDescriptorSetLayout VulkanPipelines::createDescriptorSetLayout (const std::vector<DescriptorSetLayoutBinding> &layoutBindings)
 {
 	std::vector<VkDescriptorSetLayoutBinding> bindings;
@@ -318,6 +397,30 @@ inline bool compareDescSetLayoutCacheInfos(const VulkanDescriptorSetLayoutCacheI
 	return true;
 }
 
+inline size_t hashDescSetLayoutCacheInfo(const VulkanDescriptorSetLayoutCacheInfo &info)
+{
+	// FNV-1a over the same members that compareDescSetLayoutCacheInfos() checks
+	uint64_t hash = 14695981039346656037ULL;
+
+	auto hashValue = [&hash](uint32_t value)
+	{
+		hash = (hash ^ value) * 1099511628211ULL;
+	};
+
+	hashValue(info.flags);
+	hashValue(static_cast<uint32_t>(info.bindings.size()));
+
+	for (size_t i = 0; i < info.bindings.size(); i++)
+	{
+		hashValue(info.bindings[i].binding);
+		hashValue(info.bindings[i].descriptorCount);
+		hashValue(static_cast<uint32_t>(info.bindings[i].descriptorType));
+		hashValue(info.bindings[i].stageFlags);
+	}
+
+	return static_cast<size_t>(hash);
+}
+
 /*
  * Attempts to reuse a descriptor set layout object from the cache, but will make a new one if needed.
  */
@@ -327,13 +430,17 @@ VkDescriptorSetLayout VulkanPipelines::createDescriptorSetLayout (const VkDescri
 	cacheInfo.flags = setLayoutInfo.flags;
 	cacheInfo.bindings = std::vector<VkDescriptorSetLayoutBinding>(setLayoutInfo.pBindings, setLayoutInfo.pBindings + setLayoutInfo.bindingCount);
 
+	size_t cacheHash = hashDescSetLayoutCacheInfo(cacheInfo);
+
+	std::unique_lock<std::mutex> lock(descriptorSetLayoutCache_mutex);
+
 	// Try and find a matching cached set layout to use if possible
-	for (size_t i = 0; i < descriptorSetLayoutCache.size(); i++)
-	{
-		const VulkanDescriptorSetLayoutCacheInfo &candCacheInfo = descriptorSetLayoutCache[i].first;
+	auto range = descriptorSetLayoutCache.equal_range(cacheHash);
 
-		if (compareDescSetLayoutCacheInfos(cacheInfo, candCacheInfo))
-			return descriptorSetLayoutCache[i].second;
+	for (auto it = range.first; it != range.second; it++)
+	{
+		if (compareDescSetLayoutCacheInfos(cacheInfo, it->second.first))
+			return it->second.second;
 	}
 
 	// If there's no matchign cached set layout, make a new one and add it
@@ -342,7 +449,7 @@ VkDescriptorSetLayout VulkanPipelines::createDescriptorSetLayout (const VkDescri
 
 	VK_CHECK_RESULT(vkCreateDescriptorSetLayout(renderer->device, &setLayoutInfo, nullptr, &setLayout));
 
-	descriptorSetLayoutCache.push_back(std::make_pair(cacheInfo, setLayout));
+	descriptorSetLayoutCache.insert(std::make_pair(cacheHash, std::make_pair(cacheInfo, setLayout)));
 
 	return setLayout;
 }
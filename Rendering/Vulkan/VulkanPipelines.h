@@ -12,6 +12,8 @@
 #include <Rendering/Vulkan/vulkan_common.h>
 #include <Rendering/Vulkan/VulkanObjects.h>
 
+#include <unordered_map>
+
 class VulkanRenderer;
 
 class VulkanPipelines
@@ -28,12 +30,21 @@ class VulkanPipelines
 		VkDescriptorSetLayout createDescriptorSetLayout (const std::vector<DescriptorSetLayoutBinding> &layoutBindings);
 		VkDescriptorSetLayout createDescriptorSetLayout (const VkDescriptorSetLayoutCreateInfo &setLayoutInfo);
 
+		PipelineCacheStats getPipelineCreationStats ();
+
 	private:
 
 		VulkanRenderer *renderer;
 
+		std::atomic<uint32_t> pipelinesCreated;
+		std::atomic<uint32_t> pipelineCacheHits;
+		std::atomic<uint64_t> totalPipelineCreationTime; // In microseconds
+
 		// I'm also letting the renderer backend handle descriptor set layout caches, so the front end only gives the layout info and gets it easy
-		std::vector<std::pair<VulkanDescriptorSetLayoutCacheInfo, VkDescriptorSetLayout> > descriptorSetLayoutCache;
+		// Pipelines can be created from pipeline compile jobs, so the cache is locked
+		// It's keyed on a hash of the layout info, so a lookup only has to compare against the layouts w/ the same hash
+		std::mutex descriptorSetLayoutCache_mutex;
+		std::unordered_multimap<size_t, std::pair<VulkanDescriptorSetLayoutCacheInfo, VkDescriptorSetLayout> > descriptorSetLayoutCache;
 
 		/*
 		 * All of these functions are converter functions for the generic renderer data to vulkan renderer data. Note that
@@ -45,6 +56,8 @@ class VulkanPipelines
 		VkPipelineRasterizationStateCreateInfo getPipelineRasterizationInfo (const PipelineRasterizationInfo &info);
 		VkPipelineMultisampleStateCreateInfo getPipelineMultisampleInfo (const PipelineMultisampleInfo &info);
 		VkPipelineDepthStencilStateCreateInfo getPipelineDepthStencilInfo (const PipelineDepthStencilInfo &info);
+
+		void countPipelineCreation (std::chrono::steady_clock::time_point startTime, bool cacheHit);
 };
 
 #endif /* RENDERING_VULKAN_VULKANPIPELINES_H_ */
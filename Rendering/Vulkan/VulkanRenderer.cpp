@@ -16,6 +16,8 @@
 #define GLFW_INCLUDE_VULKAN
 #include <GLFW/glfw3.h>
 
+#include <sys/stat.h>
+
 const std::vector<const char*> validationLayers = {"VK_LAYER_LUNARG_standard_validation"};
 const std::vector<const char*> deviceExtensions = {VK_KHR_SWAPCHAIN_EXTENSION_NAME};
 
@@ -144,6 +146,8 @@ void VulkanRenderer::initRenderer ()
 
 	VK_CHECK_RESULT(vmaCreateAllocator(&allocCreateInfo, &memAllocator));
 
+	createPipelineCache();
+
 #ifdef __linux__
 	defaultCompiler = new shaderc::Compiler();
 #endif
@@ -154,9 +158,14 @@ void VulkanRenderer::initRenderer ()
 
 void VulkanRenderer::cleanupVulkan ()
 {
+	waitForPipelineCompileJobs();
+
 	delete swapchains;
 	delete pipelineHandler;
 
+	savePipelineCache();
+	vkDestroyPipelineCache(device, pipelineCache, nullptr);
+
 	vmaDestroyAllocator(memAllocator);
 	vkDestroyDevice(device, nullptr);
 
@@ -196,6 +205,7 @@ CommandPool VulkanRenderer::createCommandPool (QueueType queue, CommandPoolFlags
 	vkCmdPool->queue = queue;
 	vkCmdPool->flags = flags;
 	vkCmdPool->device = device;
+	vkCmdPool->deviceQueueInfo = &deviceQueueInfo;
 
 	VK_CHECK_RESULT(vkCreateCommandPool(device, &poolCreateInfo, nullptr, &vkCmdPool->poolHandle));
 
@@ -666,6 +676,7 @@ DescriptorPool VulkanRenderer::createDescriptorPool (const std::vector<Descripto
 	vulkanDescPool->canFreeSetFromPool = false;
 	vulkanDescPool->poolBlockAllocSize = poolBlockAllocSize;
 	vulkanDescPool->layoutBindings = layoutBindings;
+	vulkanDescPool->setLayout = pipelineHandler->createDescriptorSetLayout(layoutBindings);
 	vulkanDescPool->renderer = this;
 
 	for (size_t i = 0; i < layoutBindings.size(); i ++)
@@ -1179,6 +1190,121 @@ void VulkanRenderer::setSwapchainTexture (Window *wnd, TextureView texView, Samp
 	swapchains->setSwapchainSourceImage(wnd, static_cast<VulkanTextureView*>(texView)->imageView, static_cast<VulkanSampler*>(sampler)->samplerHandle, toVkImageLayout(layout));
 }
 
+/*
+ * Creates the pipeline cache, starting it off w/ the one saved by the last run if it was made by the same driver & device.
+ */
+void VulkanRenderer::createPipelineCache ()
+{
+	std::string cacheFile = FileLoader::instance()->getWorkingDir() + VULKAN_PIPELINE_CACHE_FILE;
+	std::vector<char> cacheData;
+
+#ifdef _WIN32
+	std::ifstream in(utf8_to_utf16(cacheFile).c_str(), std::ios::in | std::ios::binary | std::ios::ate);
+#else
+	std::ifstream in(cacheFile, std::ios::in | std::ios::binary | std::ios::ate);
+#endif
+
+	if (in.is_open())
+	{
+		cacheData.resize((size_t) in.tellg());
+		in.seekg(0);
+		in.read(cacheData.data(), cacheData.size());
+
+		if (!in || !validatePipelineCacheData(cacheData))
+		{
+			printf("%s Pipeline cache: %s is from a different device/driver or is corrupted, starting w/ an empty cache\n", WARN_PREFIX, cacheFile.c_str());
+			cacheData.clear();
+		}
+	}
+
+	VkPipelineCacheCreateInfo cacheCreateInfo = {};
+	cacheCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+	cacheCreateInfo.initialDataSize = cacheData.size();
+	cacheCreateInfo.pInitialData = cacheData.size() > 0 ? cacheData.data() : nullptr;
+
+	VK_CHECK_RESULT(vkCreatePipelineCache(device, &cacheCreateInfo, nullptr, &pipelineCache));
+
+	loadedPipelineCacheSize = cacheData.size();
+
+	if (loadedPipelineCacheSize > 0)
+		printf("%s Loaded pipeline cache: %s (%u KB)\n", INFO_PREFIX, cacheFile.c_str(), uint32_t(loadedPipelineCacheSize / 1024));
+}
+
+/*
+ * Checks the header vulkan puts at the start of the cache data against the device we're using. Drivers are supposed to
+ * reject data that isn't theirs, but not all of them are good about it, so we don't give them the chance.
+ */
+bool VulkanRenderer::validatePipelineCacheData (const std::vector<char> &cacheData)
+{
+	const size_t headerSize = sizeof(uint32_t) * 4 + VK_UUID_SIZE;
+
+	if (cacheData.size() < headerSize)
+		return false;
+
+	uint32_t headerLength, headerVersion, vendorID, deviceID;
+	memcpy(&headerLength, cacheData.data() + 0, sizeof(uint32_t));
+	memcpy(&headerVersion, cacheData.data() + 4, sizeof(uint32_t));
+	memcpy(&vendorID, cacheData.data() + 8, sizeof(uint32_t));
+	memcpy(&deviceID, cacheData.data() + 12, sizeof(uint32_t));
+
+	return headerLength >= headerSize && headerLength <= cacheData.size() && headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE && vendorID == deviceProps.vendorID && deviceID == deviceProps.deviceID && memcmp(cacheData.data() + 16, deviceProps.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+}
+
+/*
+ * Writes the pipeline cache to disk, to a temporary file first so a crash halfway through doesn't leave a broken cache behind.
+ */
+void VulkanRenderer::savePipelineCache ()
+{
+	size_t cacheSize = 0;
+	VK_CHECK_RESULT(vkGetPipelineCacheData(device, pipelineCache, &cacheSize, nullptr));
+
+	std::vector<char> cacheData(cacheSize);
+	VK_CHECK_RESULT(vkGetPipelineCacheData(device, pipelineCache, &cacheSize, cacheData.data()));
+	cacheData.resize(cacheSize);
+
+	if (cacheData.size() == 0)
+		return;
+
+	std::string cacheFile = FileLoader::instance()->getWorkingDir() + VULKAN_PIPELINE_CACHE_FILE;
+	std::string tempFile = cacheFile + ".tmp";
+
+#ifdef _WIN32
+	CreateDirectoryW(utf8_to_utf16(getDirectoryOfFile(cacheFile)).c_str(), nullptr);
+	std::ofstream out(utf8_to_utf16(tempFile).c_str(), std::ios::out | std::ios::binary);
+#else
+	mkdir(getDirectoryOfFile(cacheFile).c_str(), 0755);
+	std::ofstream out(tempFile, std::ios::out | std::ios::binary);
+#endif
+
+	if (!out.is_open())
+	{
+		printf("%s Failed to open file: %s for writing, the pipeline cache won't be saved\n", WARN_PREFIX, tempFile.c_str());
+
+		return;
+	}
+
+	out.write(cacheData.data(), cacheData.size());
+	out.close();
+
+#ifdef _WIN32
+	if (!out || !MoveFileExW(utf8_to_utf16(tempFile).c_str(), utf8_to_utf16(cacheFile).c_str(), MOVEFILE_REPLACE_EXISTING))
+		DeleteFileW(utf8_to_utf16(tempFile).c_str());
+#else
+	if (!out || rename(tempFile.c_str(), cacheFile.c_str()) != 0)
+		remove(tempFile.c_str());
+#endif
+}
+
+PipelineCacheStats VulkanRenderer::getPipelineCacheStats ()
+{
+	PipelineCacheStats stats = pipelineHandler->getPipelineCreationStats();
+	stats.loadedCacheSize = loadedPipelineCacheSize;
+
+	VK_CHECK_RESULT(vkGetPipelineCacheData(device, pipelineCache, &stats.cacheSize, nullptr));
+
+	return stats;
+}
+
 bool VulkanRenderer::areValidationLayersEnabled ()
 {
 	return validationLayersEnabled;
@@ -1222,6 +1348,14 @@ void VulkanRenderer::createLogicalDevice ()
 			VulkanExtensions::enabled_VK_AMD_rasterization_order = true;
 			printf("%s Enabling the VK_AMD_rasterization_order extension\n", INFO_PREFIX);
 		}
+#ifdef VK_EXT_pipeline_creation_feedback
+		else if (!VulkanExtensions::enabled_VK_EXT_pipeline_creation_feedback && strcmp(ext.extensionName, VK_EXT_PIPELINE_CREATION_FEEDBACK_EXTENSION_NAME) == 0)
+		{
+			enabledDeviceExtensions.push_back(VK_EXT_PIPELINE_CREATION_FEEDBACK_EXTENSION_NAME);
+			VulkanExtensions::enabled_VK_EXT_pipeline_creation_feedback = true;
+			printf("%s Enabling the VK_EXT_pipeline_creation_feedback extension\n", INFO_PREFIX);
+		}
+#endif
 	}
 
 	VkPhysicalDeviceFeatures enabledDeviceFeatures = {};
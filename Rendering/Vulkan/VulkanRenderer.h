@@ -12,6 +12,8 @@
 #include <Rendering/Vulkan/vulkan_common.h>
 #include <Rendering/Vulkan/VulkanObjects.h>
 
+#define VULKAN_PIPELINE_CACHE_FILE "cache/vulkan_pipelines.bin" // Relative to the working directory
+
 class VulkanSwapchain;
 class VulkanPipelines;
 
@@ -35,6 +37,9 @@ class VulkanRenderer : public Renderer
 
 		VmaAllocator memAllocator;
 
+		// Every pipeline is created w/ this, it's loaded from & saved to VULKAN_PIPELINE_CACHE_FILE so drivers don't have to recompile them every launch
+		VkPipelineCache pipelineCache;
+
 #ifdef __linux__
 		shaderc::Compiler *defaultCompiler;
 #endif
@@ -108,6 +113,8 @@ class VulkanRenderer : public Renderer
 		void recreateSwapchain (Window *wnd);
 		void setSwapchainTexture (Window *wnd, TextureView texView, Sampler sampler, TextureLayout layout);
 
+		PipelineCacheStats getPipelineCacheStats ();
+
 		bool areValidationLayersEnabled ();
 
 		bool checkExtraSurfacePresentSupport(VkSurfaceKHR surface);
@@ -121,9 +128,15 @@ class VulkanRenderer : public Renderer
 
 		bool validationLayersEnabled;
 
+		size_t loadedPipelineCacheSize;
+
 		void choosePhysicalDevice ();
 		void createLogicalDevice ();
 
+		void createPipelineCache ();
+		void savePipelineCache ();
+		bool validatePipelineCacheData (const std::vector<char> &cacheData);
+
 		void cleanupVulkan ();
 
 		DeviceQueues findQueueFamilies (VkPhysicalDevice physDevice);
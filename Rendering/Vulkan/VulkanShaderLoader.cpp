@@ -12,28 +12,42 @@
 
 #include "Rendering/Vulkan/VulkanShaderLoader.h"
 
+#include <sys/stat.h>
+
 std::string getShaderStageMacroString (VkShaderStageFlagBits stage);
 
 #ifdef __linux__
 shaderc_shader_kind getShaderKindFromShaderStage (VkShaderStageFlagBits stage);
 std::vector<uint32_t> VulkanShaderLoader::compileGLSL (shaderc::Compiler &compiler, const std::string &file, VkShaderStageFlagBits stages)
 {
-	std::vector<char> glslSource = readFile(file);
+	FileView glslSource = FileLoader::instance()->openFileView(file);
 
-	return compileGLSLFromSource(compiler, glslSource, file, stages);
+	return compileGLSLFromSource(compiler, glslSource.data(), glslSource.size(), file, stages);
 }
 
 std::vector<uint32_t> VulkanShaderLoader::compileGLSLFromSource (shaderc::Compiler &compiler, const std::string &source, const std::string &sourceName, VkShaderStageFlagBits stages)
 {
-	return compileGLSLFromSource (compiler, std::vector<char> (source.data(), source.data() + source.length()), sourceName, stages);
+	return compileGLSLFromSource(compiler, source.data(), source.length(), sourceName, stages);
 }
 
-std::vector<uint32_t> VulkanShaderLoader::compileGLSLFromSource (shaderc::Compiler &compiler, const std::vector<char> &glslSource, const std::string &sourceName, VkShaderStageFlagBits stages)
+std::vector<uint32_t> VulkanShaderLoader::compileGLSLFromSource (shaderc::Compiler &compiler, const std::vector<char> &source, const std::string &sourceName, VkShaderStageFlagBits stages)
 {
+	return compileGLSLFromSource(compiler, source.data(), source.size(), sourceName, stages);
+}
+
+std::vector<uint32_t> VulkanShaderLoader::compileGLSLFromSource (shaderc::Compiler &compiler, const char *glslSource, size_t glslSourceSize, const std::string &sourceName, VkShaderStageFlagBits stages)
+{
+	// Everything passed to shaderc below has to be in here too
+	uint64_t cacheKey = getSPIRVCacheKey(glslSource, glslSourceSize, "shaderc -D" + getShaderStageMacroString(stages) + " -kind " + toString(getShaderKindFromShaderStage(stages)));
+	std::vector<uint32_t> spirv;
+
+	if (loadCachedSPIRV(cacheKey, spirv))
+		return spirv;
+
 	shaderc::CompileOptions opts;
 	opts.AddMacroDefinition(getShaderStageMacroString(stages));
 
-	shaderc::SpvCompilationResult spvComp = compiler.CompileGlslToSpv(std::string(glslSource.data(), glslSource.data() + glslSource.size()), getShaderKindFromShaderStage(stages), sourceName.c_str(), opts);
+	shaderc::SpvCompilationResult spvComp = compiler.CompileGlslToSpv(glslSource, glslSourceSize, getShaderKindFromShaderStage(stages), sourceName.c_str(), opts);
 
 	if (spvComp.GetCompilationStatus() != shaderc_compilation_status_success)
 	{
@@ -42,23 +56,31 @@ std::vector<uint32_t> VulkanShaderLoader::compileGLSLFromSource (shaderc::Compil
 		throw std::runtime_error("shaderc error - failed compilation");
 	}
 
-	return std::vector<uint32_t>(spvComp.cbegin(), spvComp.cend());
+	spirv = std::vector<uint32_t>(spvComp.cbegin(), spvComp.cend());
+	storeCachedSPIRV(cacheKey, spirv);
+
+	return spirv;
 }
 #elif defined(_WIN32)
 
 std::vector<uint32_t> VulkanShaderLoader::compileGLSL (const std::string &file, VkShaderStageFlagBits stages, ShaderSourceLanguage lang, const std::string &entryPoint)
 {
-	std::vector<char> glslSource = FileLoader::instance()->readFileBuffer(file);
+	FileView glslSource = FileLoader::instance()->openFileView(file);
 
-	return compileGLSLFromSource(glslSource, file, stages, lang, entryPoint);
+	return compileGLSLFromSource(glslSource.data(), glslSource.size(), file, stages, lang, entryPoint);
 }
 
 std::vector<uint32_t> VulkanShaderLoader::compileGLSLFromSource (const std::string &source, const std::string &sourceName, VkShaderStageFlagBits stages, ShaderSourceLanguage lang, const std::string &entryPoint)
 {
-	return compileGLSLFromSource(std::vector<char>(source.data(), source.data() + source.length()), sourceName, stages, lang, entryPoint);
+	return compileGLSLFromSource(source.data(), source.length(), sourceName, stages, lang, entryPoint);
 }
 
 std::vector<uint32_t> VulkanShaderLoader::compileGLSLFromSource (const std::vector<char> &source, const std::string &sourceName, VkShaderStageFlagBits stages, ShaderSourceLanguage lang, const std::string &entryPoint)
+{
+	return compileGLSLFromSource(source.data(), source.size(), sourceName, stages, lang, entryPoint);
+}
+
+std::vector<uint32_t> VulkanShaderLoader::compileGLSLFromSource (const char *source, size_t sourceSize, const std::string &sourceName, VkShaderStageFlagBits stages, ShaderSourceLanguage lang, const std::string &entryPoint)
 {
 	char tempDir[MAX_PATH];
 	GetTempPath(MAX_PATH, tempDir);
@@ -86,25 +108,39 @@ std::vector<uint32_t> VulkanShaderLoader::compileGLSLFromSource (const std::vect
 			stage = "vert";
 	}
 
+	// Only the options part of the command, since the file names change every time
+	uint64_t cacheKey = getSPIRVCacheKey(source, sourceSize, std::string("glslangValidator -V ") + (lang == SHADER_LANGUAGE_HLSL ? "-D" : "") + " -e " + entryPoint + " -D" + getShaderStageMacroString(stages) + " -S " + stage);
+	std::vector<uint32_t> cachedSPIRV;
+
+	if (loadCachedSPIRV(cacheKey, cachedSPIRV))
+		return cachedSPIRV;
 
 	std::string tempShaderSourceFile = std::string(tempDir) + "starlightengine-shader-" + toString(stringHash(toString(&tempDir) + toString(std::this_thread::get_id()))) + ".glsl." + stage + ".tmp";
 	std::string tempShaderOutputFile = std::string(tempDir) + "starlightengine-shader-" + toString(stringHash(toString(&tempDir) + toString(std::this_thread::get_id()))) + ".spv." + stage + ".tmp";
 
-	writeFile(tempShaderSourceFile, source);
+	writeFile(tempShaderSourceFile, source, sourceSize);
 
 	char cmd[512];
 	sprintf(cmd, "glslangValidator -V %s -e %s -D%s -S %s -o %s %s", (lang == SHADER_LANGUAGE_HLSL ? "-D" : ""), entryPoint.c_str(), getShaderStageMacroString(stages).c_str(), stage.c_str(), tempShaderOutputFile.c_str(), tempShaderSourceFile.c_str());
 
 	system(cmd);
 
-	std::vector<char> binary = FileLoader::instance()->readFileAbsoluteDirectoryBuffer(tempShaderOutputFile);
-	std::vector<uint32_t> spvBinary = std::vector<uint32_t> (binary.size() / 4);
+	std::vector<uint32_t> spvBinary;
 
-	memcpy(spvBinary.data(), binary.data(), binary.size());
+	// The view has to be unmapped before the temp file can be removed
+	{
+		FileView binary = FileLoader::instance()->openFileViewAbsoluteDirectory(tempShaderOutputFile);
+		spvBinary.resize(binary.size() / 4);
+
+		memcpy(spvBinary.data(), binary.data(), spvBinary.size() * 4);
+	}
 
 	remove(tempShaderSourceFile.c_str());
 	remove(tempShaderOutputFile.c_str());
 
+	if (spvBinary.size() > 0)
+		storeCachedSPIRV(cacheKey, spvBinary);
+
 	return spvBinary;
 }
 
@@ -123,6 +159,148 @@ VkShaderModule VulkanShaderLoader::createVkShaderModule (const VkDevice &device,
 	return module;
 }
 
+/*
+ * 64-bit FNV-1a, which unlike std::hash gives the same result on every build & platform, so cache entries stay valid.
+ */
+inline uint64_t spirvCacheHash (const void *data, size_t dataSize, uint64_t hash = 14695981039346656037ULL)
+{
+	const uint8_t *bytes = reinterpret_cast<const uint8_t*>(data);
+
+	for (size_t i = 0; i < dataSize; i ++)
+		hash = (hash ^ bytes[i]) * 1099511628211ULL;
+
+	return hash;
+}
+
+/*
+ * Gets the key a shader's SPIR-V is cached under. Shaders are compiled w/o an includer, so they can't #include anything,
+ * which means the source & the options are everything that decides the output. If includes are ever supported, the
+ * resolved include files have to be hashed in here too.
+ */
+uint64_t VulkanShaderLoader::getSPIRVCacheKey (const char *source, size_t sourceSize, const std::string &compileOptions)
+{
+	uint32_t version = SPIRV_CACHE_VERSION;
+
+	uint64_t key = spirvCacheHash(&version, sizeof(version));
+	key = spirvCacheHash(compileOptions.c_str(), compileOptions.length() + 1, key);
+	key = spirvCacheHash(source, sourceSize, key);
+
+	return key;
+}
+
+std::string VulkanShaderLoader::getSPIRVCacheFile (uint64_t key)
+{
+	char keyStr[17];
+	sprintf(keyStr, "%016llx", (unsigned long long) key);
+
+	return FileLoader::instance()->getWorkingDir() + SPIRV_CACHE_DIR + keyStr + ".spv";
+}
+
+/*
+ * Loads a shader's SPIR-V from the cache. Returns false if there isn't an entry for it, or if the entry doesn't check out,
+ * in which case the shader should be compiled like normal.
+ */
+bool VulkanShaderLoader::loadCachedSPIRV (uint64_t key, std::vector<uint32_t> &spirv)
+{
+	std::string cacheFile = getSPIRVCacheFile(key);
+
+#ifdef _WIN32
+	std::ifstream in(utf8_to_utf16(cacheFile).c_str(), std::ios::in | std::ios::binary);
+#else
+	std::ifstream in(cacheFile, std::ios::in | std::ios::binary);
+#endif
+
+	if (!in.is_open())
+		return false;
+
+	SPIRVCacheHeader header = {};
+	in.read(reinterpret_cast<char*>(&header), sizeof(header));
+
+	if (!in || header.magic != SPIRV_CACHE_MAGIC_NUM || header.version != SPIRV_CACHE_VERSION || header.key != key || header.spirvSize == 0 || header.spirvSize % 4 != 0 || header.spirvSize > 64 * 1024 * 1024)
+	{
+		printf("%s Ignoring invalid SPIR-V cache entry: %s\n", WARN_PREFIX, cacheFile.c_str());
+
+		return false;
+	}
+
+	spirv.resize(header.spirvSize / 4);
+	in.read(reinterpret_cast<char*>(spirv.data()), header.spirvSize);
+
+	// 0x07230203 is the SPIR-V magic number
+	if (!in || spirv[0] != 0x07230203 || spirvCacheHash(spirv.data(), header.spirvSize) != header.spirvHash)
+	{
+		printf("%s Ignoring corrupted SPIR-V cache entry: %s\n", WARN_PREFIX, cacheFile.c_str());
+		spirv.clear();
+
+		return false;
+	}
+
+	return true;
+}
+
+/*
+ * Writes a shader's SPIR-V to the cache. The entry is written to a temporary file first & then renamed over the real one,
+ * so another instance of the engine reading the cache at the same time either sees the whole entry or none of it. Failing
+ * to write an entry isn't an error, the shader just gets compiled again next time.
+ */
+void VulkanShaderLoader::storeCachedSPIRV (uint64_t key, const std::vector<uint32_t> &spirv)
+{
+	std::string cacheDir = FileLoader::instance()->getWorkingDir() + SPIRV_CACHE_DIR;
+	std::string cacheFile = getSPIRVCacheFile(key);
+	std::string tempFile = cacheFile + "." + toString(stringHash(toString(std::this_thread::get_id()) + toString(std::chrono::steady_clock::now().time_since_epoch().count()))) + ".tmp";
+
+	// Makes the "cache/" directory & then "cache/spirv/", it's fine if they already exist
+	for (size_t i = cacheDir.find('/', FileLoader::instance()->getWorkingDir().length()); i != std::string::npos; i = cacheDir.find('/', i + 1))
+	{
+#ifdef _WIN32
+		CreateDirectoryW(utf8_to_utf16(cacheDir.substr(0, i)).c_str(), nullptr);
+#else
+		mkdir(cacheDir.substr(0, i).c_str(), 0755);
+#endif
+	}
+
+	SPIRVCacheHeader header = {};
+	header.magic = SPIRV_CACHE_MAGIC_NUM;
+	header.version = SPIRV_CACHE_VERSION;
+	header.key = key;
+	header.spirvSize = spirv.size() * 4;
+	header.spirvHash = spirvCacheHash(spirv.data(), header.spirvSize);
+
+	{
+#ifdef _WIN32
+		std::ofstream out(utf8_to_utf16(tempFile).c_str(), std::ios::out | std::ios::binary);
+#else
+		std::ofstream out(tempFile, std::ios::out | std::ios::binary);
+#endif
+
+		if (!out.is_open())
+		{
+			printf("%s Failed to open file: %s for writing, shader won't be cached\n", WARN_PREFIX, tempFile.c_str());
+
+			return;
+		}
+
+		out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		out.write(reinterpret_cast<const char*>(spirv.data()), header.spirvSize);
+		out.close();
+
+		if (!out)
+		{
+			remove(tempFile.c_str());
+
+			return;
+		}
+	}
+
+#ifdef _WIN32
+	if (!MoveFileExW(utf8_to_utf16(tempFile).c_str(), utf8_to_utf16(cacheFile).c_str(), MOVEFILE_REPLACE_EXISTING))
+		DeleteFileW(utf8_to_utf16(tempFile).c_str());
+#else
+	if (rename(tempFile.c_str(), cacheFile.c_str()) != 0)
+		remove(tempFile.c_str());
+#endif
+}
+
 #ifdef __linux__
 shaderc_shader_kind getShaderKindFromShaderStage (VkShaderStageFlagBits stage)
 {
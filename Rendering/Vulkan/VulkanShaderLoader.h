@@ -12,6 +12,24 @@
 #include <Rendering/Vulkan/vulkan_common.h>
 #include <Rendering/Renderer/RendererEnums.h>
 
+#define SPIRV_CACHE_DIR "cache/spirv/" // Relative to the working directory
+#define SPIRV_CACHE_MAGIC_NUM 0x43565053 // "SPVC"
+#define SPIRV_CACHE_VERSION 1 // Bump this whenever the way shaders are compiled changes, so old cache entries aren't used
+
+/*
+ * The header at the start of a cached SPIR-V file, followed by the SPIR-V itself. The files are named after "key", which
+ * is a hash of everything that goes into compiling the shader (see getSPIRVCacheKey()), so a changed shader just gets a
+ * new entry. "spirvHash" is checked on every load, so a truncated or corrupted entry is compiled again instead of used.
+ */
+typedef struct SPIRVCacheHeader
+{
+		uint32_t magic;
+		uint32_t version;
+		uint64_t key;
+		uint64_t spirvSize; // In bytes
+		uint64_t spirvHash;
+} SPIRVCacheHeader;
+
 class VulkanShaderLoader
 {
 	public:
@@ -20,13 +38,22 @@ class VulkanShaderLoader
 		static std::vector<uint32_t> compileGLSL(shaderc::Compiler &compiler, const std::string &file, VkShaderStageFlagBits stages);
 		static std::vector<uint32_t> compileGLSLFromSource(shaderc::Compiler &compiler, const std::string &source, const std::string &sourceName, VkShaderStageFlagBits stages);
 		static std::vector<uint32_t> compileGLSLFromSource(shaderc::Compiler &compiler, const std::vector<char> &source, const std::string &sourceName, VkShaderStageFlagBits stages);
+		static std::vector<uint32_t> compileGLSLFromSource(shaderc::Compiler &compiler, const char *source, size_t sourceSize, const std::string &sourceName, VkShaderStageFlagBits stages);
 #elif defined(_WIN32)
 		static std::vector<uint32_t> compileGLSL(const std::string &file, VkShaderStageFlagBits stages, ShaderSourceLanguage lang, const std::string &entryPoint);
 		static std::vector<uint32_t> compileGLSLFromSource(const std::string &source, const std::string &sourceName, VkShaderStageFlagBits stages, ShaderSourceLanguage lang, const std::string &entryPoint);
 		static std::vector<uint32_t> compileGLSLFromSource(const std::vector<char> &source, const std::string &sourceName, VkShaderStageFlagBits stages, ShaderSourceLanguage lang, const std::string &entryPoint);
+		static std::vector<uint32_t> compileGLSLFromSource(const char *source, size_t sourceSize, const std::string &sourceName, VkShaderStageFlagBits stages, ShaderSourceLanguage lang, const std::string &entryPoint);
 #endif
 
 		static VkShaderModule createVkShaderModule (const VkDevice &device, const std::vector<uint32_t> &spirv);
+
+	private:
+
+		static uint64_t getSPIRVCacheKey (const char *source, size_t sourceSize, const std::string &compileOptions);
+		static std::string getSPIRVCacheFile (uint64_t key);
+		static bool loadCachedSPIRV (uint64_t key, std::vector<uint32_t> &spirv);
+		static void storeCachedSPIRV (uint64_t key, const std::vector<uint32_t> &spirv);
 };
 
 #endif /* RENDERING_VULKAN_VULKANSHADERLOADER_H_ */
@@ -601,7 +601,7 @@ void VulkanSwapchain::createGraphicsPipeline (WindowSwapchain &swapchain)
 	pipelineInfo.subpass = 0;
 	pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
 
-	VK_CHECK_RESULT(vkCreateGraphicsPipelines(renderer->device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &swapchain.swapchainPipeline));
+	VK_CHECK_RESULT(vkCreateGraphicsPipelines(renderer->device, renderer->pipelineCache, 1, &pipelineInfo, nullptr, &swapchain.swapchainPipeline));
 
 	debugMarkerSetName(renderer->device, swapchain.swapchainPipeline, VK_DEBUG_REPORT_OBJECT_TYPE_PIPELINE_EXT, "Swapchain Graphics Pipeline");
 }
@@ -26,6 +26,7 @@ class VulkanExtensions
 
 		static bool enabled_VK_EXT_debug_marker;
 		static bool enabled_VK_AMD_rasterization_order;
+		static bool enabled_VK_EXT_pipeline_creation_feedback;
 
 		static PFN_vkDebugMarkerSetObjectTagEXT DebugMarkerSetObjectTagEXT;
 		static PFN_vkDebugMarkerSetObjectNameEXT DebugMarkerSetObjectNameEXT;
@@ -553,7 +553,7 @@ void TerrainRenderer::init ()
 
 	buildTerrainCellGrids();
 
-	createGraphicsPipeline();
+	engine->renderer->pushPipelineCompileJob(std::bind(&TerrainRenderer::createGraphicsPipeline, this));
 
 	heightmapDescriptorPool = engine->renderer->createDescriptorPool({
 		{0, DESCRIPTOR_TYPE_SAMPLER, 1, SHADER_STAGE_TESSELLATION_EVALUATION_BIT | SHADER_STAGE_FRAGMENT_BIT},
@@ -99,7 +99,7 @@ void WorldRenderer::gbufferPassInit(RenderPass renderPass, uint32_t baseSubpass)
 
 	engine->renderer->setObjectDebugName(worldStreamingBuffer, OBJECT_TYPE_BUFFER, "LevelStaticObj Streaming Buffer");
 
-	createPipelines(renderPass, baseSubpass);
+	engine->renderer->pushPipelineCompileJob(std::bind(&WorldRenderer::createPipelines, this, renderPass, baseSubpass));
 
 	sunCSM = new CSM(engine->renderer, 4096, 3);
 
@@ -196,20 +196,30 @@ void WorldRenderer::renderWorldStaticMeshes (CommandBuffer &cmdBuffer, glm::mat4
 	LevelStaticObjectStreamingData streamData = getStaticObjStreamingData(frustum);
 	//printf("Stream took: %fms\n", (engine->getTime() - sT) * 1000.0);
 
-	std::map<size_t, LevelStaticObjectStreamingDataHierarchy> streamDataByPipeline;
+	std::map<ResourcePipelineHandle, LevelStaticObjectStreamingDataHierarchy> streamDataByPipeline;
 
 	for (auto mat = streamData.data.begin(); mat != streamData.data.end(); mat ++)
 	{
-		ResourceMaterial material = engine->resources->findMaterial(mat->first);
+		ResourceMaterial material = engine->resources->getMaterial(mat->first);
 
-		streamDataByPipeline[material->pipelineHash][mat->first] = mat->second;
+		// Materials that are still being loaded asynchronously just don't get rendered yet
+		if (material == nullptr || !material->dataLoaded)
+			continue;
+
+		// Materials whose pipeline is still compiling get drawn w/ the fallback pipeline, or skipped if that isn't ready either
+		ResourcePipeline pipeline = engine->resources->getMaterialPipeline(material);
+
+		if (pipeline == nullptr || (renderDepth && pipeline->depthPipeline == nullptr))
+			continue;
+
+		streamDataByPipeline[pipeline->handle][mat->first] = mat->second;
 	}
 
 	cmdBuffer->beginDebugRegion("Level Static Objects", glm::vec4(1.0f, 0.984f, 0.059f, 1.0f));
 
 	for (auto pipeIt = streamDataByPipeline.begin(); pipeIt != streamDataByPipeline.end(); pipeIt ++)
 	{
-		ResourcePipeline materialPipeline = engine->resources->findPipeline(pipeIt->first);
+		ResourcePipeline materialPipeline = engine->resources->getPipeline(pipeIt->first);
 
 		glm::vec3 cameraPosition = engine->api->getMainCameraPosition();
 
@@ -219,17 +229,27 @@ void WorldRenderer::renderWorldStaticMeshes (CommandBuffer &cmdBuffer, glm::mat4
 		cmdBuffer->pushConstants(SHADER_STAGE_VERTEX_BIT, sizeof(glm::mat4), sizeof(glm::vec3), &cameraPosition.x);
 		cmdBuffer->pushConstants(SHADER_STAGE_VERTEX_BIT, sizeof(glm::mat4) + sizeof(glm::vec4), sizeof(glm::vec3), &cameraCellOffset.x);
 
+		/*
+		 * Meshes all live in the mesh pool, so the vertex & index buffers only have to be bound again when a mesh is in a different
+		 * pool page (or uses a different index type) than the last one. The instance data is picked w/ firstInstance instead of
+		 * an offset when binding, so the streaming buffer is only bound once.
+		 */
+		cmdBuffer->bindVertexBuffers(1, {worldStreamingBuffer}, {0});
+
+		Buffer boundVertexBuffer = nullptr, boundIndexBuffer = nullptr;
+		bool boundIndexBufferUses32bitIndices = false;
+
 		uint32_t drawCallCount = 0;
 		for (auto mat = pipeIt->second.begin(); mat != pipeIt->second.end(); mat ++)
 		{
-			ResourceMaterial material = engine->resources->findMaterial(mat->first);
+			ResourceMaterial material = engine->resources->getMaterial(mat->first);
 
 			cmdBuffer->beginDebugRegion("For material: " + material->defUniqueName, glm::vec4(1.0f, 0.467f, 0.02f, 1.0f));
 			cmdBuffer->bindDescriptorSets(PIPELINE_BIND_POINT_GRAPHICS, 0, {material->descriptorSet});
 
 			for (auto mesh = mat->second.begin(); mesh != mat->second.end(); mesh ++)
 			{
-				ResourceStaticMesh staticMesh = engine->resources->findStaticMesh(mesh->first);
+				ResourceStaticMesh staticMesh = engine->resources->getStaticMesh(mesh->first);
 
 				cmdBuffer->insertDebugMarker("For mesh: " + staticMesh->defUniqueName, glm::vec4(1.0f, 0.039f, 0.439f, 1.0f));
 
@@ -242,6 +262,9 @@ void WorldRenderer::renderWorldStaticMeshes (CommandBuffer &cmdBuffer, glm::mat4
 
 					ResourceMesh staticMeshLOD = staticMesh->meshLODs[lod].second;
 
+					if (staticMeshLOD->loadFailed)
+						continue;
+
 					size_t meshInstanceDataSize = dataList.size() * sizeof(dataList[0]);
 
 					if (worldStreamingBufferOffset * sizeof(dataList[0]) + meshInstanceDataSize > STATIC_OBJECT_STREAMING_BUFFER_SIZE)
@@ -249,15 +272,29 @@ void WorldRenderer::renderWorldStaticMeshes (CommandBuffer &cmdBuffer, glm::mat4
 						worldStreamingBufferOffset = 0;
 					}
 
-					cmdBuffer->bindIndexBuffer(staticMeshLOD->meshIndexBuffer, 0, staticMeshLOD->uses32bitIndices);
-					cmdBuffer->bindVertexBuffers(0, {staticMeshLOD->meshVertexBuffer, worldStreamingBuffer}, {0, worldStreamingBufferOffset * sizeof(dataList[0])});
+					cmdBuffer->pushConstants(SHADER_STAGE_VERTEX_BIT, sizeof(glm::mat4) + sizeof(glm::vec4) * 2, sizeof(svec4), &staticMeshLOD->vertexDecodeScale.x);
+					cmdBuffer->pushConstants(SHADER_STAGE_VERTEX_BIT, sizeof(glm::mat4) + sizeof(glm::vec4) * 3, sizeof(svec4), &staticMeshLOD->vertexDecodeOffset.x);
+
+					if (staticMeshLOD->meshVertexBuffer != boundVertexBuffer)
+					{
+						cmdBuffer->bindVertexBuffers(0, {staticMeshLOD->meshVertexBuffer}, {0});
+						boundVertexBuffer = staticMeshLOD->meshVertexBuffer;
+					}
+
+					if (staticMeshLOD->meshIndexBuffer != boundIndexBuffer || staticMeshLOD->uses32bitIndices != boundIndexBufferUses32bitIndices)
+					{
+						cmdBuffer->bindIndexBuffer(staticMeshLOD->meshIndexBuffer, 0, staticMeshLOD->uses32bitIndices);
+						boundIndexBuffer = staticMeshLOD->meshIndexBuffer;
+						boundIndexBufferUses32bitIndices = staticMeshLOD->uses32bitIndices;
+					}
 
 					memcpy(static_cast<LevelStaticObject*>(worldStreamingBufferData) + worldStreamingBufferOffset, dataList.data(), meshInstanceDataSize);
-					worldStreamingBufferOffset += dataList.size();
 
 					drawCallCount ++;
 
-					cmdBuffer->drawIndexed(staticMeshLOD->faceCount * 3, (uint32_t) dataList.size());
+					cmdBuffer->drawIndexed(staticMeshLOD->faceCount * 3, (uint32_t) dataList.size(), staticMeshLOD->firstIndex, staticMeshLOD->vertexOffset, (uint32_t) worldStreamingBufferOffset);
+
+					worldStreamingBufferOffset += dataList.size();
 				}
 			}
 
@@ -277,10 +314,27 @@ void WorldRenderer::traverseOctreeNode (SortedOctree<LevelStaticObjectType, Leve
 
 	for (size_t i = 0; i < node.objectList.size(); i ++)
 	{
-		const LevelStaticObjectType &objType = node.objectList[i].first;
+		LevelStaticObjectType &objType = node.objectList[i].first;
 		std::vector<LevelStaticObject> &objList = node.objectList[i].second;
 
-		ResourceStaticMesh mesh = engine->resources->findStaticMesh(objType.meshDefUniqueNameHash);
+		ResourceStaticMesh mesh = engine->resources->getStaticMesh(objType.meshHandle);
+
+		// The handles are only looked up by id if they haven't been resolved yet, or the resource has been freed since
+		if (mesh == nullptr)
+		{
+			mesh = engine->resources->findStaticMesh(objType.meshDefUniqueNameID);
+			objType.meshHandle = mesh != nullptr ? mesh->handle : ResourceStaticMeshHandle();
+		}
+
+		if (engine->resources->getMaterial(objType.materialHandle) == nullptr)
+		{
+			ResourceMaterial material = engine->resources->findMaterial(objType.materialDefUniqueNameID);
+			objType.materialHandle = material != nullptr ? material->handle : ResourceMaterialHandle();
+		}
+
+		// Same goes for meshes that are still being loaded asynchronously
+		if (mesh == nullptr || !mesh->dataLoaded || objType.materialHandle.isNull())
+			continue;
 
 		int32_t lod = 0;
 		float cellDistance = glm::distance(engine->api->getMainCameraPosition(), node.cellBB.getCenter());
@@ -303,13 +357,13 @@ void WorldRenderer::traverseOctreeNode (SortedOctree<LevelStaticObjectType, Leve
 			continue;
 
 		// If there's no mesh data for this material, we need to do some special setup for it
-		auto &materialList = data.data[objType.materialDefUniqueNameHash];
-		if (materialList.find(objType.meshDefUniqueNameHash) == materialList.end())
+		auto &materialList = data.data[objType.materialHandle];
+		if (materialList.find(objType.meshHandle) == materialList.end())
 		{
-			materialList[objType.meshDefUniqueNameHash] = std::vector<std::vector<LevelStaticObject> >(mesh->meshLODs.size(), std::vector<LevelStaticObject>());
+			materialList[objType.meshHandle] = std::vector<std::vector<LevelStaticObject> >(mesh->meshLODs.size(), std::vector<LevelStaticObject>());
 		}
 
-		std::vector<LevelStaticObject> &dataList = materialList[objType.meshDefUniqueNameHash][lod];
+		std::vector<LevelStaticObject> &dataList = materialList[objType.meshHandle][lod];
 
 		dataList.insert(dataList.end(), objList.begin(), objList.end());
 	}
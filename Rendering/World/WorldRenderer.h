@@ -36,6 +36,7 @@
 #include <Rendering/Renderer/RendererEnums.h>
 #include <Rendering/Renderer/RendererObjects.h>
 #include <World/SortedOctree.h>
+#include <Resources/Resources.h>
 
 #include <Rendering/World/CSM.h>
 
@@ -47,7 +48,7 @@ class TerrainShadowRenderer;
 struct LevelStaticObject;
 struct LevelStaticObjectType;
 
-typedef std::map<size_t, std::map<size_t, std::vector<std::vector<LevelStaticObject> > > > LevelStaticObjectStreamingDataHierarchy;
+typedef std::map<ResourceMaterialHandle, std::map<ResourceStaticMeshHandle, std::vector<std::vector<LevelStaticObject> > > > LevelStaticObjectStreamingDataHierarchy;
 
 typedef struct LevelStaticObjectStreamingData
 {
@@ -55,8 +56,8 @@ typedef struct LevelStaticObjectStreamingData
 		 * The data that will be rendered. It's a little complex and long winded, and might change.
 		 *
 		 * In order, it goes:
-		 * 						map of material hashes
-		 * 							map of mesh hashes
+		 * 						map of material handles
+		 * 							map of static mesh handles
 		 * 								vector of mesh lods (size() == mesh lod number, always)
 		 * 									vector of objs using this data
 		 */
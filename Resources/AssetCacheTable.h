@@ -0,0 +1,290 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2017 David Allen
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * AssetCacheTable.h
+ */
+
+#ifndef RESOURCES_ASSETCACHETABLE_H_
+#define RESOURCES_ASSETCACHETABLE_H_
+
+#include <common.h>
+#include <Resources/AssetID.h>
+
+#define ASSET_CACHE_TABLE_MIN_CAPACITY 16
+
+/*
+ * Mixes the bits of a 64-bit key (the splitmix64 finalizer), so the low bits used to pick a slot depend on the whole key.
+ */
+inline uint64_t mixAssetCacheKey (uint64_t key)
+{
+	key ^= key >> 30;
+	key *= 0xbf58476d1ce4e5b9ULL;
+	key ^= key >> 27;
+	key *= 0x94d049bb133111ebULL;
+	key ^= key >> 31;
+
+	return key;
+}
+
+inline uint64_t combineAssetCacheKey (uint64_t seed, uint64_t key)
+{
+	return mixAssetCacheKey(seed ^ (key + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2)));
+}
+
+template<typename Key>
+struct AssetCacheKeyHash
+{
+		inline uint64_t operator() (const Key &key) const
+		{
+			return mixAssetCacheKey((uint64_t) key);
+		}
+};
+
+/*
+ * A hash table for the resource caches, w/ open addressing & linear probing. All of the entries are stored inline in one
+ * array, so a lookup is usually a single cache miss instead of the pointer chasing & string compares that a std::map costs.
+ * The capacity is always a power of two and is kept under 70% full. Erasing shifts the following entries back instead of
+ * leaving tombstones, so lookups don't get slower over time as resources are loaded & unloaded.
+ *
+ * The interface is just the parts of std::map the caches use (find, end, erase, operator[], size), so the lookups read the same.
+ * Note that unlike std::map, ANY insert or erase invalidates all of the iterators.
+ */
+template<typename Key, typename Value, typename KeyHash = AssetCacheKeyHash<Key> >
+class AssetCacheTable
+{
+	public:
+
+		typedef std::pair<Key, Value> value_type;
+
+		class iterator
+		{
+			public:
+
+				iterator (value_type *entryPtr, size_t slotIndex)
+					: entry(entryPtr), index(slotIndex)
+				{
+				}
+
+				value_type &operator* () const
+				{
+					return *entry;
+				}
+
+				value_type *operator-> () const
+				{
+					return entry;
+				}
+
+				bool operator== (const iterator &arg0) const
+				{
+					return entry == arg0.entry;
+				}
+
+				bool operator!= (const iterator &arg0) const
+				{
+					return entry != arg0.entry;
+				}
+
+			private:
+
+				value_type *entry;
+				size_t index;
+
+				friend class AssetCacheTable;
+		};
+
+		AssetCacheTable ()
+		{
+			entryCount = 0;
+		}
+
+		iterator find (const Key &key)
+		{
+			if (slots.size() == 0)
+				return end();
+
+			size_t mask = slots.size() - 1;
+
+			for (size_t i = hashKey(key) & mask; slots[i].occupied; i = (i + 1) & mask)
+				if (slots[i].entry.first == key)
+					return iterator(&slots[i].entry, i);
+
+			return end();
+		}
+
+		iterator end ()
+		{
+			return iterator(nullptr, 0);
+		}
+
+		size_t count (const Key &key)
+		{
+			return find(key) != end() ? 1 : 0;
+		}
+
+		Value &operator[] (const Key &key)
+		{
+			iterator it = find(key);
+
+			if (it != end())
+				return it->second;
+
+			if ((entryCount + 1) * 10 > slots.size() * 7)
+				rehash(std::max<size_t>(slots.size() * 2, ASSET_CACHE_TABLE_MIN_CAPACITY));
+
+			size_t mask = slots.size() - 1;
+			size_t i = hashKey(key) & mask;
+
+			while (slots[i].occupied)
+				i = (i + 1) & mask;
+
+			slots[i].occupied = true;
+			slots[i].entry = value_type(key, Value());
+			entryCount ++;
+
+			return slots[i].entry.second;
+		}
+
+		void erase (iterator it)
+		{
+			if (it == end())
+				return;
+
+			size_t mask = slots.size() - 1;
+			size_t hole = it.index;
+
+			/*
+			 * Backward shift deletion, every entry after the hole in the same run is moved into the hole if that's
+			 * still on or after it's home slot, which keeps every entry reachable from it's home w/o tombstones.
+			 */
+			for (size_t i = (hole + 1) & mask; slots[i].occupied; i = (i + 1) & mask)
+			{
+				size_t home = hashKey(slots[i].entry.first) & mask;
+
+				// Whether the home slot is cyclically in (hole, i], if so the entry has to stay where it is
+				bool homeBetween = (hole <= i) ? (home > hole && home <= i) : (home > hole || home <= i);
+
+				if (!homeBetween)
+				{
+					slots[hole].entry = std::move(slots[i].entry);
+					hole = i;
+				}
+			}
+
+			slots[hole].occupied = false;
+			slots[hole].entry = value_type();
+			entryCount --;
+		}
+
+		size_t erase (const Key &key)
+		{
+			iterator it = find(key);
+
+			if (it == end())
+				return 0;
+
+			erase(it);
+
+			return 1;
+		}
+
+		/*
+		 * Grows the table so it can hold <count> entries w/o having to grow again.
+		 */
+		void reserve (size_t count)
+		{
+			size_t newCapacity = std::max<size_t>(slots.size(), ASSET_CACHE_TABLE_MIN_CAPACITY);
+
+			while (count * 10 > newCapacity * 7)
+				newCapacity *= 2;
+
+			if (newCapacity != slots.size())
+				rehash(newCapacity);
+		}
+
+		/*
+		 * Calls <func> w/ every entry in the table, in no particular order. The table can't be changed from inside of <func>.
+		 */
+		template<typename Func>
+		void forEach (Func func)
+		{
+			for (size_t i = 0; i < slots.size(); i ++)
+				if (slots[i].occupied)
+					func(slots[i].entry);
+		}
+
+		size_t size () const
+		{
+			return entryCount;
+		}
+
+		size_t capacity () const
+		{
+			return slots.size();
+		}
+
+	private:
+
+		typedef struct Slot
+		{
+				value_type entry;
+				bool occupied;
+
+				Slot ()
+					: entry(), occupied(false)
+				{
+				}
+		} Slot;
+
+		std::vector<Slot> slots;
+		size_t entryCount;
+
+		inline size_t hashKey (const Key &key) const
+		{
+			return (size_t) KeyHash()(key);
+		}
+
+		void rehash (size_t newCapacity)
+		{
+			std::vector<Slot> oldSlots(newCapacity);
+			oldSlots.swap(slots);
+
+			size_t mask = slots.size() - 1;
+
+			for (size_t s = 0; s < oldSlots.size(); s ++)
+			{
+				if (!oldSlots[s].occupied)
+					continue;
+
+				size_t i = hashKey(oldSlots[s].entry.first) & mask;
+
+				while (slots[i].occupied)
+					i = (i + 1) & mask;
+
+				slots[i].occupied = true;
+				slots[i].entry = std::move(oldSlots[s].entry);
+			}
+		}
+};
+
+#endif /* RESOURCES_ASSETCACHETABLE_H_ */
@@ -0,0 +1,146 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2017 David Allen
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * AssetID.cpp
+ */
+
+#include "Resources/AssetID.h"
+
+#include <shared_mutex>
+#include <unordered_map>
+
+#define ASSET_ID_FNV_OFFSET_BASIS 0xcbf29ce484222325ULL
+#define ASSET_ID_FNV_PRIME 0x100000001b3ULL
+
+static std::shared_timed_mutex assetIDTable_mutex;
+static std::unordered_map<AssetID, std::string> assetIDTable;
+static uint32_t assetIDCollisionCount = 0;
+
+/*
+ * Looks up the id for an already interned name, following the same probe sequence as the collision handling in
+ * getAssetID(). Returns ASSET_ID_INVALID if the name hasn't been interned yet, and sets freeID to the first id in the
+ * sequence that isn't taken. Assumes the caller holds assetIDTable_mutex.
+ */
+inline AssetID findInternedAssetID (const std::string &name, AssetID &freeID, uint32_t &collisions)
+{
+	AssetID id = AssetIDTable::hashAssetName(name);
+	collisions = 0;
+
+	while (true)
+	{
+		auto it = assetIDTable.find(id);
+
+		if (it == assetIDTable.end())
+		{
+			freeID = id;
+
+			return ASSET_ID_INVALID;
+		}
+
+		if (it->second == name)
+			return id;
+
+		collisions ++;
+
+		// ASSET_ID_INVALID is never handed out
+		do
+		{
+			id ++;
+		}
+		while (id == ASSET_ID_INVALID);
+	}
+}
+
+AssetID AssetIDTable::getAssetID (const std::string &name)
+{
+	AssetID freeID = ASSET_ID_INVALID;
+	uint32_t collisions = 0;
+
+	{
+		std::shared_lock<std::shared_timed_mutex> lock(assetIDTable_mutex);
+
+		AssetID id = findInternedAssetID(name, freeID, collisions);
+
+		if (id != ASSET_ID_INVALID)
+			return id;
+	}
+
+	std::unique_lock<std::shared_timed_mutex> lock(assetIDTable_mutex);
+
+	// Someone else could've interned it between the locks, so it has to be looked up again
+	AssetID id = findInternedAssetID(name, freeID, collisions);
+
+	if (id != ASSET_ID_INVALID)
+		return id;
+
+	if (collisions > 0)
+	{
+		printf("%s Asset name \"%s\" collides w/ \"%s\" (id: %llu), it's been given the id %llu instead, which isn't stable between runs\n", ERR_PREFIX, name.c_str(), assetIDTable[hashAssetName(name)].c_str(), (unsigned long long) hashAssetName(name), (unsigned long long) freeID);
+
+		assetIDCollisionCount ++;
+	}
+
+	assetIDTable[freeID] = name;
+
+	return freeID;
+}
+
+std::string AssetIDTable::getAssetName (AssetID id)
+{
+	std::shared_lock<std::shared_timed_mutex> lock(assetIDTable_mutex);
+
+	auto it = assetIDTable.find(id);
+
+	return it != assetIDTable.end() ? it->second : "";
+}
+
+size_t AssetIDTable::getInternedCount ()
+{
+	std::shared_lock<std::shared_timed_mutex> lock(assetIDTable_mutex);
+
+	return assetIDTable.size();
+}
+
+uint32_t AssetIDTable::getCollisionCount ()
+{
+	std::shared_lock<std::shared_timed_mutex> lock(assetIDTable_mutex);
+
+	return assetIDCollisionCount;
+}
+
+/*
+ * The raw hash of a name, w/o any of the collision handling. Should only really be used by the table itself, anything
+ * else should go through getAssetID().
+ */
+AssetID AssetIDTable::hashAssetName (const std::string &name)
+{
+	AssetID hash = ASSET_ID_FNV_OFFSET_BASIS;
+
+	for (size_t i = 0; i < name.length(); i ++)
+	{
+		hash ^= (uint8_t) name[i];
+		hash *= ASSET_ID_FNV_PRIME;
+	}
+
+	return hash == ASSET_ID_INVALID ? 1 : hash;
+}
@@ -0,0 +1,60 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2017 David Allen
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * AssetID.h
+ */
+
+#ifndef RESOURCES_ASSETID_H_
+#define RESOURCES_ASSETID_H_
+
+#include <common.h>
+
+/*
+ * A stable id for a named asset (def unique names, file paths, mesh names, etc). It's the 64-bit FNV-1a hash of the
+ * name, so the same name gives the same id on every run & platform, unlike std::hash<std::string>.
+ */
+typedef uint64_t AssetID;
+
+#define ASSET_ID_INVALID 0
+
+/*
+ * Interns asset names into AssetIDs. Every id that's handed out is remembered along w/ the name it came from, so if two
+ * different names ever hash to the same id it's caught instead of silently mixing up two resources in the caches. The
+ * name that collided is reported and given the next unused id instead, which is only stable for the rest of the run.
+ *
+ * Lookups of names that were already interned only take a shared lock, so it's fine to call from any thread.
+ */
+class AssetIDTable
+{
+	public:
+
+		static AssetID getAssetID (const std::string &name);
+		static std::string getAssetName (AssetID id);
+
+		static size_t getInternedCount ();
+		static uint32_t getCollisionCount ();
+
+		static AssetID hashAssetName (const std::string &name);
+};
+
+#endif /* RESOURCES_ASSETID_H_ */
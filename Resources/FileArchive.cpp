@@ -0,0 +1,349 @@
+/*
+* MIT License
+*
+* Copyright (c) 2017 David Allen
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+* FileArchive.cpp
+*/
+
+#include "FileArchive.h"
+
+#include <common.h>
+
+FileArchive::FileArchive()
+{
+	header = nullptr;
+	table = nullptr;
+	paths = nullptr;
+}
+
+FileArchive::~FileArchive()
+{
+	close();
+}
+
+bool FileArchive::open(const std::string &archiveFile)
+{
+	close();
+
+	this->archiveFile = archiveFile;
+
+	mapping = FileView::mapFile(archiveFile);
+
+	if (!mapping.isValid())
+	{
+		printf("%s Failed to open archive: %s\n", ERR_PREFIX, archiveFile.c_str());
+
+		return false;
+	}
+
+	if (mapping.size() < sizeof(FileArchiveHeader))
+	{
+		printf("%s Failed to open archive: %s, it's too small to be an archive\n", ERR_PREFIX, archiveFile.c_str());
+		close();
+
+		return false;
+	}
+
+	header = reinterpret_cast<const FileArchiveHeader*>(mapping.data());
+
+	if (header->magic != FILE_ARCHIVE_MAGIC_NUM || header->version != FILE_ARCHIVE_VERSION)
+	{
+		printf("%s Failed to open archive: %s, invalid magic number or version (got %8x v%u, should be %8x v%u)\n", ERR_PREFIX, archiveFile.c_str(), header->magic, header->version, FILE_ARCHIVE_MAGIC_NUM, FILE_ARCHIVE_VERSION);
+		close();
+
+		return false;
+	}
+
+	uint64_t archiveSize = (uint64_t) mapping.size();
+
+	// The table size has to be a power of two for the lookups to work, and has to actually fit in the file
+	if (header->tableSize == 0 || (header->tableSize & (header->tableSize - 1)) != 0 || !isRangeInArchive(header->tableOffset, (uint64_t) header->tableSize * sizeof(FileArchiveEntry), archiveSize) || header->pathsOffset > archiveSize)
+	{
+		printf("%s Failed to open archive: %s, it has a corrupt table of contents\n", ERR_PREFIX, archiveFile.c_str());
+		close();
+
+		return false;
+	}
+
+	table = reinterpret_cast<const FileArchiveEntry*>(mapping.data() + header->tableOffset);
+	paths = mapping.data() + header->pathsOffset;
+
+	// Every entry gets checked once here, so findFile() & co can trust the offsets w/o reading outside of the mapping
+	for (uint32_t i = 0; i < header->tableSize; i ++)
+	{
+		const FileArchiveEntry &entry = table[i];
+
+		if (entry.pathHash == 0)
+			continue;
+
+		if (!isRangeInArchive(entry.dataOffset, entry.dataSize, archiveSize) || !isRangeInArchive(entry.pathOffset, entry.pathLength, archiveSize - header->pathsOffset))
+		{
+			printf("%s Failed to open archive: %s, entry %u points outside of the archive\n", ERR_PREFIX, archiveFile.c_str(), i);
+			close();
+
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void FileArchive::close()
+{
+	mapping = FileView();
+
+	header = nullptr;
+	table = nullptr;
+	paths = nullptr;
+}
+
+bool FileArchive::findFile(const std::string &filename, const char *&data, size_t &size) const
+{
+	const FileArchiveEntry *entry = findEntry(filename);
+
+	if (entry == nullptr)
+		return false;
+
+	data = mapping.data() + entry->dataOffset;
+	size = (size_t) entry->dataSize;
+
+	return true;
+}
+
+bool FileArchive::containsFile(const std::string &filename) const
+{
+	return findEntry(filename) != nullptr;
+}
+
+std::vector<std::string> FileArchive::getFileList() const
+{
+	std::vector<std::string> fileList;
+
+	if (header == nullptr)
+		return fileList;
+
+	for (uint32_t i = 0; i < header->tableSize; i ++)
+		if (table[i].pathHash != 0)
+			fileList.push_back(std::string(paths + table[i].pathOffset, table[i].pathLength));
+
+	return fileList;
+}
+
+std::string FileArchive::getArchiveFile() const
+{
+	return archiveFile;
+}
+
+const FileArchiveEntry *FileArchive::findEntry(const std::string &filename) const
+{
+	if (header == nullptr)
+		return nullptr;
+
+	// Archives always store paths w/ forward slashes
+	std::string path = filename;
+	std::replace(path.begin(), path.end(), '\\', '/');
+
+	uint64_t pathHash = hashPath(path);
+	uint32_t tableMask = header->tableSize - 1;
+
+	for (uint32_t i = 0; i < header->tableSize; i ++)
+	{
+		const FileArchiveEntry &entry = table[(pathHash + i) & tableMask];
+
+		// Hit an empty slot, so the file isn't in here
+		if (entry.pathHash == 0)
+			return nullptr;
+
+		if (entry.pathHash == pathHash && entry.pathLength == path.length() && memcmp(paths + entry.pathOffset, path.data(), path.length()) == 0)
+			return &entry;
+	}
+
+	return nullptr;
+}
+
+/*
+Checks that [offset, offset + size) fits in [0, limit) w/o the sum being able to overflow, since the offsets come from the file.
+*/
+bool FileArchive::isRangeInArchive(uint64_t offset, uint64_t size, uint64_t limit)
+{
+	return offset <= limit && size <= limit - offset;
+}
+
+/*
+FNV-1a, it needs to be stable between builds & platforms because it's stored on disk, so std::hash is out. A hash of 0 marks an
+empty table slot, so it's never returned.
+*/
+uint64_t FileArchive::hashPath(const std::string &path)
+{
+	uint64_t hash = 14695981039346656037ULL;
+
+	for (size_t i = 0; i < path.length(); i ++)
+	{
+		hash ^= (uint64_t) (uint8_t) path[i];
+		hash *= 1099511628211ULL;
+	}
+
+	return hash != 0 ? hash : 1;
+}
+
+bool FileArchive::writeArchive(const std::string &archiveFile, const std::string &baseDir, const std::vector<std::string> &files)
+{
+	FileArchiveHeader archiveHeader = {};
+	archiveHeader.magic = FILE_ARCHIVE_MAGIC_NUM;
+	archiveHeader.version = FILE_ARCHIVE_VERSION;
+	archiveHeader.fileCount = (uint32_t) files.size();
+
+	// Keep the table at most half full so probe sequences stay short
+	archiveHeader.tableSize = 1;
+
+	while (archiveHeader.tableSize < files.size() * 2)
+		archiveHeader.tableSize <<= 1;
+
+	std::vector<FileArchiveEntry> archiveTable(archiveHeader.tableSize);
+	std::vector<std::string> archivePaths(files.size());
+	std::string archivePathBlock;
+
+	memset(archiveTable.data(), 0, archiveTable.size() * sizeof(FileArchiveEntry));
+
+	for (size_t i = 0; i < files.size(); i ++)
+	{
+		archivePaths[i] = files[i];
+		std::replace(archivePaths[i].begin(), archivePaths[i].end(), '\\', '/');
+
+		archivePathBlock += archivePaths[i];
+	}
+
+	archiveHeader.tableOffset = sizeof(FileArchiveHeader);
+	archiveHeader.pathsOffset = archiveHeader.tableOffset + archiveTable.size() * sizeof(FileArchiveEntry);
+
+#ifdef _WIN32
+	std::ofstream archive(utf8_to_utf16(archiveFile).c_str(), std::ios::out | std::ios::binary);
+#else
+	std::ofstream archive(archiveFile, std::ios::out | std::ios::binary);
+#endif
+
+	if (!archive.is_open())
+	{
+		printf("%s Failed to write archive: %s, couldn't open it for writing\n", ERR_PREFIX, archiveFile.c_str());
+
+		return false;
+	}
+
+	// The header & table get written again at the end, once we know where all the files ended up
+	archive.write(reinterpret_cast<const char*>(&archiveHeader), sizeof(FileArchiveHeader));
+	archive.write(reinterpret_cast<const char*>(archiveTable.data()), archiveTable.size() * sizeof(FileArchiveEntry));
+	archive.write(archivePathBlock.data(), archivePathBlock.length());
+
+	const char padding[FILE_ARCHIVE_DATA_ALIGNMENT] = {0};
+	uint32_t tableMask = archiveHeader.tableSize - 1;
+	uint32_t pathOffset = 0;
+
+	// The files get written in the same order they were listed, so they're contiguous on disk in that order
+	for (size_t i = 0; i < files.size(); i ++)
+	{
+		const std::string &path = archivePaths[i];
+		std::vector<char> fileData;
+
+		// An empty buffer could also be an empty file, so the file is read here to tell a failed read apart from one
+		if (!readSourceFile(baseDir + files[i], fileData))
+		{
+			printf("%s Failed to write archive: %s, couldn't read file %s\n", ERR_PREFIX, archiveFile.c_str(), (baseDir + files[i]).c_str());
+			archive.close();
+			deleteFile(archiveFile);
+
+			return false;
+		}
+
+		size_t paddingSize = (FILE_ARCHIVE_DATA_ALIGNMENT - ((size_t) archive.tellp() % FILE_ARCHIVE_DATA_ALIGNMENT)) % FILE_ARCHIVE_DATA_ALIGNMENT;
+		archive.write(padding, paddingSize);
+
+		FileArchiveEntry entry = {};
+		entry.pathHash = hashPath(path);
+		entry.dataOffset = (uint64_t) archive.tellp();
+		entry.dataSize = fileData.size();
+		entry.pathOffset = pathOffset;
+		entry.pathLength = (uint32_t) path.length();
+
+		archive.write(fileData.data(), fileData.size());
+		pathOffset += entry.pathLength;
+
+		uint32_t slot = (uint32_t) (entry.pathHash & tableMask);
+
+		while (archiveTable[slot].pathHash != 0)
+		{
+			if (archiveTable[slot].pathHash == entry.pathHash && archiveTable[slot].pathLength == entry.pathLength && memcmp(&archivePathBlock[archiveTable[slot].pathOffset], path.data(), path.length()) == 0)
+			{
+				printf("%s Failed to write archive: %s, file %s was listed more than once\n", ERR_PREFIX, archiveFile.c_str(), path.c_str());
+				archive.close();
+				deleteFile(archiveFile);
+
+				return false;
+			}
+
+			slot = (slot + 1) & tableMask;
+		}
+
+		archiveTable[slot] = entry;
+	}
+
+	archive.seekp(0);
+	archive.write(reinterpret_cast<const char*>(&archiveHeader), sizeof(FileArchiveHeader));
+	archive.write(reinterpret_cast<const char*>(archiveTable.data()), archiveTable.size() * sizeof(FileArchiveEntry));
+
+	archive.close();
+
+	printf("%s Wrote archive: %s w/ %u files\n", INFO_PREFIX, archiveFile.c_str(), archiveHeader.fileCount);
+
+	return true;
+}
+
+bool FileArchive::readSourceFile(const std::string &file, std::vector<char> &data)
+{
+#ifdef _WIN32
+	std::ifstream in(utf8_to_utf16(file).c_str(), std::ios::ate | std::ios::binary);
+#else
+	std::ifstream in(file, std::ios::ate | std::ios::binary);
+#endif
+
+	if (!in.is_open())
+		return false;
+
+	std::streamoff fileSize = in.tellg();
+
+	if (fileSize < 0)
+		return false;
+
+	data.resize((size_t) fileSize);
+	in.seekg(0);
+	in.read(data.data(), fileSize);
+
+	return (bool) in;
+}
+
+void FileArchive::deleteFile(const std::string &file)
+{
+#ifdef _WIN32
+	DeleteFileW(utf8_to_utf16(file).c_str());
+#else
+	remove(file.c_str());
+#endif
+}
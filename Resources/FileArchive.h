@@ -0,0 +1,116 @@
+/*
+* MIT License
+*
+* Copyright (c) 2017 David Allen
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+* FileArchive.h
+*/
+
+#ifndef RESOURCE_FILEARCHIVE_H_
+#define RESOURCE_FILEARCHIVE_H_
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include <Resources/FileView.h>
+
+#define FILE_ARCHIVE_MAGIC_NUM 0x52414553 // "SEAR" in little endian
+#define FILE_ARCHIVE_VERSION 1
+#define FILE_ARCHIVE_EXTENSION ".sea"
+#define FILE_ARCHIVE_DATA_ALIGNMENT 16
+
+/*
+The header at the very start of an archive file. The table of contents is an open addressing hash table (linear probing) of
+<tableSize> entries, where <tableSize> is always a power of two, and an entry with a pathHash of 0 is an empty slot.
+*/
+typedef struct
+{
+	uint32_t magic;
+	uint32_t version;
+	uint32_t fileCount;
+	uint32_t tableSize;
+	uint64_t tableOffset;
+	uint64_t pathsOffset;
+} FileArchiveHeader;
+
+typedef struct
+{
+	uint64_t pathHash;
+	uint64_t dataOffset;
+	uint64_t dataSize;
+	uint32_t pathOffset; // Offset into the path string block, used to check for hash collisions
+	uint32_t pathLength;
+} FileArchiveEntry;
+
+/*
+A packed archive of game files. The whole archive is memory mapped once when it's opened, and every file lookup is a single hash
+table probe that returns a pointer straight into the mapping, so no extra file handles or copies are needed per file. Paths are
+stored relative to the working directory w/ forward slashes, e.g. "GameData/textures/blah.png".
+*/
+class FileArchive
+{
+	public:
+
+	FileArchive();
+	virtual ~FileArchive();
+
+	/*
+	Opens & maps an archive file. Returns false if the file couldn't be opened or isn't a valid archive.
+	*/
+	bool open(const std::string &archiveFile);
+	void close();
+
+	/*
+	Finds a file in the archive. If found, <data> points into the archive's mapping and is valid until the archive is closed.
+	*/
+	bool findFile(const std::string &filename, const char *&data, size_t &size) const;
+	bool containsFile(const std::string &filename) const;
+
+	std::vector<std::string> getFileList() const;
+	std::string getArchiveFile() const;
+
+	/*
+	Packs a list of files into a new archive. <files> are relative to <baseDir>, and are also the names the files are stored under.
+	Returns false (and doesn't leave a partial archive behind) if any of the files couldn't be read.
+	*/
+	static bool writeArchive(const std::string &archiveFile, const std::string &baseDir, const std::vector<std::string> &files);
+
+	static uint64_t hashPath(const std::string &path);
+
+	private:
+
+	std::string archiveFile;
+
+	FileView mapping;
+
+	const FileArchiveHeader *header;
+	const FileArchiveEntry *table;
+	const char *paths;
+
+	const FileArchiveEntry *findEntry(const std::string &filename) const;
+
+	static bool isRangeInArchive(uint64_t offset, uint64_t size, uint64_t limit);
+	static bool readSourceFile(const std::string &file, std::vector<char> &data);
+	static void deleteFile(const std::string &file);
+};
+
+#endif /* RESOURCE_FILEARCHIVE_H_ */
@@ -31,109 +31,88 @@
 
 #include <common.h>
 
+#include <Resources/FileArchive.h>
+#include <Resources/FileView.h>
+
+#ifndef _WIN32
+#include <sys/stat.h>
+
+/*
+Some filesystems (e.g. XFS w/o ftype, some network mounts) don't fill in d_type, so it's DT_UNKNOWN and we have to stat() the entry.
+*/
+static bool isDirectoryEntry(const std::string &dirPath, const struct dirent *entry)
+{
+	if (entry->d_type != DT_UNKNOWN)
+		return entry->d_type == DT_DIR;
+
+	struct stat entryStat;
+
+	return stat((dirPath + entry->d_name).c_str(), &entryStat) == 0 && S_ISDIR(entryStat.st_mode);
+}
+#endif
+
 FileLoader *FileLoader::fileLoaderInstance;
 
 FileLoader::FileLoader()
 {
 	workingDir = "";
+	mainArchiveCount = 0;
+	modEnableCount = 0;
 }
 
 FileLoader::~FileLoader()
 {
-
+	for (size_t i = 0; i < fileSources.size(); i ++)
+	{
+		delete fileSources[i]->archive;
+		delete fileSources[i];
+	}
 }
 
 std::string FileLoader::readFile(const std::string &filename)
 {
-	std::ifstream file;
-
-	// Search mod directories
-
-	// Search mod archives
-
-	// Search patch directories
+	std::string absoluteFile;
+	const char *data;
+	size_t size;
 
-	// Search patch archives
+	if (resolveFile(filename, absoluteFile, data, size))
+		return std::string(data, data + size);
 
-	// Search working directory
-	if ((file = openFileStream(workingDir + filename)).is_open())
-	{
-		size_t fileSize = (size_t) file.tellg();
-		std::vector<char> buffer(fileSize);
-
-		file.seekg(0);
-		file.read(buffer.data(), fileSize);
-
-		file.close();
-
-		return std::string(buffer.data(), buffer.data() + buffer.size());
-	}
-	
-	// Search main game archives
-
-	printf("%s Failed to open file: %s\n", ERR_PREFIX, filename.c_str());
-
-	return "";
+	return readFileAbsoluteDirectory(absoluteFile);
 }
 
 std::vector<char> FileLoader::readFileBuffer(const std::string &filename)
 {
-	std::ifstream file;
-
-	// Search mod directories
-
-	// Search mod archives
-
-	// Search patch directories
-
-	// Search patch archives
-
-	// Search working directory
-	if ((file = openFileStream(workingDir + filename)).is_open())
-	{
-		size_t fileSize = (size_t) file.tellg();
-		std::vector<char> buffer(fileSize);
-
-		file.seekg(0);
-		file.read(buffer.data(), fileSize);
-
-		file.close();
+	std::string absoluteFile;
+	const char *data;
+	size_t size;
 
-		return buffer;
-	}
-
-	// Search main game archives
+	if (resolveFile(filename, absoluteFile, data, size))
+		return std::vector<char>(data, data + size);
 
-	printf("%s Failed to open file: %s\n", ERR_PREFIX, filename.c_str());
-
-	return {};
+	return readFileAbsoluteDirectoryBuffer(absoluteFile);
 }
 
 std::ifstream FileLoader::openFileStream(const std::string &filename)
 {
-	// Search mod directories
-
-	// Search mod archives
+	std::string absoluteFile;
+	const char *data;
+	size_t size;
 
-	// Search patch directories
+	if (resolveFile(filename, absoluteFile, data, size))
+	{
+		printf("%s Failed to open file: %s, it's in an archive and can't be streamed, use readFile() or openFileView() instead\n", ERR_PREFIX, filename.c_str());
 
-	// Search patch archives
+		return std::ifstream();
+	}
 
-	// Search working directory
-	{
 #ifdef _WIN32
-		std::ifstream file(utf8_to_utf16(filename).c_str(), std::ios::ate | std::ios::binary);
+	std::ifstream file(utf8_to_utf16(absoluteFile).c_str(), std::ios::ate | std::ios::binary);
 #else
-		std::ifstream file(filename, std::ios::ate | std::ios::binary);
+	std::ifstream file(absoluteFile, std::ios::ate | std::ios::binary);
 #endif
 
-		if (file.is_open())
-			return file;
-	}
-
-	// Search main game archives
-
-	return std::ifstream();
+	return file;
 }
 
 std::string FileLoader::readFileAbsoluteDirectory(const std::string &filename)
@@ -152,14 +131,14 @@ std::string FileLoader::readFileAbsoluteDirectory(const std::string &filename)
 	}
 
 	size_t fileSize = (size_t) file.tellg();
-	std::vector<char> buffer(fileSize);
+	std::string contents(fileSize, '\0');
 
 	file.seekg(0);
-	file.read(buffer.data(), fileSize);
+	file.read(&contents[0], fileSize);
 
 	file.close();
 
-	return std::string(buffer.begin(), buffer.end());
+	return contents;
 }
 
 std::vector<char> FileLoader::readFileAbsoluteDirectoryBuffer(const std::string &filename)
@@ -188,6 +167,526 @@ std::vector<char> FileLoader::readFileAbsoluteDirectoryBuffer(const std::string
 	return buffer;
 }
 
+FileView FileLoader::openFileView(const std::string &filename)
+{
+	std::string absoluteFile;
+	const char *data;
+	size_t size;
+
+	if (resolveFile(filename, absoluteFile, data, size))
+		return FileView::fromMemory(data, size);
+
+	return openFileViewAbsoluteDirectory(absoluteFile);
+}
+
+FileView FileLoader::openFileViewAbsoluteDirectory(const std::string &filename)
+{
+	FileView view = FileView::mapFile(filename);
+
+	if (!view.isValid())
+		printf("%s Failed to open file: %s\n", ERR_PREFIX, filename.c_str());
+
+	return view;
+}
+
+bool FileLoader::fileExists(const std::string &filename)
+{
+	std::string absoluteFile;
+	const char *data;
+	size_t size;
+
+	if (resolveFile(filename, absoluteFile, data, size))
+		return true;
+
+#ifdef _WIN32
+	return GetFileAttributesW(utf8_to_utf16(absoluteFile).c_str()) != INVALID_FILE_ATTRIBUTES;
+#else
+	return access(absoluteFile.c_str(), F_OK) == 0;
+#endif
+}
+
+size_t FileLoader::getFileSize(const std::string &filename)
+{
+	std::string absoluteFile;
+	const char *data;
+	size_t size;
+
+	if (resolveFile(filename, absoluteFile, data, size))
+		return size;
+
+#ifdef _WIN32
+	WIN32_FILE_ATTRIBUTE_DATA fileAttribs;
+
+	if (!GetFileAttributesExW(utf8_to_utf16(absoluteFile).c_str(), GetFileExInfoStandard, &fileAttribs))
+		return 0;
+
+	return (size_t(fileAttribs.nFileSizeHigh) << 32) | size_t(fileAttribs.nFileSizeLow);
+#else
+	struct stat fileStat;
+
+	if (stat(absoluteFile.c_str(), &fileStat) != 0)
+		return 0;
+
+	return (size_t) fileStat.st_size;
+#endif
+}
+
+void FileLoader::buildFileIndex()
+{
+	std::vector<FileSource*> newSources;
+
+	// The working directory, only GameData is indexed so we don't end up scanning things like build directories
+	{
+		FileSource *source = new FileSource();
+		source->layer = FILE_SOURCE_LAYER_WORKING_DIR;
+		source->rootDir = workingDir;
+		source->archive = nullptr;
+		source->priority = getSourcePriority(FILE_SOURCE_LAYER_WORKING_DIR, 0, 0);
+
+		std::vector<std::string> files = getDirectoryFileList(workingDir + "GameData/", true);
+
+		for (size_t i = 0; i < files.size(); i ++)
+			if (files[i].compare(0, 8, "Patches/") != 0 && files[i].compare(0, 9, "Archives/") != 0)
+				source->files.insert("GameData/" + files[i]);
+
+		newSources.push_back(source);
+	}
+
+	std::vector<std::string> patches = getSubdirectoryList(workingDir + "GameData/Patches/");
+	std::sort(patches.begin(), patches.end());
+
+	for (size_t i = 0; i < patches.size(); i ++)
+	{
+		std::vector<FileSource*> patchSources = createOverlaySources(FILE_SOURCE_LAYER_PATCH, patches[i], workingDir + "GameData/Patches/" + patches[i] + "/", (uint32_t) i);
+		newSources.insert(newSources.end(), patchSources.begin(), patchSources.end());
+	}
+
+	std::unique_lock<std::mutex> lock(fileIndex_mutex);
+
+	// Throw out the old working directory & patch sources, and rebuild the whole index w/ the new ones
+	for (size_t i = 0; i < fileSources.size(); i ++)
+	{
+		if (fileSources[i]->layer == FILE_SOURCE_LAYER_WORKING_DIR || fileSources[i]->layer == FILE_SOURCE_LAYER_PATCH)
+		{
+			delete fileSources[i]->archive;
+			delete fileSources[i];
+
+			fileSources.erase(fileSources.begin() + i);
+			i --;
+		}
+	}
+
+	fileSources.insert(fileSources.end(), newSources.begin(), newSources.end());
+	fileIndex.clear();
+
+	for (size_t i = 0; i < fileSources.size(); i ++)
+		addSourceToIndex(fileSources[i]);
+
+	printf("%s Indexed %u files from %u sources, %u patches\n", INFO_PREFIX, (uint32_t) fileIndex.size(), (uint32_t) fileSources.size(), (uint32_t) patches.size());
+}
+
+bool FileLoader::enableMod(const std::string &modName)
+{
+	uint32_t modOrder;
+
+	// The name is reserved & the mod gets it's order in one go, so enabling two mods at once can't give them the same order
+	{
+		std::unique_lock<std::mutex> lock(fileIndex_mutex);
+
+		if (std::find(enabledMods.begin(), enabledMods.end(), modName) != enabledMods.end() || std::find(enablingMods.begin(), enablingMods.end(), modName) != enablingMods.end())
+			return false;
+
+		enablingMods.push_back(modName);
+		modOrder = modEnableCount ++;
+	}
+
+	std::string modDir = workingDir + "Mods/" + modName + "/";
+	std::vector<FileSource*> modSources = createOverlaySources(FILE_SOURCE_LAYER_MOD, modName, modDir, modOrder);
+
+	std::unique_lock<std::mutex> lock(fileIndex_mutex);
+
+	enablingMods.erase(std::find(enablingMods.begin(), enablingMods.end(), modName));
+
+	if (modSources.size() == 0)
+	{
+		printf("%s Failed to enable mod: %s, %s doesn't exist or is empty\n", ERR_PREFIX, modName.c_str(), modDir.c_str());
+
+		return false;
+	}
+
+	enabledMods.push_back(modName);
+
+	// Only the mod's own files need to be checked, everything else already points at the right source
+	for (size_t i = 0; i < modSources.size(); i ++)
+	{
+		fileSources.push_back(modSources[i]);
+		addSourceToIndex(modSources[i]);
+	}
+
+	printf("%s Enabled mod: %s\n", INFO_PREFIX, modName.c_str());
+
+	return true;
+}
+
+void FileLoader::disableMod(const std::string &modName)
+{
+	std::unique_lock<std::mutex> lock(fileIndex_mutex);
+
+	auto modIt = std::find(enabledMods.begin(), enabledMods.end(), modName);
+
+	if (modIt == enabledMods.end())
+		return;
+
+	enabledMods.erase(modIt);
+
+	std::vector<FileSource*> modSources;
+
+	for (size_t i = 0; i < fileSources.size(); i ++)
+	{
+		if (fileSources[i]->layer == FILE_SOURCE_LAYER_MOD && fileSources[i]->name == modName)
+		{
+			modSources.push_back(fileSources[i]);
+
+			fileSources.erase(fileSources.begin() + i);
+			i --;
+		}
+	}
+
+	for (size_t i = 0; i < modSources.size(); i ++)
+	{
+		removeSourceFromIndex(modSources[i]);
+
+		delete modSources[i]->archive;
+		delete modSources[i];
+	}
+
+	printf("%s Disabled mod: %s\n", INFO_PREFIX, modName.c_str());
+}
+
+std::vector<std::string> FileLoader::getEnabledMods()
+{
+	std::unique_lock<std::mutex> lock(fileIndex_mutex);
+
+	return enabledMods;
+}
+
+bool FileLoader::mountArchive(const std::string &archiveFile)
+{
+	FileArchive *archive = new FileArchive();
+
+	if (!archive->open(workingDir + archiveFile))
+	{
+		delete archive;
+
+		return false;
+	}
+
+	std::vector<std::string> files = archive->getFileList();
+
+	FileSource *source = new FileSource();
+	source->layer = FILE_SOURCE_LAYER_MAIN_ARCHIVE;
+	source->archive = archive;
+	source->files.insert(files.begin(), files.end());
+
+	std::unique_lock<std::mutex> lock(fileIndex_mutex);
+
+	// Main archives are searched in the order they were mounted, so earlier ones get a higher priority
+	source->priority = getSourcePriority(FILE_SOURCE_LAYER_MAIN_ARCHIVE, 0, 0xFFFF - std::min<uint32_t>(mainArchiveCount, 0xFFFF));
+	mainArchiveCount ++;
+
+	fileSources.push_back(source);
+	addSourceToIndex(source);
+
+	printf("%s Mounted archive: %s\n", INFO_PREFIX, archiveFile.c_str());
+
+	return true;
+}
+
+uint32_t FileLoader::mountArchiveDirectory(const std::string &dir)
+{
+	std::vector<std::string> files = getDirectoryFileList(workingDir + dir, false);
+	std::sort(files.begin(), files.end());
+
+	std::string archiveExt = FILE_ARCHIVE_EXTENSION;
+	uint32_t mountedCount = 0;
+
+	for (size_t i = 0; i < files.size(); i ++)
+	{
+		if (files[i].length() > archiveExt.length() && files[i].compare(files[i].length() - archiveExt.length(), archiveExt.length(), archiveExt) == 0)
+		{
+			if (mountArchive(dir + files[i]))
+				mountedCount ++;
+		}
+	}
+
+	return mountedCount;
+}
+
+std::vector<std::string> FileLoader::getDirectoryFileList(const std::string &absoluteDir, bool recursive)
+{
+	std::vector<std::string> fileList;
+	std::vector<std::string> dirStack = {""};
+
+	while (dirStack.size() > 0)
+	{
+		std::string subDir = dirStack.back();
+		dirStack.pop_back();
+
+#ifdef _WIN32
+		WIN32_FIND_DATAW findData;
+		HANDLE findHandle = FindFirstFileW(utf8_to_utf16(absoluteDir + subDir + "*").c_str(), &findData);
+
+		if (findHandle == INVALID_HANDLE_VALUE)
+			continue;
+
+		do
+		{
+			std::wstring wname = findData.cFileName;
+			std::string name = std::wstring_convert<std::codecvt_utf8_utf16<wchar_t>>().to_bytes(wname);
+
+			if (name == "." || name == "..")
+				continue;
+
+			if (findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+			{
+				if (recursive)
+					dirStack.push_back(subDir + name + "/");
+			}
+			else
+				fileList.push_back(subDir + name);
+		}
+		while (FindNextFileW(findHandle, &findData));
+
+		FindClose(findHandle);
+#else
+		DIR *dir = opendir((absoluteDir + subDir).c_str());
+
+		if (dir == nullptr)
+			continue;
+
+		struct dirent *entry;
+
+		while ((entry = readdir(dir)) != nullptr)
+		{
+			std::string name = entry->d_name;
+
+			if (name == "." || name == "..")
+				continue;
+
+			if (isDirectoryEntry(absoluteDir + subDir, entry))
+			{
+				if (recursive)
+					dirStack.push_back(subDir + name + "/");
+			}
+			else
+				fileList.push_back(subDir + name);
+		}
+
+		closedir(dir);
+#endif
+	}
+
+	return fileList;
+}
+
+std::vector<std::string> FileLoader::getSubdirectoryList(const std::string &absoluteDir)
+{
+	std::vector<std::string> dirList;
+
+#ifdef _WIN32
+	WIN32_FIND_DATAW findData;
+	HANDLE findHandle = FindFirstFileW(utf8_to_utf16(absoluteDir + "*").c_str(), &findData);
+
+	if (findHandle == INVALID_HANDLE_VALUE)
+		return dirList;
+
+	do
+	{
+		std::wstring wname = findData.cFileName;
+		std::string name = std::wstring_convert<std::codecvt_utf8_utf16<wchar_t>>().to_bytes(wname);
+
+		if (name != "." && name != ".." && (findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY))
+			dirList.push_back(name);
+	}
+	while (FindNextFileW(findHandle, &findData));
+
+	FindClose(findHandle);
+#else
+	DIR *dir = opendir(absoluteDir.c_str());
+
+	if (dir == nullptr)
+		return dirList;
+
+	struct dirent *entry;
+
+	while ((entry = readdir(dir)) != nullptr)
+	{
+		std::string name = entry->d_name;
+
+		if (name != "." && name != ".." && isDirectoryEntry(absoluteDir, entry))
+			dirList.push_back(name);
+	}
+
+	closedir(dir);
+#endif
+
+	return dirList;
+}
+
+std::vector<FileSource*> FileLoader::createOverlaySources(FileSourceLayer layer, const std::string &name, const std::string &rootDir, uint32_t order)
+{
+	std::vector<FileSource*> sources;
+	std::vector<std::string> files = getDirectoryFileList(rootDir, true);
+	std::sort(files.begin(), files.end());
+
+	std::string archiveExt = FILE_ARCHIVE_EXTENSION;
+
+	FileSource *dirSource = new FileSource();
+	dirSource->layer = layer;
+	dirSource->name = name;
+	dirSource->rootDir = rootDir;
+	dirSource->archive = nullptr;
+	dirSource->priority = getSourcePriority(layer, order, 0xFFFF);
+
+	std::vector<FileSource*> archiveSources;
+
+	for (size_t i = 0; i < files.size(); i ++)
+	{
+		bool isArchive = files[i].find('/') == std::string::npos && files[i].length() > archiveExt.length() && files[i].compare(files[i].length() - archiveExt.length(), archiveExt.length(), archiveExt) == 0;
+
+		// Archives in the root of an overlay belong to the overlay, and come after it's loose files
+		if (isArchive)
+		{
+			FileArchive *archive = new FileArchive();
+
+			if (!archive->open(rootDir + files[i]))
+			{
+				delete archive;
+
+				continue;
+			}
+
+			std::vector<std::string> archiveFiles = archive->getFileList();
+
+			FileSource *archiveSource = new FileSource();
+			archiveSource->layer = layer;
+			archiveSource->name = name;
+			archiveSource->archive = archive;
+			archiveSource->priority = getSourcePriority(layer, order, 0xFFFE - std::min<uint32_t>((uint32_t) archiveSources.size(), 0xFFFE));
+			archiveSource->files.insert(archiveFiles.begin(), archiveFiles.end());
+
+			archiveSources.push_back(archiveSource);
+		}
+		else
+			dirSource->files.insert(files[i]);
+	}
+
+	if (dirSource->files.size() > 0)
+		sources.push_back(dirSource);
+	else
+		delete dirSource;
+
+	sources.insert(sources.end(), archiveSources.begin(), archiveSources.end());
+
+	return sources;
+}
+
+bool FileLoader::resolveFile(const std::string &filename, std::string &absoluteFile, const char *&archiveData, size_t &archiveSize)
+{
+	std::string path = normalizePath(filename);
+
+	{
+		std::unique_lock<std::mutex> lock(fileIndex_mutex);
+
+		auto it = fileIndex.find(path);
+
+		if (it != fileIndex.end())
+		{
+			if (it->second.source->archive != nullptr)
+			{
+				archiveData = it->second.archiveData;
+				archiveSize = it->second.archiveSize;
+
+				return true;
+			}
+
+			absoluteFile = it->second.source->rootDir + path;
+
+			return false;
+		}
+	}
+
+	// Not indexed, so the only place it could be is somewhere in the working directory that wasn't scanned
+	absoluteFile = workingDir + filename;
+
+	return false;
+}
+
+void FileLoader::addSourceToIndex(FileSource *source)
+{
+	for (auto fileIt = source->files.begin(); fileIt != source->files.end(); fileIt ++)
+	{
+		auto it = fileIndex.find(*fileIt);
+
+		if (it != fileIndex.end() && it->second.source->priority > source->priority)
+			continue;
+
+		FileIndexEntry entry = {};
+		entry.source = source;
+
+		if (source->archive != nullptr)
+			source->archive->findFile(*fileIt, entry.archiveData, entry.archiveSize);
+
+		fileIndex[*fileIt] = entry;
+	}
+}
+
+void FileLoader::removeSourceFromIndex(FileSource *source)
+{
+	for (auto fileIt = source->files.begin(); fileIt != source->files.end(); fileIt ++)
+	{
+		auto it = fileIndex.find(*fileIt);
+
+		if (it == fileIndex.end() || it->second.source != source)
+			continue;
+
+		// Fall back to the next highest priority source that has this file, if there is one
+		FileSource *nextSource = nullptr;
+
+		for (size_t i = 0; i < fileSources.size(); i ++)
+			if (fileSources[i] != source && (nextSource == nullptr || fileSources[i]->priority > nextSource->priority) && fileSources[i]->files.count(*fileIt) > 0)
+				nextSource = fileSources[i];
+
+		if (nextSource == nullptr)
+		{
+			fileIndex.erase(it);
+
+			continue;
+		}
+
+		FileIndexEntry entry = {};
+		entry.source = nextSource;
+
+		if (nextSource->archive != nullptr)
+			nextSource->archive->findFile(*fileIt, entry.archiveData, entry.archiveSize);
+
+		it->second = entry;
+	}
+}
+
+uint64_t FileLoader::getSourcePriority(FileSourceLayer layer, uint32_t order, uint32_t subOrder)
+{
+	return (uint64_t(layer) << 48) | (uint64_t(order) << 16) | uint64_t(subOrder & 0xFFFF);
+}
+
+std::string FileLoader::normalizePath(const std::string &path)
+{
+	std::string normalizedPath = path;
+	std::replace(normalizedPath.begin(), normalizedPath.end(), '\\', '/');
+
+	return normalizedPath;
+}
+
 void FileLoader::setWorkingDir(const std::string &dir)
 {
 	workingDir = dir;
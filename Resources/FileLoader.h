@@ -33,6 +33,45 @@
 #include <string>
 #include <vector>
 #include <fstream>
+#include <cstdint>
+#include <unordered_map>
+#include <unordered_set>
+#include <mutex>
+
+class FileArchive;
+class FileView;
+
+typedef enum FileSourceLayer
+{
+	FILE_SOURCE_LAYER_MAIN_ARCHIVE = 0,
+	FILE_SOURCE_LAYER_WORKING_DIR = 1,
+	FILE_SOURCE_LAYER_PATCH = 2,
+	FILE_SOURCE_LAYER_MOD = 3
+} FileSourceLayer;
+
+/*
+A single place files can come from, either a loose directory or a mounted archive. Sources w/ a higher priority override files
+in sources w/ a lower priority.
+*/
+typedef struct
+{
+	FileSourceLayer layer;
+	std::string name;    // The mod/patch name, empty for the main game
+	std::string rootDir; // Absolute w/ a separator on the end, empty for archives
+	FileArchive *archive;
+	uint64_t priority;
+
+	std::unordered_set<std::string> files; // Every file this source provides, w/ forward slashes
+} FileSource;
+
+typedef struct
+{
+	FileSource *source;
+
+	// Only for archive sources, points straight into the archive's mapping
+	const char *archiveData;
+	size_t archiveSize;
+} FileIndexEntry;
 
 /*
 A unified class to load files, mainly helps with choosing the right directory to read the file from. It allows for multiple instances
@@ -42,6 +81,12 @@ Directories are searched in this order:
  - For all patches: in <exec_dir>/GameData/Patches/<patch_name>/.., and then in the patch's archive files
  - In <exec_dir>/..
  - In the main game's loaded archive files
+
+Rather than actually searching each of these per file, every source is scanned once when it's mounted into a hash table of
+path -> source that always holds the highest priority source for each file, so resolving a file is a single lookup no matter how
+many mods or patches are mounted. Mods enabled later take priority over earlier ones, patches later in name order take priority over
+earlier ones, and main archives are searched in the order they were mounted. Only files in <exec_dir>/GameData/.. are indexed from
+the working directory, anything else (or anything created after it was indexed) costs one extra open() of <exec_dir>/.. on a miss.
 */
 class FileLoader
 {
@@ -70,8 +115,69 @@ class FileLoader
 	*/
 	std::vector<char> readFileAbsoluteDirectoryBuffer(const std::string &filename);
 
+	/*
+	Opens a stream to a file. Searches directories as described in the class description, except archives, which can't be streamed.
+	*/
 	std::ifstream openFileStream(const std::string &filename);
 
+	/*
+	Maps a file into memory and returns a view of its contents w/o copying it. Searches directories as described in the class description.
+	The view unmaps the file when it's destroyed, files in an archive stay valid as long as the archive is mounted. Prefer this over
+	readFileBuffer() for anything that's only parsed once, e.g. textures, shaders, & meshes.
+	*/
+	FileView openFileView(const std::string &filename);
+
+	/*
+	Maps a file into memory and returns a view of its contents. This doesn't search any local directories and treats <filename> as having a full directory attached to it.
+	*/
+	FileView openFileViewAbsoluteDirectory(const std::string &filename);
+
+	/*
+	Checks whether a file exists w/o printing an error if it doesn't. Searches directories as described in the class description.
+	*/
+	bool fileExists(const std::string &filename);
+
+	/*
+	Returns the size of a file in bytes w/o opening it, or 0 if it doesn't exist. Searches directories as described in the class description.
+	*/
+	size_t getFileSize(const std::string &filename);
+
+	/*
+	Builds the file index from scratch, scanning the working directory, every patch in <exec_dir>/GameData/Patches/, and the main
+	game's mounted archives. Call this once at startup after setting the working directory & mounting the main archives.
+	*/
+	void buildFileIndex();
+
+	/*
+	Enables the mod in <exec_dir>/Mods/<modName>/, w/ priority over every mod enabled before it. Only the mod's own files are scanned
+	and added to the index. Returns false if the mod doesn't exist or is already enabled.
+	*/
+	bool enableMod(const std::string &modName);
+
+	/*
+	Disables a mod, any files it overrode fall back to the next source that has them. Make sure nothing is still reading from the
+	mod's archives (i.e. no async loads are in flight) before disabling it.
+	*/
+	void disableMod(const std::string &modName);
+
+	std::vector<std::string> getEnabledMods();
+
+	/*
+	Mounts a packed archive (see FileArchive.h) as one of the main game archives. <archiveFile> is relative to the working directory.
+	Archives are searched in the order they were mounted, so mount them all at startup before anything gets loaded.
+	*/
+	bool mountArchive(const std::string &archiveFile);
+
+	/*
+	Mounts every archive in a directory (relative to the working directory), sorted by name. Returns the number of archives mounted.
+	*/
+	uint32_t mountArchiveDirectory(const std::string &dir);
+
+	/*
+	Lists all the files in <absoluteDir>, relative to it & w/ forward slashes. Doesn't list directories themselves.
+	*/
+	std::vector<std::string> getDirectoryFileList(const std::string &absoluteDir, bool recursive);
+
 	void setWorkingDir(const std::string &dir);
 	std::string getWorkingDir();
 
@@ -84,6 +190,33 @@ class FileLoader
 
 	// The working/local directory, DOES have a separator on the end of it, e.g "C:\Users\Someone\Documents\"
 	std::string workingDir;
+
+	// Every mounted source, in no particular order, priority is stored in the source itself
+	std::vector<FileSource*> fileSources;
+
+	uint32_t mainArchiveCount;
+	uint32_t modEnableCount;
+	std::vector<std::string> enabledMods;
+	std::vector<std::string> enablingMods; // Mods that enableMod() is still mounting, so they can't be enabled twice at once
+
+	std::unordered_map<std::string, FileIndexEntry> fileIndex;
+	std::mutex fileIndex_mutex; // Controls access of member "fileIndex", "fileSources", & the mod members above
+
+	/*
+	Looks a file up in the index. Returns true if it's in an archive, w/ <archiveData> & <archiveSize> pointing into the archive,
+	otherwise returns false w/ <absoluteFile> set to the loose file that should be opened.
+	*/
+	bool resolveFile(const std::string &filename, std::string &absoluteFile, const char *&archiveData, size_t &archiveSize);
+
+	std::vector<FileSource*> createOverlaySources(FileSourceLayer layer, const std::string &name, const std::string &rootDir, uint32_t order);
+	std::vector<std::string> getSubdirectoryList(const std::string &absoluteDir);
+
+	// These expect fileIndex_mutex to already be locked
+	void addSourceToIndex(FileSource *source);
+	void removeSourceFromIndex(FileSource *source);
+
+	static uint64_t getSourcePriority(FileSourceLayer layer, uint32_t order, uint32_t subOrder);
+	static std::string normalizePath(const std::string &path);
 };
 
 #endif /* RESOURCE_FILELOADER_H_ */
\ No newline at end of file
@@ -0,0 +1,228 @@
+/*
+* MIT License
+*
+* Copyright (c) 2017 David Allen
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+* FileView.cpp
+*/
+
+#include "FileView.h"
+
+#include <common.h>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#endif
+
+FileView::FileView()
+{
+	viewData = nullptr;
+	viewSize = 0;
+	valid = false;
+	ownsMapping = false;
+
+#ifdef _WIN32
+	fileHandle = INVALID_HANDLE_VALUE;
+	fileMappingHandle = nullptr;
+#endif
+}
+
+FileView::FileView(FileView &&other) noexcept : FileView()
+{
+	*this = std::move(other);
+}
+
+FileView::~FileView()
+{
+	release();
+}
+
+FileView &FileView::operator=(FileView &&other) noexcept
+{
+	if (this != &other)
+	{
+		release();
+
+		viewData = other.viewData;
+		viewSize = other.viewSize;
+		valid = other.valid;
+		ownsMapping = other.ownsMapping;
+
+#ifdef _WIN32
+		fileHandle = other.fileHandle;
+		fileMappingHandle = other.fileMappingHandle;
+
+		other.fileHandle = INVALID_HANDLE_VALUE;
+		other.fileMappingHandle = nullptr;
+#endif
+
+		other.viewData = nullptr;
+		other.viewSize = 0;
+		other.valid = false;
+		other.ownsMapping = false;
+	}
+
+	return *this;
+}
+
+FileView FileView::mapFile(const std::string &filename)
+{
+	FileView view;
+
+#ifdef _WIN32
+	HANDLE file = CreateFileW(utf8_to_utf16(filename).c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+	if (file == INVALID_HANDLE_VALUE)
+		return view;
+
+	LARGE_INTEGER fileSize;
+	GetFileSizeEx(file, &fileSize);
+
+	view.fileHandle = file;
+	view.viewSize = (size_t) fileSize.QuadPart;
+	view.ownsMapping = true;
+
+	// Empty files can't be mapped, but they're still valid files
+	if (view.viewSize > 0)
+	{
+		view.fileMappingHandle = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+		if (view.fileMappingHandle != nullptr)
+			view.viewData = (const char*) MapViewOfFile(view.fileMappingHandle, FILE_MAP_READ, 0, 0, 0);
+
+		if (view.viewData == nullptr)
+		{
+			view.release();
+
+			return view;
+		}
+	}
+#else
+	int fd = open(filename.c_str(), O_RDONLY);
+
+	if (fd == -1)
+		return view;
+
+	struct stat fileStat;
+
+	if (fstat(fd, &fileStat) == -1)
+	{
+		close(fd);
+
+		return view;
+	}
+
+	view.viewSize = (size_t) fileStat.st_size;
+	view.ownsMapping = true;
+
+	// Empty files can't be mapped, but they're still valid files
+	if (view.viewSize > 0)
+	{
+		void *mapping = mmap(nullptr, view.viewSize, PROT_READ, MAP_PRIVATE, fd, 0);
+
+		if (mapping == MAP_FAILED)
+		{
+			close(fd);
+			view.viewSize = 0;
+			view.ownsMapping = false;
+
+			return view;
+		}
+
+		view.viewData = (const char*) mapping;
+	}
+
+	// The mapping keeps it's own reference to the file, so we don't need the descriptor anymore
+	close(fd);
+#endif
+
+	view.valid = true;
+
+	return view;
+}
+
+FileView FileView::fromMemory(const char *data, size_t size)
+{
+	FileView view;
+	view.viewData = data;
+	view.viewSize = size;
+	view.valid = true;
+	view.ownsMapping = false;
+
+	return view;
+}
+
+const char *FileView::data() const
+{
+	return viewData;
+}
+
+size_t FileView::size() const
+{
+	return viewSize;
+}
+
+const char *FileView::begin() const
+{
+	return viewData;
+}
+
+const char *FileView::end() const
+{
+	return viewData + viewSize;
+}
+
+bool FileView::isValid() const
+{
+	return valid;
+}
+
+void FileView::release()
+{
+	if (ownsMapping)
+	{
+#ifdef _WIN32
+		if (viewData != nullptr)
+			UnmapViewOfFile(viewData);
+
+		if (fileMappingHandle != nullptr)
+			CloseHandle(fileMappingHandle);
+
+		if (fileHandle != INVALID_HANDLE_VALUE)
+			CloseHandle(fileHandle);
+#else
+		if (viewData != nullptr)
+			munmap((void*) viewData, viewSize);
+#endif
+	}
+
+#ifdef _WIN32
+	fileHandle = INVALID_HANDLE_VALUE;
+	fileMappingHandle = nullptr;
+#endif
+
+	viewData = nullptr;
+	viewSize = 0;
+	valid = false;
+	ownsMapping = false;
+}
@@ -0,0 +1,88 @@
+/*
+* MIT License
+*
+* Copyright (c) 2017 David Allen
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+* FileView.h
+*/
+
+#ifndef RESOURCE_FILEVIEW_H_
+#define RESOURCE_FILEVIEW_H_
+
+#include <string>
+#include <cstddef>
+
+/*
+A read-only view of a file's contents, w/o copying it into memory. A view either owns a memory mapping of a loose file, which is
+unmapped when the view is destroyed, or points into the mapping of a mounted archive, which stays valid as long as the archive is
+mounted. Views can be moved but not copied, so there's always exactly one owner of a mapping.
+*/
+class FileView
+{
+	public:
+
+	FileView();
+	FileView(FileView &&other) noexcept;
+	virtual ~FileView();
+
+	FileView &operator=(FileView &&other) noexcept;
+
+	FileView(const FileView &other) = delete;
+	FileView &operator=(const FileView &other) = delete;
+
+	/*
+	Maps a whole file into memory. <filename> is treated as having a full directory attached to it. Returns an invalid view if the
+	file couldn't be opened or mapped.
+	*/
+	static FileView mapFile(const std::string &filename);
+
+	/*
+	Creates a view that doesn't own it's data, e.g. a file inside of an archive's mapping.
+	*/
+	static FileView fromMemory(const char *data, size_t size);
+
+	const char *data() const;
+	size_t size() const;
+
+	const char *begin() const;
+	const char *end() const;
+
+	/*
+	Whether or not the view actually refers to a file, note that an empty file still gives a valid view.
+	*/
+	bool isValid() const;
+
+	private:
+
+	const char *viewData;
+	size_t viewSize;
+	bool valid;
+	bool ownsMapping;
+
+#ifdef _WIN32
+	void *fileHandle; // HANDLE, kept as a void* so windows.h isn't needed here
+	void *fileMappingHandle;
+#endif
+
+	void release();
+};
+
+#endif /* RESOURCE_FILEVIEW_H_ */
@@ -0,0 +1,461 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2017 David Allen
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * MeshOptimizer.cpp
+ */
+
+#include "Resources/MeshOptimizer.h"
+
+// The cache size & weights used to score vertices in optimizeVertexCache(), these are the values from Forsyth's paper
+#define FORSYTH_CACHE_SIZE 32
+
+const float FORSYTH_CACHE_DECAY_POWER = 1.5f;
+const float FORSYTH_LAST_TRIANGLE_SCORE = 0.75f;
+const float FORSYTH_VALENCE_BOOST_SCALE = 2.0f;
+const float FORSYTH_VALENCE_BOOST_POWER = 0.5f;
+
+/*
+ * Scores a vertex based on where it is in the cache and how many triangles still need it. Vertices used by the
+ * last triangle get a fixed score so the next triangle doesn't just keep reusing the same edge, and vertices with
+ * few triangles left get a boost so they're finished off and don't leave lone triangles behind.
+ */
+inline float getForsythVertexScore (int32_t cachePosition, uint32_t remainingValence)
+{
+	if (remainingValence == 0)
+		return -1.0f;
+
+	float score = 0.0f;
+
+	if (cachePosition >= 0)
+	{
+		if (cachePosition < 3)
+			score = FORSYTH_LAST_TRIANGLE_SCORE;
+		else
+			score = powf(1.0f - float(cachePosition - 3) / float(FORSYTH_CACHE_SIZE - 3), FORSYTH_CACHE_DECAY_POWER);
+	}
+
+	score += FORSYTH_VALENCE_BOOST_SCALE * powf(float(remainingValence), -FORSYTH_VALENCE_BOOST_POWER);
+
+	return score;
+}
+
+/*
+ * Reorders an attribute array, "remap" maps old vertex indices to new ones, and any vertex mapped
+ * to UINT32_MAX is dropped. Empty attributes (the mesh doesn't have them) are left alone.
+ */
+template<typename T>
+inline void remapVertexAttribute (std::vector<T> &attribute, const std::vector<uint32_t> &remap, uint32_t newVertexCount)
+{
+	if (attribute.size() == 0)
+		return;
+
+	std::vector<T> remappedAttribute(newVertexCount);
+
+	for (size_t v = 0; v < remap.size() && v < attribute.size(); v ++)
+	{
+		if (remap[v] != UINT32_MAX)
+			remappedAttribute[remap[v]] = attribute[v];
+	}
+
+	attribute.swap(remappedAttribute);
+}
+
+MeshOptimizerStats MeshOptimizer::optimizeMesh (ResourceMeshData &meshData, bool reorderForOverdraw)
+{
+	MeshOptimizerStats stats = {};
+
+	std::vector<uint32_t> indices;
+
+	if (meshData.uses32BitIndices)
+		indices = meshData.indices_32bit;
+	else
+		indices.assign(meshData.indices_16bit.begin(), meshData.indices_16bit.end());
+
+	// Unindexed meshes don't have anything we can reorder
+	if (indices.size() < 3)
+		return stats;
+
+	analyzeVertexCache(indices, meshData.vertices.size(), stats.acmrBefore, stats.atvrBefore);
+
+	indices = optimizeVertexCache(indices, meshData.vertices.size());
+
+	if (reorderForOverdraw)
+	{
+		std::vector<uint32_t> overdrawIndices = optimizeOverdraw(indices, meshData.vertices, MESH_OPTIMIZER_OVERDRAW_THRESHOLD);
+
+		stats.overdrawOrderUsed = overdrawIndices != indices;
+		indices.swap(overdrawIndices);
+	}
+
+	optimizeVertexFetch(meshData, indices);
+
+	analyzeVertexCache(indices, meshData.vertices.size(), stats.acmrAfter, stats.atvrAfter);
+
+	// The vertex fetch pass can drop unused vertices, so the mesh might fit in 16-bit indices now
+	meshData.uses32BitIndices = meshData.vertices.size() > 65535;
+	meshData.faceCount = (uint32_t) (indices.size() / 3);
+	meshData.indices_16bit.clear();
+	meshData.indices_32bit.clear();
+
+	if (meshData.uses32BitIndices)
+		meshData.indices_32bit.swap(indices);
+	else
+		meshData.indices_16bit.assign(indices.begin(), indices.end());
+
+	return stats;
+}
+
+/*
+ * Forsyth's "Linear-Speed Vertex Cache Optimisation". Greedily picks the next triangle with the highest score,
+ * where a triangle's score is the sum of its vertices' scores, and only triangles touching the (simulated) cache
+ * get their scores updated after each pick, so it runs in about O(triangles * cache size).
+ */
+std::vector<uint32_t> MeshOptimizer::optimizeVertexCache (const std::vector<uint32_t> &indices, size_t vertexCount)
+{
+	const size_t triangleCount = indices.size() / 3;
+
+	std::vector<uint32_t> optimizedIndices;
+	optimizedIndices.reserve(triangleCount * 3);
+
+	if (triangleCount == 0)
+		return optimizedIndices;
+
+	// Build the list of triangles each vertex is used by
+	std::vector<uint32_t> vertexValence(vertexCount, 0);
+	std::vector<uint32_t> vertexTriangleOffsets(vertexCount + 1, 0);
+	std::vector<uint32_t> vertexTriangles(triangleCount * 3);
+
+	for (size_t i = 0; i < triangleCount * 3; i ++)
+		vertexValence[indices[i]] ++;
+
+	for (size_t v = 0; v < vertexCount; v ++)
+		vertexTriangleOffsets[v + 1] = vertexTriangleOffsets[v] + vertexValence[v];
+
+	std::vector<uint32_t> vertexTriangleFill(vertexTriangleOffsets.begin(), vertexTriangleOffsets.end() - 1);
+
+	for (size_t i = 0; i < triangleCount * 3; i ++)
+		vertexTriangles[vertexTriangleFill[indices[i]] ++] = (uint32_t) (i / 3);
+
+	std::vector<int32_t> vertexCachePosition(vertexCount, -1);
+	std::vector<float> vertexScore(vertexCount);
+	std::vector<float> triangleScore(triangleCount, 0.0f);
+	std::vector<bool> triangleEmitted(triangleCount, false);
+
+	for (size_t v = 0; v < vertexCount; v ++)
+		vertexScore[v] = getForsythVertexScore(-1, vertexValence[v]);
+
+	size_t bestTriangle = 0;
+
+	for (size_t t = 0; t < triangleCount; t ++)
+	{
+		triangleScore[t] = vertexScore[indices[t * 3 + 0]] + vertexScore[indices[t * 3 + 1]] + vertexScore[indices[t * 3 + 2]];
+
+		if (triangleScore[t] > triangleScore[bestTriangle])
+			bestTriangle = t;
+	}
+
+	std::vector<uint32_t> cache, newCache;
+	cache.reserve(FORSYTH_CACHE_SIZE + 3);
+	newCache.reserve(FORSYTH_CACHE_SIZE + 3);
+
+	size_t searchCursor = 0;
+
+	for (size_t emitted = 0; emitted < triangleCount; emitted ++)
+	{
+		// Nothing in the cache touches a triangle that's left, so just start over at the next one that hasn't been drawn
+		if (bestTriangle == SIZE_MAX)
+		{
+			while (triangleEmitted[searchCursor])
+				searchCursor ++;
+
+			bestTriangle = searchCursor;
+		}
+
+		const uint32_t *triangle = &indices[bestTriangle * 3];
+
+		optimizedIndices.insert(optimizedIndices.end(), triangle, triangle + 3);
+		triangleEmitted[bestTriangle] = true;
+
+		// Take the triangle out of each of its vertices' lists of remaining triangles
+		for (uint32_t k = 0; k < 3; k ++)
+		{
+			uint32_t vertex = triangle[k];
+			uint32_t *vertexTriangleList = &vertexTriangles[vertexTriangleOffsets[vertex]];
+
+			for (uint32_t j = 0; j < vertexValence[vertex]; j ++)
+			{
+				if (vertexTriangleList[j] == bestTriangle)
+				{
+					std::swap(vertexTriangleList[j], vertexTriangleList[vertexValence[vertex] - 1]);
+
+					break;
+				}
+			}
+
+			vertexValence[vertex] --;
+		}
+
+		// The triangle's vertices go to the front of the cache, and everything else gets pushed back
+		newCache.clear();
+
+		for (uint32_t k = 0; k < 3; k ++)
+		{
+			if (std::find(newCache.begin(), newCache.end(), triangle[k]) == newCache.end())
+				newCache.push_back(triangle[k]);
+		}
+
+		for (size_t c = 0; c < cache.size(); c ++)
+		{
+			if (std::find(newCache.begin(), newCache.end(), cache[c]) == newCache.end())
+				newCache.push_back(cache[c]);
+		}
+
+		for (size_t c = 0; c < newCache.size(); c ++)
+		{
+			uint32_t vertex = newCache[c];
+
+			vertexCachePosition[vertex] = c < FORSYTH_CACHE_SIZE ? (int32_t) c : -1;
+			vertexScore[vertex] = getForsythVertexScore(vertexCachePosition[vertex], vertexValence[vertex]);
+		}
+
+		// Only triangles using vertices that moved in the cache could have a different score now
+		bestTriangle = SIZE_MAX;
+		float bestTriangleScore = -1.0f;
+
+		for (size_t c = 0; c < newCache.size(); c ++)
+		{
+			uint32_t vertex = newCache[c];
+			const uint32_t *vertexTriangleList = &vertexTriangles[vertexTriangleOffsets[vertex]];
+
+			for (uint32_t j = 0; j < vertexValence[vertex]; j ++)
+			{
+				uint32_t t = vertexTriangleList[j];
+
+				triangleScore[t] = vertexScore[indices[t * 3 + 0]] + vertexScore[indices[t * 3 + 1]] + vertexScore[indices[t * 3 + 2]];
+
+				if (triangleScore[t] > bestTriangleScore)
+				{
+					bestTriangle = t;
+					bestTriangleScore = triangleScore[t];
+				}
+			}
+		}
+
+		if (newCache.size() > FORSYTH_CACHE_SIZE)
+			newCache.resize(FORSYTH_CACHE_SIZE);
+
+		cache.swap(newCache);
+	}
+
+	return optimizedIndices;
+}
+
+/*
+ * A simplified version of Sander et al's "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw". The
+ * (already cache optimized) triangles are split into clusters wherever a triangle misses the cache on all three of its
+ * vertices, since that's where the cache ordering started over anyway. Then the clusters are sorted so the ones facing
+ * away from the center of the mesh get drawn first, which are the ones most likely to occlude the rest of the mesh.
+ * Moving the clusters around costs a bit of cache efficiency, so if the ACMR gets worse than "threshold" times the old one,
+ * the original order is returned.
+ */
+std::vector<uint32_t> MeshOptimizer::optimizeOverdraw (const std::vector<uint32_t> &indices, const std::vector<svec3> &vertices, float threshold)
+{
+	const size_t triangleCount = indices.size() / 3;
+
+	if (triangleCount == 0 || vertices.size() == 0)
+		return indices;
+
+	// Find the cluster boundaries by simulating a FIFO cache
+	std::vector<size_t> clusterStarts;
+	std::vector<uint32_t> cacheTimestamps(vertices.size(), 0);
+	uint32_t timestamp = MESH_OPTIMIZER_ANALYZE_CACHE_SIZE + 1;
+
+	for (size_t t = 0; t < triangleCount; t ++)
+	{
+		uint32_t misses = 0;
+
+		for (uint32_t k = 0; k < 3; k ++)
+		{
+			uint32_t vertex = indices[t * 3 + k];
+
+			if (timestamp - cacheTimestamps[vertex] > MESH_OPTIMIZER_ANALYZE_CACHE_SIZE)
+			{
+				cacheTimestamps[vertex] = timestamp ++;
+				misses ++;
+			}
+		}
+
+		if (t == 0 || misses == 3)
+			clusterStarts.push_back(t);
+	}
+
+	// Nothing to sort if the whole mesh is a single cluster
+	if (clusterStarts.size() < 2)
+		return indices;
+
+	clusterStarts.push_back(triangleCount);
+
+	// Each cluster's area weighted centroid & normal, the normal's length ends up being twice the area
+	std::vector<svec3> clusterCentroids(clusterStarts.size() - 1, {0, 0, 0});
+	std::vector<svec3> clusterNormals(clusterStarts.size() - 1, {0, 0, 0});
+	std::vector<float> clusterAreas(clusterStarts.size() - 1, 0.0f);
+	svec3 meshCentroid = {0, 0, 0};
+	float meshArea = 0.0f;
+
+	for (size_t c = 0; c < clusterStarts.size() - 1; c ++)
+	{
+		for (size_t t = clusterStarts[c]; t < clusterStarts[c + 1]; t ++)
+		{
+			const svec3 &v0 = vertices[indices[t * 3 + 0]];
+			const svec3 &v1 = vertices[indices[t * 3 + 1]];
+			const svec3 &v2 = vertices[indices[t * 3 + 2]];
+
+			svec3 e0 = {v1.x - v0.x, v1.y - v0.y, v1.z - v0.z};
+			svec3 e1 = {v2.x - v0.x, v2.y - v0.y, v2.z - v0.z};
+			svec3 normal = {e0.y * e1.z - e0.z * e1.y, e0.z * e1.x - e0.x * e1.z, e0.x * e1.y - e0.y * e1.x};
+
+			float area = std::sqrt(normal.x * normal.x + normal.y * normal.y + normal.z * normal.z) * 0.5f;
+			svec3 triangleCentroid = {(v0.x + v1.x + v2.x) / 3.0f, (v0.y + v1.y + v2.y) / 3.0f, (v0.z + v1.z + v2.z) / 3.0f};
+
+			clusterCentroids[c].x += triangleCentroid.x * area;
+			clusterCentroids[c].y += triangleCentroid.y * area;
+			clusterCentroids[c].z += triangleCentroid.z * area;
+
+			clusterNormals[c].x += normal.x;
+			clusterNormals[c].y += normal.y;
+			clusterNormals[c].z += normal.z;
+
+			clusterAreas[c] += area;
+		}
+
+		meshCentroid.x += clusterCentroids[c].x;
+		meshCentroid.y += clusterCentroids[c].y;
+		meshCentroid.z += clusterCentroids[c].z;
+		meshArea += clusterAreas[c];
+	}
+
+	if (meshArea > 0.0f)
+	{
+		meshCentroid.x /= meshArea;
+		meshCentroid.y /= meshArea;
+		meshCentroid.z /= meshArea;
+	}
+
+	std::vector<float> clusterSortKeys(clusterStarts.size() - 1, 0.0f);
+	std::vector<uint32_t> clusterOrder(clusterStarts.size() - 1);
+
+	for (size_t c = 0; c < clusterStarts.size() - 1; c ++)
+	{
+		clusterOrder[c] = (uint32_t) c;
+
+		float normalLength = std::sqrt(clusterNormals[c].x * clusterNormals[c].x + clusterNormals[c].y * clusterNormals[c].y + clusterNormals[c].z * clusterNormals[c].z);
+
+		// Degenerate clusters (no area) just keep a key of 0, they don't draw anything anyway
+		if (clusterAreas[c] <= 0.0f || normalLength <= 0.0f)
+			continue;
+
+		svec3 toCluster = {clusterCentroids[c].x / clusterAreas[c] - meshCentroid.x, clusterCentroids[c].y / clusterAreas[c] - meshCentroid.y, clusterCentroids[c].z / clusterAreas[c] - meshCentroid.z};
+
+		clusterSortKeys[c] = (toCluster.x * clusterNormals[c].x + toCluster.y * clusterNormals[c].y + toCluster.z * clusterNormals[c].z) / normalLength;
+	}
+
+	std::stable_sort(clusterOrder.begin(), clusterOrder.end(), [&clusterSortKeys](uint32_t a, uint32_t b) {return clusterSortKeys[a] > clusterSortKeys[b];});
+
+	std::vector<uint32_t> overdrawIndices;
+	overdrawIndices.reserve(triangleCount * 3);
+
+	for (size_t c = 0; c < clusterOrder.size(); c ++)
+		overdrawIndices.insert(overdrawIndices.end(), indices.begin() + clusterStarts[clusterOrder[c]] * 3, indices.begin() + clusterStarts[clusterOrder[c] + 1] * 3);
+
+	float oldACMR, newACMR, atvr;
+	analyzeVertexCache(indices, vertices.size(), oldACMR, atvr);
+	analyzeVertexCache(overdrawIndices, vertices.size(), newACMR, atvr);
+
+	if (newACMR > oldACMR * threshold)
+		return indices;
+
+	return overdrawIndices;
+}
+
+/*
+ * Reorders the vertices into the order the index buffer first uses them, and remaps the indices to match. Vertices
+ * that are never used get dropped. Every attribute in "meshData" gets the same reordering.
+ */
+void MeshOptimizer::optimizeVertexFetch (ResourceMeshData &meshData, std::vector<uint32_t> &indices)
+{
+	std::vector<uint32_t> remap(meshData.vertices.size(), UINT32_MAX);
+	uint32_t newVertexCount = 0;
+
+	for (size_t i = 0; i < indices.size(); i ++)
+	{
+		if (remap[indices[i]] == UINT32_MAX)
+			remap[indices[i]] = newVertexCount ++;
+
+		indices[i] = remap[indices[i]];
+	}
+
+	remapVertexAttribute(meshData.vertices, remap, newVertexCount);
+	remapVertexAttribute(meshData.uvs, remap, newVertexCount);
+	remapVertexAttribute(meshData.normals, remap, newVertexCount);
+	remapVertexAttribute(meshData.tangents, remap, newVertexCount);
+	remapVertexAttribute(meshData.bitangents, remap, newVertexCount);
+	remapVertexAttribute(meshData.boneIDs, remap, newVertexCount);
+	remapVertexAttribute(meshData.boneWeights, remap, newVertexCount);
+}
+
+/*
+ * Simulates a FIFO post-transform cache of MESH_OPTIMIZER_ANALYZE_CACHE_SIZE entries. ACMR is the number of
+ * transformed vertices per triangle, ATVR is the number of transformed vertices per (used) vertex.
+ */
+void MeshOptimizer::analyzeVertexCache (const std::vector<uint32_t> &indices, size_t vertexCount, float &acmr, float &atvr)
+{
+	acmr = atvr = 0.0f;
+
+	if (indices.size() < 3 || vertexCount == 0)
+		return;
+
+	std::vector<uint32_t> cacheTimestamps(vertexCount, 0);
+	std::vector<bool> vertexUsed(vertexCount, false);
+	uint32_t timestamp = MESH_OPTIMIZER_ANALYZE_CACHE_SIZE + 1;
+	size_t transformedVertices = 0, usedVertices = 0;
+
+	for (size_t i = 0; i < indices.size(); i ++)
+	{
+		uint32_t vertex = indices[i];
+
+		if (timestamp - cacheTimestamps[vertex] > MESH_OPTIMIZER_ANALYZE_CACHE_SIZE)
+		{
+			cacheTimestamps[vertex] = timestamp ++;
+			transformedVertices ++;
+		}
+
+		if (!vertexUsed[vertex])
+		{
+			vertexUsed[vertex] = true;
+			usedVertices ++;
+		}
+	}
+
+	acmr = float(transformedVertices) / float(indices.size() / 3);
+	atvr = float(transformedVertices) / float(usedVertices);
+}
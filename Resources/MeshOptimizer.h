@@ -0,0 +1,78 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2017 David Allen
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * MeshOptimizer.h
+ */
+
+#ifndef RESOURCES_MESHOPTIMIZER_H_
+#define RESOURCES_MESHOPTIMIZER_H_
+
+#include <common.h>
+#include <Resources/Resources.h>
+
+/*
+ * The post-transform cache size the ACMR/ATVR numbers are measured with. 16 is roughly what
+ * desktop gpus behave like, and is the number everyone else reports with, so they're comparable.
+ */
+#define MESH_OPTIMIZER_ANALYZE_CACHE_SIZE 16
+
+/*
+ * How much worse (as a ratio) the ACMR is allowed to get when reordering for overdraw before we
+ * throw the overdraw ordering away and just keep the vertex cache ordering.
+ */
+#define MESH_OPTIMIZER_OVERDRAW_THRESHOLD 1.05f
+
+typedef struct MeshOptimizerStats
+{
+		float acmrBefore; // Average cache miss ratio, transformed vertices per triangle (0.5 is ideal, 3.0 is worst)
+		float atvrBefore; // Average transformed vertex ratio, transformed vertices per vertex (1.0 is ideal)
+		float acmrAfter;
+		float atvrAfter;
+		bool overdrawOrderUsed;
+} MeshOptimizerStats;
+
+/*
+ * Reorders a mesh's triangles and vertices so the gpu has less work to do drawing it. There's three
+ * passes, run in this order by optimizeMesh():
+ *
+ *  - Vertex cache: triangles get reordered (Forsyth's algorithm) so vertices are reused while they're still
+ *    in the post-transform cache.
+ *  - Overdraw (optional): the cache ordered triangles are split into clusters, and the clusters get sorted so the
+ *    ones facing outward are drawn first. Only kept if it doesn't hurt the vertex cache too much.
+ *  - Vertex fetch: vertices are reordered by when they're first used so the vertex fetches are mostly linear. Any
+ *    vertices that aren't referenced by the index buffer are dropped here too.
+ */
+class MeshOptimizer
+{
+	public:
+
+		static MeshOptimizerStats optimizeMesh (ResourceMeshData &meshData, bool reorderForOverdraw = true);
+
+		static std::vector<uint32_t> optimizeVertexCache (const std::vector<uint32_t> &indices, size_t vertexCount);
+		static std::vector<uint32_t> optimizeOverdraw (const std::vector<uint32_t> &indices, const std::vector<svec3> &vertices, float threshold);
+		static void optimizeVertexFetch (ResourceMeshData &meshData, std::vector<uint32_t> &indices);
+
+		static void analyzeVertexCache (const std::vector<uint32_t> &indices, size_t vertexCount, float &acmr, float &atvr);
+};
+
+#endif /* RESOURCES_MESHOPTIMIZER_H_ */
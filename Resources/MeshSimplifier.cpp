@@ -0,0 +1,492 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2017 David Allen
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * MeshSimplifier.cpp
+ */
+
+#include "Resources/MeshSimplifier.h"
+
+/*
+ * A symmetric 4x4 matrix, the sum of the (area weighted) squared distances to a set of planes. The total weight of the
+ * planes is kept alongside it, so that dividing by it gives the weighted mean squared distance, which doesn't depend on the
+ * scale or tessellation of the mesh.
+ */
+typedef struct
+{
+		double a2, ab, ac, ad;
+		double b2, bc, bd;
+		double c2, cd;
+		double d2;
+		double weight;
+} MeshQuadric;
+
+inline void addMeshQuadric (MeshQuadric &q, const MeshQuadric &other)
+{
+	q.a2 += other.a2; q.ab += other.ab; q.ac += other.ac; q.ad += other.ad;
+	q.b2 += other.b2; q.bc += other.bc; q.bd += other.bd;
+	q.c2 += other.c2; q.cd += other.cd;
+	q.d2 += other.d2;
+	q.weight += other.weight;
+}
+
+inline void addPlaneToMeshQuadric (MeshQuadric &q, double a, double b, double c, double d, double weight)
+{
+	q.a2 += a * a * weight; q.ab += a * b * weight; q.ac += a * c * weight; q.ad += a * d * weight;
+	q.b2 += b * b * weight; q.bc += b * c * weight; q.bd += b * d * weight;
+	q.c2 += c * c * weight; q.cd += c * d * weight;
+	q.d2 += d * d * weight;
+	q.weight += weight;
+}
+
+inline double evaluateMeshQuadric (const MeshQuadric &q, const svec3 &p)
+{
+	double x = p.x, y = p.y, z = p.z;
+
+	return q.a2 * x * x + 2.0 * q.ab * x * y + 2.0 * q.ac * x * z + 2.0 * q.ad * x
+			+ q.b2 * y * y + 2.0 * q.bc * y * z + 2.0 * q.bd * y
+			+ q.c2 * z * z + 2.0 * q.cd * z
+			+ q.d2;
+}
+
+/*
+ * The distance from a point to the planes of a quadric, i.e. the sqrt of the weighted mean squared distance.
+ */
+inline double getMeshQuadricDistance (const MeshQuadric &q, const svec3 &p)
+{
+	if (q.weight <= 0.0)
+		return 0.0;
+
+	return std::sqrt(std::max(evaluateMeshQuadric(q, p) / q.weight, 0.0));
+}
+
+inline svec3 getTriangleNormal (const svec3 &v0, const svec3 &v1, const svec3 &v2)
+{
+	svec3 e0 = {v1.x - v0.x, v1.y - v0.y, v1.z - v0.z};
+	svec3 e1 = {v2.x - v0.x, v2.y - v0.y, v2.z - v0.z};
+
+	return {e0.y * e1.z - e0.z * e1.y, e0.z * e1.x - e0.x * e1.z, e0.x * e1.y - e0.y * e1.x};
+}
+
+typedef struct
+{
+		double cost; // The distance the surface moves by, see getMeshQuadricDistance()
+		uint32_t fromVertex; // The vertex that gets removed
+		uint32_t toVertex;
+} MeshEdgeCollapse;
+
+/*
+ * Finds the vertex at position "toPosition" that shares a triangle w/ "vertex", returns false if there isn't exactly one. When a
+ * position is collapsed, each of it's vertices is remapped to the one it's connected to, so a collapse along a seam moves both
+ * sides of the seam together. If any of the vertices don't have exactly one then the collapse would tear the seam open.
+ */
+inline bool findCollapseTargetVertex (uint32_t vertex, uint32_t toPosition, const std::vector<uint32_t> &indices, const std::vector<uint32_t> &positionIDs,
+		const std::vector<uint32_t> &vertexTriangleOffsets, const std::vector<uint32_t> &vertexTriangles, uint32_t &outTarget)
+{
+	bool found = false;
+
+	for (uint32_t j = vertexTriangleOffsets[vertex]; j < vertexTriangleOffsets[vertex + 1]; j ++)
+	{
+		const uint32_t *triangle = &indices[vertexTriangles[j] * 3];
+
+		for (uint32_t k = 0; k < 3; k ++)
+		{
+			if (positionIDs[triangle[k]] != toPosition)
+				continue;
+
+			if (found && outTarget != triangle[k])
+				return false;
+
+			outTarget = triangle[k];
+			found = true;
+		}
+	}
+
+	return found;
+}
+
+/*
+ * Simplifies a mesh until it either has "targetTriangleRatio" of it's triangles left, or the next collapse would move the
+ * surface further than "targetError" (a distance, relative to the largest dimension of the mesh's bounds). The returned mesh still has all of
+ * the original vertices, some of which aren't used anymore, so it should be run through MeshOptimizer::optimizeMesh()
+ * afterwards to compact it. The error of the result, relative to the mesh's bounds, is written to "resultError".
+ *
+ * Collapses are done in passes: every edge's cost is computed & sorted, and then the cheapest ones are collapsed as
+ * long as they don't touch anything else collapsed in the same pass (so the costs & flip checks stay valid).
+ */
+ResourceMeshData MeshSimplifier::simplifyMesh (const ResourceMeshData &meshData, float targetTriangleRatio, float targetError, float *resultError)
+{
+	ResourceMeshData simplifiedData = meshData;
+
+	if (resultError != nullptr)
+		*resultError = 0.0f;
+
+	std::vector<uint32_t> indices;
+
+	if (meshData.uses32BitIndices)
+		indices = meshData.indices_32bit;
+	else
+		indices.assign(meshData.indices_16bit.begin(), meshData.indices_16bit.end());
+
+	const std::vector<svec3> &vertices = meshData.vertices;
+	const uint32_t vertexCount = (uint32_t) vertices.size();
+	const size_t targetIndexCount = std::max<size_t>(1, size_t(double(indices.size() / 3) * double(targetTriangleRatio))) * 3;
+
+	if (indices.size() <= targetIndexCount || vertexCount == 0)
+		return simplifiedData;
+
+	svec3 boundsMin = vertices[0], boundsMax = vertices[0];
+
+	for (uint32_t v = 1; v < vertexCount; v ++)
+	{
+		boundsMin = {std::min(boundsMin.x, vertices[v].x), std::min(boundsMin.y, vertices[v].y), std::min(boundsMin.z, vertices[v].z)};
+		boundsMax = {std::max(boundsMax.x, vertices[v].x), std::max(boundsMax.y, vertices[v].y), std::max(boundsMax.z, vertices[v].z)};
+	}
+
+	const double meshExtent = std::max(std::max(boundsMax.x - boundsMin.x, boundsMax.y - boundsMin.y), std::max(boundsMax.z - boundsMin.z, 1e-6f));
+	const double errorLimit = double(targetError) * meshExtent;
+
+	// Weld the vertices by position, so we can find seams (several vertices w/ the same position) and borders
+	std::vector<uint32_t> positionIDs(vertexCount);
+	std::vector<uint32_t> sortedVertices(vertexCount);
+	uint32_t positionCount = 0;
+
+	for (uint32_t v = 0; v < vertexCount; v ++)
+		sortedVertices[v] = v;
+
+	std::sort(sortedVertices.begin(), sortedVertices.end(), [&vertices](uint32_t a, uint32_t b) {
+		return std::make_tuple(vertices[a].x, vertices[a].y, vertices[a].z) < std::make_tuple(vertices[b].x, vertices[b].y, vertices[b].z);
+	});
+
+	// The vertices at each position are sortedVertices[positionVertexOffsets[p]] up to sortedVertices[positionVertexOffsets[p + 1]]
+	std::vector<uint32_t> positionVertexOffsets;
+
+	for (uint32_t i = 0; i < vertexCount; i ++)
+	{
+		const svec3 &p = vertices[sortedVertices[i]];
+
+		if (i == 0 || !(p.x == vertices[sortedVertices[i - 1]].x && p.y == vertices[sortedVertices[i - 1]].y && p.z == vertices[sortedVertices[i - 1]].z))
+		{
+			positionCount ++;
+			positionVertexOffsets.push_back(i);
+		}
+
+		positionIDs[sortedVertices[i]] = positionCount - 1;
+	}
+
+	positionVertexOffsets.push_back(vertexCount);
+
+	/*
+	 * Any edge that only belongs to one triangle is on the border, and it's vertices are locked. Edges where the triangles on either
+	 * side use different vertices are on a seam, those can still be collapsed along (see findCollapseTargetVertex()), but they get
+	 * an extra plane through the edge so that the seam keeps it's shape, the same as the border would if it weren't locked.
+	 */
+	typedef struct
+	{
+			uint64_t positionEdge;
+			uint64_t vertexEdge;
+			uint32_t triangle;
+	} MeshSimplifierEdge;
+
+	std::vector<MeshSimplifierEdge> edges;
+	edges.reserve(indices.size());
+
+	for (size_t i = 0; i < indices.size(); i += 3)
+	{
+		for (uint32_t k = 0; k < 3; k ++)
+		{
+			uint32_t va = indices[i + k], vb = indices[i + (k + 1) % 3];
+			uint32_t a = positionIDs[va], b = positionIDs[vb];
+
+			if (a != b)
+				edges.push_back({(uint64_t(std::min(a, b)) << 32) | uint64_t(std::max(a, b)), a < b ? (uint64_t(va) << 32) | vb : (uint64_t(vb) << 32) | va, uint32_t(i / 3)});
+		}
+	}
+
+	std::sort(edges.begin(), edges.end(), [](const MeshSimplifierEdge &a, const MeshSimplifierEdge &b) {return a.positionEdge < b.positionEdge;});
+
+	std::vector<bool> positionLocked(positionCount, false);
+	std::vector<MeshSimplifierEdge> seamEdges;
+
+	for (size_t e = 0; e < edges.size();)
+	{
+		size_t edgeEnd = e + 1;
+		bool seamEdge = false;
+
+		while (edgeEnd < edges.size() && edges[edgeEnd].positionEdge == edges[e].positionEdge)
+		{
+			seamEdge = seamEdge || edges[edgeEnd].vertexEdge != edges[e].vertexEdge;
+			edgeEnd ++;
+		}
+
+		if (edgeEnd - e == 1)
+		{
+			positionLocked[uint32_t(edges[e].positionEdge >> 32)] = true;
+			positionLocked[uint32_t(edges[e].positionEdge & 0xFFFFFFFF)] = true;
+		}
+		else if (seamEdge)
+			seamEdges.insert(seamEdges.end(), edges.begin() + e, edges.begin() + edgeEnd);
+
+		e = edgeEnd;
+	}
+
+	std::vector<bool> vertexLocked(vertexCount);
+
+	for (uint32_t v = 0; v < vertexCount; v ++)
+		vertexLocked[v] = positionLocked[positionIDs[v]];
+
+	// The quadrics are per position, so both sides of a seam contribute to it
+	std::vector<MeshQuadric> positionQuadrics(positionCount, MeshQuadric());
+
+	for (size_t i = 0; i < indices.size(); i += 3)
+	{
+		const svec3 &v0 = vertices[indices[i + 0]];
+		svec3 normal = getTriangleNormal(v0, vertices[indices[i + 1]], vertices[indices[i + 2]]);
+		double normalLength = std::sqrt(double(normal.x) * normal.x + double(normal.y) * normal.y + double(normal.z) * normal.z);
+
+		if (normalLength <= 0.0)
+			continue;
+
+		double a = normal.x / normalLength, b = normal.y / normalLength, c = normal.z / normalLength;
+		double d = -(a * v0.x + b * v0.y + c * v0.z);
+
+		for (uint32_t k = 0; k < 3; k ++)
+			addPlaneToMeshQuadric(positionQuadrics[positionIDs[indices[i + k]]], a, b, c, d, normalLength * 0.5);
+	}
+
+	// The seam planes are perpendicular to the triangle & go through the seam edge, weighted by the edge's length squared
+	for (size_t e = 0; e < seamEdges.size(); e ++)
+	{
+		uint32_t pa = uint32_t(seamEdges[e].positionEdge >> 32), pb = uint32_t(seamEdges[e].positionEdge & 0xFFFFFFFF);
+		const svec3 &ea = vertices[uint32_t(seamEdges[e].vertexEdge >> 32)], &eb = vertices[uint32_t(seamEdges[e].vertexEdge & 0xFFFFFFFF)];
+		const uint32_t *triangle = &indices[seamEdges[e].triangle * 3];
+
+		svec3 normal = getTriangleNormal(vertices[triangle[0]], vertices[triangle[1]], vertices[triangle[2]]);
+		svec3 edge = {eb.x - ea.x, eb.y - ea.y, eb.z - ea.z};
+		svec3 planeNormal = getTriangleNormal({0, 0, 0}, edge, normal);
+
+		double edgeLength2 = double(edge.x) * edge.x + double(edge.y) * edge.y + double(edge.z) * edge.z;
+		double planeNormalLength = std::sqrt(double(planeNormal.x) * planeNormal.x + double(planeNormal.y) * planeNormal.y + double(planeNormal.z) * planeNormal.z);
+
+		if (planeNormalLength <= 0.0)
+			continue;
+
+		double a = planeNormal.x / planeNormalLength, b = planeNormal.y / planeNormalLength, c = planeNormal.z / planeNormalLength;
+		double d = -(a * ea.x + b * ea.y + c * ea.z);
+
+		addPlaneToMeshQuadric(positionQuadrics[pa], a, b, c, d, edgeLength2);
+		addPlaneToMeshQuadric(positionQuadrics[pb], a, b, c, d, edgeLength2);
+	}
+
+	double maxCollapseError = 0.0;
+
+	std::vector<uint32_t> vertexTriangleOffsets(vertexCount + 1), vertexTriangles, vertexTriangleFill;
+	std::vector<MeshEdgeCollapse> collapses;
+	std::vector<uint32_t> vertexRemap(vertexCount);
+	std::vector<bool> vertexCollapseLocked(vertexCount);
+	std::vector<std::pair<uint32_t, uint32_t> > collapseRemaps;
+
+	while (indices.size() > targetIndexCount)
+	{
+		// Build the list of triangles each vertex is used by
+		std::fill(vertexTriangleOffsets.begin(), vertexTriangleOffsets.end(), 0);
+
+		for (size_t i = 0; i < indices.size(); i ++)
+			vertexTriangleOffsets[indices[i] + 1] ++;
+
+		for (uint32_t v = 0; v < vertexCount; v ++)
+			vertexTriangleOffsets[v + 1] += vertexTriangleOffsets[v];
+
+		vertexTriangles.resize(indices.size());
+		vertexTriangleFill.assign(vertexTriangleOffsets.begin(), vertexTriangleOffsets.end() - 1);
+
+		for (size_t i = 0; i < indices.size(); i ++)
+			vertexTriangles[vertexTriangleFill[indices[i]] ++] = uint32_t(i / 3);
+
+		// Each interior edge shows up in two triangles, once as (a, b) and once as (b, a), so only take the a < b one
+		collapses.clear();
+
+		for (size_t i = 0; i < indices.size(); i += 3)
+		{
+			for (uint32_t k = 0; k < 3; k ++)
+			{
+				uint32_t a = indices[i + k], b = indices[i + (k + 1) % 3];
+
+				if (a >= b || positionIDs[a] == positionIDs[b] || (vertexLocked[a] && vertexLocked[b]))
+					continue;
+
+				MeshQuadric edgeQuadric = positionQuadrics[positionIDs[a]];
+				addMeshQuadric(edgeQuadric, positionQuadrics[positionIDs[b]]);
+
+				double costAtoB = vertexLocked[a] ? std::numeric_limits<double>::max() : getMeshQuadricDistance(edgeQuadric, vertices[b]);
+				double costBtoA = vertexLocked[b] ? std::numeric_limits<double>::max() : getMeshQuadricDistance(edgeQuadric, vertices[a]);
+
+				if (costAtoB <= costBtoA)
+					collapses.push_back({costAtoB, a, b});
+				else
+					collapses.push_back({costBtoA, b, a});
+			}
+		}
+
+		std::sort(collapses.begin(), collapses.end(), [](const MeshEdgeCollapse &a, const MeshEdgeCollapse &b) {return a.cost < b.cost;});
+
+		for (uint32_t v = 0; v < vertexCount; v ++)
+			vertexRemap[v] = v;
+
+		std::fill(vertexCollapseLocked.begin(), vertexCollapseLocked.end(), false);
+
+		const size_t trianglesToRemove = (indices.size() - targetIndexCount) / 3;
+		size_t trianglesRemoved = 0;
+		uint32_t collapseCount = 0;
+
+		for (size_t c = 0; c < collapses.size() && trianglesRemoved < trianglesToRemove; c ++)
+		{
+			const MeshEdgeCollapse &collapse = collapses[c];
+
+			if (collapse.cost > errorLimit)
+				break;
+
+			const uint32_t fromPosition = positionIDs[collapse.fromVertex], toPosition = positionIDs[collapse.toVertex];
+
+			// Every vertex at the position is collapsed, each one onto the vertex it's connected to at the other position
+			bool collapseValid = true;
+			collapseRemaps.clear();
+
+			for (uint32_t pv = positionVertexOffsets[fromPosition]; pv < positionVertexOffsets[fromPosition + 1] && collapseValid; pv ++)
+			{
+				uint32_t fromVertex = sortedVertices[pv], toVertex = 0;
+
+				// Vertices that aren't used anymore don't need to go anywhere
+				if (vertexTriangleOffsets[fromVertex] == vertexTriangleOffsets[fromVertex + 1])
+					continue;
+
+				if (!findCollapseTargetVertex(fromVertex, toPosition, indices, positionIDs, vertexTriangleOffsets, vertexTriangles, toVertex)
+						|| vertexCollapseLocked[fromVertex] || vertexCollapseLocked[toVertex])
+					collapseValid = false;
+				else
+					collapseRemaps.push_back(std::make_pair(fromVertex, toVertex));
+			}
+
+			if (!collapseValid)
+				continue;
+
+			// Make sure none of the triangles that stick around would get flipped (or folded over too far)
+			bool collapseFlips = false;
+			size_t collapsedTriangles = 0;
+
+			for (size_t r = 0; r < collapseRemaps.size() && !collapseFlips; r ++)
+			{
+				const uint32_t fromVertex = collapseRemaps[r].first, toVertex = collapseRemaps[r].second;
+
+				for (uint32_t j = vertexTriangleOffsets[fromVertex]; j < vertexTriangleOffsets[fromVertex + 1]; j ++)
+				{
+					const uint32_t *triangle = &indices[vertexTriangles[j] * 3];
+
+					if (triangle[0] == toVertex || triangle[1] == toVertex || triangle[2] == toVertex)
+					{
+						collapsedTriangles ++;
+
+						continue;
+					}
+
+					svec3 newPositions[3];
+
+					for (uint32_t k = 0; k < 3; k ++)
+						newPositions[k] = vertices[triangle[k] == fromVertex ? toVertex : triangle[k]];
+
+					svec3 oldNormal = getTriangleNormal(vertices[triangle[0]], vertices[triangle[1]], vertices[triangle[2]]);
+					svec3 newNormal = getTriangleNormal(newPositions[0], newPositions[1], newPositions[2]);
+
+					double normalDot = double(oldNormal.x) * newNormal.x + double(oldNormal.y) * newNormal.y + double(oldNormal.z) * newNormal.z;
+					double oldLength = std::sqrt(double(oldNormal.x) * oldNormal.x + double(oldNormal.y) * oldNormal.y + double(oldNormal.z) * oldNormal.z);
+					double newLength = std::sqrt(double(newNormal.x) * newNormal.x + double(newNormal.y) * newNormal.y + double(newNormal.z) * newNormal.z);
+
+					if (normalDot <= 0.25 * oldLength * newLength)
+					{
+						collapseFlips = true;
+
+						break;
+					}
+				}
+			}
+
+			if (collapseFlips)
+				continue;
+
+			addMeshQuadric(positionQuadrics[toPosition], positionQuadrics[fromPosition]);
+			maxCollapseError = std::max(maxCollapseError, collapse.cost);
+
+			for (size_t r = 0; r < collapseRemaps.size(); r ++)
+			{
+				const uint32_t fromVertex = collapseRemaps[r].first;
+
+				vertexRemap[fromVertex] = collapseRemaps[r].second;
+
+				// Everything around the collapse is locked until the next pass, since it's triangles just changed
+				for (uint32_t j = vertexTriangleOffsets[fromVertex]; j < vertexTriangleOffsets[fromVertex + 1]; j ++)
+				{
+					const uint32_t *triangle = &indices[vertexTriangles[j] * 3];
+
+					vertexCollapseLocked[triangle[0]] = vertexCollapseLocked[triangle[1]] = vertexCollapseLocked[triangle[2]] = true;
+				}
+			}
+
+			trianglesRemoved += collapsedTriangles;
+			collapseCount ++;
+		}
+
+		// Nothing left that's under the error limit
+		if (collapseCount == 0)
+			break;
+
+		size_t newIndexCount = 0;
+
+		for (size_t i = 0; i < indices.size(); i += 3)
+		{
+			uint32_t a = vertexRemap[indices[i + 0]], b = vertexRemap[indices[i + 1]], c = vertexRemap[indices[i + 2]];
+
+			if (a != b && b != c && a != c)
+			{
+				indices[newIndexCount + 0] = a;
+				indices[newIndexCount + 1] = b;
+				indices[newIndexCount + 2] = c;
+				newIndexCount += 3;
+			}
+		}
+
+		indices.resize(newIndexCount);
+	}
+
+	simplifiedData.faceCount = (uint32_t) (indices.size() / 3);
+	simplifiedData.indices_16bit.clear();
+	simplifiedData.indices_32bit.clear();
+
+	if (simplifiedData.uses32BitIndices)
+		simplifiedData.indices_32bit.swap(indices);
+	else
+		simplifiedData.indices_16bit.assign(indices.begin(), indices.end());
+
+	if (resultError != nullptr)
+		*resultError = float(maxCollapseError / meshExtent);
+
+	return simplifiedData;
+}
@@ -0,0 +1,52 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2017 David Allen
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * MeshSimplifier.h
+ */
+
+#ifndef RESOURCES_MESHSIMPLIFIER_H_
+#define RESOURCES_MESHSIMPLIFIER_H_
+
+#include <common.h>
+#include <Resources/Resources.h>
+
+/*
+ * Simplifies meshes for the automatically generated LODs (see StaticMeshDef::generatedLODCount). It's a quadric error
+ * (Garland & Heckbert) edge collapser, but vertices are only ever collapsed onto one of their neighbors instead of to a new
+ * optimal position, so every attribute (uvs, normals, etc) stays valid without having to be interpolated.
+ *
+ * Vertices on the mesh's border are never moved, so the silhouette edges of open meshes are kept intact. Vertices on a
+ * uv/normal seam (more than one vertex w/ the same position) can only be collapsed along the seam, onto another seam vertex,
+ * w/ the vertices on each side of the seam moving together, so the seam is never torn open.
+ *
+ * The error is the (area weighted) mean distance from the moved vertex to the planes of the triangles it's been merged w/, so
+ * it's an actual distance, independent of the mesh's scale & tessellation.
+ */
+class MeshSimplifier
+{
+	public:
+
+		static ResourceMeshData simplifyMesh (const ResourceMeshData &meshData, float targetTriangleRatio, float targetError, float *resultError = nullptr);
+};
+
+#endif /* RESOURCES_MESHSIMPLIFIER_H_ */
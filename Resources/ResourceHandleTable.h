@@ -0,0 +1,171 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2017 David Allen
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * ResourceHandleTable.h
+ */
+
+#ifndef RESOURCES_RESOURCEHANDLETABLE_H_
+#define RESOURCES_RESOURCEHANDLETABLE_H_
+
+#include <common.h>
+#include <Resources/Resources.h>
+
+#define RESOURCE_HANDLE_TABLE_CHUNK_SIZE 1024
+#define RESOURCE_HANDLE_TABLE_MAX_CHUNKS 256
+
+/*
+ * The slot array that ResourceHandles index into. Slots are allocated in fixed size chunks that never move, so a handle
+ * can be resolved w/o taking the lock, even while another thread is loading something. Allocating & releasing slots
+ * does take the lock, and freed slots are reused first so the array stays dense.
+ *
+ * Note that resolving a handle isn't synchronized w/ the resource being freed, it only tells you whether the resource was
+ * still alive. That's fine as long as resources are only freed on the main thread (which the resource manager guarantees).
+ */
+template<typename T>
+class ResourceHandleTable
+{
+	public:
+
+		ResourceHandleTable ()
+		{
+			for (uint32_t i = 0; i < RESOURCE_HANDLE_TABLE_MAX_CHUNKS; i ++)
+				chunks[i] = nullptr;
+
+			slotCount = 0;
+			usedSlotCount = 0;
+		}
+
+		virtual ~ResourceHandleTable ()
+		{
+			for (uint32_t i = 0; i < RESOURCE_HANDLE_TABLE_MAX_CHUNKS; i ++)
+				delete[] chunks[i];
+		}
+
+		ResourceHandle<T> allocate (T *resource)
+		{
+			std::unique_lock<std::mutex> lock(table_mutex);
+
+			uint32_t index;
+
+			if (freeSlots.size() > 0)
+			{
+				index = freeSlots.back();
+				freeSlots.pop_back();
+			}
+			else
+			{
+				index = slotCount.load(std::memory_order_relaxed);
+
+				if (index / RESOURCE_HANDLE_TABLE_CHUNK_SIZE >= RESOURCE_HANDLE_TABLE_MAX_CHUNKS)
+				{
+					// None of the callers can do anything w/o a handle, so this is treated as fatal rather than handing out a null one
+					printf("%s Ran out of resource handles, more than %u resources of the same type are loaded\n", ERR_PREFIX, RESOURCE_HANDLE_TABLE_CHUNK_SIZE * RESOURCE_HANDLE_TABLE_MAX_CHUNKS);
+
+					throw std::runtime_error("ran out of resource handles");
+				}
+
+				if (chunks[index / RESOURCE_HANDLE_TABLE_CHUNK_SIZE] == nullptr)
+					chunks[index / RESOURCE_HANDLE_TABLE_CHUNK_SIZE] = new Slot[RESOURCE_HANDLE_TABLE_CHUNK_SIZE];
+
+				Slot &slot = getSlot(index);
+				slot.resource = nullptr;
+				slot.generation.store(1, std::memory_order_relaxed);
+
+				slotCount.store(index + 1, std::memory_order_release);
+			}
+
+			Slot &slot = getSlot(index);
+			slot.resource = resource;
+
+			usedSlotCount ++;
+
+			// The generation is re-stored so that the resource ptr is visible to anyone who sees the generation match
+			uint32_t generation = slot.generation.load(std::memory_order_relaxed);
+			slot.generation.store(generation, std::memory_order_release);
+
+			return {index, generation};
+		}
+
+		void release (ResourceHandle<T> handle)
+		{
+			std::unique_lock<std::mutex> lock(table_mutex);
+
+			if (handle.isNull() || handle.index >= slotCount.load(std::memory_order_relaxed))
+				return;
+
+			Slot &slot = getSlot(handle.index);
+
+			if (slot.generation.load(std::memory_order_relaxed) != handle.generation)
+				return;
+
+			// Generation 0 is reserved for null handles, so it's skipped when the counter wraps
+			uint32_t nextGeneration = handle.generation + 1;
+			slot.generation.store(nextGeneration == 0 ? 1 : nextGeneration, std::memory_order_release);
+			slot.resource = nullptr;
+
+			freeSlots.push_back(handle.index);
+			usedSlotCount --;
+		}
+
+		/*
+		 * Returns the resource the handle refers to, or nullptr if it's a null handle or the resource has been freed.
+		 */
+		inline T *get (ResourceHandle<T> handle) const
+		{
+			if (handle.isNull() || handle.index >= slotCount.load(std::memory_order_acquire))
+				return nullptr;
+
+			const Slot &slot = getSlot(handle.index);
+
+			return slot.generation.load(std::memory_order_acquire) == handle.generation ? slot.resource : nullptr;
+		}
+
+		uint32_t getUsedSlotCount ()
+		{
+			std::unique_lock<std::mutex> lock(table_mutex);
+
+			return usedSlotCount;
+		}
+
+	private:
+
+		typedef struct Slot
+		{
+				std::atomic<uint32_t> generation;
+				T *resource;
+		} Slot;
+
+		Slot *chunks[RESOURCE_HANDLE_TABLE_MAX_CHUNKS];
+		std::atomic<uint32_t> slotCount; // The number of slots that have ever been allocated, the highest valid index + 1
+
+		std::mutex table_mutex;
+		std::vector<uint32_t> freeSlots;
+		uint32_t usedSlotCount;
+
+		inline Slot &getSlot (uint32_t index) const
+		{
+			return chunks[index / RESOURCE_HANDLE_TABLE_CHUNK_SIZE][index % RESOURCE_HANDLE_TABLE_CHUNK_SIZE];
+		}
+};
+
+#endif /* RESOURCES_RESOURCEHANDLETABLE_H_ */
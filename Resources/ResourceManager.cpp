@@ -28,6 +28,9 @@
  */
 
 #include "Resources/ResourceManager.h"
+#include "Resources/MeshOptimizer.h"
+#include "Resources/MeshSimplifier.h"
+#include "Resources/TextureCooker.h"
 
 #include <Rendering/Renderer/Renderer.h>
 
@@ -37,7 +40,19 @@
 ResourceManager::ResourceManager (Renderer *rendererInstance)
 {
 	renderer = rendererInstance;
-	mainThreadTransferCommandPool = renderer->createCommandPool(QUEUE_TYPE_GRAPHICS, COMMAND_POOL_TRANSIENT_BIT);
+	rendererMeshFormat = MESH_DATA_FORMAT_IVUNT;
+	uploadBatcher = new UploadBatcher(renderer);
+	meshPool = new MeshPool(renderer);
+
+	mainThreadID = std::this_thread::get_id();
+	pendingAsyncLoadCount = 0;
+	asyncWorkersRunning = true;
+
+	// Leave one thread for the main thread, but always have at least one worker
+	uint32_t asyncWorkerCount = std::max<uint32_t>(std::thread::hardware_concurrency(), 2) - 1;
+
+	for (uint32_t i = 0; i < asyncWorkerCount; i ++)
+		asyncWorkerThreads.push_back(std::thread(&ResourceManager::asyncWorkerThreadFunc, this));
 
 	std::vector<DescriptorSetLayoutBinding> layoutBindings;
 	layoutBindings.push_back({0, DESCRIPTOR_TYPE_SAMPLER, 1, SHADER_STAGE_FRAGMENT_BIT});
@@ -48,6 +63,16 @@ ResourceManager::ResourceManager (Renderer *rendererInstance)
 	pipelineRenderPass = nullptr;
 	pipelineShadowRenderPass = nullptr;
 
+	resourceCacheConfig.cpuBudget = RESOURCE_CACHE_DEFAULT_CPU_BUDGET;
+	resourceCacheConfig.vramBudget = RESOURCE_CACHE_DEFAULT_VRAM_BUDGET;
+	resourceCacheConfig.decayTime = RESOURCE_CACHE_DEFAULT_DECAY_TIME;
+	resourceCacheConfig.textureStreamingBudget = RESOURCE_CACHE_DEFAULT_TEXTURE_STREAMING_BUDGET;
+	resourceCacheStats = {};
+
+	streamedTextureMemorySize = 0;
+
+	frameUploadBudget = 0;
+
 	/*
 	 * Create the color textures
 	 */
@@ -56,7 +81,6 @@ ResourceManager::ResourceManager (Renderer *rendererInstance)
 	{
 		colorBlackTex = renderer->createTexture({4, 4, 1}, RESOURCE_FORMAT_R8G8B8A8_UNORM, TEXTURE_USAGE_SAMPLED_BIT | TEXTURE_USAGE_TRANSFER_DST_BIT, MEMORY_USAGE_GPU_ONLY);
 		colorBlackTexView = renderer->createTextureView(colorBlackTex);
-		StagingBuffer colorTexStagingBuffer = renderer->createStagingBuffer(4 * 4 * 4);
 
 		uint8_t colorBlackBuffer[4 * 4 * 4];
 		uint8_t colBlack[4] = {0, 0, 0, 255};
@@ -64,24 +88,14 @@ ResourceManager::ResourceManager (Renderer *rendererInstance)
 		for (int i = 0; i < 16; i++)
 			memcpy(&colorBlackBuffer[i * 4], colBlack, 4);
 
-		renderer->fillStagingBuffer(colorTexStagingBuffer, sizeof(colorBlackBuffer), colorBlackBuffer);
-
-		CommandBuffer cmdBuffer = renderer->beginSingleTimeCommand(mainThreadTransferCommandPool);
-
-		cmdBuffer->setTextureLayout(colorBlackTex, TEXTURE_LAYOUT_UNDEFINED, TEXTURE_LAYOUT_TRANSFER_DST_OPTIMAL, {0, 1, 0, 1}, PIPELINE_STAGE_ALL_COMMANDS_BIT, PIPELINE_STAGE_ALL_COMMANDS_BIT);
-		cmdBuffer->stageBuffer(colorTexStagingBuffer, colorBlackTex);
-		cmdBuffer->setTextureLayout(colorBlackTex, TEXTURE_LAYOUT_TRANSFER_DST_OPTIMAL, TEXTURE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, {0, 1, 0, 1}, PIPELINE_STAGE_ALL_COMMANDS_BIT, PIPELINE_STAGE_ALL_COMMANDS_BIT);
-
-		renderer->endSingleTimeCommand(cmdBuffer, mainThreadTransferCommandPool, QUEUE_TYPE_GRAPHICS);
-
-		renderer->destroyStagingBuffer(colorTexStagingBuffer);
+		TextureBufferCopyInfo copyRegion = {0, {0, 0, 1}, {0, 0, 0}, {4, 4, 1}};
+		memcpy(uploadBatcher->uploadTexture(colorBlackTex, sizeof(colorBlackBuffer), {copyRegion}, 1, 1), colorBlackBuffer, sizeof(colorBlackBuffer));
 	}
 
 	// Dither texture
 	{
 		ditherTex = renderer->createTexture({8, 8, 1}, RESOURCE_FORMAT_R8_UNORM, TEXTURE_USAGE_SAMPLED_BIT | TEXTURE_USAGE_TRANSFER_DST_BIT, MEMORY_USAGE_GPU_ONLY);
 		ditherTexView = renderer->createTextureView(ditherTex);
-		StagingBuffer ditherTexStagingBuffer = renderer->createStagingBuffer(8 * 8 * 1);
 
 		const float bayerPattern[] = {
 			0, 32, 8, 40, 2, 34, 10, 42,  /* 8x8 Bayer ordered dithering  */
@@ -98,23 +112,34 @@ ResourceManager::ResourceManager (Renderer *rendererInstance)
 		for (int i = 0; i < 64; i++)
 			ditherTexBuffer[i] = uint8_t(bayerPattern[i] * (255.0f / 64.0f));
 
-		renderer->fillStagingBuffer(ditherTexStagingBuffer, sizeof(ditherTexBuffer), ditherTexBuffer);
-
-		CommandBuffer cmdBuffer = renderer->beginSingleTimeCommand(mainThreadTransferCommandPool);
-
-		cmdBuffer->setTextureLayout(ditherTex, TEXTURE_LAYOUT_UNDEFINED, TEXTURE_LAYOUT_TRANSFER_DST_OPTIMAL, {0, 1, 0, 1}, PIPELINE_STAGE_ALL_COMMANDS_BIT, PIPELINE_STAGE_ALL_COMMANDS_BIT);
-		cmdBuffer->stageBuffer(ditherTexStagingBuffer, ditherTex);
-		cmdBuffer->setTextureLayout(ditherTex, TEXTURE_LAYOUT_TRANSFER_DST_OPTIMAL, TEXTURE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, {0, 1, 0, 1}, PIPELINE_STAGE_ALL_COMMANDS_BIT, PIPELINE_STAGE_ALL_COMMANDS_BIT);
-
-		renderer->endSingleTimeCommand(cmdBuffer, mainThreadTransferCommandPool, QUEUE_TYPE_GRAPHICS);
-
-		renderer->destroyStagingBuffer(ditherTexStagingBuffer);
+		TextureBufferCopyInfo copyRegion = {0, {0, 0, 1}, {0, 0, 0}, {8, 8, 1}};
+		memcpy(uploadBatcher->uploadTexture(ditherTex, sizeof(ditherTexBuffer), {copyRegion}, 1, 1), ditherTexBuffer, sizeof(ditherTexBuffer));
 	}
+
+	uploadBatcher->flush();
 }
 
 ResourceManager::~ResourceManager ()
 {
-	renderer->destroyCommandPool(mainThreadTransferCommandPool);
+	{
+		std::unique_lock<std::mutex> lock(asyncWorkerJobs_mutex);
+		asyncWorkersRunning = false;
+	}
+
+	asyncWorkerJobs_cv.notify_all();
+
+	for (size_t i = 0; i < asyncWorkerThreads.size(); i ++)
+		asyncWorkerThreads[i].join();
+
+	updateRetainedResources(true);
+	updatePendingTextureFrees(true);
+
+	for (auto it = requestedMaterialPipelines.begin(); it != requestedMaterialPipelines.end(); it ++)
+		returnPipeline(*it);
+
+	delete uploadBatcher;
+	delete meshPool;
+
 	renderer->destroyDescriptorPool(mainThreadDescriptorPool);
 
 	renderer->destroyTexture(colorBlackTex);
@@ -128,1316 +153,4017 @@ ResourceManager::~ResourceManager ()
 	printf("Remaining resources - %u, %u, %u\n", loadedMaterials.size(), loadedTextures.size(), loadedStaticMeshes.size());
 }
 
-void ResourceManager::loadGameDefsFile (const std::string &file)
+/*
+ * Finishes any async loads that are ready for their last stage (creating the renderer objects & uploading
+ * the data), and calls the callbacks of any finished resources. This has to be called on the main thread,
+ * StarlightEngine calls it once per update. If a frame upload budget is set then we stop once that many bytes
+ * have been uploaded this frame, so a burst of finished loads gets spread over a few frames instead of hitching one.
+ */
+void ResourceManager::processAsyncLoads ()
 {
+	DEBUG_ASSERT(std::this_thread::get_id() == mainThreadID);
+
+	runMainThreadAsyncTasks();
+	updateTextureStreaming();
+
+	// Any uploads done by the tasks are submitted here, and the loads whose uploads have finished get their callbacks called
+	uploadBatcher->update();
+
+	// These count frames to know when nothing in flight can still be using what they free, so they're only done here, and not while waiting on a load
+	meshPool->update();
+	updatePendingTextureFrees(false);
 
+	updateRetainedResources(false);
 }
 
-ResourceMaterial ResourceManager::loadMaterialImmediate (const std::string &defUniqueName)
+void ResourceManager::runMainThreadAsyncTasks ()
 {
-	auto it = loadedMaterials.find(stringHash(defUniqueName));
+	size_t taskCount = 0;
 
-	if (it == loadedMaterials.end())
 	{
-		MaterialDef *matDef = getMaterialDef(defUniqueName);
+		std::unique_lock<std::mutex> lock(mainThreadAsyncTasks_mutex);
+		taskCount = mainThreadAsyncTasks.size();
+	}
 
-		ResourceMaterialObject *mat = new ResourceMaterialObject();
-		mat->defUniqueName = defUniqueName;
-		mat->descriptorSet = mainThreadDescriptorPool->allocateDescriptorSet();
-		mat->sampler = renderer->createSampler(matDef->addressMode, matDef->linearFiltering ? SAMPLER_FILTER_LINEAR : SAMPLER_FILTER_NEAREST, matDef->linearFiltering ? SAMPLER_FILTER_LINEAR : SAMPLER_FILTER_NEAREST, 4, {0, 14, 0},
-				matDef->linearMipmapFiltering ? SAMPLER_MIPMAP_MODE_LINEAR : SAMPLER_MIPMAP_MODE_NEAREST);
-		mat->pipelineHash = stringHash(matDef->pipelineUniqueName);
-		renderer->setObjectDebugName(mat->sampler, OBJECT_TYPE_SAMPLER, "Material: " + mat->defUniqueName + " sampler");
+	// Only do the tasks that were queued when we started, anything queued by the tasks themselves gets done next time
+	for (size_t i = 0; i < taskCount; i ++)
+	{
+		std::function<void()> task;
 
-		std::vector<std::string> texFiles;
+		{
+			std::unique_lock<std::mutex> lock(mainThreadAsyncTasks_mutex);
 
-		for (int i = 0; i < MATERIAL_DEF_MAX_TEXTURE_NUM; i ++)
-			if (std::string(matDef->textureFiles[i]).length() != 0)
-				texFiles.push_back(std::string(matDef->textureFiles[i]));
+			if (mainThreadAsyncTasks.size() == 0)
+				break;
 
-		for (size_t i = 0; i < texFiles.size(); i++)
-			mat->textures[i] = loadTextureImmediate(texFiles[i]);
+			task = mainThreadAsyncTasks.front();
+			mainThreadAsyncTasks.pop_front();
+		}
 
-		mat->usedTextureCount = (uint8_t) texFiles.size();
+		task();
 
-		std::vector<DescriptorWriteInfo> writes(2);
-		writes[0].descriptorCount = 1;
-		writes[0].descriptorType = DESCRIPTOR_TYPE_SAMPLER;
-		writes[0].dstSet = mat->descriptorSet;
-		writes[0].imageInfo =
-		{
-			{	mat->sampler, nullptr, TEXTURE_LAYOUT_UNDEFINED}};
-		writes[0].dstBinding = 0;
-		writes[0].dstArrayElement = 0;
+		if (frameUploadBudget > 0 && uploadBatcher->getFrameUploadSize() >= frameUploadBudget)
+			break;
+	}
+}
 
-		std::vector<DescriptorImageInfo> texDescInfos;
+/*
+ * Returns the number of resources that were requested by a load*Async() function and haven't finished loading yet.
+ */
+uint32_t ResourceManager::getPendingAsyncLoadCount ()
+{
+	return pendingAsyncLoadCount;
+}
 
-		for (size_t i = 0; i < texFiles.size(); i++)
-		{
-			DescriptorImageInfo imgInfo = {};
-			imgInfo.sampler = nullptr;
-			imgInfo.view = mat->textures[i]->textureView;
-			imgInfo.layout = TEXTURE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+void ResourceManager::setFrameUploadBudget (size_t budget)
+{
+	frameUploadBudget = budget;
+}
 
-			texDescInfos.push_back(imgInfo);
-		}
+size_t ResourceManager::getFrameUploadBudget ()
+{
+	return frameUploadBudget;
+}
 
-		// Fill in the rest w/ dummy textures as to not cause a validation error
-		while (texDescInfos.size() < 8)
-		{
-			DescriptorImageInfo imgInfo = {};
-			imgInfo.sampler = nullptr;
-			imgInfo.view = colorBlackTexView;
-			imgInfo.layout = TEXTURE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+UploadBatcherStats ResourceManager::getUploadStats ()
+{
+	return uploadBatcher->getStats();
+}
 
-			texDescInfos.push_back(imgInfo);
-		}
+MeshPoolStats ResourceManager::getMeshPoolStats ()
+{
+	return meshPool->getStats();
+}
 
-		writes[1].descriptorCount = texDescInfos.size();
-		writes[1].descriptorType = DESCRIPTOR_TYPE_SAMPLED_IMAGE;
-		writes[1].dstSet = mat->descriptorSet;
-		writes[1].imageInfo = texDescInfos;
-		writes[1].dstBinding = 1;
-		writes[1].dstArrayElement = 0;
+uint32_t ResourceManager::getAsyncWorkerCount ()
+{
+	return (uint32_t) asyncWorkerThreads.size();
+}
 
-		renderer->writeDescriptorSets(writes);
+/*
+ * Reads & decodes the layers of a PNG texture array the same way loadTextureArrayImmediate() does, but on at most <maxThreads>
+ * threads (including the calling one), and w/o uploading anything. Sets <time> to how long it took in milliseconds, it's for
+ * benchmarking how the decode scales w/ the thread count. Returns false if the texture array couldn't be decoded.
+ */
+bool ResourceManager::timePNGTextureArrayDecode (const std::vector<std::string> &files, uint32_t maxThreads, double &time)
+{
+	ResourceTextureStagingData texData = {};
+	texData.format = TEXTURE_FILE_FORMAT_PNG;
 
-		loadedMaterials[stringHash(defUniqueName)] = std::make_pair(mat, 1);
+	auto startTime = std::chrono::high_resolution_clock::now();
+	bool decoded = readPNGTextureData(files, texData, maxThreads);
 
-		return mat;
-	}
-	else
-	{
-		it->second.second ++;
+	time = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
 
-		return it->second.first;
-	}
+	return decoded;
 }
 
-ResourceMaterial ResourceManager::findMaterial (const std::string &defUniqueName)
+void ResourceManager::asyncWorkerThreadFunc ()
 {
-	return findMaterial(stringHash(defUniqueName));
-}
+	while (true)
+	{
+		std::function<void()> job;
 
-ResourceMaterial ResourceManager::findMaterial (size_t defUniqueNameHash)
-{
-	auto it = loadedMaterials.find(defUniqueNameHash);
+		{
+			std::unique_lock<std::mutex> lock(asyncWorkerJobs_mutex);
+			asyncWorkerJobs_cv.wait(lock, [this] {return !asyncWorkersRunning || asyncWorkerJobs.size() > 0;});
+
+			if (!asyncWorkersRunning)
+				return;
 
-	return it != loadedMaterials.end() ? it->second.first : nullptr;
+			job = asyncWorkerJobs.front();
+			asyncWorkerJobs.pop_front();
+		}
+
+		job();
+	}
 }
 
-void ResourceManager::returnMaterial (const std::string &defUniqueName)
+void ResourceManager::pushAsyncWorkerJob (const std::function<void()> &job)
 {
-	return returnMaterial(stringHash(defUniqueName));
+	{
+		std::unique_lock<std::mutex> lock(asyncWorkerJobs_mutex);
+		asyncWorkerJobs.push_back(job);
+	}
+
+	asyncWorkerJobs_cv.notify_one();
 }
 
-void ResourceManager::returnMaterial (size_t defUniqueNameHash)
+/*
+ * Runs "job" for every index in [0, jobCount) on the async worker threads, and returns once they're all done. The
+ * calling thread runs jobs too, so this is safe to call from a worker thread (or while every worker is busy), it just
+ * won't go as wide. Jobs are handed out one index at a time, so they can take very different amounts of time. If <maxThreads>
+ * isn't 0, then at most that many threads (counting the calling one) run the jobs.
+ */
+void ResourceManager::runParallelJobs (uint32_t jobCount, const std::function<void(uint32_t)> &job, uint32_t maxThreads)
 {
-	auto it = loadedMaterials.find(defUniqueNameHash);
+	if (jobCount == 0)
+		return;
 
-	if (it != loadedMaterials.end())
+	struct ParallelJobsState
 	{
-		// Decrement the reference counter
-		it->second.second --;
+			std::function<void(uint32_t)> job;
+			uint32_t jobCount;
+			std::atomic<uint32_t> nextJob;
+			std::atomic<uint32_t> finishedJobs;
+
+			std::mutex finished_mutex;
+			std::condition_variable finished_cv; // Notified once "finishedJobs" reaches "jobCount"
+	};
+
+	// Shared so the helper jobs can safely outlive this call, any that start late just find nothing left to do
+	std::shared_ptr<ParallelJobsState> state = std::make_shared<ParallelJobsState>();
+	state->job = job;
+	state->jobCount = jobCount;
+	state->nextJob = 0;
+	state->finishedJobs = 0;
+
+	std::function<void()> runJobs = [state]()
+	{
+		uint32_t jobIndex;
 
-		// If the reference counter is now zero, then delete the mesh data entirely
-		if (it->second.second == 0)
+		while ((jobIndex = state->nextJob ++) < state->jobCount)
 		{
-			ResourceMaterial mat = it->second.first;
+			state->job(jobIndex);
 
-			mainThreadDescriptorPool->freeDescriptorSet(mat->descriptorSet);
-			renderer->destroySampler(mat->sampler);
+			// Taking the lock first means the caller can't miss the notify between checking "finishedJobs" and waiting
+			if (++ state->finishedJobs == state->jobCount)
+			{
+				std::unique_lock<std::mutex> lock(state->finished_mutex);
+				state->finished_cv.notify_all();
+			}
+		}
+	};
 
-			for (size_t i = 0; i < mat->usedTextureCount; i ++)
-				returnTexture(mat->textures[i]);
+	uint32_t helperCount = std::min<uint32_t>(jobCount - 1, (uint32_t) asyncWorkerThreads.size());
 
-			delete mat;
+	if (maxThreads > 0)
+		helperCount = std::min<uint32_t>(helperCount, maxThreads - 1);
 
-			loadedMaterials.erase(it);
-		}
-	}
+	for (uint32_t i = 0; i < helperCount; i ++)
+		pushAsyncWorkerJob(runJobs);
+
+	runJobs();
+
+	// Whatever's left is already running on the helpers, so there's nothing for this thread to do but wait
+	std::unique_lock<std::mutex> lock(state->finished_mutex);
+	state->finished_cv.wait(lock, [&state, jobCount]() {return state->finishedJobs == jobCount;});
 }
 
-bool ResourceMananger_meshLodDistComp (const std::pair<float, ResourceMesh> &arg0, const std::pair<float, ResourceMesh> &arg1)
+void ResourceManager::pushMainThreadAsyncTask (const std::function<void()> &task)
 {
-	return arg0.first < arg1.first;
+	std::unique_lock<std::mutex> lock(mainThreadAsyncTasks_mutex);
+	mainThreadAsyncTasks.push_back(task);
 }
 
-ResourceStaticMesh ResourceManager::loadStaticMeshImmediate (const std::string &defUniqueName)
+/*
+ * Adds a callback to be called once a resource has finished loading. If it's already loaded, then the
+ * callback is called on the next processAsyncLoads(), so callbacks are never called from inside of a load*Async().
+ */
+void ResourceManager::addAsyncLoadCallback (void *resource, const std::atomic<bool> &dataLoaded, const std::function<void()> &callback)
 {
-	auto it = loadedStaticMeshes.find(stringHash(defUniqueName));
+	std::unique_lock<std::mutex> lock(asyncLoadCallbacks_mutex);
 
-	if (it == loadedStaticMeshes.end())
+	if (dataLoaded)
 	{
-		StaticMeshDef *matDef = getMeshDef(defUniqueName);
+		lock.unlock();
+		pushMainThreadAsyncTask(callback);
 
-		ResourceStaticMeshObject *mesh = new ResourceStaticMeshObject();
-		mesh->defUniqueName = matDef->uniqueName;
+		return;
+	}
 
-		DEBUG_ASSERT(matDef->meshLODFiles.size() == matDef->meshLODNames.size() && matDef->meshLODNames.size() == matDef->meshLODMaxDists.size());
+	asyncLoadCallbacks[resource].push_back(callback);
+}
 
-		for (size_t i = 0; i < matDef->meshLODFiles.size(); i ++)
-		{
-			std::string lodMeshFile = std::string(matDef->meshLODFiles[i]);
-			std::string lodMeshName = std::string(matDef->meshLODNames[i]);
-			float lodMaxDist = matDef->meshLODMaxDists[i];
+/*
+ * Marks an async resource as loaded and calls all of it's callbacks. Has to be called on the main thread.
+ */
+void ResourceManager::finishAsyncLoad (void *resource, std::atomic<bool> &dataLoaded)
+{
+	std::vector<std::function<void()> > callbacks;
 
-			mesh->meshLODs.push_back(std::make_pair(lodMaxDist, loadMeshImmediate(lodMeshFile, lodMeshName)));
+	{
+		std::unique_lock<std::mutex> lock(asyncLoadCallbacks_mutex);
+		dataLoaded = true;
+
+		auto it = asyncLoadCallbacks.find(resource);
+
+		if (it != asyncLoadCallbacks.end())
+		{
+			callbacks.swap(it->second);
+			asyncLoadCallbacks.erase(it);
 		}
+	}
 
-		// The "meshLODs" member is required to be sorted by lod distance
-		std::sort(mesh->meshLODs.begin(), mesh->meshLODs.end(), ResourceMananger_meshLodDistComp);
+	pendingAsyncLoadCount --;
+	asyncLoadFinished_cv.notify_all();
 
-		//mesh->mesh = loadMeshImmediate(workingDir + std::string(matDef->meshFile), std::string(matDef->meshName));
+	for (size_t i = 0; i < callbacks.size(); i ++)
+		callbacks[i]();
+}
 
-		loadedStaticMeshes[stringHash(defUniqueName)] = std::make_pair(mesh, 1);
+/*
+ * Waits until a resource's data is loaded. The last stage of every async load is done on the main thread,
+ * so if we're waiting on the main thread then we have to do that work ourselves, otherwise we'd wait forever.
+ * Any other thread just sleeps until finishAsyncLoad() wakes it up.
+ */
+void ResourceManager::waitForAsyncLoad (const std::atomic<bool> &dataLoaded)
+{
+	if (std::this_thread::get_id() != mainThreadID)
+	{
+		std::unique_lock<std::mutex> lock(asyncLoadCallbacks_mutex);
+		asyncLoadFinished_cv.wait(lock, [&dataLoaded]() {return dataLoaded.load();});
 
-		return mesh;
+		return;
 	}
-	else
-	{
-		it->second.second ++;
 
-		return it->second.first;
+	while (!dataLoaded)
+	{
+		runMainThreadAsyncTasks();
+		uploadBatcher->update();
 	}
 }
 
-ResourceStaticMesh ResourceManager::findStaticMesh (const std::string &defUniqueName)
+void ResourceManager::setResourceCacheConfig (const ResourceCacheConfig &config)
 {
-	return findStaticMesh(stringHash(defUniqueName));
+	std::unique_lock<std::mutex> lock(retainedResources_mutex);
+	resourceCacheConfig = config;
 }
 
-ResourceStaticMesh ResourceManager::findStaticMesh (size_t defUniqueNameHash)
+ResourceCacheConfig ResourceManager::getResourceCacheConfig ()
 {
-	auto it = loadedStaticMeshes.find(defUniqueNameHash);
+	std::unique_lock<std::mutex> lock(retainedResources_mutex);
+	return resourceCacheConfig;
+}
+
+ResourceCacheStats ResourceManager::getResourceCacheStats ()
+{
+	std::unique_lock<std::mutex> lock(retainedResources_mutex);
+
+	ResourceCacheStats stats = resourceCacheStats;
+	stats.streamedTextureCount = (uint32_t) streamedTextures.size();
+	stats.textureMipStreamsInFlight = (uint32_t) textureMipStreams.size();
+	stats.streamedTextureVRAMSize = streamedTextureMemorySize;
 
-	return it != loadedStaticMeshes.end() ? it->second.first : nullptr;
+	return stats;
 }
 
-void ResourceManager::returnStaticMesh (const std::string &defUniqueName)
+/*
+ * Frees every resource that doesn't have any references left, regardless of the budgets. Has to be called on the main thread.
+ */
+void ResourceManager::evictUnreferencedResources ()
 {
-	returnStaticMesh(stringHash(defUniqueName));
+	updateRetainedResources(true);
 }
 
-void ResourceManager::returnStaticMesh (size_t defUniqueNameHash)
+/*
+ * Puts a resource whose reference counter just hit 0 at the back of the retained list. If the resource's cache has a mutex,
+ * then it has to be locked by the caller.
+ */
+void ResourceManager::retainResource (RetainedResourceType type, void *resource, size_t cpuSize, size_t vramSize)
 {
-	auto it = loadedStaticMeshes.find(defUniqueNameHash);
+	std::unique_lock<std::mutex> lock(retainedResources_mutex);
 
-	if (it != loadedStaticMeshes.end())
+	RetainedResource retained = {};
+	retained.type = type;
+	retained.resource = resource;
+	retained.cpuSize = cpuSize;
+	retained.vramSize = vramSize;
+	retained.returnTime = std::chrono::steady_clock::now();
+
+	retainedResourcesMap[resource] = retainedResources.insert(retainedResources.end(), retained);
+
+	resourceCacheStats.retainedCount ++;
+	resourceCacheStats.retainedCPUSize += cpuSize;
+	resourceCacheStats.retainedVRAMSize += vramSize;
+}
+
+/*
+ * Counts a load as a hit or a miss, and if it was a hit on a retained resource then it's taken back out of the retained
+ * list. Has to be called while the resource's cache mutex (if it has one) is still locked, so it can't be evicted in between.
+ */
+void ResourceManager::countResourceCacheLookup (void *resource, bool hit)
+{
+	std::unique_lock<std::mutex> lock(retainedResources_mutex);
+
+	if (!hit)
 	{
-		// Decrement the reference counter
-		it->second.second --;
+		resourceCacheStats.misses ++;
 
-		// If the reference counter is now zero, then delete the mesh data entirely
-		if (it->second.second == 0)
-		{
-			ResourceStaticMesh mesh = it->second.first;
+		return;
+	}
 
-			for (uint32_t lod = 0; lod < mesh->meshLODs.size(); lod ++)
-			{
-				returnMesh(mesh->meshLODs[lod].second);
-			}
+	resourceCacheStats.hits ++;
 
-			delete mesh;
+	auto it = retainedResourcesMap.find(resource);
 
-			loadedStaticMeshes.erase(it);
-		}
+	if (it != retainedResourcesMap.end())
+	{
+		resourceCacheStats.retainedHits ++;
+		resourceCacheStats.retainedCount --;
+		resourceCacheStats.retainedCPUSize -= it->second->cpuSize;
+		resourceCacheStats.retainedVRAMSize -= it->second->vramSize;
+
+		retainedResources.erase(it->second);
+		retainedResourcesMap.erase(it);
 	}
 }
 
-ResourcePipeline ResourceManager::loadPipelineImmediate (const std::string &defUniqueName)
+/*
+ * Evicts retained resources from the front of the list (least recently returned) until both budgets are met and nothing
+ * left has decayed, or everything if evictAll is set. Evicting a material or static mesh returns it's textures or meshes,
+ * which then get retained themselves. Has to be called on the main thread, StarlightEngine does it in processAsyncLoads().
+ */
+void ResourceManager::updateRetainedResources (bool evictAll)
 {
-	auto it = loadedPipelines.find(stringHash(defUniqueName));
+	DEBUG_ASSERT(std::this_thread::get_id() == mainThreadID);
 
-	if (it == loadedPipelines.end())
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+	while (true)
 	{
-		PipelineDef *pipeDef = getPipelineDef(defUniqueName);
+		RetainedResource retained;
 
-		ResourcePipelineObject *pipe = new ResourcePipelineObject();
-		pipe->dataLoaded = true;
+		{
+			std::unique_lock<std::mutex> lock(retainedResources_mutex);
+
+			if (retainedResources.size() == 0)
+				break;
 
-		ShaderModule vertShader = renderer->createShaderModule(std::string(pipeDef->vertexShaderFile), SHADER_STAGE_VERTEX_BIT, SHADER_LANGUAGE_GLSL);
-		ShaderModule fragShader = renderer->createShaderModule(std::string(pipeDef->fragmentShaderFile), SHADER_STAGE_FRAGMENT_BIT, SHADER_LANGUAGE_GLSL);
+			const RetainedResource &front = retainedResources.front();
+			bool overBudget = resourceCacheStats.retainedCPUSize > resourceCacheConfig.cpuBudget || resourceCacheStats.retainedVRAMSize > resourceCacheConfig.vramBudget;
+			bool decayed = std::chrono::duration<double>(now - front.returnTime).count() >= resourceCacheConfig.decayTime;
 
-		ShaderModule tessCtrlShader = nullptr, tessEvalShader = nullptr, geomShader = nullptr;
+			if (!evictAll && !overBudget && !decayed)
+				break;
 
-		if (strlen(pipeDef->tessControlShaderFile) != 0)
-			tessCtrlShader = renderer->createShaderModule(std::string(pipeDef->tessControlShaderFile), SHADER_STAGE_TESSELLATION_CONTROL_BIT, SHADER_LANGUAGE_GLSL);
+			retained = front;
 
-		if (strlen(pipeDef->tessEvalShaderFile) != 0)
-			tessEvalShader = renderer->createShaderModule(std::string(pipeDef->tessEvalShaderFile), SHADER_STAGE_TESSELLATION_EVALUATION_BIT, SHADER_LANGUAGE_GLSL);
+			resourceCacheStats.retainedCount --;
+			resourceCacheStats.retainedCPUSize -= retained.cpuSize;
+			resourceCacheStats.retainedVRAMSize -= retained.vramSize;
 
-		if (strlen(pipeDef->geometryShaderFile) != 0)
-			geomShader = renderer->createShaderModule(std::string(pipeDef->geometryShaderFile), SHADER_STAGE_GEOMETRY_BIT, SHADER_LANGUAGE_GLSL);
+			retainedResourcesMap.erase(retained.resource);
+			retainedResources.pop_front();
+		}
 
-		// If only one of the tessellation stages is present
-		if ((tessCtrlShader != nullptr && tessEvalShader == nullptr) || (tessCtrlShader == nullptr && tessEvalShader != nullptr))
+		if (evictRetainedResource(retained))
 		{
-			printf("%s Failed to load pipeline: %s, must have both tessellation control and evaluation shaders, not just one\n", INFO_PREFIX, pipeDef->uniqueName);
-			// TODO Handle failed pipeline case more gracefully
-
-			return nullptr;
+			std::unique_lock<std::mutex> lock(retainedResources_mutex);
+			resourceCacheStats.evictions ++;
 		}
+	}
+}
 
-		const uint32_t ivunt_vertexFormatSize = 44;
+/*
+ * Actually frees a resource that was taken off the retained list. Since the list's lock isn't held in between, the resource
+ * could've been loaded (and maybe even returned) again since, in which case it's left alone.
+ */
+bool ResourceManager::evictRetainedResource (const RetainedResource &retained)
+{
+	auto isRetained = [this](void *resource) -> bool
+	{
+		std::unique_lock<std::mutex> lock(retainedResources_mutex);
+		return retainedResourcesMap.count(resource) > 0;
+	};
 
-		VertexInputBinding meshVertexBindingDesc = {}, instanceVertexBindingDesc = {};
-		meshVertexBindingDesc.binding = 0;
-		meshVertexBindingDesc.stride = ivunt_vertexFormatSize;
-		meshVertexBindingDesc.inputRate = VERTEX_INPUT_RATE_VERTEX;
+	switch (retained.type)
+	{
+		case RETAINED_RESOURCE_TYPE_MESH:
+		{
+			ResourceMesh mesh = static_cast<ResourceMesh>(retained.resource);
+			std::unique_lock<std::mutex> lock(loadedMeshes_mutex);
 
-		instanceVertexBindingDesc.binding = 1;
-		instanceVertexBindingDesc.stride = sizeof(svec4) * 2;
-		instanceVertexBindingDesc.inputRate = VERTEX_INPUT_RATE_INSTANCE;
+			auto it = loadedMeshes.find(getMeshCacheKey(mesh->file, mesh->mesh, mesh->meshFormat, mesh->interlaced));
 
-		std::vector<VertexInputAttrib> attribDesc = std::vector<VertexInputAttrib>(6);
-		attribDesc[0].binding = 0;
-		attribDesc[0].location = 0;
-		attribDesc[0].format = RESOURCE_FORMAT_R32G32B32_SFLOAT;
-		attribDesc[0].offset = 0;
+			if (it == loadedMeshes.end() || it->second.second > 0 || isRetained(mesh))
+				return false;
 
-		attribDesc[1].binding = 0;
-		attribDesc[1].location = 1;
-		attribDesc[1].format = RESOURCE_FORMAT_R32G32_SFLOAT;
-		attribDesc[1].offset = sizeof(glm::vec3);
+			loadedMeshes.erase(it);
 
-		attribDesc[2].binding = 0;
-		attribDesc[2].location = 2;
-		attribDesc[2].format = RESOURCE_FORMAT_R32G32B32_SFLOAT;
-		attribDesc[2].offset = sizeof(glm::vec3) + sizeof(glm::vec2);
+			meshPool->free(mesh->poolAllocation);
 
-		attribDesc[3].binding = 0;
-		attribDesc[3].location = 3;
-		attribDesc[3].format = RESOURCE_FORMAT_R32G32B32_SFLOAT;
-		attribDesc[3].offset = sizeof(glm::vec3) + sizeof(glm::vec2) + sizeof(glm::vec3);
+			meshHandles.release(mesh->handle);
+			delete mesh;
 
-		attribDesc[4].binding = 1;
-		attribDesc[4].location = 4;
-		attribDesc[4].format = RESOURCE_FORMAT_R32G32B32A32_SFLOAT;
-		attribDesc[4].offset = 0;
+			return true;
+		}
+		case RETAINED_RESOURCE_TYPE_TEXTURE:
+		{
+			ResourceTexture tex = static_cast<ResourceTexture>(retained.resource);
+			std::unique_lock<std::mutex> lock(loadedTextures_mutex);
 
-		attribDesc[5].binding = 1;
-		attribDesc[5].location = 5;
-		attribDesc[5].format = RESOURCE_FORMAT_R32G32B32A32_SFLOAT;
-		attribDesc[5].offset = sizeof(svec4);
+			auto it = loadedTextures.find(AssetIDTable::getAssetID(tex->files[0]));
 
-		PipelineVertexInputInfo vertexInput = {};
-		vertexInput.vertexInputAttribs = attribDesc;
-		vertexInput.vertexInputBindings =
-		{	meshVertexBindingDesc, instanceVertexBindingDesc};
+			if (it == loadedTextures.end() || it->second.second > 0 || isRetained(tex))
+				return false;
 
-		PipelineInputAssemblyInfo inputAssembly = {};
-		inputAssembly.primitiveRestart = false;
-		inputAssembly.topology = PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+			loadedTextures.erase(it);
 
-		PipelineViewportInfo viewportInfo = {};
-		viewportInfo.scissors =
-		{
-			{	0, 0, 1920, 1080}};
-		viewportInfo.viewports =
-		{
-			{	0, 0, 1920, 1080}};
+			stopTextureStreaming(tex);
 
-		PipelineRasterizationInfo rastInfo = {};
-		rastInfo.clockwiseFrontFace = pipeDef->clockwiseFrontFace;
-		rastInfo.cullMode = (pipeDef->backfaceCulling ? CULL_MODE_BACK_BIT : 0) | (pipeDef->frontfaceCullilng ? CULL_MODE_FRONT_BIT : 0);
-		rastInfo.lineWidth = 1;
-		rastInfo.polygonMode = POLYGON_MODE_FILL;
-		rastInfo.rasterizerDiscardEnable = false;
-		rastInfo.enableOutOfOrderRasterization = true;
+			if (!tex->loadFailed)
+			{
+				renderer->destroyTexture(tex->texture);
+				renderer->destroyTextureView(tex->textureView);
+			}
 
-		PipelineDepthStencilInfo depthInfo = {};
-		depthInfo.enableDepthTest = true;
-		depthInfo.enableDepthWrite = true;
-		depthInfo.minDepthBounds = 0;
-		depthInfo.maxDepthBounds = 1;
-		depthInfo.depthCompareOp = COMPARE_OP_GREATER;
+			textureHandles.release(tex->handle);
+			delete tex;
 
-		PipelineColorBlendAttachment colorBlendAttachment = {};
-		colorBlendAttachment.blendEnable = false;
-		colorBlendAttachment.colorWriteMask = COLOR_COMPONENT_R_BIT | COLOR_COMPONENT_G_BIT | COLOR_COMPONENT_B_BIT | COLOR_COMPONENT_A_BIT;
+			return true;
+		}
+		case RETAINED_RESOURCE_TYPE_MATERIAL:
+		{
+			ResourceMaterial mat = static_cast<ResourceMaterial>(retained.resource);
 
-		PipelineColorBlendInfo colorBlend = {};
-		colorBlend.attachments =
-		{	colorBlendAttachment, colorBlendAttachment};
-		colorBlend.logicOpEnable = false;
-		colorBlend.logicOp = LOGIC_OP_COPY;
-		colorBlend.blendConstants[0] = 1.0f;
-		colorBlend.blendConstants[1] = 1.0f;
-		colorBlend.blendConstants[2] = 1.0f;
-		colorBlend.blendConstants[3] = 1.0f;
+			auto it = loadedMaterials.find(AssetIDTable::getAssetID(mat->defUniqueName));
 
-		PipelineDynamicStateInfo dynamicState = {};
-		dynamicState.dynamicStates =
-		{	DYNAMIC_STATE_VIEWPORT, DYNAMIC_STATE_SCISSOR};
+			if (it == loadedMaterials.end() || it->second.second > 0 || isRetained(mat))
+				return false;
 
-		GraphicsPipelineInfo info = {};
+			loadedMaterials.erase(it);
 
-		PipelineShaderStage vertShaderStage = {};
-		vertShaderStage.entry = "main";
-		vertShaderStage.module = vertShader;
+			mainThreadDescriptorPool->freeDescriptorSet(mat->descriptorSet);
+			renderer->destroySampler(mat->sampler);
 
-		PipelineShaderStage fragShaderStage = {};
-		fragShaderStage.entry = "main";
-		fragShaderStage.module = fragShader;
+			for (size_t i = 0; i < mat->usedTextureCount; i ++)
+				if (mat->textures[i] != nullptr)
+					returnTexture(mat->textures[i]);
 
-		// Note if you change the index of the frag shader, replace the index in if (pipeDef->canRenderDepth) {..}
-		info.stages =
-		{	vertShaderStage, fragShaderStage};
+			materialHandles.release(mat->handle);
+			delete mat;
 
-		if (tessCtrlShader != nullptr)
+			return true;
+		}
+		case RETAINED_RESOURCE_TYPE_STATIC_MESH:
 		{
-			PipelineShaderStage tessCtrlShaderStage = {};
-			tessCtrlShaderStage.entry = "main";
-			tessCtrlShaderStage.module = tessCtrlShader;
+			ResourceStaticMesh mesh = static_cast<ResourceStaticMesh>(retained.resource);
 
-			info.stages.push_back(tessCtrlShaderStage);
-		}
+			auto it = loadedStaticMeshes.find(AssetIDTable::getAssetID(mesh->defUniqueName));
 
-		if (tessEvalShader != nullptr)
-		{
-			PipelineShaderStage tessEvalShaderStage = {};
-			tessEvalShaderStage.entry = "main";
-			tessEvalShaderStage.module = tessEvalShader;
+			if (it == loadedStaticMeshes.end() || it->second.second > 0 || isRetained(mesh))
+				return false;
 
-			info.stages.push_back(tessEvalShaderStage);
+			loadedStaticMeshes.erase(it);
 
-			info.tessellationInfo.patchControlPoints = 3;
-		}
+			for (uint32_t lod = 0; lod < mesh->meshLODs.size(); lod ++)
+				returnMesh(mesh->meshLODs[lod].second);
 
-		if (geomShader != nullptr)
-		{
-			PipelineShaderStage geomShaderStage = {};
-			geomShaderStage.entry = "main";
-			geomShaderStage.module = geomShader;
+			staticMeshHandles.release(mesh->handle);
+			delete mesh;
 
-			info.stages.push_back(geomShaderStage);
+			return true;
 		}
+		default:
+			return false;
+	}
+}
 
-		info.vertexInputInfo = vertexInput;
-		info.inputAssemblyInfo = inputAssembly;
-		info.viewportInfo = viewportInfo;
-		info.rasterizationInfo = rastInfo;
-		info.depthStencilInfo = depthInfo;
-		info.colorBlendInfo = colorBlend;
-		info.dynamicStateInfo = dynamicState;
+/*
+ * Loads every def in a game defs file, either from it's cooked version if there is one (see cookGameDefsFile()),
+ * or from the text form (see parseGameDefsText()). The defs from a cooked file are copied out of the mapping in
+ * one go per type of def, and the def maps are grown once up front, so even thousands of defs load quickly.
+ * Defs w/ the same unique name as one that's already loaded replace it, same as the add*Def() functions.
+ */
+bool ResourceManager::loadGameDefsFile (const std::string &file)
+{
+	std::string cookedFile = getCookedGameDefsFile(file);
+	std::unique_ptr<GameDefs> defs(new GameDefs());
+	bool loaded = false;
 
-		std::vector<DescriptorSetLayoutBinding> layoutBindings;
-		layoutBindings.push_back({0, DESCRIPTOR_TYPE_SAMPLER, 1, SHADER_STAGE_FRAGMENT_BIT});
-		layoutBindings.push_back({1, DESCRIPTOR_TYPE_SAMPLED_IMAGE, 8, SHADER_STAGE_FRAGMENT_BIT});
+	if (FileLoader::instance()->fileExists(cookedFile))
+	{
+		FileView cookedView = FileLoader::instance()->openFileView(cookedFile);
+		loaded = readCookedGameDefs(cookedView.data(), cookedView.size(), cookedFile, *defs);
 
-		info.inputPushConstantRanges = {{0, sizeof(glm::mat4) + sizeof(glm::vec4) + sizeof(glm::vec4), SHADER_STAGE_VERTEX_BIT}};
-		info.inputSetLayouts = {layoutBindings};
+		if (!loaded)
+			*defs = GameDefs();
+	}
 
-		pipe->pipeline = renderer->createGraphicsPipeline(info, pipelineRenderPass, 0);
-		pipe->depthPipeline = nullptr;
+	// A broken cooked file falls back to the text form, if there is one
+	if (!loaded && cookedFile != file)
+	{
+		FileView textView = FileLoader::instance()->openFileView(file);
+		loaded = textView.isValid() && parseGameDefsText(textView.data(), textView.size(), file, *defs);
+	}
 
-		if (pipeDef->canRenderDepth)
-		{
-			ShaderModule shadowFragShader = renderer->createShaderModule(std::string(pipeDef->shadows_fragmentShaderFile), SHADER_STAGE_FRAGMENT_BIT, SHADER_LANGUAGE_GLSL);
-			fragShaderStage.module = shadowFragShader;
+	if (!loaded)
+	{
+		printf("%s Failed to load game defs file: %s\n", ERR_PREFIX, file.c_str());
 
-			// Should probably do this better
-			info.rasterizationInfo.clockwiseFrontFace = !info.rasterizationInfo.clockwiseFrontFace;
-			info.stages[1].module = shadowFragShader;
-			info.depthStencilInfo.depthCompareOp = COMPARE_OP_LESS;
+		return false;
+	}
 
-			pipe->depthPipeline = renderer->createGraphicsPipeline(info, pipelineShadowRenderPass, 0);
+	loadedMaterialDefsMap.reserve(loadedMaterialDefsMap.size() + defs->materialDefs.size());
+	loadedPipelineDefsMap.reserve(loadedPipelineDefsMap.size() + defs->pipelineDefs.size());
+	loadedMeshDefsMap.reserve(loadedMeshDefsMap.size() + defs->meshDefs.size());
+	loadedLevelDefsMap.reserve(loadedLevelDefsMap.size() + defs->levelDefs.size());
 
-			renderer->destroyShaderModule(shadowFragShader);
-		}
+	for (size_t i = 0; i < defs->materialDefs.size(); i ++)
+		loadedMaterialDefsMap[AssetIDTable::getAssetID(defs->materialDefs[i].uniqueName)] = &defs->materialDefs[i];
 
-		renderer->destroyShaderModule(vertShader);
-		renderer->destroyShaderModule(fragShader);
+	for (size_t i = 0; i < defs->pipelineDefs.size(); i ++)
+		loadedPipelineDefsMap[AssetIDTable::getAssetID(defs->pipelineDefs[i].uniqueName)] = &defs->pipelineDefs[i];
 
-		if (tessCtrlShader != nullptr)
-			renderer->destroyShaderModule(tessCtrlShader);
+	for (size_t i = 0; i < defs->meshDefs.size(); i ++)
+	{
+		generateMeshDefLODs(defs->meshDefs[i]);
 
-		if (tessEvalShader != nullptr)
-			renderer->destroyShaderModule(tessEvalShader);
+		loadedMeshDefsMap[AssetIDTable::getAssetID(defs->meshDefs[i].uniqueName)] = &defs->meshDefs[i];
+	}
 
-		if (geomShader != nullptr)
-			renderer->destroyShaderModule(geomShader);
+	for (size_t i = 0; i < defs->levelDefs.size(); i ++)
+		loadedLevelDefsMap[AssetIDTable::getAssetID(defs->levelDefs[i].uniqueName)] = &defs->levelDefs[i];
 
-		loadedPipelines[stringHash(defUniqueName)] = std::make_pair(pipe, 1);
+	printf("%s Loaded %u material, %u pipeline, %u static mesh, and %u level defs from: %s\n", INFO_PREFIX, (uint32_t) defs->materialDefs.size(), (uint32_t) defs->pipelineDefs.size(), (uint32_t) defs->meshDefs.size(), (uint32_t) defs->levelDefs.size(), file.c_str());
 
-		return pipe;
-	}
-	else
-	{
-		it->second.second ++;
+	loadedGameDefs.push_back(std::move(defs));
 
-		return it->second.first;
-	}
+	return true;
 }
 
-ResourcePipeline ResourceManager::findPipeline (const std::string &defUniqueName)
+/*
+ * Cooks the text form of a game defs file into the binary form described by CookedGameDefsHeader. The cooked file is
+ * written next to the source file in the working directory (see getCookedGameDefsFile()), and loadGameDefsFile() loads
+ * it instead of the text form from then on. Like the other cooked files, it isn't checked against it's source.
+ */
+bool ResourceManager::cookGameDefsFile (const std::string &file)
 {
-	return findPipeline(stringHash(defUniqueName));
+	FileView textView = FileLoader::instance()->openFileView(file);
+
+	if (!textView.isValid())
+	{
+		printf("%s Failed to cook game defs file: %s, couldn't open it\n", ERR_PREFIX, file.c_str());
+
+		return false;
+	}
+
+	GameDefs defs;
+
+	if (!parseGameDefsText(textView.data(), textView.size(), file, defs))
+		return false;
+
+	if (!writeCookedGameDefsFile(FileLoader::instance()->getWorkingDir() + getCookedGameDefsFile(file), defs))
+		return false;
+
+	printf("%s Cooked %u material, %u pipeline, %u static mesh, and %u level defs from: %s\n", INFO_PREFIX, (uint32_t) defs.materialDefs.size(), (uint32_t) defs.pipelineDefs.size(), (uint32_t) defs.meshDefs.size(), (uint32_t) defs.levelDefs.size(), file.c_str());
+
+	return true;
 }
 
-ResourcePipeline ResourceManager::findPipeline (size_t defUniqueNameHash)
+/*
+ * Gets the name of the cooked version of a game defs file, e.g. "GameData/defs/game.defs" turns into
+ * "GameData/defs/game.defs.sdefs". A file that's already cooked is returned as is.
+ */
+std::string ResourceManager::getCookedGameDefsFile (const std::string &file)
 {
-	auto it = loadedPipelines.find(defUniqueNameHash);
+	std::string cookedExt = COOKED_GAME_DEFS_EXTENSION;
 
-	return it != loadedPipelines.end() ? it->second.first : nullptr;
+	if (file.length() > cookedExt.length() && file.compare(file.length() - cookedExt.length(), cookedExt.length(), cookedExt) == 0)
+		return file;
+
+	return file + cookedExt;
 }
 
-void ResourceManager::returnPipeline (const std::string &defUniqueName)
+typedef enum GameDefsTextBlock
 {
-	returnPipeline(stringHash(defUniqueName));
-}
+	GAME_DEFS_TEXT_BLOCK_NONE = 0,
+	GAME_DEFS_TEXT_BLOCK_MATERIAL,
+	GAME_DEFS_TEXT_BLOCK_PIPELINE,
+	GAME_DEFS_TEXT_BLOCK_STATIC_MESH,
+	GAME_DEFS_TEXT_BLOCK_LEVEL
+} GameDefsTextBlock;
 
-void ResourceManager::returnPipeline (size_t defUniqueNameHash)
+/*
+ * Splits a line of a game defs file into tokens on whitespace. Tokens can be quoted to have spaces in them (or to be
+ * empty), and anything after a '#' that isn't in quotes is a comment.
+ */
+inline std::vector<std::string> tokenizeGameDefsLine (const std::string &line)
 {
-	auto it = loadedPipelines.find(defUniqueNameHash);
+	std::vector<std::string> tokens;
+	size_t i = 0;
 
-	if (it != loadedPipelines.end())
+	while (i < line.length())
 	{
-		// Decrement the reference counter
-		it->second.second --;
+		if (isspace((unsigned char) line[i]))
+		{
+			i ++;
 
-		// If the reference counter is now zero, then delete the pipeline entirely
-		if (it->second.second == 0)
+			continue;
+		}
+
+		if (line[i] == '#')
+			break;
+
+		if (line[i] == '"')
 		{
-			ResourcePipeline pipeline = it->second.first;
+			size_t end = line.find('"', i + 1);
 
-			renderer->destroyPipeline(pipeline->pipeline);
-			renderer->destroyPipeline(pipeline->depthPipeline);
+			if (end == std::string::npos)
+				end = line.length();
 
-			delete pipeline;
+			tokens.push_back(line.substr(i + 1, end - i - 1));
+			i = end + 1;
+		}
+		else
+		{
+			size_t start = i;
 
-			loadedPipelines.erase(it);
+			while (i < line.length() && !isspace((unsigned char) line[i]))
+				i ++;
+
+			tokens.push_back(line.substr(start, i - start));
 		}
 	}
+
+	return tokens;
 }
 
-void ResourceManager::addLevelDef (const LevelDef &def)
+inline bool copyGameDefsString (char *dst, size_t dstSize, const std::string &src)
 {
-	LevelDef *levelDef = new LevelDef();
-	*levelDef = def;
+	if (src.length() >= dstSize)
+		return false;
+
+	memcpy(dst, src.c_str(), src.length() + 1);
 
-	loadedLevelDefsMap[stringHash(std::string(def.uniqueName))] = levelDef;
+	return true;
 }
 
-void ResourceManager::addMaterialDef (const MaterialDef &def)
+inline bool parseGameDefsBool (const std::string &token, bool &value)
 {
-	MaterialDef *matDef = new MaterialDef();
-	*matDef = def;
+	if (token == "true" || token == "1")
+		value = true;
+	else if (token == "false" || token == "0")
+		value = false;
+	else
+		return false;
 
-	loadedMaterialDefsMap[stringHash(std::string(def.uniqueName))] = matDef;
+	return true;
 }
 
-void ResourceManager::addMeshDef (const StaticMeshDef &def)
+inline bool parseGameDefsFloat (const std::string &token, float &value)
 {
-	StaticMeshDef *meshDef = new StaticMeshDef();
-	*meshDef = def;
+	char *end = nullptr;
+	value = strtof(token.c_str(), &end);
 
-	loadedMeshDefsMap[stringHash(std::string(def.uniqueName))] = meshDef;
+	return end != token.c_str() && *end == '\0';
 }
 
-void ResourceManager::addPipelineDef (const PipelineDef &def)
+inline bool parseGameDefsUInt (const std::string &token, uint32_t &value)
 {
-	PipelineDef *pipeDef = new PipelineDef();
-	*pipeDef = def;
+	char *end = nullptr;
+	value = (uint32_t) strtoul(token.c_str(), &end, 10);
 
-	loadedPipelineDefsMap[stringHash(std::string(def.uniqueName))] = pipeDef;
+	return end != token.c_str() && *end == '\0';
 }
 
-LevelDef *ResourceManager::getLevelDef (const std::string &defUniqueName)
+/*
+ * Parses the text form of a game defs file. Each def is a block that starts w/ it's type and unique name, has
+ * one property per line, and ends w/ "end", e.g.
+ *
+ *	material dirt
+ *		pipeline engine.defaultMaterial
+ *		texture GameData/textures/dirt/dirt-albedo.png
+ *		addressMode repeat
+ *	end
+ *
+ *	staticMesh "LOD Test"
+ *		lod GameData/models/lod-test.dae Cube 250
+ *		generatedLODs 2
+ *	end
+ *
+ * The properties of each type are:
+ *  - material: pipeline, texture (once per texture, in order), anisotropy, linearFiltering, linearMipmapFiltering,
+ *    addressMode (repeat, mirroredRepeat, or clampToEdge)
+ *  - pipeline: vertexShader, tessControlShader, tessEvalShader, geometryShader, fragmentShader, shadowsFragmentShader,
+ *    clockwiseFrontFace, backfaceCulling, frontfaceCulling, canRenderDepth
+ *  - staticMesh: lod <file> <mesh> <max_dist> (once per LOD), generatedLODs, generatedLODTriangleRatio,
+ *    generatedLODMaxError, generatedLODDistRatio
+ *  - level: file
+ *
+ * Anything that's left out is zeroed, the same as a def that's made w/ "= {}" in code.
+ */
+bool ResourceManager::parseGameDefsText (const char *text, size_t textSize, const std::string &file, GameDefs &defs)
 {
-	return getLevelDef(stringHash(defUniqueName));
-}
+	GameDefsTextBlock block = GAME_DEFS_TEXT_BLOCK_NONE;
+	uint32_t materialTextureCount = 0;
+	uint32_t lineNumber = 0;
+	size_t lineStart = 0;
 
-MaterialDef *ResourceManager::getMaterialDef (const std::string &defUniqueName)
-{
-	return getMaterialDef(stringHash(defUniqueName));
-}
+	while (lineStart < textSize)
+	{
+		size_t lineEnd = lineStart;
 
-StaticMeshDef *ResourceManager::getMeshDef (const std::string &defUniqueName)
-{
-	return getMeshDef(stringHash(defUniqueName));
-}
+		while (lineEnd < textSize && text[lineEnd] != '\n')
+			lineEnd ++;
 
-PipelineDef *ResourceManager::getPipelineDef (const std::string &defUniqueName)
-{
-	return getPipelineDef(stringHash(defUniqueName));
-}
+		std::string line(text + lineStart, lineEnd - lineStart);
+		std::vector<std::string> tokens = tokenizeGameDefsLine(line);
 
-LevelDef *ResourceManager::getLevelDef (size_t uniqueNameHash)
-{
-	auto it = loadedLevelDefsMap.find(uniqueNameHash);
+		lineStart = lineEnd + 1;
+		lineNumber ++;
 
-	if (it != loadedLevelDefsMap.end())
-		return it->second;
+		if (tokens.size() == 0)
+			continue;
 
-	return nullptr;
-}
+		const std::string &key = tokens[0];
+		bool valid = true;
 
-MaterialDef *ResourceManager::getMaterialDef (size_t uniqueNameHash)
-{
-	auto it = loadedMaterialDefsMap.find(uniqueNameHash);
+		if (block == GAME_DEFS_TEXT_BLOCK_NONE)
+		{
+			if (tokens.size() != 2)
+			{
+				valid = false;
+			}
+			else if (key == "material")
+			{
+				defs.materialDefs.push_back(MaterialDef());
+				valid = copyGameDefsString(defs.materialDefs.back().uniqueName, RESOURCE_DEF_MAX_NAME_LENGTH, tokens[1]);
+				block = GAME_DEFS_TEXT_BLOCK_MATERIAL;
+				materialTextureCount = 0;
+			}
+			else if (key == "pipeline")
+			{
+				defs.pipelineDefs.push_back(PipelineDef());
+				valid = copyGameDefsString(defs.pipelineDefs.back().uniqueName, RESOURCE_DEF_MAX_NAME_LENGTH, tokens[1]);
+				block = GAME_DEFS_TEXT_BLOCK_PIPELINE;
+			}
+			else if (key == "staticMesh")
+			{
+				defs.meshDefs.push_back(StaticMeshDef());
+				valid = copyGameDefsString(defs.meshDefs.back().uniqueName, RESOURCE_DEF_MAX_NAME_LENGTH, tokens[1]);
+				block = GAME_DEFS_TEXT_BLOCK_STATIC_MESH;
+			}
+			else if (key == "level")
+			{
+				defs.levelDefs.push_back(LevelDef());
+				valid = copyGameDefsString(defs.levelDefs.back().uniqueName, RESOURCE_DEF_MAX_NAME_LENGTH, tokens[1]);
+				block = GAME_DEFS_TEXT_BLOCK_LEVEL;
+			}
+			else
+			{
+				valid = false;
+			}
+		}
+		else if (key == "end")
+		{
+			valid = tokens.size() == 1;
+			block = GAME_DEFS_TEXT_BLOCK_NONE;
+		}
+		else if (block == GAME_DEFS_TEXT_BLOCK_STATIC_MESH && key == "lod")
+		{
+			StaticMeshDef &def = defs.meshDefs.back();
+			float maxDist = 0.0f;
 
-	if (it != loadedMaterialDefsMap.end())
-		return it->second;
+			valid = tokens.size() == 4 && parseGameDefsFloat(tokens[3], maxDist);
 
-	return nullptr;
-}
+			if (valid)
+			{
+				def.meshLODFiles.push_back(tokens[1]);
+				def.meshLODNames.push_back(tokens[2]);
+				def.meshLODMaxDists.push_back(maxDist);
+			}
+		}
+		else if (tokens.size() != 2)
+		{
+			valid = false;
+		}
+		else if (block == GAME_DEFS_TEXT_BLOCK_MATERIAL)
+		{
+			MaterialDef &def = defs.materialDefs.back();
+			const std::string &value = tokens[1];
+
+			if (key == "pipeline")
+				valid = copyGameDefsString(def.pipelineUniqueName, RESOURCE_DEF_MAX_NAME_LENGTH, value);
+			else if (key == "texture")
+				valid = materialTextureCount < MATERIAL_DEF_MAX_TEXTURE_NUM && copyGameDefsString(def.textureFiles[materialTextureCount ++], RESOURCE_DEF_MAX_FILE_LENGTH, value);
+			else if (key == "anisotropy")
+				valid = parseGameDefsBool(value, def.enableAnisotropy);
+			else if (key == "linearFiltering")
+				valid = parseGameDefsBool(value, def.linearFiltering);
+			else if (key == "linearMipmapFiltering")
+				valid = parseGameDefsBool(value, def.linearMipmapFiltering);
+			else if (key == "addressMode" && value == "repeat")
+				def.addressMode = SAMPLER_ADDRESS_MODE_REPEAT;
+			else if (key == "addressMode" && value == "mirroredRepeat")
+				def.addressMode = SAMPLER_ADDRESS_MODE_MIRRORED_REPEAT;
+			else if (key == "addressMode" && value == "clampToEdge")
+				def.addressMode = SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+			else
+				valid = false;
+		}
+		else if (block == GAME_DEFS_TEXT_BLOCK_PIPELINE)
+		{
+			PipelineDef &def = defs.pipelineDefs.back();
+			const std::string &value = tokens[1];
+
+			if (key == "vertexShader")
+				valid = copyGameDefsString(def.vertexShaderFile, RESOURCE_DEF_MAX_FILE_LENGTH, value);
+			else if (key == "tessControlShader")
+				valid = copyGameDefsString(def.tessControlShaderFile, RESOURCE_DEF_MAX_FILE_LENGTH, value);
+			else if (key == "tessEvalShader")
+				valid = copyGameDefsString(def.tessEvalShaderFile, RESOURCE_DEF_MAX_FILE_LENGTH, value);
+			else if (key == "geometryShader")
+				valid = copyGameDefsString(def.geometryShaderFile, RESOURCE_DEF_MAX_FILE_LENGTH, value);
+			else if (key == "fragmentShader")
+				valid = copyGameDefsString(def.fragmentShaderFile, RESOURCE_DEF_MAX_FILE_LENGTH, value);
+			else if (key == "shadowsFragmentShader")
+				valid = copyGameDefsString(def.shadows_fragmentShaderFile, RESOURCE_DEF_MAX_FILE_LENGTH, value);
+			else if (key == "clockwiseFrontFace")
+				valid = parseGameDefsBool(value, def.clockwiseFrontFace);
+			else if (key == "backfaceCulling")
+				valid = parseGameDefsBool(value, def.backfaceCulling);
+			else if (key == "frontfaceCulling")
+				valid = parseGameDefsBool(value, def.frontfaceCullilng);
+			else if (key == "canRenderDepth")
+				valid = parseGameDefsBool(value, def.canRenderDepth);
+			else
+				valid = false;
+		}
+		else if (block == GAME_DEFS_TEXT_BLOCK_STATIC_MESH)
+		{
+			StaticMeshDef &def = defs.meshDefs.back();
+			const std::string &value = tokens[1];
+
+			if (key == "generatedLODs")
+				valid = parseGameDefsUInt(value, def.generatedLODCount);
+			else if (key == "generatedLODTriangleRatio")
+				valid = parseGameDefsFloat(value, def.generatedLODTriangleRatio);
+			else if (key == "generatedLODMaxError")
+				valid = parseGameDefsFloat(value, def.generatedLODMaxError);
+			else if (key == "generatedLODDistRatio")
+				valid = parseGameDefsFloat(value, def.generatedLODDistRatio);
+			else
+				valid = false;
+		}
+		else if (block == GAME_DEFS_TEXT_BLOCK_LEVEL)
+		{
+			LevelDef &def = defs.levelDefs.back();
 
-StaticMeshDef *ResourceManager::getMeshDef (size_t uniqueNameHash)
-{
-	auto it = loadedMeshDefsMap.find(uniqueNameHash);
+			if (key == "file")
+				valid = copyGameDefsString(def.fileName, RESOURCE_DEF_MAX_FILE_LENGTH, tokens[1]);
+			else
+				valid = false;
+		}
 
-	if (it != loadedMeshDefsMap.end())
-		return it->second;
+		if (!valid)
+		{
+			printf("%s Failed to parse game defs file: %s, invalid or unknown line %u: %s\n", ERR_PREFIX, file.c_str(), lineNumber, line.c_str());
 
-	return nullptr;
-}
+			return false;
+		}
+	}
 
-PipelineDef *ResourceManager::getPipelineDef (size_t uniqueNameHash)
-{
-	auto it = loadedPipelineDefsMap.find(uniqueNameHash);
+	if (block != GAME_DEFS_TEXT_BLOCK_NONE)
+	{
+		printf("%s Failed to parse game defs file: %s, the last def is missing it's \"end\"\n", ERR_PREFIX, file.c_str());
 
-	if (it != loadedPipelineDefsMap.end())
-		return it->second;
+		return false;
+	}
 
-	return nullptr;
+	return true;
 }
 
 /*
- * Loads a mesh resource, complete with rendering data. This function is thread safe if called ONLY on the main thread,
- * and note that it might busy wait if the resource has already been requested to be loaded, but the
- * actual file loading/formatting has been pushed to a worker thread. Also note that this function
- * WILL return a valid and immediately usuable mesh resource, and will load from a cache if possible.
- * Preferably, and for explicit multithreading, or to load a mesh from another thread other than the main thread, use
- * the other in-built function(s). This function is NOT the most optimized out of all the other built-ins.
- *
- * This function loads mesh data in a format optimized for rendering, as specified in the function.
+ * Reads the defs out of a cooked game defs file. Level defs are copied out w/ a single resize & memcpy, the rest are
+ * converted one by one from their cooked structs, since the static mesh defs' LOD lists are vectors and the bools in the
+ * material & pipeline defs are stored as bytes (any byte that isn't 0 reads as true).
  */
-ResourceMesh ResourceManager::loadMeshImmediate (const std::string &file, const std::string &mesh)
+bool ResourceManager::readCookedGameDefs (const char *data, size_t dataSize, const std::string &file, GameDefs &defs)
 {
-	std::unique_lock<std::mutex> lock(loadedMeshes_mutex);
+	if (dataSize < sizeof(CookedGameDefsHeader))
+	{
+		printf("%s Failed to load cooked game defs: %s, file is too small to be a cooked game defs file\n", ERR_PREFIX, file.c_str());
 
-	const MeshDataFormat rendererOptimizedMeshFormat = MESH_DATA_FORMAT_IVUNT;
+		return false;
+	}
 
-	auto it = loadedMeshes.find(std::make_tuple(file, mesh, rendererOptimizedMeshFormat, true));
+	const CookedGameDefsHeader &header = *reinterpret_cast<const CookedGameDefsHeader*>(data);
 
-	if (it == loadedMeshes.end())
+	if (header.magic != COOKED_GAME_DEFS_MAGIC_NUM || header.version != COOKED_GAME_DEFS_VERSION)
 	{
-		ResourceMeshObject *meshRes = new ResourceMeshObject();
-		meshRes->file = file;
-		meshRes->mesh = mesh;
-		meshRes->meshFormat = rendererOptimizedMeshFormat;
-		meshRes->interlaced = true;
-		meshRes->dataLoaded = true;
+		printf("%s Failed to load cooked game defs: %s, invalid magic number or version (got %8x v%u, should be %8x v%u)\n", ERR_PREFIX, file.c_str(), header.magic, header.version, COOKED_GAME_DEFS_MAGIC_NUM, COOKED_GAME_DEFS_VERSION);
 
-		ResourceMeshData rawMeshData = loadRawMeshData(file, mesh);
-		std::vector<char> formattedData = getFormattedMeshData(rawMeshData, rendererOptimizedMeshFormat, meshRes->indexChunkSize, meshRes->vertexStride, true);
+		return false;
+	}
 
-		meshRes->faceCount = rawMeshData.faceCount;
-		meshRes->uses32bitIndices = rawMeshData.uses32BitIndices;
+	if (header.materialDefSize != sizeof(CookedGameDefsMaterialDef) || header.pipelineDefSize != sizeof(CookedGameDefsPipelineDef) || header.levelDefSize != sizeof(LevelDef))
+	{
+		printf("%s Failed to load cooked game defs: %s, it was cooked w/ different def structs, it has to be re-cooked\n", ERR_PREFIX, file.c_str());
 
-		StagingBuffer vertexStagingBuffer = renderer->createAndFillStagingBuffer(formattedData.size() - meshRes->indexChunkSize, formattedData.data() + meshRes->indexChunkSize);
-		StagingBuffer indexStagingBuffer = renderer->createAndFillStagingBuffer(meshRes->indexChunkSize, formattedData.data());
+		return false;
+	}
 
-		meshRes->meshVertexBuffer = renderer->createBuffer(formattedData.size(), BUFFER_USAGE_VERTEX_BUFFER, true, false, MEMORY_USAGE_GPU_ONLY, false);
-		meshRes->meshIndexBuffer = renderer->createBuffer(formattedData.size(), BUFFER_USAGE_INDEX_BUFFER, true, false, MEMORY_USAGE_GPU_ONLY, false);
+	auto arrayInBounds = [dataSize](uint64_t offset, uint64_t count, uint64_t elementSize) -> bool
+	{
+		return offset <= dataSize && count <= (dataSize - offset) / elementSize;
+	};
 
-		CommandBuffer cmdBuffer = renderer->beginSingleTimeCommand(mainThreadTransferCommandPool);
-		cmdBuffer->stageBuffer(vertexStagingBuffer, meshRes->meshVertexBuffer);
-		cmdBuffer->stageBuffer(indexStagingBuffer, meshRes->meshIndexBuffer);
-		renderer->endSingleTimeCommand(cmdBuffer, mainThreadTransferCommandPool, QUEUE_TYPE_GRAPHICS);
+	if (!arrayInBounds(header.materialDefsOffset, header.materialDefCount, sizeof(CookedGameDefsMaterialDef)) || !arrayInBounds(header.pipelineDefsOffset, header.pipelineDefCount, sizeof(CookedGameDefsPipelineDef))
+			|| !arrayInBounds(header.meshDefsOffset, header.meshDefCount, sizeof(CookedGameDefsMeshDef)) || !arrayInBounds(header.meshLODsOffset, header.meshLODCount, sizeof(CookedGameDefsMeshLOD))
+			|| !arrayInBounds(header.levelDefsOffset, header.levelDefCount, sizeof(LevelDef)) || !arrayInBounds(header.stringTableOffset, header.stringTableSize, 1)
+			|| (header.stringTableSize > 0 && data[header.stringTableOffset + header.stringTableSize - 1] != '\0'))
+	{
+		printf("%s Failed to load cooked game defs: %s, the file is truncated or corrupt\n", ERR_PREFIX, file.c_str());
 
-		renderer->destroyStagingBuffer(vertexStagingBuffer);
-		renderer->destroyStagingBuffer(indexStagingBuffer);
+		return false;
+	}
 
-		/*
-		 * I'm formatting the debug name to trim it to the "GameData/meshes/" directory. For example:
-		 * "GameData/meshes/blah.fbx" would turn to ".../blah.fbx""
-		 */
+	defs.levelDefs.resize(header.levelDefCount);
+	memcpy(defs.levelDefs.data(), data + header.levelDefsOffset, header.levelDefCount * sizeof(LevelDef));
 
-		size_t i = file.find("/meshes/");
+	const CookedGameDefsMaterialDef *cookedMaterialDefs = reinterpret_cast<const CookedGameDefsMaterialDef*>(data + header.materialDefsOffset);
+	const CookedGameDefsPipelineDef *cookedPipelineDefs = reinterpret_cast<const CookedGameDefsPipelineDef*>(data + header.pipelineDefsOffset);
 
-		std::string debugMarkerName = ".../";
+	defs.materialDefs.resize(header.materialDefCount);
 
-		if (i != file.npos)
-			debugMarkerName += file.substr(i + 8);
-		else
-			debugMarkerName = file;
+	for (uint32_t i = 0; i < header.materialDefCount; i ++)
+	{
+		const CookedGameDefsMaterialDef &cookedDef = cookedMaterialDefs[i];
+		MaterialDef &def = defs.materialDefs[i];
 
-		renderer->setObjectDebugName(meshRes->meshVertexBuffer, OBJECT_TYPE_BUFFER, debugMarkerName + "V[" + mesh + "]");
-		renderer->setObjectDebugName(meshRes->meshIndexBuffer, OBJECT_TYPE_BUFFER, debugMarkerName + "I[" + mesh + "]");
+		if (cookedDef.addressMode > SAMPLER_ADDRESS_MODE_MIRROR_CLAMP_TO_EDGE)
+		{
+			printf("%s Failed to load cooked game defs: %s, the file is truncated or corrupt\n", ERR_PREFIX, file.c_str());
 
-		loadedMeshes[std::make_tuple(file, mesh, rendererOptimizedMeshFormat, true)] = std::make_pair(meshRes, 1);
+			return false;
+		}
 
-		return meshRes;
+		memcpy(def.uniqueName, cookedDef.uniqueName, sizeof(def.uniqueName));
+		memcpy(def.textureFiles, cookedDef.textureFiles, sizeof(def.textureFiles));
+		memcpy(def.pipelineUniqueName, cookedDef.pipelineUniqueName, sizeof(def.pipelineUniqueName));
+		def.addressMode = (SamplerAddressMode) cookedDef.addressMode;
+		def.enableAnisotropy = cookedDef.enableAnisotropy != 0;
+		def.linearFiltering = cookedDef.linearFiltering != 0;
+		def.linearMipmapFiltering = cookedDef.linearMipmapFiltering != 0;
 	}
-	else
-	{
-		// Increment the reference counter
-		it->second.second ++;
 
-		// If the mesh object is loaded, but it's data isn't, then wait until it is
-		// This usually happens when one thread pushes loading to another thread, and so
-		// the object is created, but the loading hasn't finished yet
-		while (it->second.first->dataLoaded == false)
-		{
-			std::this_thread::yield();
-		}
+	defs.pipelineDefs.resize(header.pipelineDefCount);
 
-		return it->second.first;
+	for (uint32_t i = 0; i < header.pipelineDefCount; i ++)
+	{
+		const CookedGameDefsPipelineDef &cookedDef = cookedPipelineDefs[i];
+		PipelineDef &def = defs.pipelineDefs[i];
+
+		memcpy(def.uniqueName, cookedDef.uniqueName, sizeof(def.uniqueName));
+		memcpy(def.vertexShaderFile, cookedDef.vertexShaderFile, sizeof(def.vertexShaderFile));
+		memcpy(def.tessControlShaderFile, cookedDef.tessControlShaderFile, sizeof(def.tessControlShaderFile));
+		memcpy(def.tessEvalShaderFile, cookedDef.tessEvalShaderFile, sizeof(def.tessEvalShaderFile));
+		memcpy(def.geometryShaderFile, cookedDef.geometryShaderFile, sizeof(def.geometryShaderFile));
+		memcpy(def.fragmentShaderFile, cookedDef.fragmentShaderFile, sizeof(def.fragmentShaderFile));
+		memcpy(def.shadows_fragmentShaderFile, cookedDef.shadows_fragmentShaderFile, sizeof(def.shadows_fragmentShaderFile));
+		def.clockwiseFrontFace = cookedDef.clockwiseFrontFace != 0;
+		def.backfaceCulling = cookedDef.backfaceCulling != 0;
+		def.frontfaceCullilng = cookedDef.frontfaceCullilng != 0;
+		def.canRenderDepth = cookedDef.canRenderDepth != 0;
 	}
-}
 
-/*
- * Returns an owner's possession of a mesh. Essentially just decrements the
- * reference counter for the resource, and deletes it if there's none left.
- */
-void ResourceManager::returnMesh (ResourceMesh mesh)
-{
-	std::unique_lock<std::mutex> lock(loadedMeshes_mutex);
+	const CookedGameDefsMeshDef *cookedMeshDefs = reinterpret_cast<const CookedGameDefsMeshDef*>(data + header.meshDefsOffset);
+	const CookedGameDefsMeshLOD *cookedMeshLODs = reinterpret_cast<const CookedGameDefsMeshLOD*>(data + header.meshLODsOffset);
+	const char *stringTable = data + header.stringTableOffset;
 
-	auto it = loadedMeshes.find(std::make_tuple(mesh->file, mesh->mesh, mesh->meshFormat, mesh->interlaced));
+	defs.meshDefs.resize(header.meshDefCount);
 
-	if (it != loadedMeshes.end())
+	for (uint32_t i = 0; i < header.meshDefCount; i ++)
 	{
-		// Decrement the reference counter
-		it->second.second --;
+		const CookedGameDefsMeshDef &cookedDef = cookedMeshDefs[i];
+		StaticMeshDef &def = defs.meshDefs[i];
 
-		// If the reference counter is now zero, then delete the mesh data entirely
-		if (it->second.second == 0)
+		if (cookedDef.firstLOD > header.meshLODCount || cookedDef.lodCount > header.meshLODCount - cookedDef.firstLOD)
 		{
-			loadedMeshes.erase(it);
+			printf("%s Failed to load cooked game defs: %s, the file is truncated or corrupt\n", ERR_PREFIX, file.c_str());
+
+			return false;
+		}
 
-			renderer->destroyBuffer(mesh->meshVertexBuffer);
-			renderer->destroyBuffer(mesh->meshIndexBuffer);
+		memcpy(def.uniqueName, cookedDef.uniqueName, RESOURCE_DEF_MAX_NAME_LENGTH);
+		def.generatedLODCount = cookedDef.generatedLODCount;
+		def.generatedLODTriangleRatio = cookedDef.generatedLODTriangleRatio;
+		def.generatedLODMaxError = cookedDef.generatedLODMaxError;
+		def.generatedLODDistRatio = cookedDef.generatedLODDistRatio;
 
-			delete mesh;
+		def.meshLODFiles.reserve(cookedDef.lodCount);
+		def.meshLODNames.reserve(cookedDef.lodCount);
+		def.meshLODMaxDists.reserve(cookedDef.lodCount);
+
+		for (uint32_t lod = cookedDef.firstLOD; lod < cookedDef.firstLOD + cookedDef.lodCount; lod ++)
+		{
+			const CookedGameDefsMeshLOD &cookedLOD = cookedMeshLODs[lod];
+
+			if (cookedLOD.fileOffset >= header.stringTableSize || cookedLOD.meshOffset >= header.stringTableSize)
+			{
+				printf("%s Failed to load cooked game defs: %s, the file is truncated or corrupt\n", ERR_PREFIX, file.c_str());
+
+				return false;
+			}
+
+			def.meshLODFiles.push_back(std::string(stringTable + cookedLOD.fileOffset));
+			def.meshLODNames.push_back(std::string(stringTable + cookedLOD.meshOffset));
+			def.meshLODMaxDists.push_back(cookedLOD.maxDist);
 		}
 	}
-}
 
-TextureFileFormat inferFileFormat (const std::string &file);
+	return true;
+}
 
-ResourceTexture ResourceManager::loadTextureImmediate (const std::string &file, TextureFileFormat format)
+/*
+ * Writes a set of defs to a cooked game defs file. The generated LODs of the static mesh defs aren't expanded, only
+ * their settings are written, so they're generated at load time the same as w/ the text form. The file is written to
+ * a temp file first and then moved over the old one, so a failed write never leaves a half written file behind.
+ */
+bool ResourceManager::writeCookedGameDefsFile (const std::string &cookedFile, const GameDefs &defs)
 {
-	std::unique_lock<std::mutex> lock(loadedTextures_mutex);
+	std::vector<CookedGameDefsMaterialDef> cookedMaterialDefs(defs.materialDefs.size());
+	std::vector<CookedGameDefsPipelineDef> cookedPipelineDefs(defs.pipelineDefs.size());
 
-	auto it = loadedTextures.find(file);
+	for (size_t i = 0; i < defs.materialDefs.size(); i ++)
+	{
+		const MaterialDef &def = defs.materialDefs[i];
+		CookedGameDefsMaterialDef &cookedDef = cookedMaterialDefs[i];
+
+		memcpy(cookedDef.uniqueName, def.uniqueName, sizeof(cookedDef.uniqueName));
+		memcpy(cookedDef.textureFiles, def.textureFiles, sizeof(cookedDef.textureFiles));
+		memcpy(cookedDef.pipelineUniqueName, def.pipelineUniqueName, sizeof(cookedDef.pipelineUniqueName));
+		cookedDef.addressMode = (uint32_t) def.addressMode;
+		cookedDef.enableAnisotropy = def.enableAnisotropy ? 1 : 0;
+		cookedDef.linearFiltering = def.linearFiltering ? 1 : 0;
+		cookedDef.linearMipmapFiltering = def.linearMipmapFiltering ? 1 : 0;
+	}
 
-	if (it == loadedTextures.end())
+	for (size_t i = 0; i < defs.pipelineDefs.size(); i ++)
 	{
-		ResourceTextureObject *texRes = new ResourceTextureObject();
-		texRes->files = {file};
-		texRes->dataLoaded = true;
-		texRes->arrayLayers = 1;
+		const PipelineDef &def = defs.pipelineDefs[i];
+		CookedGameDefsPipelineDef &cookedDef = cookedPipelineDefs[i];
+
+		memcpy(cookedDef.uniqueName, def.uniqueName, sizeof(cookedDef.uniqueName));
+		memcpy(cookedDef.vertexShaderFile, def.vertexShaderFile, sizeof(cookedDef.vertexShaderFile));
+		memcpy(cookedDef.tessControlShaderFile, def.tessControlShaderFile, sizeof(cookedDef.tessControlShaderFile));
+		memcpy(cookedDef.tessEvalShaderFile, def.tessEvalShaderFile, sizeof(cookedDef.tessEvalShaderFile));
+		memcpy(cookedDef.geometryShaderFile, def.geometryShaderFile, sizeof(cookedDef.geometryShaderFile));
+		memcpy(cookedDef.fragmentShaderFile, def.fragmentShaderFile, sizeof(cookedDef.fragmentShaderFile));
+		memcpy(cookedDef.shadows_fragmentShaderFile, def.shadows_fragmentShaderFile, sizeof(cookedDef.shadows_fragmentShaderFile));
+		cookedDef.clockwiseFrontFace = def.clockwiseFrontFace ? 1 : 0;
+		cookedDef.backfaceCulling = def.backfaceCulling ? 1 : 0;
+		cookedDef.frontfaceCullilng = def.frontfaceCullilng ? 1 : 0;
+		cookedDef.canRenderDepth = def.canRenderDepth ? 1 : 0;
+	}
 
-		if (format == TEXTURE_FILE_FORMAT_MAX_ENUM)
-			format = inferFileFormat(file);
+	std::vector<CookedGameDefsMeshDef> cookedMeshDefs(defs.meshDefs.size());
+	std::vector<CookedGameDefsMeshLOD> cookedMeshLODs;
+	std::string stringTable;
 
-		if (format == TEXTURE_FILE_FORMAT_MAX_ENUM)
+	for (size_t i = 0; i < defs.meshDefs.size(); i ++)
+	{
+		const StaticMeshDef &def = defs.meshDefs[i];
+		CookedGameDefsMeshDef &cookedDef = cookedMeshDefs[i];
+
+		memcpy(cookedDef.uniqueName, def.uniqueName, RESOURCE_DEF_MAX_NAME_LENGTH);
+		cookedDef.firstLOD = (uint32_t) cookedMeshLODs.size();
+		cookedDef.lodCount = (uint32_t) def.meshLODFiles.size();
+		cookedDef.generatedLODCount = def.generatedLODCount;
+		cookedDef.generatedLODTriangleRatio = def.generatedLODTriangleRatio;
+		cookedDef.generatedLODMaxError = def.generatedLODMaxError;
+		cookedDef.generatedLODDistRatio = def.generatedLODDistRatio;
+
+		for (size_t lod = 0; lod < def.meshLODFiles.size(); lod ++)
 		{
-			// If it's still max enum, then we failed to specify/find the format we're supposed to load it in
-			// Therefore, we'll cancel and return a nullptr
-			printf("%s Failed to load texture: %s, couldn't find or isn't a supported file format", ERR_PREFIX, file.c_str());
+			CookedGameDefsMeshLOD cookedLOD = {};
+			cookedLOD.maxDist = def.meshLODMaxDists[lod];
 
-			return nullptr;
-		}
+			cookedLOD.fileOffset = (uint32_t) stringTable.size();
+			stringTable.append(def.meshLODFiles[lod]).push_back('\0');
 
-		switch (format)
-		{
-			case TEXTURE_FILE_FORMAT_PNG:
-				loadPNGTextureData(texRes);
-				break;
-			case TEXTURE_FILE_FORMAT_DDS:
-				loadDDSTextureData(texRes);
-				break;
-			default:
-				break;
+			cookedLOD.meshOffset = (uint32_t) stringTable.size();
+			stringTable.append(def.meshLODNames[lod]).push_back('\0');
+
+			cookedMeshLODs.push_back(cookedLOD);
 		}
+	}
 
-		/*
-		 * I'm formatting the debug name to trim it to the "GameData/textures/" directory. For example:
-		 * "GameData/textures/blah.png" would turn to ".../blah.png""
-		 */
+	CookedGameDefsHeader header = {};
+	header.magic = COOKED_GAME_DEFS_MAGIC_NUM;
+	header.version = COOKED_GAME_DEFS_VERSION;
+	header.materialDefSize = sizeof(CookedGameDefsMaterialDef);
+	header.pipelineDefSize = sizeof(CookedGameDefsPipelineDef);
+	header.levelDefSize = sizeof(LevelDef);
+	header.materialDefCount = (uint32_t) defs.materialDefs.size();
+	header.pipelineDefCount = (uint32_t) defs.pipelineDefs.size();
+	header.meshDefCount = (uint32_t) cookedMeshDefs.size();
+	header.meshLODCount = (uint32_t) cookedMeshLODs.size();
+	header.levelDefCount = (uint32_t) defs.levelDefs.size();
+	header.stringTableSize = (uint32_t) stringTable.size();
+
+	size_t fileSize = sizeof(CookedGameDefsHeader);
+
+	auto placeArray = [&fileSize](size_t arraySize) -> uint64_t
+	{
+		fileSize = (fileSize + COOKED_GAME_DEFS_ALIGNMENT - 1) & ~size_t(COOKED_GAME_DEFS_ALIGNMENT - 1);
+		uint64_t offset = fileSize;
+		fileSize += arraySize;
+
+		return offset;
+	};
+
+	header.materialDefsOffset = placeArray(cookedMaterialDefs.size() * sizeof(CookedGameDefsMaterialDef));
+	header.pipelineDefsOffset = placeArray(cookedPipelineDefs.size() * sizeof(CookedGameDefsPipelineDef));
+	header.meshDefsOffset = placeArray(cookedMeshDefs.size() * sizeof(CookedGameDefsMeshDef));
+	header.meshLODsOffset = placeArray(cookedMeshLODs.size() * sizeof(CookedGameDefsMeshLOD));
+	header.levelDefsOffset = placeArray(defs.levelDefs.size() * sizeof(LevelDef));
+	header.stringTableOffset = placeArray(stringTable.size());
+
+	std::vector<char> fileData(fileSize, 0);
+	memcpy(fileData.data(), &header, sizeof(header));
+	memcpy(fileData.data() + header.materialDefsOffset, cookedMaterialDefs.data(), cookedMaterialDefs.size() * sizeof(CookedGameDefsMaterialDef));
+	memcpy(fileData.data() + header.pipelineDefsOffset, cookedPipelineDefs.data(), cookedPipelineDefs.size() * sizeof(CookedGameDefsPipelineDef));
+	memcpy(fileData.data() + header.meshDefsOffset, cookedMeshDefs.data(), cookedMeshDefs.size() * sizeof(CookedGameDefsMeshDef));
+	memcpy(fileData.data() + header.meshLODsOffset, cookedMeshLODs.data(), cookedMeshLODs.size() * sizeof(CookedGameDefsMeshLOD));
+	memcpy(fileData.data() + header.levelDefsOffset, defs.levelDefs.data(), defs.levelDefs.size() * sizeof(LevelDef));
+	memcpy(fileData.data() + header.stringTableOffset, stringTable.data(), stringTable.size());
+
+	std::string tempFile = cookedFile + "." + toString(stringHash(toString(std::this_thread::get_id()))) + ".tmp";
+	bool written = false;
+
+#ifdef _WIN32
+	std::ofstream out(utf8_to_utf16(tempFile).c_str(), std::ios::out | std::ios::binary);
+#else
+	std::ofstream out(tempFile, std::ios::out | std::ios::binary);
+#endif
+
+	if (out.is_open())
+	{
+		out.write(fileData.data(), fileData.size());
+		out.close();
 
-		size_t i = file.find("/textures/");
+#ifdef _WIN32
+		written = out && MoveFileExW(utf8_to_utf16(tempFile).c_str(), utf8_to_utf16(cookedFile).c_str(), MOVEFILE_REPLACE_EXISTING);
 
-		std::string debugMarkerName = ".../";
+		if (!written)
+			DeleteFileW(utf8_to_utf16(tempFile).c_str());
+#else
+		written = out && rename(tempFile.c_str(), cookedFile.c_str()) == 0;
 
-		if (i != file.npos)
-			debugMarkerName += file.substr(i + 10);
-		else
-			debugMarkerName = file;
+		if (!written)
+			remove(tempFile.c_str());
+#endif
+	}
 
-		renderer->setObjectDebugName(texRes->texture, OBJECT_TYPE_TEXTURE, debugMarkerName);
+	if (!written)
+		printf("%s Failed to write cooked game defs file: %s\n", ERR_PREFIX, cookedFile.c_str());
 
-		texRes->textureView = renderer->createTextureView(texRes->texture, TEXTURE_VIEW_TYPE_2D, {0, texRes->mipmapLevels, 0, 1});
+	return written;
+}
 
-		loadedTextures[file] = std::make_pair(texRes, 1);
+ResourceMaterial ResourceManager::loadMaterialImmediate (const std::string &defUniqueName)
+{
+	auto it = loadedMaterials.find(AssetIDTable::getAssetID(defUniqueName));
 
-		return texRes;
-	}
-	else
+	if (it == loadedMaterials.end())
 	{
-		// Increment the reference counter
-		it->second.second ++;
+		countResourceCacheLookup(nullptr, false);
 
-		// If the texture object is loaded, but it's data isn't, then wait until it is
-		// This usually happens when one thread pushes loading to another thread, and so
-		// the object is created, but the loading hasn't finished yet
-		while (it->second.first->dataLoaded == false)
-		{
-			std::this_thread::yield();
-		}
+		MaterialDef *matDef = getMaterialDef(defUniqueName);
 
-		return it->second.first;
+		ResourceMaterialObject *mat = new ResourceMaterialObject();
+		mat->defUniqueName = defUniqueName;
+		mat->descriptorSet = mainThreadDescriptorPool->allocateDescriptorSet();
+		mat->sampler = renderer->createSampler(matDef->addressMode, matDef->linearFiltering ? SAMPLER_FILTER_LINEAR : SAMPLER_FILTER_NEAREST, matDef->linearFiltering ? SAMPLER_FILTER_LINEAR : SAMPLER_FILTER_NEAREST, 4, {0, 14, 0},
+				matDef->linearMipmapFiltering ? SAMPLER_MIPMAP_MODE_LINEAR : SAMPLER_MIPMAP_MODE_NEAREST);
+		mat->pipelineID = AssetIDTable::getAssetID(matDef->pipelineUniqueName);
+		renderer->setObjectDebugName(mat->sampler, OBJECT_TYPE_SAMPLER, "Material: " + mat->defUniqueName + " sampler");
+
+		std::vector<std::string> texFiles;
+
+		for (int i = 0; i < MATERIAL_DEF_MAX_TEXTURE_NUM; i ++)
+			if (std::string(matDef->textureFiles[i]).length() != 0)
+				texFiles.push_back(std::string(matDef->textureFiles[i]));
+
+		for (size_t i = 0; i < texFiles.size(); i++)
+			mat->textures[i] = loadTextureImmediate(texFiles[i]);
+
+		mat->usedTextureCount = (uint8_t) texFiles.size();
+
+		writeMaterialDescriptorSet(mat);
+		mat->dataLoaded = true;
+
+		mat->handle = materialHandles.allocate(mat);
+		loadedMaterials[AssetIDTable::getAssetID(defUniqueName)] = std::make_pair(mat, 1);
+
+		return mat;
+	}
+	else
+	{
+		it->second.second ++;
+		countResourceCacheLookup(it->second.first, true);
+
+		ResourceMaterial mat = it->second.first;
+		waitForAsyncLoad(mat->dataLoaded);
+
+		return mat;
 	}
 }
 
-ResourceTexture ResourceManager::loadTextureArrayImmediate (const std::vector<std::string> &files, TextureFileFormat format)
+/*
+ * Loads a material asynchronously. The material object is returned immediately, but it's textures are loaded
+ * on the worker threads, and the material isn't usable until it's "dataLoaded" member is true. The callback
+ * (if any) is called on the main thread once that happens.
+ */
+ResourceMaterial ResourceManager::loadMaterialAsync (const std::string &defUniqueName, std::function<void(ResourceMaterial)> callback)
 {
-	std::unique_lock<std::mutex> lock(loadedTextures_mutex);
+	auto it = loadedMaterials.find(AssetIDTable::getAssetID(defUniqueName));
 
-	auto it = loadedTextures.find(files[0]);
-
-	if (it == loadedTextures.end())
+	if (it == loadedMaterials.end())
 	{
-		ResourceTextureObject *texRes = new ResourceTextureObject();
-		texRes->files = files;
-		texRes->dataLoaded = true;
-		texRes->arrayLayers = 1;
+		countResourceCacheLookup(nullptr, false);
 
-		if (format == TEXTURE_FILE_FORMAT_MAX_ENUM)
-			format = inferFileFormat(files[0]);
+		MaterialDef *matDef = getMaterialDef(defUniqueName);
 
-		if (format == TEXTURE_FILE_FORMAT_MAX_ENUM)
-		{
-			// If it's still max enum, then we failed to specify/find the format we're supposed to load it in
-			// Therefore, we'll cancel and return a nullptr
-			printf("%s Failed to load texture: %s, couldn't find or isn't a supported file format", ERR_PREFIX, files[0].c_str());
+		ResourceMaterialObject *mat = new ResourceMaterialObject();
+		mat->dataLoaded = false;
+		mat->defUniqueName = defUniqueName;
+		mat->descriptorSet = mainThreadDescriptorPool->allocateDescriptorSet();
+		mat->sampler = renderer->createSampler(matDef->addressMode, matDef->linearFiltering ? SAMPLER_FILTER_LINEAR : SAMPLER_FILTER_NEAREST, matDef->linearFiltering ? SAMPLER_FILTER_LINEAR : SAMPLER_FILTER_NEAREST, 4, {0, 14, 0},
+				matDef->linearMipmapFiltering ? SAMPLER_MIPMAP_MODE_LINEAR : SAMPLER_MIPMAP_MODE_NEAREST);
+		mat->pipelineID = AssetIDTable::getAssetID(matDef->pipelineUniqueName);
+		renderer->setObjectDebugName(mat->sampler, OBJECT_TYPE_SAMPLER, "Material: " + mat->defUniqueName + " sampler");
 
-			return nullptr;
-		}
+		std::vector<std::string> texFiles;
 
-		switch (format)
-		{
-			case TEXTURE_FILE_FORMAT_PNG:
-				loadPNGTextureData(texRes);
-				break;
-			case TEXTURE_FILE_FORMAT_DDS:
-				loadDDSTextureData(texRes);
-				break;
-			default:
-				break;
-		}
+		for (int i = 0; i < MATERIAL_DEF_MAX_TEXTURE_NUM; i ++)
+			if (std::string(matDef->textureFiles[i]).length() != 0)
+				texFiles.push_back(std::string(matDef->textureFiles[i]));
 
-		/*
-		 * I'm formatting the debug name to trim it to the "GameData/textures/" directory. For example:
-		 * "GameData/textures/blah.png" would turn to ".../blah.png""
-		 */
+		mat->usedTextureCount = (uint8_t) texFiles.size();
 
-		size_t i = files[0].find("/textures/");
+		mat->handle = materialHandles.allocate(mat);
+		loadedMaterials[AssetIDTable::getAssetID(defUniqueName)] = std::make_pair(mat, 1);
+		pendingAsyncLoadCount ++;
 
-		std::string debugMarkerName = ".../";
+		if (callback)
+			addAsyncLoadCallback(mat, mat->dataLoaded, [callback, mat]() {callback(mat);});
 
-		if (i != files[0].npos)
-			debugMarkerName += files[0].substr(i + 10);
-		else
-			debugMarkerName = files[0];
+		// The material is finished as soon as the last of it's textures is
+		std::shared_ptr<uint32_t> texturesLeft = std::make_shared<uint32_t>(texFiles.size() + 1);
+		std::function<void()> onTextureLoaded = [this, mat, texturesLeft]()
+		{
+			(*texturesLeft) --;
 
-		renderer->setObjectDebugName(texRes->texture, OBJECT_TYPE_TEXTURE, debugMarkerName);
+			if (*texturesLeft == 0)
+			{
+				writeMaterialDescriptorSet(mat);
+				finishAsyncLoad(mat, mat->dataLoaded);
+			}
+		};
+
+		for (size_t i = 0; i < texFiles.size(); i++)
+		{
+			mat->textures[i] = loadTextureAsync(texFiles[i], TEXTURE_FILE_FORMAT_MAX_ENUM, [onTextureLoaded](ResourceTexture tex) {onTextureLoaded();});
 
-		texRes->textureView = renderer->createTextureView(texRes->texture, TEXTURE_VIEW_TYPE_2D_ARRAY, {0, texRes->mipmapLevels, 0, (uint32_t) files.size()});
+			// A nullptr means the texture failed right away, so we won't get a callback for it
+			if (mat->textures[i] == nullptr)
+				(*texturesLeft) --;
+		}
 
-		loadedTextures[files[0]] = std::make_pair(texRes, 1);
+		// The extra count keeps the material from finishing while we're still requesting textures
+		pushMainThreadAsyncTask(onTextureLoaded);
 
-		return texRes;
+		return mat;
 	}
 	else
 	{
-		// Increment the reference counter
 		it->second.second ++;
+		countResourceCacheLookup(it->second.first, true);
 
-		// If the texture object is loaded, but it's data isn't, then wait until it is
-		// This usually happens when one thread pushes loading to another thread, and so
-		// the object is created, but the loading hasn't finished yet
-		while (it->second.first->dataLoaded == false)
-		{
-			std::this_thread::yield();
-		}
+		ResourceMaterial mat = it->second.first;
 
-		return it->second.first;
+		if (callback)
+			addAsyncLoadCallback(mat, mat->dataLoaded, [callback, mat]() {callback(mat);});
+
+		return mat;
 	}
 }
 
-void ResourceManager::returnTexture (ResourceTexture tex)
+/*
+ * Writes the sampler & textures of a material to it's descriptor set. Any unused texture slots get
+ * filled with the black texture.
+ */
+void ResourceManager::writeMaterialDescriptorSet (ResourceMaterial mat)
 {
-	std::unique_lock<std::mutex> lock(loadedTextures_mutex);
+	std::vector<DescriptorWriteInfo> writes(2);
+	writes[0].descriptorCount = 1;
+	writes[0].descriptorType = DESCRIPTOR_TYPE_SAMPLER;
+	writes[0].dstSet = mat->descriptorSet;
+	writes[0].imageInfo =
+	{
+		{	mat->sampler, nullptr, TEXTURE_LAYOUT_UNDEFINED}};
+	writes[0].dstBinding = 0;
+	writes[0].dstArrayElement = 0;
 
-	auto it = loadedTextures.find(tex->files[0]);
+	std::vector<DescriptorImageInfo> texDescInfos;
 
-	if (it != loadedTextures.end())
+	for (size_t i = 0; i < mat->usedTextureCount; i++)
+	{
+		DescriptorImageInfo imgInfo = {};
+		imgInfo.sampler = nullptr;
+		imgInfo.view = mat->textures[i] != nullptr && !mat->textures[i]->loadFailed ? mat->textures[i]->textureView : colorBlackTexView;
+		imgInfo.layout = TEXTURE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+		texDescInfos.push_back(imgInfo);
+	}
+
+	// Fill in the rest w/ dummy textures as to not cause a validation error
+	while (texDescInfos.size() < 8)
+	{
+		DescriptorImageInfo imgInfo = {};
+		imgInfo.sampler = nullptr;
+		imgInfo.view = colorBlackTexView;
+		imgInfo.layout = TEXTURE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+		texDescInfos.push_back(imgInfo);
+	}
+
+	writes[1].descriptorCount = texDescInfos.size();
+	writes[1].descriptorType = DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+	writes[1].dstSet = mat->descriptorSet;
+	writes[1].imageInfo = texDescInfos;
+	writes[1].dstBinding = 1;
+	writes[1].dstArrayElement = 0;
+
+	renderer->writeDescriptorSets(writes);
+}
+
+ResourceMaterial ResourceManager::findMaterial (const std::string &defUniqueName)
+{
+	return findMaterial(AssetIDTable::getAssetID(defUniqueName));
+}
+
+ResourceMaterial ResourceManager::findMaterial (AssetID defUniqueNameID)
+{
+	auto it = loadedMaterials.find(defUniqueNameID);
+
+	// Retained materials aren't referenced by anything, so they shouldn't be found either
+	return (it != loadedMaterials.end() && it->second.second > 0) ? it->second.first : nullptr;
+}
+
+void ResourceManager::returnMaterial (const std::string &defUniqueName)
+{
+	return returnMaterial(AssetIDTable::getAssetID(defUniqueName));
+}
+
+void ResourceManager::returnMaterial (AssetID defUniqueNameID)
+{
+	auto it = loadedMaterials.find(defUniqueNameID);
+
+	if (it != loadedMaterials.end())
 	{
+		// If the material is still being loaded asynchronously, then we have to let it finish before we can safely destroy it
+		waitForAsyncLoad(it->second.first->dataLoaded);
+
+		// Waiting runs the main thread tasks & load callbacks, which can insert into loadedMaterials, so the old iterator isn't valid anymore
+		it = loadedMaterials.find(defUniqueNameID);
+
 		// Decrement the reference counter
 		it->second.second --;
 
-		// If the reference counter is now zero, then delete the mesh data entirely
+		// If the reference counter is now zero, then it's kept around until it's evicted by updateRetainedResources()
 		if (it->second.second == 0)
 		{
-			loadedTextures.erase(it);
-			renderer->destroyTexture(tex->texture);
-			renderer->destroyTextureView(tex->textureView);
+			ResourceMaterial mat = it->second.first;
+			size_t textureMemorySize = 0;
 
-			delete tex;
+			for (size_t i = 0; i < mat->usedTextureCount; i ++)
+				if (mat->textures[i] != nullptr)
+					textureMemorySize += mat->textures[i]->memorySize;
+
+			retainResource(RETAINED_RESOURCE_TYPE_MATERIAL, mat, sizeof(ResourceMaterialObject) + mat->defUniqueName.capacity(), textureMemorySize);
 		}
 	}
 }
 
-void ResourceManager::loadPNGTextureData (ResourceTexture tex)
+bool ResourceMananger_meshLodDistComp (const std::pair<float, ResourceMesh> &arg0, const std::pair<float, ResourceMesh> &arg1)
 {
-	uint32_t width = 0, height = 0;
-	std::vector<std::vector<uint8_t>> textureData;
-
-	for (uint32_t f = 0; f < tex->files.size(); f ++)
-	{
-		if (tex->files[f].length() == 0)
-			continue;
+	return arg0.first < arg1.first;
+}
 
-		textureData.push_back(std::vector<uint8_t> ());
+ResourceStaticMesh ResourceManager::loadStaticMeshImmediate (const std::string &defUniqueName)
+{
+	auto it = loadedStaticMeshes.find(AssetIDTable::getAssetID(defUniqueName));
 
-		uint32_t fwidth, fheight;
+	if (it == loadedStaticMeshes.end())
+	{
+		countResourceCacheLookup(nullptr, false);
 
-		std::vector<char> pngData = FileLoader::instance()->readFileBuffer(tex->files[f]);
+		StaticMeshDef *matDef = getMeshDef(defUniqueName);
 
-		if (pngData.size() == 0)
-			continue;
+		ResourceStaticMeshObject *mesh = new ResourceStaticMeshObject();
+		mesh->defUniqueName = matDef->uniqueName;
 
-		unsigned err = lodepng::decode(textureData[f], fwidth, fheight, reinterpret_cast<const unsigned char*>(pngData.data()), pngData.size(), LCT_RGBA, 8);
+		DEBUG_ASSERT(matDef->meshLODFiles.size() == matDef->meshLODNames.size() && matDef->meshLODNames.size() == matDef->meshLODMaxDists.size());
 
-		if (err)
+		for (size_t i = 0; i < matDef->meshLODFiles.size(); i ++)
 		{
-			printf("%s Encountered an error while loading PNG file: %s, lodepng returned: %u\n", ERR_PREFIX, tex->files[f].c_str(), err);
-					continue;
+			std::string lodMeshFile = std::string(matDef->meshLODFiles[i]);
+			std::string lodMeshName = std::string(matDef->meshLODNames[i]);
+			float lodMaxDist = matDef->meshLODMaxDists[i];
+
+			mesh->meshLODs.push_back(std::make_pair(lodMaxDist, loadMeshImmediate(lodMeshFile, lodMeshName)));
 		}
 
-		// Make sure each texture has the same size
-		if (f > 0 && (fwidth != width || fheight != height))
-		{
-			printf("%s Couldn't load a texture array, one or more textures don't have consistent dimensions. Files: ", ERR_PREFIX);
+		// The "meshLODs" member is required to be sorted by lod distance
+		std::sort(mesh->meshLODs.begin(), mesh->meshLODs.end(), ResourceMananger_meshLodDistComp);
 
-			for (uint32_t i = 0; i < tex->files.size(); i ++)
-			{
-				printf("%s%s", tex->files[i].c_str(), (i == tex->files.size() - 1 ? "" : ", "));
-			}
-			printf("\n");
+		//mesh->mesh = loadMeshImmediate(workingDir + std::string(matDef->meshFile), std::string(matDef->meshName));
 
-			return;
-		}
+		mesh->dataLoaded = true;
 
-		width = fwidth;
-		height = fheight;
+		mesh->handle = staticMeshHandles.allocate(mesh);
+		loadedStaticMeshes[AssetIDTable::getAssetID(defUniqueName)] = std::make_pair(mesh, 1);
+
+		return mesh;
 	}
+	else
+	{
+		it->second.second ++;
+		countResourceCacheLookup(it->second.first, true);
+
+		ResourceStaticMesh mesh = it->second.first;
+		waitForAsyncLoad(mesh->dataLoaded);
 
-	StagingBuffer stagingBuffer = renderer->createStagingBuffer(textureData[0].size());
+		return mesh;
+	}
+}
 
-	tex->mipmapLevels = (uint32_t) glm::floor(glm::log2(glm::max<float>(width, height))) + 1;
-	tex->texture = renderer->createTexture({width, height, 1}, RESOURCE_FORMAT_R8G8B8A8_UNORM, TEXTURE_USAGE_TRANSFER_SRC_BIT | TEXTURE_USAGE_TRANSFER_DST_BIT | TEXTURE_USAGE_SAMPLED_BIT, MEMORY_USAGE_GPU_ONLY, false, tex->mipmapLevels, textureData.size());
+/*
+ * Loads a static mesh asynchronously. The static mesh object is returned immediately (w/ all of it's LODs
+ * in the correct order), but the LOD meshes are loaded on the worker threads. The static mesh isn't usable
+ * until it's "dataLoaded" member is true, and the callback (if any) is called on the main thread once that happens.
+ */
+ResourceStaticMesh ResourceManager::loadStaticMeshAsync (const std::string &defUniqueName, std::function<void(ResourceStaticMesh)> callback)
+{
+	auto it = loadedStaticMeshes.find(AssetIDTable::getAssetID(defUniqueName));
 
-	for (uint32_t f = 0; f < tex->files.size(); f ++)
+	if (it == loadedStaticMeshes.end())
 	{
-		renderer->fillStagingBuffer(stagingBuffer, textureData[f].size(), textureData[f].data());
+		countResourceCacheLookup(nullptr, false);
 
-		CommandBuffer cmdBuffer = renderer->beginSingleTimeCommand(mainThreadTransferCommandPool);
+		StaticMeshDef *matDef = getMeshDef(defUniqueName);
 
-		TextureSubresourceRange subresourceRange = {};
-		subresourceRange.baseMipLevel = 0;
-		subresourceRange.baseArrayLayer = f;
-		subresourceRange.levelCount = 1;
-		subresourceRange.layerCount = 1;
+		ResourceStaticMeshObject *mesh = new ResourceStaticMeshObject();
+		mesh->dataLoaded = false;
+		mesh->defUniqueName = matDef->uniqueName;
 
-		//cmdBuffer->transitionTextureLayout(tex->texture, TEXTURE_LAYOUT_UNDEFINED, TEXTURE_LAYOUT_TRANSFER_DST_OPTIMAL, subresourceRange);
-		cmdBuffer->setTextureLayout(tex->texture, TEXTURE_LAYOUT_UNDEFINED, TEXTURE_LAYOUT_TRANSFER_DST_OPTIMAL, subresourceRange, PIPELINE_STAGE_ALL_COMMANDS_BIT, PIPELINE_STAGE_ALL_COMMANDS_BIT);
-		cmdBuffer->stageBuffer(stagingBuffer, tex->texture, {0, f, 1});
+		DEBUG_ASSERT(matDef->meshLODFiles.size() == matDef->meshLODNames.size() && matDef->meshLODNames.size() == matDef->meshLODMaxDists.size());
 
-		if (tex->mipmapLevels > 1)
-		{
-			//cmdBuffer->transitionTextureLayout(tex->texture, TEXTURE_LAYOUT_TRANSFER_DST_OPTIMAL, TEXTURE_LAYOUT_TRANSFER_SRC_OPTIMAL);
-			cmdBuffer->setTextureLayout(tex->texture, TEXTURE_LAYOUT_TRANSFER_DST_OPTIMAL, TEXTURE_LAYOUT_TRANSFER_SRC_OPTIMAL, subresourceRange, PIPELINE_STAGE_ALL_COMMANDS_BIT, PIPELINE_STAGE_ALL_COMMANDS_BIT);
+		mesh->handle = staticMeshHandles.allocate(mesh);
+		loadedStaticMeshes[AssetIDTable::getAssetID(defUniqueName)] = std::make_pair(mesh, 1);
+		pendingAsyncLoadCount ++;
 
-			for (uint32_t i = 1; i < tex->mipmapLevels; i ++)
-			{
-				TextureSubresourceRange mipRange = {};
-				mipRange.baseMipLevel = i;
-				mipRange.baseArrayLayer = f;
-				mipRange.levelCount = 1;
-				mipRange.layerCount = 1;
-
-				TextureBlitInfo blitInfo = {};
-				blitInfo.srcSubresource =
-				{	i - 1, f, 1};
-				blitInfo.dstSubresource =
-				{	i, f, 1};
-				blitInfo.srcOffsets[0] =
-				{	0, 0, 0};
-				blitInfo.dstOffsets[0] =
-				{	0, 0, 0};
-				blitInfo.srcOffsets[1] =
-				{	int32_t(width >> (i - 1)), int32_t(height >> (i - 1)), 1};
-				blitInfo.dstOffsets[1] =
-				{	int32_t(width >> i), int32_t(height >> i), 1};
-
-				//cmdBuffer->transitionTextureLayout(tex->texture, TEXTURE_LAYOUT_UNDEFINED, TEXTURE_LAYOUT_TRANSFER_DST_OPTIMAL, mipRange);
-				cmdBuffer->setTextureLayout(tex->texture, TEXTURE_LAYOUT_UNDEFINED, TEXTURE_LAYOUT_TRANSFER_DST_OPTIMAL, mipRange, PIPELINE_STAGE_TRANSFER_BIT, PIPELINE_STAGE_ALL_COMMANDS_BIT);
-				cmdBuffer->blitTexture(tex->texture, TEXTURE_LAYOUT_TRANSFER_SRC_OPTIMAL, tex->texture, TEXTURE_LAYOUT_TRANSFER_DST_OPTIMAL, {blitInfo}, SAMPLER_FILTER_LINEAR);
-				cmdBuffer->setTextureLayout(tex->texture, TEXTURE_LAYOUT_TRANSFER_DST_OPTIMAL, TEXTURE_LAYOUT_TRANSFER_SRC_OPTIMAL, mipRange, PIPELINE_STAGE_ALL_COMMANDS_BIT, PIPELINE_STAGE_TRANSFER_BIT);
-			}
+		if (callback)
+			addAsyncLoadCallback(mesh, mesh->dataLoaded, [callback, mesh]() {callback(mesh);});
 
-			subresourceRange.levelCount = tex->mipmapLevels;
+		// The static mesh is finished as soon as the last of it's LODs is
+		std::shared_ptr<uint32_t> lodsLeft = std::make_shared<uint32_t>(matDef->meshLODFiles.size() + 1);
+		std::function<void()> onLODLoaded = [this, mesh, lodsLeft]()
+		{
+			(*lodsLeft) --;
 
-			cmdBuffer->setTextureLayout(tex->texture, TEXTURE_LAYOUT_TRANSFER_SRC_OPTIMAL, TEXTURE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, subresourceRange, PIPELINE_STAGE_ALL_COMMANDS_BIT, PIPELINE_STAGE_ALL_COMMANDS_BIT);
+			if (*lodsLeft == 0)
+				finishAsyncLoad(mesh, mesh->dataLoaded);
+		};
 
-			//cmdBuffer->transitionTextureLayout(tex->texture, TEXTURE_LAYOUT_TRANSFER_SRC_OPTIMAL, TEXTURE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, subresourceRange);
-		}
-		else
+		for (size_t i = 0; i < matDef->meshLODFiles.size(); i ++)
 		{
-			cmdBuffer->transitionTextureLayout(tex->texture, TEXTURE_LAYOUT_TRANSFER_DST_OPTIMAL, TEXTURE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+			std::string lodMeshFile = std::string(matDef->meshLODFiles[i]);
+			std::string lodMeshName = std::string(matDef->meshLODNames[i]);
+			float lodMaxDist = matDef->meshLODMaxDists[i];
+
+			mesh->meshLODs.push_back(std::make_pair(lodMaxDist, loadMeshAsync(lodMeshFile, lodMeshName, [onLODLoaded](ResourceMesh lodMesh) {onLODLoaded();})));
 		}
 
-		renderer->endSingleTimeCommand(cmdBuffer, mainThreadTransferCommandPool, QUEUE_TYPE_GRAPHICS);
+		// The "meshLODs" member is required to be sorted by lod distance
+		std::sort(mesh->meshLODs.begin(), mesh->meshLODs.end(), ResourceMananger_meshLodDistComp);
+
+		// The extra count keeps the static mesh from finishing while we're still requesting LODs
+		pushMainThreadAsyncTask(onLODLoaded);
+
+		return mesh;
 	}
+	else
+	{
+		it->second.second ++;
+		countResourceCacheLookup(it->second.first, true);
 
-	renderer->destroyStagingBuffer(stagingBuffer);
+		ResourceStaticMesh mesh = it->second.first;
+
+		if (callback)
+			addAsyncLoadCallback(mesh, mesh->dataLoaded, [callback, mesh]() {callback(mesh);});
+
+		return mesh;
+	}
 }
 
-#ifndef MAKEFOURCC
-#define MAKEFOURCC(ch0, ch1, ch2, ch3)                              \
-                ((uint32_t)(uint8_t)(ch0) | ((uint32_t)(uint8_t)(ch1) << 8) |       \
-                ((uint32_t)(uint8_t)(ch2) << 16) | ((uint32_t)(uint8_t)(ch3) << 24 ))
-#endif /* defined(MAKEFOURCC) */
+ResourceStaticMesh ResourceManager::findStaticMesh (const std::string &defUniqueName)
+{
+	return findStaticMesh(AssetIDTable::getAssetID(defUniqueName));
+}
 
-inline ResourceFormat convertDXGIFormatToResourceFormat(uint32_t dxgi)
+ResourceStaticMesh ResourceManager::findStaticMesh (AssetID defUniqueNameID)
 {
-	switch (dxgi)
-	{
-		case 71: // BC1_UNORM
-			return RESOURCE_FORMAT_BC1_RGBA_UNORM_BLOCK;
-		case 72: // BC1_UNORM_SRGB
-			return RESOURCE_FORMAT_BC1_RGBA_SRGB_BLOCK;
-		case 74: // BC2_UNORM
-			return RESOURCE_FORMAT_BC2_UNORM_BLOCK;
-		case 75: // BC2_UNORM_SRGB
-			return RESOURCE_FORMAT_BC2_SRGB_BLOCK;
-		case 77: // BC3_UNORM
-			return RESOURCE_FORMAT_BC3_UNORM_BLOCK;
-		case 78: // BC3_UNORM_SRGB
-			return RESOURCE_FORMAT_BC3_SRGB_BLOCK;
-		case 80: // BC4_UNORM
-			return RESOURCE_FORMAT_BC4_UNORM_BLOCK;
-		case 81: // BC4_SNORM
-			return RESOURCE_FORMAT_BC4_SNORM_BLOCK;
-		case 83: // BC5_UNORM
-			return RESOURCE_FORMAT_BC5_UNORM_BLOCK;
-		case 84: // BC5_SNORM
-			return RESOURCE_FORMAT_BC5_SNORM_BLOCK;
-		case 95: // BC6H_UF16
-			return RESOURCE_FORMAT_BC6H_UFLOAT_BLOCK;
-		case 96: // BC6H_SF16
-			return RESOURCE_FORMAT_BC6H_SFLOAT_BLOCK;
-		case 98: // BC7_UNORM
-			return RESOURCE_FORMAT_BC7_UNORM_BLOCK;
-		case 99: // BC7_UNORM_SRGB
-			return RESOURCE_FORMAT_BC7_SRGB_BLOCK;
-		case 112: // R16G16_SFLOAT
-			return RESOURCE_FORMAT_R16G16_SFLOAT;
-		default:
-			return RESOURCE_FORMAT_UNDEFINED;
-	}
+	auto it = loadedStaticMeshes.find(defUniqueNameID);
+
+	// Retained static meshes aren't referenced by anything, so they shouldn't be found either
+	return (it != loadedStaticMeshes.end() && it->second.second > 0) ? it->second.first : nullptr;
 }
 
-inline ResourceFormat getDDSFormat(const std::vector<char> &buffer)
+void ResourceManager::returnStaticMesh (const std::string &defUniqueName)
 {
-	const DDSHeader &header = *reinterpret_cast<const DDSHeader*>(&buffer[4]);
+	returnStaticMesh(AssetIDTable::getAssetID(defUniqueName));
+}
 
-	switch (header.ddspf.dwFourCC)
+void ResourceManager::returnStaticMesh (AssetID defUniqueNameID)
+{
+	auto it = loadedStaticMeshes.find(defUniqueNameID);
+
+	if (it != loadedStaticMeshes.end())
 	{
-		case MAKEFOURCC('D', 'X', '1', '0'):
+		// If the static mesh is still being loaded asynchronously, then we have to let it finish before we can safely destroy it
+		waitForAsyncLoad(it->second.first->dataLoaded);
+
+		// Waiting runs the main thread tasks & load callbacks, which can insert into loadedStaticMeshes, so the old iterator isn't valid anymore
+		it = loadedStaticMeshes.find(defUniqueNameID);
+
+		// Decrement the reference counter
+		it->second.second --;
+
+		// If the reference counter is now zero, then it's kept around until it's evicted by updateRetainedResources()
+		if (it->second.second == 0)
 		{
-			const DDSHeaderDXT10 &header10 = *reinterpret_cast<const DDSHeaderDXT10*>(&buffer[sizeof(uint32_t) + sizeof(DDSHeader)]);
+			ResourceStaticMesh mesh = it->second.first;
+			size_t meshMemorySize = 0;
+
+			for (uint32_t lod = 0; lod < mesh->meshLODs.size(); lod ++)
+				meshMemorySize += mesh->meshLODs[lod].second->poolAllocation.vertexSize + mesh->meshLODs[lod].second->poolAllocation.indexSize;
+
+			retainResource(RETAINED_RESOURCE_TYPE_STATIC_MESH, mesh, sizeof(ResourceStaticMeshObject) + mesh->meshLODs.capacity() * sizeof(mesh->meshLODs[0]), meshMemorySize);
+		}
+	}
+}
+
+ResourcePipeline ResourceManager::loadPipelineImmediate (const std::string &defUniqueName)
+{
+	auto it = loadedPipelines.find(AssetIDTable::getAssetID(defUniqueName));
+
+	if (it == loadedPipelines.end())
+	{
+		PipelineDef *pipeDef = getPipelineDef(defUniqueName);
+
+		if (!checkPipelineDef(pipeDef))
+			return nullptr;
+
+		ResourcePipelineObject *pipe = new ResourcePipelineObject();
+		pipe->dataLoaded = true;
+		pipe->defUniqueName = defUniqueName;
+
+		createPipelineObjects(pipe, pipeDef);
+
+		pipe->handle = pipelineHandles.allocate(pipe);
+		loadedPipelines[AssetIDTable::getAssetID(defUniqueName)] = std::make_pair(pipe, 1);
+
+		return pipe;
+	}
+	else
+	{
+		it->second.second ++;
+
+		return it->second.first;
+	}
+}
+
+/*
+ * Same as loadPipelineImmediate(), except the shaders & pipelines are compiled by the renderer's pipeline compile
+ * threads, so a whole batch of pipelines can compile in parallel. The pipeline's "dataLoaded" flag is set (and the
+ * callback is called) on the main thread once it's done, and renderer->waitForPipelineCompileJobs() can be used to
+ * wait on all of them at once.
+ */
+ResourcePipeline ResourceManager::loadPipelineAsync (const std::string &defUniqueName, std::function<void(ResourcePipeline)> callback)
+{
+	auto it = loadedPipelines.find(AssetIDTable::getAssetID(defUniqueName));
+
+	if (it == loadedPipelines.end())
+	{
+		PipelineDef *pipeDef = getPipelineDef(defUniqueName);
+
+		if (!checkPipelineDef(pipeDef))
+			return nullptr;
+
+		ResourcePipelineObject *pipe = new ResourcePipelineObject();
+		pipe->dataLoaded = false;
+		pipe->defUniqueName = defUniqueName;
+		pipe->pipeline = nullptr;
+		pipe->depthPipeline = nullptr;
+
+		pipe->handle = pipelineHandles.allocate(pipe);
+		loadedPipelines[AssetIDTable::getAssetID(defUniqueName)] = std::make_pair(pipe, 1);
+		pendingAsyncLoadCount ++;
+
+		if (callback)
+			addAsyncLoadCallback(pipe, pipe->dataLoaded, [callback, pipe]() {callback(pipe);});
+
+		renderer->pushPipelineCompileJob([this, pipe, pipeDef]()
+		{
+			createPipelineObjects(pipe, pipeDef);
+			pushMainThreadAsyncTask([this, pipe]() {finishAsyncLoad(pipe, pipe->dataLoaded);});
+		});
+
+		return pipe;
+	}
+	else
+	{
+		it->second.second ++;
+
+		ResourcePipeline pipe = it->second.first;
+
+		if (callback)
+			addAsyncLoadCallback(pipe, pipe->dataLoaded, [callback, pipe]() {callback(pipe);});
+
+		return pipe;
+	}
+}
+
+bool ResourceManager::checkPipelineDef (PipelineDef *pipeDef)
+{
+	// If only one of the tessellation stages is present
+	if ((strlen(pipeDef->tessControlShaderFile) != 0) != (strlen(pipeDef->tessEvalShaderFile) != 0))
+	{
+		printf("%s Failed to load pipeline: %s, must have both tessellation control and evaluation shaders, not just one\n", INFO_PREFIX, pipeDef->uniqueName);
+		// TODO Handle failed pipeline case more gracefully
+
+		return false;
+	}
+
+	return true;
+}
+
+/*
+ * Compiles the shaders & creates the renderer pipelines for a pipeline def. This only touches the renderer's
+ * shader/pipeline creation functions, so it's safe to call from a pipeline compile job.
+ */
+void ResourceManager::createPipelineObjects (ResourcePipeline pipe, PipelineDef *pipeDef)
+{
+	ShaderModule vertShader = renderer->createShaderModule(std::string(pipeDef->vertexShaderFile), SHADER_STAGE_VERTEX_BIT, SHADER_LANGUAGE_GLSL);
+	ShaderModule fragShader = renderer->createShaderModule(std::string(pipeDef->fragmentShaderFile), SHADER_STAGE_FRAGMENT_BIT, SHADER_LANGUAGE_GLSL);
+
+	ShaderModule tessCtrlShader = nullptr, tessEvalShader = nullptr, geomShader = nullptr;
+
+	if (strlen(pipeDef->tessControlShaderFile) != 0)
+		tessCtrlShader = renderer->createShaderModule(std::string(pipeDef->tessControlShaderFile), SHADER_STAGE_TESSELLATION_CONTROL_BIT, SHADER_LANGUAGE_GLSL);
+
+	if (strlen(pipeDef->tessEvalShaderFile) != 0)
+		tessEvalShader = renderer->createShaderModule(std::string(pipeDef->tessEvalShaderFile), SHADER_STAGE_TESSELLATION_EVALUATION_BIT, SHADER_LANGUAGE_GLSL);
+
+	if (strlen(pipeDef->geometryShaderFile) != 0)
+		geomShader = renderer->createShaderModule(std::string(pipeDef->geometryShaderFile), SHADER_STAGE_GEOMETRY_BIT, SHADER_LANGUAGE_GLSL);
+
+	const uint32_t ivunt_vertexFormatSize = 44;
+	const uint32_t ivunt_packed_vertexFormatSize = 20;
+
+	bool packedVertices = rendererMeshFormat == MESH_DATA_FORMAT_IVUNT_PACKED;
+
+	VertexInputBinding meshVertexBindingDesc = {}, instanceVertexBindingDesc = {};
+	meshVertexBindingDesc.binding = 0;
+	meshVertexBindingDesc.stride = packedVertices ? ivunt_packed_vertexFormatSize : ivunt_vertexFormatSize;
+	meshVertexBindingDesc.inputRate = VERTEX_INPUT_RATE_VERTEX;
+
+	instanceVertexBindingDesc.binding = 1;
+	instanceVertexBindingDesc.stride = sizeof(svec4) * 2;
+	instanceVertexBindingDesc.inputRate = VERTEX_INPUT_RATE_INSTANCE;
+
+	std::vector<VertexInputAttrib> attribDesc = std::vector<VertexInputAttrib>(6);
+	attribDesc[0].binding = 0;
+	attribDesc[0].location = 0;
+	attribDesc[0].format = RESOURCE_FORMAT_R32G32B32_SFLOAT;
+	attribDesc[0].offset = 0;
+
+	attribDesc[1].binding = 0;
+	attribDesc[1].location = 1;
+	attribDesc[1].format = RESOURCE_FORMAT_R32G32_SFLOAT;
+	attribDesc[1].offset = sizeof(glm::vec3);
+
+	attribDesc[2].binding = 0;
+	attribDesc[2].location = 2;
+	attribDesc[2].format = RESOURCE_FORMAT_R32G32B32_SFLOAT;
+	attribDesc[2].offset = sizeof(glm::vec3) + sizeof(glm::vec2);
+
+	attribDesc[3].binding = 0;
+	attribDesc[3].location = 3;
+	attribDesc[3].format = RESOURCE_FORMAT_R32G32B32_SFLOAT;
+	attribDesc[3].offset = sizeof(glm::vec3) + sizeof(glm::vec2) + sizeof(glm::vec3);
+
+	// Packed vertices have the same attributes, just quantized (see MeshDataFormat), and are decoded in the vertex shader
+	if (packedVertices)
+	{
+		attribDesc[0].format = RESOURCE_FORMAT_R16G16B16A16_SNORM;
+		attribDesc[0].offset = 0;
+
+		attribDesc[1].format = RESOURCE_FORMAT_R16G16_SFLOAT;
+		attribDesc[1].offset = sizeof(int16_t) * 4;
+
+		attribDesc[2].format = RESOURCE_FORMAT_R16G16_SNORM;
+		attribDesc[2].offset = sizeof(int16_t) * 4 + sizeof(uint16_t) * 2;
+
+		attribDesc[3].format = RESOURCE_FORMAT_R16G16_SNORM;
+		attribDesc[3].offset = sizeof(int16_t) * 4 + sizeof(uint16_t) * 2 + sizeof(int16_t) * 2;
+	}
+
+	attribDesc[4].binding = 1;
+	attribDesc[4].location = 4;
+	attribDesc[4].format = RESOURCE_FORMAT_R32G32B32A32_SFLOAT;
+	attribDesc[4].offset = 0;
+
+	attribDesc[5].binding = 1;
+	attribDesc[5].location = 5;
+	attribDesc[5].format = RESOURCE_FORMAT_R32G32B32A32_SFLOAT;
+	attribDesc[5].offset = sizeof(svec4);
+
+	PipelineVertexInputInfo vertexInput = {};
+	vertexInput.vertexInputAttribs = attribDesc;
+	vertexInput.vertexInputBindings =
+	{	meshVertexBindingDesc, instanceVertexBindingDesc};
+
+	PipelineInputAssemblyInfo inputAssembly = {};
+	inputAssembly.primitiveRestart = false;
+	inputAssembly.topology = PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+
+	PipelineViewportInfo viewportInfo = {};
+	viewportInfo.scissors =
+	{
+		{	0, 0, 1920, 1080}};
+	viewportInfo.viewports =
+	{
+		{	0, 0, 1920, 1080}};
+
+	PipelineRasterizationInfo rastInfo = {};
+	rastInfo.clockwiseFrontFace = pipeDef->clockwiseFrontFace;
+	rastInfo.cullMode = (pipeDef->backfaceCulling ? CULL_MODE_BACK_BIT : 0) | (pipeDef->frontfaceCullilng ? CULL_MODE_FRONT_BIT : 0);
+	rastInfo.lineWidth = 1;
+	rastInfo.polygonMode = POLYGON_MODE_FILL;
+	rastInfo.rasterizerDiscardEnable = false;
+	rastInfo.enableOutOfOrderRasterization = true;
+
+	PipelineDepthStencilInfo depthInfo = {};
+	depthInfo.enableDepthTest = true;
+	depthInfo.enableDepthWrite = true;
+	depthInfo.minDepthBounds = 0;
+	depthInfo.maxDepthBounds = 1;
+	depthInfo.depthCompareOp = COMPARE_OP_GREATER;
+
+	PipelineColorBlendAttachment colorBlendAttachment = {};
+	colorBlendAttachment.blendEnable = false;
+	colorBlendAttachment.colorWriteMask = COLOR_COMPONENT_R_BIT | COLOR_COMPONENT_G_BIT | COLOR_COMPONENT_B_BIT | COLOR_COMPONENT_A_BIT;
+
+	PipelineColorBlendInfo colorBlend = {};
+	colorBlend.attachments =
+	{	colorBlendAttachment, colorBlendAttachment};
+	colorBlend.logicOpEnable = false;
+	colorBlend.logicOp = LOGIC_OP_COPY;
+	colorBlend.blendConstants[0] = 1.0f;
+	colorBlend.blendConstants[1] = 1.0f;
+	colorBlend.blendConstants[2] = 1.0f;
+	colorBlend.blendConstants[3] = 1.0f;
+
+	PipelineDynamicStateInfo dynamicState = {};
+	dynamicState.dynamicStates =
+	{	DYNAMIC_STATE_VIEWPORT, DYNAMIC_STATE_SCISSOR};
+
+	GraphicsPipelineInfo info = {};
+
+	PipelineShaderStage vertShaderStage = {};
+	vertShaderStage.entry = "main";
+	vertShaderStage.module = vertShader;
+
+	PipelineShaderStage fragShaderStage = {};
+	fragShaderStage.entry = "main";
+	fragShaderStage.module = fragShader;
+
+	// Note if you change the index of the frag shader, replace the index in if (pipeDef->canRenderDepth) {..}
+	info.stages =
+	{	vertShaderStage, fragShaderStage};
+
+	if (tessCtrlShader != nullptr)
+	{
+		PipelineShaderStage tessCtrlShaderStage = {};
+		tessCtrlShaderStage.entry = "main";
+		tessCtrlShaderStage.module = tessCtrlShader;
+
+		info.stages.push_back(tessCtrlShaderStage);
+	}
+
+	if (tessEvalShader != nullptr)
+	{
+		PipelineShaderStage tessEvalShaderStage = {};
+		tessEvalShaderStage.entry = "main";
+		tessEvalShaderStage.module = tessEvalShader;
+
+		info.stages.push_back(tessEvalShaderStage);
+
+		info.tessellationInfo.patchControlPoints = 3;
+	}
+
+	if (geomShader != nullptr)
+	{
+		PipelineShaderStage geomShaderStage = {};
+		geomShaderStage.entry = "main";
+		geomShaderStage.module = geomShader;
+
+		info.stages.push_back(geomShaderStage);
+	}
+
+	info.vertexInputInfo = vertexInput;
+	info.inputAssemblyInfo = inputAssembly;
+	info.viewportInfo = viewportInfo;
+	info.rasterizationInfo = rastInfo;
+	info.depthStencilInfo = depthInfo;
+	info.colorBlendInfo = colorBlend;
+	info.dynamicStateInfo = dynamicState;
+
+	std::vector<DescriptorSetLayoutBinding> layoutBindings;
+	layoutBindings.push_back({0, DESCRIPTOR_TYPE_SAMPLER, 1, SHADER_STAGE_FRAGMENT_BIT});
+	layoutBindings.push_back({1, DESCRIPTOR_TYPE_SAMPLED_IMAGE, 8, SHADER_STAGE_FRAGMENT_BIT});
+
+	// mvp, camera position, camera cell offset, then the per mesh vertex decode scale & offset
+	info.inputPushConstantRanges = {{0, sizeof(glm::mat4) + sizeof(glm::vec4) * 4, SHADER_STAGE_VERTEX_BIT}};
+	info.inputSetLayouts = {layoutBindings};
+
+	pipe->pipeline = renderer->createGraphicsPipeline(info, pipelineRenderPass, 0);
+	pipe->depthPipeline = nullptr;
+
+	if (pipeDef->canRenderDepth)
+	{
+		ShaderModule shadowFragShader = renderer->createShaderModule(std::string(pipeDef->shadows_fragmentShaderFile), SHADER_STAGE_FRAGMENT_BIT, SHADER_LANGUAGE_GLSL);
+		fragShaderStage.module = shadowFragShader;
+
+		// Should probably do this better
+		info.rasterizationInfo.clockwiseFrontFace = !info.rasterizationInfo.clockwiseFrontFace;
+		info.stages[1].module = shadowFragShader;
+		info.depthStencilInfo.depthCompareOp = COMPARE_OP_LESS;
+
+		pipe->depthPipeline = renderer->createGraphicsPipeline(info, pipelineShadowRenderPass, 0);
+
+		renderer->destroyShaderModule(shadowFragShader);
+	}
+
+	renderer->destroyShaderModule(vertShader);
+	renderer->destroyShaderModule(fragShader);
+
+	if (tessCtrlShader != nullptr)
+		renderer->destroyShaderModule(tessCtrlShader);
+
+	if (tessEvalShader != nullptr)
+		renderer->destroyShaderModule(tessEvalShader);
+
+	if (geomShader != nullptr)
+		renderer->destroyShaderModule(geomShader);
+}
+
+ResourcePipeline ResourceManager::findPipeline (const std::string &defUniqueName)
+{
+	return findPipeline(AssetIDTable::getAssetID(defUniqueName));
+}
+
+ResourcePipeline ResourceManager::findPipeline (AssetID defUniqueNameID)
+{
+	auto it = loadedPipelines.find(defUniqueNameID);
+
+	return it != loadedPipelines.end() ? it->second.first : nullptr;
+}
+
+void ResourceManager::returnPipeline (const std::string &defUniqueName)
+{
+	returnPipeline(AssetIDTable::getAssetID(defUniqueName));
+}
+
+void ResourceManager::returnPipeline (AssetID defUniqueNameID)
+{
+	auto it = loadedPipelines.find(defUniqueNameID);
+
+	if (it != loadedPipelines.end())
+	{
+		// Decrement the reference counter
+		it->second.second --;
+
+		// If the reference counter is now zero, then delete the pipeline entirely
+		if (it->second.second == 0)
+		{
+			ResourcePipeline pipeline = it->second.first;
+
+			/*
+			 * A compile job might still be working on it. Waiting runs the main thread tasks & load callbacks, which can insert
+			 * into loadedPipelines (or even take a new reference to this pipeline), so it's looked up again afterwards.
+			 */
+			waitForAsyncLoad(pipeline->dataLoaded);
+			it = loadedPipelines.find(defUniqueNameID);
+
+			if (it->second.second != 0)
+				return;
+
+			renderer->destroyPipeline(pipeline->pipeline);
+			renderer->destroyPipeline(pipeline->depthPipeline);
+
+			pipelineHandles.release(pipeline->handle);
+			delete pipeline;
+
+			loadedPipelines.erase(it);
+		}
+	}
+}
+
+/*
+ * Gets the pipeline a material should be drawn w/. The first time a material needs it's pipeline, the pipeline is compiled in
+ * the background w/ loadPipelineAsync() instead of stalling the frame, and until it's done the material is drawn w/ the
+ * fallback pipeline (see RESOURCE_FALLBACK_PIPELINE). Once it's compiled this just starts returning the material's own
+ * pipeline. Returns nullptr if neither one can be drawn w/ yet, in which case the material should just be skipped.
+ */
+ResourcePipeline ResourceManager::getMaterialPipeline (ResourceMaterial material)
+{
+	ResourcePipeline pipeline = getPipeline(material->pipelineHandle);
+
+	// The material's pipeline handle is only looked up by id the first time, or if the pipeline's been reloaded since
+	if (pipeline == nullptr)
+	{
+		pipeline = findPipeline(material->pipelineID);
+
+		if (pipeline == nullptr)
+		{
+			// Only requested once, so a pipeline that fails to load doesn't get tried (and print an error) every frame
+			if (requestedMaterialPipelines.count(material->pipelineID) != 0)
+				return nullptr;
+
+			requestedMaterialPipelines.insert(material->pipelineID);
+
+			PipelineDef *pipeDef = getPipelineDef(material->pipelineID);
+
+			if (pipeDef == nullptr)
+			{
+				printf("%s Material: %s uses an undefined pipeline\n", WARN_PREFIX, material->defUniqueName.c_str());
+
+				return nullptr;
+			}
+
+			pipeline = loadPipelineAsync(pipeDef->uniqueName);
+
+			if (pipeline == nullptr)
+				return nullptr;
+		}
+
+		material->pipelineHandle = pipeline->handle;
+	}
+
+	if (!pipeline->dataLoaded)
+	{
+		pipeline = findPipeline(AssetIDTable::getAssetID(RESOURCE_FALLBACK_PIPELINE));
+
+		if (pipeline == nullptr || !pipeline->dataLoaded)
+			return nullptr;
+	}
+
+	return pipeline;
+}
+
+void ResourceManager::addLevelDef (const LevelDef &def)
+{
+	LevelDef *levelDef = new LevelDef();
+	*levelDef = def;
+
+	loadedLevelDefsMap[AssetIDTable::getAssetID(def.uniqueName)] = levelDef;
+}
+
+void ResourceManager::addMaterialDef (const MaterialDef &def)
+{
+	MaterialDef *matDef = new MaterialDef();
+	*matDef = def;
+
+	loadedMaterialDefsMap[AssetIDTable::getAssetID(def.uniqueName)] = matDef;
+}
+
+void ResourceManager::addMeshDef (const StaticMeshDef &def)
+{
+	StaticMeshDef *meshDef = new StaticMeshDef();
+	*meshDef = def;
+
+	generateMeshDefLODs(*meshDef);
+
+	loadedMeshDefsMap[AssetIDTable::getAssetID(def.uniqueName)] = meshDef;
+}
+
+/*
+ * Appends the LODs described by the def's "generatedLOD*" members to it's LOD lists. They're all simplified from the LOD
+ * w/ the greatest max dist, and that LOD's range (from the next closest LOD out to it's max dist) is split up geometrically
+ * between itself & the generated ones. The allowed error grows along w/ the distances, so the error on screen stays about the same.
+ */
+void ResourceManager::generateMeshDefLODs (StaticMeshDef &def)
+{
+	if (def.generatedLODCount == 0 || def.meshLODFiles.size() == 0)
+		return;
+
+	float triangleRatio = def.generatedLODTriangleRatio > 0.0f ? def.generatedLODTriangleRatio : 0.5f;
+	float maxError = def.generatedLODMaxError > 0.0f ? def.generatedLODMaxError : 0.01f;
+	float distRatio = def.generatedLODDistRatio > 0.0f ? def.generatedLODDistRatio : 0.5f;
+
+	size_t baseLOD = 0;
+	float nearDist = 0.0f;
+
+	for (size_t i = 1; i < def.meshLODMaxDists.size(); i ++)
+		if (def.meshLODMaxDists[i] > def.meshLODMaxDists[baseLOD])
+			baseLOD = i;
+
+	for (size_t i = 0; i < def.meshLODMaxDists.size(); i ++)
+		if (i != baseLOD)
+			nearDist = std::max(nearDist, def.meshLODMaxDists[i]);
+
+	std::string baseFile = def.meshLODFiles[baseLOD];
+	std::string baseMesh = def.meshLODNames[baseLOD];
+	float farDist = def.meshLODMaxDists[baseLOD];
+
+	def.meshLODMaxDists[baseLOD] = nearDist + (farDist - nearDist) * std::pow(distRatio, float(def.generatedLODCount));
+
+	for (uint32_t lod = 1; lod <= def.generatedLODCount; lod ++)
+	{
+		def.meshLODFiles.push_back(baseFile);
+		def.meshLODNames.push_back(getGeneratedLODMeshName(baseMesh, std::pow(triangleRatio, float(lod)), maxError / std::pow(distRatio, float(lod - 1))));
+		def.meshLODMaxDists.push_back(nearDist + (farDist - nearDist) * std::pow(distRatio, float(def.generatedLODCount - lod)));
+	}
+}
+
+void ResourceManager::addPipelineDef (const PipelineDef &def)
+{
+	PipelineDef *pipeDef = new PipelineDef();
+	*pipeDef = def;
+
+	loadedPipelineDefsMap[AssetIDTable::getAssetID(def.uniqueName)] = pipeDef;
+}
+
+LevelDef *ResourceManager::getLevelDef (const std::string &defUniqueName)
+{
+	return getLevelDef(AssetIDTable::getAssetID(defUniqueName));
+}
+
+MaterialDef *ResourceManager::getMaterialDef (const std::string &defUniqueName)
+{
+	return getMaterialDef(AssetIDTable::getAssetID(defUniqueName));
+}
+
+StaticMeshDef *ResourceManager::getMeshDef (const std::string &defUniqueName)
+{
+	return getMeshDef(AssetIDTable::getAssetID(defUniqueName));
+}
+
+PipelineDef *ResourceManager::getPipelineDef (const std::string &defUniqueName)
+{
+	return getPipelineDef(AssetIDTable::getAssetID(defUniqueName));
+}
+
+LevelDef *ResourceManager::getLevelDef (AssetID uniqueNameID)
+{
+	auto it = loadedLevelDefsMap.find(uniqueNameID);
+
+	if (it != loadedLevelDefsMap.end())
+		return it->second;
+
+	return nullptr;
+}
+
+MaterialDef *ResourceManager::getMaterialDef (AssetID uniqueNameID)
+{
+	auto it = loadedMaterialDefsMap.find(uniqueNameID);
+
+	if (it != loadedMaterialDefsMap.end())
+		return it->second;
+
+	return nullptr;
+}
+
+StaticMeshDef *ResourceManager::getMeshDef (AssetID uniqueNameID)
+{
+	auto it = loadedMeshDefsMap.find(uniqueNameID);
+
+	if (it != loadedMeshDefsMap.end())
+		return it->second;
+
+	return nullptr;
+}
+
+PipelineDef *ResourceManager::getPipelineDef (AssetID uniqueNameID)
+{
+	auto it = loadedPipelineDefsMap.find(uniqueNameID);
+
+	if (it != loadedPipelineDefsMap.end())
+		return it->second;
+
+	return nullptr;
+}
+
+/*
+ * Loads a mesh resource, complete with rendering data. This function is thread safe if called ONLY on the main thread,
+ * and note that it might busy wait if the resource has already been requested to be loaded, but the
+ * actual file loading/formatting has been pushed to a worker thread. Also note that this function
+ * WILL return a valid and immediately usuable mesh resource, and will load from a cache if possible.
+ * Preferably, and for explicit multithreading, or to load a mesh from another thread other than the main thread, use
+ * the other in-built function(s). This function is NOT the most optimized out of all the other built-ins.
+ *
+ * This function loads mesh data in a format optimized for rendering, as specified in the function.
+ */
+ResourceMesh ResourceManager::loadMeshImmediate (const std::string &file, const std::string &mesh)
+{
+	std::unique_lock<std::mutex> lock(loadedMeshes_mutex);
+
+	const MeshDataFormat rendererOptimizedMeshFormat = rendererMeshFormat;
+
+	auto it = loadedMeshes.find(getMeshCacheKey(file, mesh, rendererOptimizedMeshFormat, true));
+
+	if (it == loadedMeshes.end())
+	{
+		countResourceCacheLookup(nullptr, false);
+
+		ResourceMeshObject *meshRes = new ResourceMeshObject();
+		meshRes->file = file;
+		meshRes->mesh = mesh;
+		meshRes->meshFormat = rendererOptimizedMeshFormat;
+		meshRes->interlaced = true;
+		meshRes->dataLoaded = false;
+		meshRes->loadFailed = false;
+		meshRes->poolAllocation.page = MESH_POOL_INVALID_PAGE;
+
+		/*
+		 * The mesh is added to the cache before it's loaded, and the lock is let go of before uploading. Waiting on the upload
+		 * runs the upload callbacks (which can load or return other meshes), so they'd deadlock if we still held the lock. Anything
+		 * else that finds the mesh in the meantime waits on "dataLoaded", the same as it would for an async load.
+		 */
+		meshRes->handle = meshHandles.allocate(meshRes);
+		loadedMeshes[getMeshCacheKey(file, mesh, rendererOptimizedMeshFormat, true)] = std::make_pair(meshRes, 1);
+		pendingAsyncLoadCount ++;
+
+		lock.unlock();
+
+		FileView cookedMeshFile;
+		const char *cookedData;
+		size_t cookedDataSize;
+
+		if (openCookedMeshData(meshRes, cookedMeshFile, cookedData, cookedDataSize))
+		{
+			uploadMeshData(meshRes, cookedData, cookedDataSize);
+		}
+		else
+		{
+			ResourceMeshData rawMeshData = loadRawMeshData(file, mesh);
+
+			if (rawMeshData.faceCount == 0)
+			{
+				printf("%s Failed to load mesh \"%s\" from file \"%s\", it's missing or empty\n", ERR_PREFIX, mesh.c_str(), file.c_str());
+
+				meshRes->loadFailed = true;
+				finishAsyncLoad(meshRes, meshRes->dataLoaded);
+
+				return meshRes;
+			}
+
+			std::vector<char> formattedData = getFormattedMeshData(rawMeshData, rendererOptimizedMeshFormat, meshRes->indexChunkSize, meshRes->vertexStride, true);
+
+			meshRes->faceCount = rawMeshData.faceCount;
+			meshRes->uses32bitIndices = rawMeshData.uses32BitIndices;
+			getMeshVertexDecodeParams(rawMeshData, rendererOptimizedMeshFormat, meshRes->vertexDecodeScale, meshRes->vertexDecodeOffset);
+
+			// Generated LODs are cooked the first time they're loaded, so the simplification only has to be done once
+			if (mesh.find(MESH_GENERATED_LOD_SEPARATOR) != std::string::npos && getCookedMeshFile(file, mesh, rendererOptimizedMeshFormat) != file)
+				writeCookedMeshFile(FileLoader::instance()->getWorkingDir() + getCookedMeshFile(file, mesh, rendererOptimizedMeshFormat), rawMeshData, rendererOptimizedMeshFormat, formattedData, meshRes->indexChunkSize, meshRes->vertexStride);
+
+			uploadMeshData(meshRes, formattedData.data(), formattedData.size());
+		}
+
+		uploadBatcher->flushAndWait();
+		finishAsyncLoad(meshRes, meshRes->dataLoaded);
+
+		return meshRes;
+	}
+	else
+	{
+		// Increment the reference counter
+		it->second.second ++;
+		countResourceCacheLookup(it->second.first, true);
+
+		ResourceMesh meshRes = it->second.first;
+		lock.unlock();
+
+		// If the mesh object is loaded, but it's data isn't, then wait until it is
+		// This usually happens when one thread pushes loading to another thread, and so
+		// the object is created, but the loading hasn't finished yet
+		waitForAsyncLoad(meshRes->dataLoaded);
+
+		return meshRes;
+	}
+}
+
+/*
+ * Loads a mesh resource asynchronously. The mesh object is returned immediately, and the file loading & formatting
+ * is pushed to the worker threads. The GPU upload is done on the main thread during processAsyncLoads(), after which
+ * the "dataLoaded" member is set and the callback (if any) is called on the main thread. Until then the mesh object
+ * should not be used for rendering. Uses the same cache as loadMeshImmediate().
+ */
+ResourceMesh ResourceManager::loadMeshAsync (const std::string &file, const std::string &mesh, std::function<void(ResourceMesh)> callback)
+{
+	std::unique_lock<std::mutex> lock(loadedMeshes_mutex);
+
+	const MeshDataFormat rendererOptimizedMeshFormat = rendererMeshFormat;
+
+	auto it = loadedMeshes.find(getMeshCacheKey(file, mesh, rendererOptimizedMeshFormat, true));
+
+	if (it == loadedMeshes.end())
+	{
+		countResourceCacheLookup(nullptr, false);
+
+		ResourceMeshObject *meshRes = new ResourceMeshObject();
+		meshRes->file = file;
+		meshRes->mesh = mesh;
+		meshRes->meshFormat = rendererOptimizedMeshFormat;
+		meshRes->interlaced = true;
+		meshRes->dataLoaded = false;
+		meshRes->loadFailed = false;
+		meshRes->poolAllocation.page = MESH_POOL_INVALID_PAGE;
+
+		meshRes->handle = meshHandles.allocate(meshRes);
+		loadedMeshes[getMeshCacheKey(file, mesh, rendererOptimizedMeshFormat, true)] = std::make_pair(meshRes, 1);
+		pendingAsyncLoadCount ++;
+
+		lock.unlock();
+
+		if (callback)
+			addAsyncLoadCallback(meshRes, meshRes->dataLoaded, [callback, meshRes]() {callback(meshRes);});
+
+		pushAsyncWorkerJob([this, meshRes, file, mesh, rendererOptimizedMeshFormat]()
+		{
+			std::shared_ptr<FileView> cookedMeshFile = std::make_shared<FileView>();
+			const char *cookedData;
+			size_t cookedDataSize;
+
+			if (openCookedMeshData(meshRes, *cookedMeshFile, cookedData, cookedDataSize))
+			{
+				// The view has to stay mapped until the data has been copied to the staging memory
+				pushMainThreadAsyncTask([this, meshRes, cookedMeshFile, cookedData, cookedDataSize]()
+				{
+					if (uploadMeshData(meshRes, cookedData, cookedDataSize))
+						uploadBatcher->addUploadCallback([this, meshRes]() {finishAsyncLoad(meshRes, meshRes->dataLoaded);});
+					else
+						finishAsyncLoad(meshRes, meshRes->dataLoaded);
+				});
+
+				return;
+			}
+
+			ResourceMeshData rawMeshData = loadRawMeshData(file, mesh);
+
+			if (rawMeshData.faceCount == 0)
+			{
+				printf("%s Failed to load mesh \"%s\" from file \"%s\", it's missing or empty\n", ERR_PREFIX, mesh.c_str(), file.c_str());
+
+				meshRes->loadFailed = true;
+				pushMainThreadAsyncTask([this, meshRes]() {finishAsyncLoad(meshRes, meshRes->dataLoaded);});
+
+				return;
+			}
+
+			std::shared_ptr<std::vector<char> > formattedData = std::make_shared<std::vector<char> >(getFormattedMeshData(rawMeshData, rendererOptimizedMeshFormat, meshRes->indexChunkSize, meshRes->vertexStride, true));
+
+			meshRes->faceCount = rawMeshData.faceCount;
+			meshRes->uses32bitIndices = rawMeshData.uses32BitIndices;
+			getMeshVertexDecodeParams(rawMeshData, rendererOptimizedMeshFormat, meshRes->vertexDecodeScale, meshRes->vertexDecodeOffset);
+
+			if (mesh.find(MESH_GENERATED_LOD_SEPARATOR) != std::string::npos && getCookedMeshFile(file, mesh, rendererOptimizedMeshFormat) != file)
+				writeCookedMeshFile(FileLoader::instance()->getWorkingDir() + getCookedMeshFile(file, mesh, rendererOptimizedMeshFormat), rawMeshData, rendererOptimizedMeshFormat, *formattedData, meshRes->indexChunkSize, meshRes->vertexStride);
+
+			pushMainThreadAsyncTask([this, meshRes, formattedData]()
+			{
+				if (uploadMeshData(meshRes, formattedData->data(), formattedData->size()))
+					uploadBatcher->addUploadCallback([this, meshRes]() {finishAsyncLoad(meshRes, meshRes->dataLoaded);});
+				else
+					finishAsyncLoad(meshRes, meshRes->dataLoaded);
+			});
+		});
+
+		return meshRes;
+	}
+	else
+	{
+		// Increment the reference counter
+		it->second.second ++;
+		countResourceCacheLookup(it->second.first, true);
+
+		ResourceMesh meshRes = it->second.first;
+		lock.unlock();
+
+		if (callback)
+			addAsyncLoadCallback(meshRes, meshRes->dataLoaded, [callback, meshRes]() {callback(meshRes);});
+
+		return meshRes;
+	}
+}
+
+/*
+ * Suballocates the vertex & index ranges for a mesh from the mesh pool and queues it's formatted data to be
+ * uploaded to them. The data is only on the GPU once the upload batch it went in has finished (see UploadBatcher).
+ * If the mesh doesn't fit in the pool nothing is uploaded, the mesh is marked as failed and false is returned.
+ * Has to be called on the main thread.
+ */
+bool ResourceManager::uploadMeshData (ResourceMesh meshRes, const char *formattedData, size_t formattedDataSize)
+{
+	size_t vertexDataSize = formattedDataSize - meshRes->indexChunkSize;
+	size_t indexSize = meshRes->uses32bitIndices ? sizeof(uint32_t) : sizeof(uint16_t);
+
+	// The vertex range has to start on a whole vertex, and stay 4 byte aligned for the copy
+	size_t vertexAlignment = meshRes->vertexStride;
+
+	while (vertexAlignment % 4 != 0)
+		vertexAlignment += meshRes->vertexStride;
+
+	if (!meshPool->allocate(vertexDataSize, vertexAlignment, meshRes->indexChunkSize, meshRes->poolAllocation))
+	{
+		printf("%s Failed to load mesh \"%s\" from file \"%s\", it doesn't fit in the mesh pool\n", ERR_PREFIX, meshRes->mesh.c_str(), meshRes->file.c_str());
+
+		meshRes->meshVertexBuffer = nullptr;
+		meshRes->meshIndexBuffer = nullptr;
+		meshRes->faceCount = 0;
+		meshRes->loadFailed = true;
+
+		return false;
+	}
+
+	meshRes->meshVertexBuffer = meshPool->getVertexBuffer(meshRes->poolAllocation.page);
+	meshRes->meshIndexBuffer = meshPool->getIndexBuffer(meshRes->poolAllocation.page);
+	meshRes->firstIndex = uint32_t(meshRes->poolAllocation.indexOffset / indexSize);
+	meshRes->vertexOffset = int32_t(meshRes->poolAllocation.vertexOffset / meshRes->vertexStride);
+
+	memcpy(uploadBatcher->uploadBuffer(meshRes->meshVertexBuffer, meshRes->poolAllocation.vertexOffset, vertexDataSize), formattedData + meshRes->indexChunkSize, vertexDataSize);
+	memcpy(uploadBatcher->uploadBuffer(meshRes->meshIndexBuffer, meshRes->poolAllocation.indexOffset, meshRes->indexChunkSize), formattedData, meshRes->indexChunkSize);
+
+	return true;
+}
+
+/*
+ * Returns an owner's possession of a mesh. Essentially just decrements the
+ * reference counter for the resource, and deletes it if there's none left.
+ */
+void ResourceManager::returnMesh (ResourceMesh mesh)
+{
+	// If the mesh is still being loaded asynchronously, then we have to let it finish before we can safely destroy it
+	waitForAsyncLoad(mesh->dataLoaded);
+
+	std::unique_lock<std::mutex> lock(loadedMeshes_mutex);
+
+	auto it = loadedMeshes.find(getMeshCacheKey(mesh->file, mesh->mesh, mesh->meshFormat, mesh->interlaced));
+
+	if (it != loadedMeshes.end())
+	{
+		// Decrement the reference counter
+		it->second.second --;
+
+		// If the reference counter is now zero, then it's kept around until it's evicted by updateRetainedResources()
+		if (it->second.second == 0)
+			retainResource(RETAINED_RESOURCE_TYPE_MESH, mesh, sizeof(ResourceMeshObject), mesh->poolAllocation.vertexSize + mesh->poolAllocation.indexSize);
+	}
+}
+
+TextureFileFormat inferFileFormat (const std::string &file);
+
+ResourceTexture ResourceManager::loadTextureImmediate (const std::string &file, TextureFileFormat format)
+{
+	std::unique_lock<std::mutex> lock(loadedTextures_mutex);
+
+	auto it = loadedTextures.find(AssetIDTable::getAssetID(file));
+
+	if (it == loadedTextures.end())
+	{
+		countResourceCacheLookup(nullptr, false);
+
+		ResourceTextureObject *texRes = new ResourceTextureObject();
+		texRes->files = {file};
+		texRes->dataLoaded = false;
+		texRes->loadFailed = false;
+		texRes->arrayLayers = 1;
+
+		if (format == TEXTURE_FILE_FORMAT_MAX_ENUM)
+			format = inferFileFormat(file);
+
+		if (format == TEXTURE_FILE_FORMAT_MAX_ENUM)
+		{
+			// If it's still max enum, then we failed to specify/find the format we're supposed to load it in
+			// Therefore, we'll cancel and return a nullptr
+			printf("%s Failed to load texture: %s, couldn't find or isn't a supported file format", ERR_PREFIX, file.c_str());
+
+			return nullptr;
+		}
+
+		// Let go of the lock before uploading, since the upload callbacks can load or return other textures (see loadMeshImmediate())
+		texRes->handle = textureHandles.allocate(texRes);
+		loadedTextures[AssetIDTable::getAssetID(file)] = std::make_pair(texRes, 1);
+		pendingAsyncLoadCount ++;
+
+		lock.unlock();
+
+		ResourceTextureStagingData texData = {};
+
+		if (readTextureData(texRes->files, format, texData))
+		{
+			uploadTextureData(texRes, texData);
+			uploadBatcher->flushAndWait();
+
+			texRes->textureView = renderer->createTextureView(texRes->texture, TEXTURE_VIEW_TYPE_2D, {0, texRes->mipmapLevels, 0, 1});
+		}
+		else
+			texRes->loadFailed = true;
+
+		finishAsyncLoad(texRes, texRes->dataLoaded);
+
+		return texRes;
+	}
+	else
+	{
+		// Increment the reference counter
+		it->second.second ++;
+		countResourceCacheLookup(it->second.first, true);
+
+		ResourceTexture texRes = it->second.first;
+		lock.unlock();
+
+		// If the texture object is loaded, but it's data isn't, then wait until it is
+		// This usually happens when one thread pushes loading to another thread, and so
+		// the object is created, but the loading hasn't finished yet
+		waitForAsyncLoad(texRes->dataLoaded);
+
+		/*
+		 * Whatever loads a texture immediately can hold on to it's view, so if it was streamed then it has to stop being
+		 * streamed, and has to have all of it's mip levels for good.
+		 */
+		if (texRes->mipStreamable)
+		{
+			stopTextureStreaming(texRes);
+
+			if (texRes->residentMip > 0)
+			{
+				ResourceTextureStagingData texData = {};
+				readTextureData(texRes->files, TEXTURE_FILE_FORMAT_DDS, texData);
+
+				RendererTexture *fullTexture = uploadDDSTextureMips(texRes, texData, 0);
+				uploadBatcher->flushAndWait();
+
+				swapStreamedTexture(texRes, fullTexture, 0);
+			}
+		}
+
+		return texRes;
+	}
+}
+
+ResourceTexture ResourceManager::loadTextureArrayImmediate (const std::vector<std::string> &files, TextureFileFormat format)
+{
+	std::unique_lock<std::mutex> lock(loadedTextures_mutex);
+
+	auto it = loadedTextures.find(AssetIDTable::getAssetID(files[0]));
+
+	if (it == loadedTextures.end())
+	{
+		countResourceCacheLookup(nullptr, false);
+
+		ResourceTextureObject *texRes = new ResourceTextureObject();
+		texRes->files = files;
+		texRes->dataLoaded = false;
+		texRes->loadFailed = false;
+		texRes->arrayLayers = 1;
+
+		if (format == TEXTURE_FILE_FORMAT_MAX_ENUM)
+			format = inferFileFormat(files[0]);
+
+		if (format == TEXTURE_FILE_FORMAT_MAX_ENUM)
+		{
+			// If it's still max enum, then we failed to specify/find the format we're supposed to load it in
+			// Therefore, we'll cancel and return a nullptr
+			printf("%s Failed to load texture: %s, couldn't find or isn't a supported file format", ERR_PREFIX, files[0].c_str());
+
+			return nullptr;
+		}
+
+		// Let go of the lock before uploading, since the upload callbacks can load or return other textures (see loadMeshImmediate())
+		texRes->handle = textureHandles.allocate(texRes);
+		loadedTextures[AssetIDTable::getAssetID(files[0])] = std::make_pair(texRes, 1);
+		pendingAsyncLoadCount ++;
+
+		lock.unlock();
+
+		ResourceTextureStagingData texData = {};
+
+		if (readTextureData(texRes->files, format, texData))
+		{
+			uploadTextureData(texRes, texData);
+			uploadBatcher->flushAndWait();
+
+			texRes->textureView = renderer->createTextureView(texRes->texture, TEXTURE_VIEW_TYPE_2D_ARRAY, {0, texRes->mipmapLevels, 0, (uint32_t) files.size()});
+		}
+		else
+			texRes->loadFailed = true;
+
+		finishAsyncLoad(texRes, texRes->dataLoaded);
+
+		return texRes;
+	}
+	else
+	{
+		// Increment the reference counter
+		it->second.second ++;
+		countResourceCacheLookup(it->second.first, true);
+
+		ResourceTexture texRes = it->second.first;
+		lock.unlock();
+
+		// If the texture object is loaded, but it's data isn't, then wait until it is
+		// This usually happens when one thread pushes loading to another thread, and so
+		// the object is created, but the loading hasn't finished yet
+		waitForAsyncLoad(texRes->dataLoaded);
+
+		return texRes;
+	}
+}
+
+/*
+ * Loads a texture asynchronously. The texture object is returned immediately, and the file reading & decoding is
+ * pushed to the worker threads. The GPU upload is done on the main thread during processAsyncLoads(), after which
+ * the "dataLoaded" member is set and the callback (if any) is called on the main thread. Until then the texture
+ * object should not be used for rendering. Uses the same cache as loadTextureImmediate().
+ */
+ResourceTexture ResourceManager::loadTextureAsync (const std::string &file, TextureFileFormat format, std::function<void(ResourceTexture)> callback)
+{
+	std::unique_lock<std::mutex> lock(loadedTextures_mutex);
+
+	auto it = loadedTextures.find(AssetIDTable::getAssetID(file));
+
+	if (it == loadedTextures.end())
+	{
+		countResourceCacheLookup(nullptr, false);
+
+		if (format == TEXTURE_FILE_FORMAT_MAX_ENUM)
+			format = inferFileFormat(file);
+
+		if (format == TEXTURE_FILE_FORMAT_MAX_ENUM)
+		{
+			// If it's still max enum, then we failed to specify/find the format we're supposed to load it in
+			// Therefore, we'll cancel and return a nullptr
+			printf("%s Failed to load texture: %s, couldn't find or isn't a supported file format", ERR_PREFIX, file.c_str());
+
+			return nullptr;
+		}
+
+		ResourceTextureObject *texRes = new ResourceTextureObject();
+		texRes->files = {file};
+		texRes->dataLoaded = false;
+		texRes->loadFailed = false;
+		texRes->arrayLayers = 1;
+		texRes->mipStreamable = format == TEXTURE_FILE_FORMAT_DDS;
+
+		texRes->handle = textureHandles.allocate(texRes);
+		loadedTextures[AssetIDTable::getAssetID(file)] = std::make_pair(texRes, 1);
+		pendingAsyncLoadCount ++;
+
+		lock.unlock();
+
+		if (callback)
+			addAsyncLoadCallback(texRes, texRes->dataLoaded, [callback, texRes]() {callback(texRes);});
+
+		pushAsyncWorkerJob([this, texRes, file, format]()
+		{
+			std::shared_ptr<ResourceTextureStagingData> texData = std::make_shared<ResourceTextureStagingData>();
+
+			if (!readTextureData({file}, format, *texData))
+			{
+				texRes->mipStreamable = false;
+				texRes->loadFailed = true;
+				pushMainThreadAsyncTask([this, texRes]() {finishAsyncLoad(texRes, texRes->dataLoaded);});
+
+				return;
+			}
+
+			pushMainThreadAsyncTask([this, texRes, texData]()
+			{
+				uploadTextureData(texRes, *texData);
+				texRes->textureView = renderer->createTextureView(texRes->texture, TEXTURE_VIEW_TYPE_2D, {0, texRes->mipmapLevels - texRes->residentMip, 0, 1});
+
+				if (texRes->mipStreamable)
+				{
+					streamedTextures.insert(texRes);
+					streamedTextureMemorySize += texRes->memorySize;
+				}
+
+				uploadBatcher->addUploadCallback([this, texRes]() {finishAsyncLoad(texRes, texRes->dataLoaded);});
+			});
+		});
+
+		return texRes;
+	}
+	else
+	{
+		// Increment the reference counter
+		it->second.second ++;
+		countResourceCacheLookup(it->second.first, true);
+
+		ResourceTexture texRes = it->second.first;
+		lock.unlock();
+
+		if (callback)
+			addAsyncLoadCallback(texRes, texRes->dataLoaded, [callback, texRes]() {callback(texRes);});
+
+		return texRes;
+	}
+}
+
+void ResourceManager::returnTexture (ResourceTexture tex)
+{
+	// If the texture is still being loaded asynchronously, then we have to let it finish before we can safely destroy it
+	waitForAsyncLoad(tex->dataLoaded);
+
+	std::unique_lock<std::mutex> lock(loadedTextures_mutex);
+
+	auto it = loadedTextures.find(AssetIDTable::getAssetID(tex->files[0]));
+
+	if (it != loadedTextures.end())
+	{
+		// Decrement the reference counter
+		it->second.second --;
+
+		// If the reference counter is now zero, then it's kept around until it's evicted by updateRetainedResources()
+		if (it->second.second == 0)
+			retainResource(RETAINED_RESOURCE_TYPE_TEXTURE, tex, sizeof(ResourceTextureObject), tex->memorySize);
+	}
+}
+
+/*
+ * Sets how many texels across (on it's bigger side) a streamed texture needs to be, which decides the most detailed
+ * mip level that's streamed in for it. Doesn't do anything for textures that aren't streamed. Has to be called on the main thread.
+ */
+void ResourceManager::setTextureRequiredSize (ResourceTexture tex, uint32_t requiredSize)
+{
+	if (!tex->dataLoaded || !tex->mipStreamable)
+		return;
+
+	uint32_t mip = 0;
+
+	while (mip + 1 < tex->mipmapLevels && std::max(tex->width >> (mip + 1), tex->height >> (mip + 1)) >= requiredSize)
+		mip ++;
+
+	tex->requestedMip = mip;
+}
+
+/*
+ * Starts streaming in the mip levels that streamed textures want, as long as they fit in the texture streaming budget. If
+ * they don't, then the textures that have more levels resident than they want drop them, to make room for next time.
+ */
+void ResourceManager::updateTextureStreaming ()
+{
+	bool budgetExceeded = streamedTextureMemorySize > resourceCacheConfig.textureStreamingBudget;
+
+	for (auto it = streamedTextures.begin(); it != streamedTextures.end(); it ++)
+	{
+		ResourceTexture tex = *it;
+
+		if (textureMipStreams.size() >= TEXTURE_STREAMING_MAX_IN_FLIGHT || (frameUploadBudget > 0 && uploadBatcher->getFrameUploadSize() >= frameUploadBudget))
+			return;
+
+		uint32_t targetMip = std::min(tex->requestedMip, getTextureTailMip(tex));
+
+		if (!tex->dataLoaded || targetMip >= tex->residentMip || textureMipStreams.count(tex) > 0)
+			continue;
+
+		// Only stream in as many levels as we have room for
+		while (targetMip < tex->residentMip && streamedTextureMemorySize - tex->memorySize + getDDSTextureMipsSize(tex, targetMip, 1) > resourceCacheConfig.textureStreamingBudget)
+			targetMip ++;
+
+		if (targetMip < tex->residentMip)
+			streamTextureMips(tex, targetMip);
+		else
+			budgetExceeded = true;
+	}
+
+	if (!budgetExceeded)
+		return;
+
+	for (auto it = streamedTextures.begin(); it != streamedTextures.end(); it ++)
+	{
+		ResourceTexture tex = *it;
+
+		if (textureMipStreams.size() >= TEXTURE_STREAMING_MAX_IN_FLIGHT)
+			return;
+
+		uint32_t targetMip = std::min(tex->requestedMip, getTextureTailMip(tex));
+
+		if (tex->dataLoaded && targetMip > tex->residentMip && textureMipStreams.count(tex) == 0)
+			streamTextureMips(tex, targetMip);
+	}
+}
+
+/*
+ * Changes the resident mip levels of a streamed texture, see TextureMipStream.
+ */
+void ResourceManager::streamTextureMips (ResourceTexture tex, uint32_t targetMip)
+{
+	std::shared_ptr<TextureMipStream> stream = std::make_shared<TextureMipStream>();
+	stream->tex = tex;
+	stream->targetMip = targetMip;
+	stream->cancelled = false;
+
+	textureMipStreams[tex] = stream;
+
+	std::vector<std::string> files = tex->files;
+
+	pushAsyncWorkerJob([this, stream, files]()
+	{
+		std::shared_ptr<ResourceTextureStagingData> texData = std::make_shared<ResourceTextureStagingData>();
+		readTextureData(files, TEXTURE_FILE_FORMAT_DDS, *texData);
+
+		pushMainThreadAsyncTask([this, stream, texData]()
+		{
+			if (stream->cancelled)
+				return;
+
+			ResourceTexture tex = stream->tex;
+
+			// The file's changed since the texture was loaded, so the levels don't line up anymore
+			if (texData->ddsBuffers.size() != 1 || texData->mipmapLevels != tex->mipmapLevels || texData->textureFormat != tex->textureFormat || texData->width != tex->width || texData->height != tex->height)
+			{
+				printf("%s Stopped streaming texture: %s, the file doesn't match the loaded texture anymore\n", WARN_PREFIX, tex->files[0].c_str());
+
+				stopTextureStreaming(tex);
+
+				return;
+			}
+
+			RendererTexture *newTexture = uploadDDSTextureMips(tex, *texData, stream->targetMip);
+
+			uploadBatcher->addUploadCallback([this, stream, newTexture]()
+			{
+				if (stream->cancelled)
+				{
+					pendingTextureFrees.push_back({TEXTURE_STREAMING_FREE_DELAY_FRAMES, newTexture, nullptr, nullptr});
+
+					return;
+				}
+
+				textureMipStreams.erase(stream->tex);
+				swapStreamedTexture(stream->tex, newTexture, stream->targetMip);
+			});
+		});
+	});
+}
+
+/*
+ * Swaps a texture's renderer texture for one w/ a different set of mip levels resident, and rewrites the descriptor sets of
+ * every material that uses it. The old texture, view, & descriptor sets are freed once no frame in flight can be using them.
+ */
+void ResourceManager::swapStreamedTexture (ResourceTexture tex, RendererTexture *newTexture, uint32_t newResidentMip)
+{
+	pendingTextureFrees.push_back({TEXTURE_STREAMING_FREE_DELAY_FRAMES, tex->texture, tex->textureView, nullptr});
+
+	tex->texture = newTexture;
+	tex->textureView = renderer->createTextureView(newTexture, TEXTURE_VIEW_TYPE_2D, {0, tex->mipmapLevels - newResidentMip, 0, 1});
+	tex->residentMip = newResidentMip;
+
+	size_t newMemorySize = getDDSTextureMipsSize(tex, newResidentMip, 1);
+
+	if (streamedTextures.count(tex) > 0)
+		streamedTextureMemorySize = streamedTextureMemorySize - tex->memorySize + newMemorySize;
+
+	tex->memorySize = newMemorySize;
+
+	loadedMaterials.forEach([this, tex](std::pair<AssetID, std::pair<ResourceMaterial, uint32_t> > &entry)
+	{
+		ResourceMaterial mat = entry.second.first;
+
+		// Materials that are still loading write their descriptor set once they're done, so they'll get the new view anyways
+		if (!mat->dataLoaded || std::find(mat->textures, mat->textures + mat->usedTextureCount, tex) == mat->textures + mat->usedTextureCount)
+			return;
+
+		pendingTextureFrees.push_back({TEXTURE_STREAMING_FREE_DELAY_FRAMES, nullptr, nullptr, mat->descriptorSet});
+
+		mat->descriptorSet = mainThreadDescriptorPool->allocateDescriptorSet();
+		writeMaterialDescriptorSet(mat);
+	});
+}
+
+/*
+ * Stops a texture from being streamed, w/ whatever mip levels it has resident right now. Any stream in progress is cancelled.
+ */
+void ResourceManager::stopTextureStreaming (ResourceTexture tex)
+{
+	auto streamIt = textureMipStreams.find(tex);
+
+	if (streamIt != textureMipStreams.end())
+	{
+		streamIt->second->cancelled = true;
+		textureMipStreams.erase(streamIt);
+	}
+
+	if (streamedTextures.erase(tex) > 0)
+		streamedTextureMemorySize -= tex->memorySize;
+
+	tex->mipStreamable = false;
+}
+
+void ResourceManager::updatePendingTextureFrees (bool freeAll)
+{
+	for (size_t i = 0; i < pendingTextureFrees.size(); i ++)
+		pendingTextureFrees[i].framesLeft --;
+
+	while (pendingTextureFrees.size() > 0 && (freeAll || pendingTextureFrees.front().framesLeft == 0))
+	{
+		PendingTextureFree &pendingFree = pendingTextureFrees.front();
+
+		if (pendingFree.textureView != nullptr)
+			renderer->destroyTextureView(pendingFree.textureView);
+
+		if (pendingFree.texture != nullptr)
+			renderer->destroyTexture(pendingFree.texture);
+
+		if (pendingFree.descriptorSet != nullptr)
+			mainThreadDescriptorPool->freeDescriptorSet(pendingFree.descriptorSet);
+
+		pendingTextureFrees.pop_front();
+	}
+}
+
+/*
+ * Reads (and decodes if need be) the texture data from a set of files, one per array layer. Returns false if there
+ * wasn't anything that could be uploaded. This doesn't touch the renderer at all, so it's safe to call from any thread.
+ */
+bool ResourceManager::readTextureData (const std::vector<std::string> &files, TextureFileFormat format, ResourceTextureStagingData &data)
+{
+	data.format = format;
+
+	// If every layer of a PNG texture has been cooked, then the cooked (block compressed & mipmapped) DDS is loaded instead
+	if (format == TEXTURE_FILE_FORMAT_PNG)
+	{
+		std::vector<std::string> cookedFiles;
+
+		for (size_t i = 0; i < files.size(); i ++)
+		{
+			if (files[i].length() == 0 || !FileLoader::instance()->fileExists(TextureCooker::getCookedTextureFile(files[i])))
+				break;
+
+			cookedFiles.push_back(TextureCooker::getCookedTextureFile(files[i]));
+		}
+
+		if (cookedFiles.size() == files.size())
+		{
+			data.format = TEXTURE_FILE_FORMAT_DDS;
+			readDDSTextureData(cookedFiles, data);
+
+			return data.ddsBuffers.size() > 0;
+		}
+	}
+
+	switch (format)
+	{
+		case TEXTURE_FILE_FORMAT_PNG:
+			return readPNGTextureData(files, data);
+		case TEXTURE_FILE_FORMAT_DDS:
+			readDDSTextureData(files, data);
+			return data.ddsBuffers.size() > 0;
+		default:
+			return false;
+	}
+}
+
+/*
+ * Creates the texture & queues the data read by readTextureData() to be uploaded. Like meshes, the data is only on
+ * the GPU once it's upload batch has finished. Has to be called on the main thread.
+ */
+void ResourceManager::uploadTextureData (ResourceTexture tex, ResourceTextureStagingData &data)
+{
+	switch (data.format)
+	{
+		case TEXTURE_FILE_FORMAT_PNG:
+			uploadPNGTextureData(tex, data);
+			break;
+		case TEXTURE_FILE_FORMAT_DDS:
+			uploadDDSTextureData(tex, data);
+			break;
+		default:
+			break;
+	}
+
+	/*
+	 * I'm formatting the debug name to trim it to the "GameData/textures/" directory. For example:
+	 * "GameData/textures/blah.png" would turn to ".../blah.png""
+	 */
+
+	size_t i = tex->files[0].find("/textures/");
+
+	std::string debugMarkerName = ".../";
+
+	if (i != tex->files[0].npos)
+		debugMarkerName += tex->files[0].substr(i + 10);
+	else
+		debugMarkerName = tex->files[0];
+
+	renderer->setObjectDebugName(tex->texture, OBJECT_TYPE_TEXTURE, debugMarkerName);
+}
+
+/*
+ * Reads & decodes every layer of a PNG texture. The layers are decoded in parallel on the async workers, since
+ * decoding is by far the slowest part of loading a PNG, and texture arrays (i.e. terrain materials) can have a lot of layers.
+ * Returns false if no layer could be decoded, or if the layers aren't all the same size. Layers that fail on their own are
+ * left empty, and uploaded as black.
+ */
+bool ResourceManager::readPNGTextureData (const std::vector<std::string> &files, ResourceTextureStagingData &data, uint32_t maxThreads)
+{
+	std::vector<std::vector<uint8_t>> &textureData = data.pngLayers;
+	std::vector<uint32_t> layerWidths(files.size(), 0), layerHeights(files.size(), 0);
+	std::vector<unsigned> layerErrors(files.size(), 0);
+
+	textureData.resize(files.size());
+
+	runParallelJobs((uint32_t) files.size(), [&](uint32_t f)
+	{
+		if (files[f].length() == 0)
+			return;
+
+		FileView pngData = FileLoader::instance()->openFileView(files[f]);
+
+		if (pngData.size() == 0)
+			return;
+
+		layerErrors[f] = lodepng::decode(textureData[f], layerWidths[f], layerHeights[f], reinterpret_cast<const unsigned char*>(pngData.data()), pngData.size(), LCT_RGBA, 8);
+	}, maxThreads);
+
+	uint32_t width = 0, height = 0;
+
+	for (uint32_t f = 0; f < files.size(); f ++)
+	{
+		if (layerErrors[f])
+		{
+			printf("%s Encountered an error while loading PNG file: %s, lodepng returned: %u\n", ERR_PREFIX, files[f].c_str(), layerErrors[f]);
+
+			textureData[f].clear();
+			continue;
+		}
+
+		if (textureData[f].size() == 0)
+			continue;
+
+		// Make sure each texture has the same size
+		if (width != 0 && (layerWidths[f] != width || layerHeights[f] != height))
+		{
+			printf("%s Couldn't load a texture array, one or more textures don't have consistent dimensions. Files: ", ERR_PREFIX);
+
+			for (uint32_t i = 0; i < files.size(); i ++)
+			{
+				printf("%s%s", files[i].c_str(), (i == files.size() - 1 ? "" : ", "));
+			}
+			printf("\n");
+
+			return false;
+		}
+
+		width = layerWidths[f];
+		height = layerHeights[f];
+	}
+
+	if (width == 0 || height == 0)
+	{
+		printf("%s Failed to load PNG texture: %s, none of it's layers could be decoded\n", ERR_PREFIX, files.size() > 0 ? files[0].c_str() : "");
+
+		return false;
+	}
+
+	data.width = width;
+	data.height = height;
+	data.mipmapLevels = (uint32_t) glm::floor(glm::log2(glm::max<float>(width, height))) + 1;
+	data.textureFormat = RESOURCE_FORMAT_R8G8B8A8_UNORM;
+
+	return true;
+}
+
+/*
+ * Queues every layer as a single upload, w/ the mipmaps for all of the layers generated at once by the upload
+ * batch, one blit per mip level. Layers that failed to load are left black.
+ */
+void ResourceManager::uploadPNGTextureData (ResourceTexture tex, ResourceTextureStagingData &data)
+{
+	uint32_t width = data.width, height = data.height;
+	std::vector<std::vector<uint8_t>> &textureData = data.pngLayers;
+	uint32_t layerCount = (uint32_t) textureData.size();
+	size_t layerSize = size_t(width) * height * 4;
+
+	tex->width = width;
+	tex->height = height;
+	tex->mipmapLevels = data.mipmapLevels;
+	tex->textureFormat = data.textureFormat;
+	tex->mipStreamable = false; // The mip chain is generated on the GPU, so there aren't any mips to stream from
+	tex->residentMip = 0;
+	tex->texture = renderer->createTexture({width, height, 1}, RESOURCE_FORMAT_R8G8B8A8_UNORM, TEXTURE_USAGE_TRANSFER_SRC_BIT | TEXTURE_USAGE_TRANSFER_DST_BIT | TEXTURE_USAGE_SAMPLED_BIT, MEMORY_USAGE_GPU_ONLY, false, tex->mipmapLevels, layerCount);
+	tex->memorySize = (layerSize * layerCount * 4) / 3; // The mip chain adds about a third
+
+	std::vector<TextureBufferCopyInfo> copyRegions(layerCount);
+
+	for (uint32_t f = 0; f < layerCount; f ++)
+	{
+		copyRegions[f].bufferOffset = f * layerSize;
+		copyRegions[f].textureSubresource = {0, f, 1};
+		copyRegions[f].textureOffset = {0, 0, 0};
+		copyRegions[f].textureExtent = {width, height, 1};
+	}
+
+	char *stagingData = static_cast<char*>(uploadBatcher->uploadTexture(tex->texture, layerSize * layerCount, copyRegions, tex->mipmapLevels, layerCount, tex->mipmapLevels > 1));
+
+	for (uint32_t f = 0; f < layerCount; f ++)
+	{
+		if (textureData[f].size() == layerSize)
+			memcpy(stagingData + f * layerSize, textureData[f].data(), layerSize);
+		else
+			memset(stagingData + f * layerSize, 0, layerSize);
+	}
+}
+
+inline ResourceFormat convertDXGIFormatToResourceFormat(uint32_t dxgi)
+{
+	switch (dxgi)
+	{
+		case 71: // BC1_UNORM
+			return RESOURCE_FORMAT_BC1_RGBA_UNORM_BLOCK;
+		case 72: // BC1_UNORM_SRGB
+			return RESOURCE_FORMAT_BC1_RGBA_SRGB_BLOCK;
+		case 74: // BC2_UNORM
+			return RESOURCE_FORMAT_BC2_UNORM_BLOCK;
+		case 75: // BC2_UNORM_SRGB
+			return RESOURCE_FORMAT_BC2_SRGB_BLOCK;
+		case 77: // BC3_UNORM
+			return RESOURCE_FORMAT_BC3_UNORM_BLOCK;
+		case 78: // BC3_UNORM_SRGB
+			return RESOURCE_FORMAT_BC3_SRGB_BLOCK;
+		case 80: // BC4_UNORM
+			return RESOURCE_FORMAT_BC4_UNORM_BLOCK;
+		case 81: // BC4_SNORM
+			return RESOURCE_FORMAT_BC4_SNORM_BLOCK;
+		case 83: // BC5_UNORM
+			return RESOURCE_FORMAT_BC5_UNORM_BLOCK;
+		case 84: // BC5_SNORM
+			return RESOURCE_FORMAT_BC5_SNORM_BLOCK;
+		case 95: // BC6H_UF16
+			return RESOURCE_FORMAT_BC6H_UFLOAT_BLOCK;
+		case 96: // BC6H_SF16
+			return RESOURCE_FORMAT_BC6H_SFLOAT_BLOCK;
+		case 98: // BC7_UNORM
+			return RESOURCE_FORMAT_BC7_UNORM_BLOCK;
+		case 99: // BC7_UNORM_SRGB
+			return RESOURCE_FORMAT_BC7_SRGB_BLOCK;
+		case 112: // R16G16_SFLOAT
+			return RESOURCE_FORMAT_R16G16_SFLOAT;
+		default:
+			return RESOURCE_FORMAT_UNDEFINED;
+	}
+}
+
+inline ResourceFormat getDDSFormat(const char *buffer)
+{
+	const DDSHeader &header = *reinterpret_cast<const DDSHeader*>(&buffer[4]);
+
+	switch (header.ddspf.dwFourCC)
+	{
+		case MAKEFOURCC('D', 'X', '1', '0'):
+		{
+			const DDSHeaderDXT10 &header10 = *reinterpret_cast<const DDSHeaderDXT10*>(&buffer[sizeof(uint32_t) + sizeof(DDSHeader)]);
 
 			return convertDXGIFormatToResourceFormat(header10.dxgiFormat);
 		}
-		case MAKEFOURCC('D', 'X', 'T', '1'):
-			return RESOURCE_FORMAT_BC1_RGBA_UNORM_BLOCK;
-		case MAKEFOURCC('D', 'X', 'T', '3'):
-			return RESOURCE_FORMAT_BC2_UNORM_BLOCK;
-		case MAKEFOURCC('D', 'X', 'T', '5'):
-			return RESOURCE_FORMAT_BC3_UNORM_BLOCK;
-		case MAKEFOURCC('B', 'C', '4', 'U'):
-			return RESOURCE_FORMAT_BC4_UNORM_BLOCK;
-		case MAKEFOURCC('B', 'C', '4', 'S'):
-			return RESOURCE_FORMAT_BC4_SNORM_BLOCK;
-		case MAKEFOURCC('B', 'C', '5', 'U'):
-			return RESOURCE_FORMAT_BC5_UNORM_BLOCK;
-		case MAKEFOURCC('B', 'C', '5', 'S'):
-			return RESOURCE_FORMAT_BC5_SNORM_BLOCK;
-		default:
-			return convertDXGIFormatToResourceFormat(header.ddspf.dwFourCC);
+		case MAKEFOURCC('D', 'X', 'T', '1'):
+			return RESOURCE_FORMAT_BC1_RGBA_UNORM_BLOCK;
+		case MAKEFOURCC('D', 'X', 'T', '3'):
+			return RESOURCE_FORMAT_BC2_UNORM_BLOCK;
+		case MAKEFOURCC('D', 'X', 'T', '5'):
+			return RESOURCE_FORMAT_BC3_UNORM_BLOCK;
+		case MAKEFOURCC('B', 'C', '4', 'U'):
+			return RESOURCE_FORMAT_BC4_UNORM_BLOCK;
+		case MAKEFOURCC('B', 'C', '4', 'S'):
+			return RESOURCE_FORMAT_BC4_SNORM_BLOCK;
+		case MAKEFOURCC('B', 'C', '5', 'U'):
+			return RESOURCE_FORMAT_BC5_UNORM_BLOCK;
+		case MAKEFOURCC('B', 'C', '5', 'S'):
+			return RESOURCE_FORMAT_BC5_SNORM_BLOCK;
+		default:
+			return convertDXGIFormatToResourceFormat(header.ddspf.dwFourCC);
+	}
+}
+
+inline uint8_t getFormatBlockSize(ResourceFormat format)
+{
+	switch (format)
+	{
+		case RESOURCE_FORMAT_BC1_RGBA_UNORM_BLOCK:
+		case RESOURCE_FORMAT_BC1_RGBA_SRGB_BLOCK:
+		case RESOURCE_FORMAT_BC4_UNORM_BLOCK:
+		case RESOURCE_FORMAT_BC4_SNORM_BLOCK:
+			return 8;
+		case RESOURCE_FORMAT_BC2_UNORM_BLOCK:
+		case RESOURCE_FORMAT_BC2_SRGB_BLOCK:
+		case RESOURCE_FORMAT_BC3_UNORM_BLOCK:
+		case RESOURCE_FORMAT_BC3_SRGB_BLOCK:
+		case RESOURCE_FORMAT_BC5_UNORM_BLOCK:
+		case RESOURCE_FORMAT_BC5_SNORM_BLOCK:
+		case RESOURCE_FORMAT_BC6H_UFLOAT_BLOCK:
+		case RESOURCE_FORMAT_BC6H_SFLOAT_BLOCK:
+		case RESOURCE_FORMAT_BC7_UNORM_BLOCK:
+		case RESOURCE_FORMAT_BC7_SRGB_BLOCK:
+			return 16;
+		case RESOURCE_FORMAT_R16G16_SFLOAT:
+			return 64;
+		default:
+			return 0;
+	}
+}
+
+size_t getMipSizeCompressed(uint32_t width, uint32_t height, uint32_t level, uint32_t blockSize)
+{
+	return ((std::max(width >> level, 1u) + 3) / 4) * ((std::max(height >> level, 1u) + 3) / 4) * blockSize;
+}
+
+void ResourceManager::readDDSTextureData (const std::vector<std::string> &files, ResourceTextureStagingData &data)
+{
+	uint32_t width = 0, height = 0;
+	std::vector<FileView> &buffers = data.ddsBuffers;
+	size_t firstTexOffset = 0;
+
+	data.textureFormat = RESOURCE_FORMAT_UNDEFINED;
+	data.mipmapLevels = 0;
+
+	for (size_t i = 0; i < files.size(); i++)
+	{
+		buffers.push_back(FileLoader::instance()->openFileView(files[i]));
+		const char *buffer = buffers.back().data();
+
+		if (buffers.back().size() < sizeof(uint32_t) + sizeof(DDSHeader))
+		{
+			printf("%s Failed to load DDS texture: %s, file is too small to be a DDS texture\n", ERR_PREFIX, files[i].c_str());
+
+			buffers.pop_back();
+			continue;
+		}
+
+		if (*(const uint32_t*) buffer != DDS_MAGIC_NUM)
+		{
+			printf("%s Failed to load DDS texture: %s, contained an invalid magic number/file identifier (got %8x, should be %8x)\n", ERR_PREFIX, files[i].c_str(), *(const uint32_t*) buffer, DDS_MAGIC_NUM);
+
+			buffers.pop_back();
+			continue;
+		}
+
+		const DDSHeader &header = *reinterpret_cast<const DDSHeader*>(&buffer[4]);
+
+		if (!(header.ddspf.dwFlags & DDPF_FOURCC))
+		{
+			printf("%s Failed to load DDS texture: %s, pixel format's dwFlags state it doesn't contain a valid dwFourCC, thus an invalid format. Flags: %8x\n", ERR_PREFIX, files[i].c_str(), header.ddspf.dwFlags);
+
+			buffers.pop_back();
+			continue;
+		}
+
+		uint32_t fwidth = header.dwWidth;
+		uint32_t fheight = header.dwHeight;
+		uint32_t fmipmapcount = std::max(header.dwMipMapCount, 1u); // Files w/o mipmaps can leave the count at 0
+		ResourceFormat fformat = getDDSFormat(buffer);
+		size_t fdataOffset = 4 + sizeof(DDSHeader) + (header.ddspf.dwFourCC == MAKEFOURCC('D', 'X', '1', '0') ? sizeof(DDSHeaderDXT10) : 0);
+		size_t fdataSize = 0;
+
+		for (uint32_t m = 0; m < fmipmapcount; m ++)
+			fdataSize += getMipSizeCompressed(fwidth, fheight, m, getFormatBlockSize(fformat));
+
+		if (getFormatBlockSize(fformat) == 0 || buffers.back().size() < fdataOffset + fdataSize)
+		{
+			printf("%s Failed to load DDS texture: %s, unsupported format or the file is truncated\n", ERR_PREFIX, files[i].c_str());
+
+			buffers.pop_back();
+			continue;
+		}
+
+		if (files[i] == "GameData/textures/brdf2dlut.dds")
+		{
+			printf("Is in format: %u | %u, %u, %u\n", fformat, header.ddspf.dwFourCC, (fwidth + 3) / 4, (fheight + 3) / 4);
+		}
+
+		if (i > 0 && (fwidth != width || fheight != height))
+		{
+			printf("%s Couldn't load slice %u in texture array, one or more textures don't have consistent dimensions. Files: ", ERR_PREFIX, i);
+
+			for (uint32_t i = 0; i < files.size(); i++)
+			{
+				printf("%s%s", files[i].c_str(), (i == files.size() - 1 ? "" : ", "));
+			}
+			printf("\n");
+
+			buffers.pop_back();
+			continue;
+		}
+		else if (i > 0 && (fmipmapcount != data.mipmapLevels))
+		{
+			printf("%s Couldn't load slice %u in texture array, one or more textures don't have a consistent number of mipmaps. Files: ", ERR_PREFIX, i);
+
+			for (uint32_t i = 0; i < files.size(); i++)
+			{
+				printf("%s%s", files[i].c_str(), (i == files.size() - 1 ? "" : ", "));
+			}
+			printf("\n");
+
+			buffers.pop_back();
+			continue;
+		}
+		else if (i > 0 && (fformat != data.textureFormat))
+		{
+			printf("%s Couldn't load slice %u in texture array, one or more textures don't have consistent formats. Files: ", ERR_PREFIX, i);
+
+			for (uint32_t i = 0; i < files.size(); i++)
+			{
+				printf("%s%s", files[i].c_str(), (i == files.size() - 1 ? "" : ", "));
+			}
+			printf("\n");
+
+			buffers.pop_back();
+			continue;
+		}
+
+		width = fwidth;
+		height = fheight;
+		data.mipmapLevels = fmipmapcount;
+		data.textureFormat = fformat;
+
+		firstTexOffset = fdataOffset;
+	}
+
+	data.width = width;
+	data.height = height;
+	data.firstTexOffset = firstTexOffset;
+}
+
+/*
+ * Queues every mip level of every layer as a single upload. DDS files store each layer's mip chain back to back,
+ * so each layer is just one memcpy into the staging memory.
+ */
+void ResourceManager::uploadDDSTextureData (ResourceTexture tex, ResourceTextureStagingData &data)
+{
+	tex->width = data.width;
+	tex->height = data.height;
+	tex->mipmapLevels = data.mipmapLevels;
+	tex->textureFormat = data.textureFormat;
+
+	// Only single textures w/ more than just a tail get streamed, for anything else the whole mip chain is uploaded right away
+	tex->mipStreamable = tex->mipStreamable && data.ddsBuffers.size() == 1 && getTextureTailMip(tex) > 0;
+	tex->residentMip = tex->mipStreamable ? getTextureTailMip(tex) : 0;
+
+	tex->texture = uploadDDSTextureMips(tex, data, tex->residentMip);
+	tex->memorySize = getDDSTextureMipsSize(tex, tex->residentMip, (uint32_t) data.ddsBuffers.size());
+}
+
+/*
+ * Creates a texture w/ the mip levels of a DDS texture from "baseMip" down (so "baseMip" is level 0 of the new texture), and
+ * queues their data to be uploaded to it. The texture's format & mip count have to already be set. Has to be called on the main thread.
+ */
+RendererTexture *ResourceManager::uploadDDSTextureMips (ResourceTexture tex, ResourceTextureStagingData &data, uint32_t baseMip)
+{
+	uint32_t width = data.width, height = data.height;
+	std::vector<FileView> &buffers = data.ddsBuffers;
+	uint32_t mipLevels = tex->mipmapLevels - baseMip;
+	uint32_t blockSize = getFormatBlockSize(tex->textureFormat);
+
+	RendererTexture *texture = renderer->createTexture({std::max(width >> baseMip, 1u), std::max(height >> baseMip, 1u), 1}, tex->textureFormat, TEXTURE_USAGE_TRANSFER_DST_BIT | TEXTURE_USAGE_SAMPLED_BIT, MEMORY_USAGE_GPU_ONLY, false, mipLevels, buffers.size());
+
+	std::vector<TextureBufferCopyInfo> copyRegions;
+	size_t skippedMipsSize = 0, mipChainSize = 0;
+
+	for (uint32_t m = 0; m < baseMip; m++)
+		skippedMipsSize += getMipSizeCompressed(width, height, m, blockSize);
+
+	for (uint32_t m = baseMip; m < tex->mipmapLevels; m++)
+		mipChainSize += getMipSizeCompressed(width, height, m, blockSize);
+
+	for (uint32_t a = 0; a < uint32_t(buffers.size()); a++)
+	{
+		size_t mipOffset = a * mipChainSize;
+
+		for (uint32_t m = baseMip; m < tex->mipmapLevels; m++)
+		{
+			TextureBufferCopyInfo copyRegion = {};
+			copyRegion.bufferOffset = mipOffset;
+			copyRegion.textureSubresource = {m - baseMip, a, 1};
+			copyRegion.textureOffset = {0, 0, 0};
+			copyRegion.textureExtent = {std::max(width >> m, 1u), std::max(height >> m, 1u), 1};
+
+			copyRegions.push_back(copyRegion);
+			mipOffset += getMipSizeCompressed(width, height, m, blockSize);
+		}
+	}
+
+	char *stagingData = static_cast<char*>(uploadBatcher->uploadTexture(texture, mipChainSize * buffers.size(), copyRegions, mipLevels, (uint32_t) buffers.size()));
+
+	for (uint32_t a = 0; a < uint32_t(buffers.size()); a++)
+		memcpy(stagingData + a * mipChainSize, buffers[a].data() + data.firstTexOffset + skippedMipsSize, mipChainSize);
+
+	return texture;
+}
+
+/*
+ * Returns the first mip level of the tail of a texture, the levels that are small enough to always be resident.
+ */
+uint32_t ResourceManager::getTextureTailMip (ResourceTexture tex)
+{
+	uint32_t tailMip = 0;
+
+	while (tailMip + 1 < tex->mipmapLevels && std::max(tex->width >> tailMip, tex->height >> tailMip) > TEXTURE_STREAMING_TAIL_SIZE)
+		tailMip ++;
+
+	return tailMip;
+}
+
+size_t ResourceManager::getDDSTextureMipsSize (ResourceTexture tex, uint32_t baseMip, uint32_t layerCount)
+{
+	size_t mipChainSize = 0;
+
+	for (uint32_t m = baseMip; m < tex->mipmapLevels; m++)
+		mipChainSize += getMipSizeCompressed(tex->width, tex->height, m, getFormatBlockSize(tex->textureFormat));
+
+	return mipChainSize * layerCount;
+}
+
+/*
+ * Copies the data for a single mesh out of an assimp scene.
+ */
+inline ResourceMeshData copyAssimpMeshData (const aiMesh *aiSceneMesh)
+{
+	ResourceMeshData meshData = {};
+
+	meshData.vertices.resize(aiSceneMesh->mNumVertices);
+	memcpy(meshData.vertices.data(), &aiSceneMesh->mVertices[0].x, aiSceneMesh->mNumVertices * sizeof(glm::vec3));
+
+	if (aiSceneMesh->HasTextureCoords(0))
+	{
+		meshData.uvs.reserve(aiSceneMesh->mNumVertices);
+
+		for (uint32_t uv = 0; uv < aiSceneMesh->mNumVertices; uv ++)
+		{
+			meshData.uvs.push_back({aiSceneMesh->mTextureCoords[0][uv].x, aiSceneMesh->mTextureCoords[0][uv].y});
+		}
+	}
+
+	if (aiSceneMesh->HasNormals())
+	{
+		meshData.normals.resize(aiSceneMesh->mNumVertices);
+		memcpy(meshData.normals.data(), &aiSceneMesh->mNormals[0].x, aiSceneMesh->mNumVertices * sizeof(glm::vec3));
+	}
+
+	if (aiSceneMesh->HasTangentsAndBitangents())
+	{
+		meshData.tangents.resize(aiSceneMesh->mNumVertices);
+		memcpy(meshData.tangents.data(), &aiSceneMesh->mTangents[0].x, aiSceneMesh->mNumVertices * sizeof(glm::vec3));
+	}
+
+	if (aiSceneMesh->HasFaces())
+	{
+		meshData.faceCount = aiSceneMesh->mNumFaces;
+
+		// If there are more than (2^16)-1 vertices, then we'll have to use 32-bit indices
+		if (aiSceneMesh->mNumVertices > 65535)
+		{
+			meshData.uses32BitIndices = true;
+			meshData.indices_32bit.reserve(aiSceneMesh->mNumFaces * 3);
+
+			for (uint32_t f = 0; f < aiSceneMesh->mNumFaces; f ++)
+			{
+				meshData.indices_32bit.push_back((uint32_t) aiSceneMesh->mFaces[f].mIndices[0]);
+				meshData.indices_32bit.push_back((uint32_t) aiSceneMesh->mFaces[f].mIndices[1]);
+				meshData.indices_32bit.push_back((uint32_t) aiSceneMesh->mFaces[f].mIndices[2]);
+			}
+		}
+		else
+		{
+			meshData.uses32BitIndices = false;
+			meshData.indices_16bit.reserve(aiSceneMesh->mNumFaces * 3);
+
+			for (uint32_t f = 0; f < aiSceneMesh->mNumFaces; f ++)
+			{
+				meshData.indices_16bit.push_back((uint16_t) aiSceneMesh->mFaces[f].mIndices[0]);
+				meshData.indices_16bit.push_back((uint16_t) aiSceneMesh->mFaces[f].mIndices[1]);
+				meshData.indices_16bit.push_back((uint16_t) aiSceneMesh->mFaces[f].mIndices[2]);
+			}
+		}
+	}
+
+	return meshData;
+}
+
+ResourceMeshData ResourceManager::loadRawMeshData (const std::string &file, const std::string &mesh)
+{
+	ResourceMeshData meshData = {};
+
+	std::string baseMesh;
+	float lodTriangleRatio, lodMaxError;
+
+	// Generated LODs are made by loading the mesh they're from and simplifying it
+	if (parseGeneratedLODMeshName(mesh, baseMesh, lodTriangleRatio, lodMaxError))
+	{
+		ResourceMeshData baseMeshData = loadRawMeshData(file, baseMesh);
+
+		if (baseMeshData.faceCount == 0)
+			return meshData;
+
+		float lodError;
+		meshData = MeshSimplifier::simplifyMesh(baseMeshData, lodTriangleRatio, lodMaxError, &lodError);
+		MeshOptimizer::optimizeMesh(meshData);
+
+		printf("%s Generated LOD for file: %s, mesh: %s, %u -> %u triangles (error: %f)\n", INFO_PREFIX, file.c_str(), baseMesh.c_str(), baseMeshData.faceCount, meshData.faceCount, lodError);
+
+		return meshData;
+	}
+
+	Assimp::Importer *importer = acquireAssimpImporter();
+
+	FileView meshFileData = FileLoader::instance()->openFileView(file);
+	const aiScene* scene = importer->ReadFileFromMemory(meshFileData.data(), meshFileData.size(), aiProcess_CalcTangentSpace | aiProcess_Triangulate | aiProcess_JoinIdenticalVertices);
+
+	if (!scene)
+	{
+		printf("%s Failed to load file: %s, mesh: %s, with assimp. Returned: %s\n", ERR_PREFIX, file.c_str(), mesh.c_str(), importer->GetErrorString());
+		releaseAssimpImporter(importer);
+
+		return meshData;
+	}
+
+	for (uint32_t i = 0; i < scene->mNumMeshes; i ++)
+	{
+		if (strcmp(scene->mMeshes[i]->mName.C_Str(), mesh.c_str()) == 0)
+		{
+			meshData = copyAssimpMeshData(scene->mMeshes[i]);
+			MeshOptimizer::optimizeMesh(meshData);
+		}
+	}
+
+	importer->FreeScene();
+	releaseAssimpImporter(importer);
+
+	return meshData;
+}
+
+/*
+ * Takes an importer out of the pool, making a new one if they're all in use. Can be called from any thread.
+ */
+Assimp::Importer *ResourceManager::acquireAssimpImporter ()
+{
+	std::unique_lock<std::mutex> lock(assimpImporterPool_mutex);
+
+	if (freeAssimpImporters.size() == 0)
+	{
+		assimpImporters.push_back(std::unique_ptr<Assimp::Importer>(new Assimp::Importer()));
+
+		return assimpImporters.back().get();
+	}
+
+	Assimp::Importer *importer = freeAssimpImporters.back();
+	freeAssimpImporters.pop_back();
+
+	return importer;
+}
+
+/*
+ * Puts an importer back in the pool, it's scene should already be freed.
+ */
+void ResourceManager::releaseAssimpImporter (Assimp::Importer *importer)
+{
+	std::unique_lock<std::mutex> lock(assimpImporterPool_mutex);
+
+	freeAssimpImporters.push_back(importer);
+}
+
+template<typename T>
+inline bool isSameMeshComponent (const std::vector<T> &a, const std::vector<T> &b)
+{
+	return a.size() == b.size() && (a.size() == 0 || memcmp(a.data(), b.data(), a.size() * sizeof(T)) == 0);
+}
+
+inline bool isSameMeshData (const ResourceMeshData &a, const ResourceMeshData &b)
+{
+	return a.faceCount == b.faceCount && a.uses32BitIndices == b.uses32BitIndices && isSameMeshComponent(a.indices_16bit, b.indices_16bit) && isSameMeshComponent(a.indices_32bit, b.indices_32bit)
+			&& isSameMeshComponent(a.vertices, b.vertices) && isSameMeshComponent(a.uvs, b.uvs) && isSameMeshComponent(a.normals, b.normals) && isSameMeshComponent(a.tangents, b.tangents);
+}
+
+/*
+ * Imports every mesh in a file once on the calling thread, and then <importsPerThread> times on each of <threadCount> threads
+ * at once, and checks that every import on the threads came out exactly the same as the serial one. This is for making sure
+ * the importer pool lets imports run in parallel w/o them stepping on each other. Returns false if any of them differed.
+ */
+bool ResourceManager::stressTestMeshImports (const std::string &file, uint32_t threadCount, uint32_t importsPerThread)
+{
+	std::vector<std::string> meshNames;
+
+	{
+		Assimp::Importer *importer = acquireAssimpImporter();
+
+		FileView meshFileData = FileLoader::instance()->openFileView(file);
+		const aiScene* scene = importer->ReadFileFromMemory(meshFileData.data(), meshFileData.size(), aiProcess_CalcTangentSpace | aiProcess_Triangulate | aiProcess_JoinIdenticalVertices);
+
+		for (uint32_t i = 0; scene != nullptr && i < scene->mNumMeshes; i ++)
+			meshNames.push_back(scene->mMeshes[i]->mName.C_Str());
+
+		importer->FreeScene();
+		releaseAssimpImporter(importer);
+	}
+
+	if (meshNames.size() == 0)
+	{
+		printf("%s Failed to stress test mesh imports of file: %s, it doesn't have any meshes\n", ERR_PREFIX, file.c_str());
+
+		return false;
+	}
+
+	auto startTime = std::chrono::high_resolution_clock::now();
+	std::vector<ResourceMeshData> serialMeshData(meshNames.size());
+
+	for (size_t m = 0; m < meshNames.size(); m ++)
+		serialMeshData[m] = loadRawMeshData(file, meshNames[m]);
+
+	double serialTime = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+
+	std::atomic<uint32_t> mismatchCount(0);
+	std::vector<std::thread> threads;
+
+	startTime = std::chrono::high_resolution_clock::now();
+
+	for (uint32_t t = 0; t < threadCount; t ++)
+	{
+		threads.push_back(std::thread([&, t]()
+		{
+			// Each thread starts at a different mesh, so that different meshes are being imported at the same time too
+			for (uint32_t i = 0; i < importsPerThread; i ++)
+			{
+				size_t m = (t + i) % meshNames.size();
+
+				if (!isSameMeshData(loadRawMeshData(file, meshNames[m]), serialMeshData[m]))
+				{
+					printf("%s Mesh import stress test: thread %u got a different result for file: %s, mesh: %s\n", ERR_PREFIX, t, file.c_str(), meshNames[m].c_str());
+					mismatchCount ++;
+				}
+			}
+		}));
+	}
+
+	for (size_t t = 0; t < threads.size(); t ++)
+		threads[t].join();
+
+	double parallelTime = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+	uint32_t importCount = threadCount * importsPerThread;
+	uint32_t importerCount;
+
+	{
+		std::unique_lock<std::mutex> lock(assimpImporterPool_mutex);
+		importerCount = (uint32_t) assimpImporters.size();
+	}
+
+	printf("%s Mesh import stress test of %s: %u meshes serially in %.2f ms (%.2f ms/import), %u imports on %u threads in %.2f ms (%.2f ms/import), %u importers, %u mismatches\n", INFO_PREFIX, file.c_str(),
+			(uint32_t) meshNames.size(), serialTime, serialTime / meshNames.size(), importCount, threadCount, parallelTime, importCount > 0 ? parallelTime / importCount : 0.0, importerCount, mismatchCount.load());
+
+	return mismatchCount == 0;
+}
+
+/*
+ * Cooks every mesh in a file into the binary format described by CookedMeshHeader, in the layout
+ * loadMesh*() asks for. The cooked files are written next to the source file in the working directory
+ * (see getCookedMeshFile()), and from then on the mesh loads skip assimp entirely. Returns the number
+ * of meshes that were cooked. Note that cooked meshes aren't checked against their source file, so
+ * they have to be re-cooked whenever it changes.
+ */
+uint32_t ResourceManager::cookMeshFile (const std::string &file)
+{
+	const MeshDataFormat rendererOptimizedMeshFormat = rendererMeshFormat;
+
+	Assimp::Importer *importer = acquireAssimpImporter();
+
+	FileView meshFileData = FileLoader::instance()->openFileView(file);
+	const aiScene* scene = importer->ReadFileFromMemory(meshFileData.data(), meshFileData.size(), aiProcess_CalcTangentSpace | aiProcess_Triangulate | aiProcess_JoinIdenticalVertices);
+
+	if (!scene)
+	{
+		printf("%s Failed to cook file: %s, with assimp. Returned: %s\n", ERR_PREFIX, file.c_str(), importer->GetErrorString());
+		releaseAssimpImporter(importer);
+
+		return 0;
+	}
+
+	uint32_t cookedCount = 0;
+
+	for (uint32_t i = 0; i < scene->mNumMeshes; i ++)
+	{
+		ResourceMeshData meshData = copyAssimpMeshData(scene->mMeshes[i]);
+		MeshOptimizerStats optimizerStats = MeshOptimizer::optimizeMesh(meshData);
+
+		printf("%s Optimized mesh: %s, ACMR: %.3f -> %.3f, ATVR: %.3f -> %.3f%s\n", INFO_PREFIX, scene->mMeshes[i]->mName.C_Str(), optimizerStats.acmrBefore, optimizerStats.acmrAfter, optimizerStats.atvrBefore, optimizerStats.atvrAfter, optimizerStats.overdrawOrderUsed ? ", overdraw ordered" : "");
+
+		std::string cookedFile = FileLoader::instance()->getWorkingDir() + getCookedMeshFile(file, scene->mMeshes[i]->mName.C_Str(), rendererOptimizedMeshFormat);
+
+		size_t indexChunkSize, vertexStride;
+		std::vector<char> formattedData = getFormattedMeshData(meshData, rendererOptimizedMeshFormat, indexChunkSize, vertexStride, true);
+
+		if (writeCookedMeshFile(cookedFile, meshData, rendererOptimizedMeshFormat, formattedData, indexChunkSize, vertexStride))
+			cookedCount ++;
+	}
+
+	importer->FreeScene();
+	releaseAssimpImporter(importer);
+
+	printf("%s Cooked %u meshes from: %s\n", INFO_PREFIX, cookedCount, file.c_str());
+
+	return cookedCount;
+}
+
+/*
+ * Writes a mesh that's already been formatted by getFormattedMeshData() to a cooked mesh file. Returns false
+ * if the file couldn't be written.
+ *
+ * Other threads can be mapping the cooked file while it's (re)written, so it's written to a temporary file first & then
+ * renamed over the real one, which means a reader either gets the whole old file or the whole new one, never part of one.
+ * Cooks of the same file from several threads are done one at a time.
+ */
+bool ResourceManager::writeCookedMeshFile (const std::string &cookedFile, const ResourceMeshData &meshData, MeshDataFormat format, const std::vector<char> &formattedData, size_t indexChunkSize, size_t vertexStride)
+{
+	CookedMeshHeader header = {};
+	header.magic = COOKED_MESH_MAGIC_NUM;
+	header.version = COOKED_MESH_VERSION;
+	header.meshFormat = format;
+	header.flags = COOKED_MESH_FLAG_INTERLACED | (meshData.uses32BitIndices ? COOKED_MESH_FLAG_32BIT_INDICES : 0);
+	header.faceCount = meshData.faceCount;
+	header.vertexStride = (uint32_t) vertexStride;
+	header.indexChunkSize = indexChunkSize;
+	header.dataSize = formattedData.size();
+	getMeshVertexDecodeParams(meshData, format, header.vertexDecodeScale, header.vertexDecodeOffset);
+
+	{
+		std::unique_lock<std::mutex> lock(cookingMeshFiles_mutex);
+		cookingMeshFiles_cv.wait(lock, [this, &cookedFile]() {return cookingMeshFiles.count(cookedFile) == 0;});
+		cookingMeshFiles.insert(cookedFile);
 	}
-}
 
-inline uint8_t getFormatBlockSize(ResourceFormat format)
-{
-	switch (format)
+	std::string tempFile = cookedFile + "." + toString(stringHash(toString(std::this_thread::get_id()))) + ".tmp";
+	bool written = false;
+
+#ifdef _WIN32
+	std::ofstream out(utf8_to_utf16(tempFile).c_str(), std::ios::out | std::ios::binary);
+#else
+	std::ofstream out(tempFile, std::ios::out | std::ios::binary);
+#endif
+
+	if (out.is_open())
 	{
-		case RESOURCE_FORMAT_BC1_RGBA_UNORM_BLOCK:
-		case RESOURCE_FORMAT_BC1_RGBA_SRGB_BLOCK:
-		case RESOURCE_FORMAT_BC4_UNORM_BLOCK:
-		case RESOURCE_FORMAT_BC4_SNORM_BLOCK:
-			return 8;
-		case RESOURCE_FORMAT_BC2_UNORM_BLOCK:
-		case RESOURCE_FORMAT_BC2_SRGB_BLOCK:
-		case RESOURCE_FORMAT_BC3_UNORM_BLOCK:
-		case RESOURCE_FORMAT_BC3_SRGB_BLOCK:
-		case RESOURCE_FORMAT_BC5_UNORM_BLOCK:
-		case RESOURCE_FORMAT_BC5_SNORM_BLOCK:
-		case RESOURCE_FORMAT_BC6H_UFLOAT_BLOCK:
-		case RESOURCE_FORMAT_BC6H_SFLOAT_BLOCK:
-		case RESOURCE_FORMAT_BC7_UNORM_BLOCK:
-		case RESOURCE_FORMAT_BC7_SRGB_BLOCK:
-			return 16;
-		case RESOURCE_FORMAT_R16G16_SFLOAT:
-			return 64;
-		default:
-			return 0;
+		out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		out.write(formattedData.data(), formattedData.size());
+		out.close();
+
+#ifdef _WIN32
+		written = out && MoveFileExW(utf8_to_utf16(tempFile).c_str(), utf8_to_utf16(cookedFile).c_str(), MOVEFILE_REPLACE_EXISTING);
+
+		if (!written)
+			DeleteFileW(utf8_to_utf16(tempFile).c_str());
+#else
+		written = out && rename(tempFile.c_str(), cookedFile.c_str()) == 0;
+
+		if (!written)
+			remove(tempFile.c_str());
+#endif
 	}
+
+	if (!written)
+		printf("%s Failed to write cooked mesh file: %s\n", ERR_PREFIX, cookedFile.c_str());
+
+	{
+		std::unique_lock<std::mutex> lock(cookingMeshFiles_mutex);
+		cookingMeshFiles.erase(cookedFile);
+	}
+
+	cookingMeshFiles_cv.notify_all();
+
+	return written;
 }
 
-size_t getMipSizeCompressed(uint32_t width, uint32_t height, uint32_t level, uint32_t blockSize)
+/*
+ * Gets the mesh name of a LOD generated from "mesh", e.g. "Cube" w/ a triangle ratio of 0.25 and a max error of 0.01
+ * turns into "Cube@lod2500_1000". Loading a mesh w/ a name like that loads "Cube" and simplifies it (see loadRawMeshData()).
+ * Since the settings are part of the name, changing them also changes the cooked file, so stale LODs are never loaded.
+ */
+std::string ResourceManager::getGeneratedLODMeshName (const std::string &mesh, float triangleRatio, float maxError)
 {
-	return (((width / uint32_t(std::pow(2, level))) + 3) / 4) * (((height / uint32_t(std::pow(2, level))) + 3) / 4) * blockSize;
+	return mesh + MESH_GENERATED_LOD_SEPARATOR + toString(uint32_t(triangleRatio * 10000.0f + 0.5f)) + "_" + toString(uint32_t(maxError * 100000.0f + 0.5f));
 }
 
-void ResourceManager::loadDDSTextureData(ResourceTexture tex)
+bool ResourceManager::parseGeneratedLODMeshName (const std::string &lodMesh, std::string &mesh, float &triangleRatio, float &maxError)
 {
-	uint32_t width = 0, height = 0;
-	std::vector<std::vector<char>> buffers;
-	size_t firstTexOffset = 0;
+	size_t separator = lodMesh.rfind(MESH_GENERATED_LOD_SEPARATOR);
 
-	tex->textureFormat = RESOURCE_FORMAT_UNDEFINED;
+	if (separator == std::string::npos)
+		return false;
 
-	for (size_t i = 0; i < tex->files.size(); i++)
-	{
-		buffers.push_back(FileLoader::instance()->readFileBuffer(tex->files[i]));
-		std::vector<char> &buffer = buffers[i];
+	uint32_t triangleRatioParam, maxErrorParam;
 
-		if (*(uint32_t*) (&buffer[0]) != DDS_MAGIC_NUM)
-		{
-			printf("%s Failed to load DDS texture: %s, contained an invalid magic number/file identifier (got %8x, should be %8x)\n", ERR_PREFIX, tex->files[i].c_str(), *(uint32_t*) (buffer[0]), DDS_MAGIC_NUM);
+	if (sscanf(lodMesh.c_str() + separator + strlen(MESH_GENERATED_LOD_SEPARATOR), "%u_%u", &triangleRatioParam, &maxErrorParam) != 2)
+		return false;
 
-			buffers.pop_back();
-			continue;
-		}
+	mesh = lodMesh.substr(0, separator);
+	triangleRatio = triangleRatioParam / 10000.0f;
+	maxError = maxErrorParam / 100000.0f;
 
-		DDSHeader &header = *reinterpret_cast<DDSHeader*>(&buffer[4]);
+	return true;
+}
 
-		if (!(header.ddspf.dwFlags & DDPF_FOURCC))
-		{
-			printf("%s Failed to load DDS texture: %s, pixel format's dwFlags state it doesn't contain a valid dwFourCC, thus an invalid format. Flags: %8x\n", ERR_PREFIX, tex->files[i].c_str(), header.ddspf.dwFlags);
+/*
+ * Gets the name of the cooked version of a mesh, e.g. "GameData/meshes/blah.fbx" w/ mesh "Cube" in the MESH_DATA_FORMAT_IVUNT_PACKED
+ * format turns into "GameData/meshes/blah.fbx.Cube.ivunt_packed.smsh". Since the format is part of the name, meshes loaded in
+ * different formats never overwrite each other's cooked files. The settings of generated LODs are already part of their mesh
+ * name (see getGeneratedLODMeshName()). A file that's already cooked is returned as is.
+ */
+std::string ResourceManager::getCookedMeshFile (const std::string &file, const std::string &mesh, MeshDataFormat format)
+{
+	std::string cookedExt = COOKED_MESH_EXTENSION;
 
-			buffers.pop_back();
-			continue;
-		}
+	if (file.length() > cookedExt.length() && file.compare(file.length() - cookedExt.length(), cookedExt.length(), cookedExt) == 0)
+		return file;
 
-		uint32_t fwidth = header.dwWidth;
-		uint32_t fheight = header.dwHeight;
-		uint32_t fmipmapcount = header.dwMipMapCount;
-		ResourceFormat fformat = getDDSFormat(buffer);
+	std::string formatName;
 
-		if (tex->files[i] == "GameData/textures/brdf2dlut.dds")
-		{
-			printf("Is in format: %u | %u, %u, %u\n", fformat, header.ddspf.dwFourCC, (fwidth + 3) / 4, (fheight + 3) / 4);
-		}
+	switch (format)
+	{
+		case MESH_DATA_FORMAT_IVUNT:
+			formatName = "ivunt";
+			break;
+		case MESH_DATA_FORMAT_IV:
+			formatName = "iv";
+			break;
+		case MESH_DATA_FORMAT_V:
+			formatName = "v";
+			break;
+		case MESH_DATA_FORMAT_IVUNT_PACKED:
+			formatName = "ivunt_packed";
+			break;
+		default:
+			formatName = toString(uint32_t(format));
+	}
 
-		if (i > 0 && (fwidth != width || fheight != height))
-		{
-			printf("%s Couldn't load slice %u in texture array, one or more textures don't have consistent dimensions. Files: ", ERR_PREFIX, i);
+	return file + "." + mesh + "." + formatName + cookedExt;
+}
 
-			for (uint32_t i = 0; i < tex->files.size(); i++)
-			{
-				printf("%s%s", tex->files[i].c_str(), (i == tex->files.size() - 1 ? "" : ", "));
-			}
-			printf("\n");
+/*
+ * Maps the cooked version of a mesh if there is one, and fills in the mesh's info from it's header. <formattedData>
+ * points into <cookedMeshFile>, so the view has to be kept around until the data is uploaded. Returns false if
+ * there isn't a usable cooked mesh, in which case the mesh has to be loaded through assimp.
+ */
+bool ResourceManager::openCookedMeshData (ResourceMesh meshRes, FileView &cookedMeshFile, const char *&formattedData, size_t &formattedDataSize)
+{
+	std::string cookedFile = getCookedMeshFile(meshRes->file, meshRes->mesh, meshRes->meshFormat);
 
-			buffers.pop_back();
-			continue;
-		}
-		else if (i > 0 && (fmipmapcount != tex->mipmapLevels))
-		{
-			printf("%s Couldn't load slice %u in texture array, one or more textures don't have a consistent number of mipmaps. Files: ", ERR_PREFIX, i);
+	if (!FileLoader::instance()->fileExists(cookedFile))
+		return false;
 
-			for (uint32_t i = 0; i < tex->files.size(); i++)
-			{
-				printf("%s%s", tex->files[i].c_str(), (i == tex->files.size() - 1 ? "" : ", "));
-			}
-			printf("\n");
+	cookedMeshFile = FileLoader::instance()->openFileView(cookedFile);
 
-			buffers.pop_back();
-			continue;
-		}
-		else if (i > 0 && (fformat != tex->textureFormat))
-		{
-			printf("%s Couldn't load slice %u in texture array, one or more textures don't have consistent formats. Files: ", ERR_PREFIX, i);
+	if (cookedMeshFile.size() < sizeof(CookedMeshHeader))
+	{
+		printf("%s Failed to load cooked mesh: %s, file is too small to be a cooked mesh\n", ERR_PREFIX, cookedFile.c_str());
 
-			for (uint32_t i = 0; i < tex->files.size(); i++)
-			{
-				printf("%s%s", tex->files[i].c_str(), (i == tex->files.size() - 1 ? "" : ", "));
-			}
-			printf("\n");
+		return false;
+	}
 
-			buffers.pop_back();
-			continue;
-		}
+	const CookedMeshHeader &header = *reinterpret_cast<const CookedMeshHeader*>(cookedMeshFile.data());
 
-		width = fwidth;
-		height = fheight;
-		tex->mipmapLevels = header.dwMipMapCount;
-		tex->textureFormat = fformat;
+	if (header.magic != COOKED_MESH_MAGIC_NUM || header.version != COOKED_MESH_VERSION)
+	{
+		printf("%s Failed to load cooked mesh: %s, invalid magic number or version (got %8x v%u, should be %8x v%u)\n", ERR_PREFIX, cookedFile.c_str(), header.magic, header.version, COOKED_MESH_MAGIC_NUM, COOKED_MESH_VERSION);
 
-		firstTexOffset = 4 + sizeof(DDSHeader) + (header.ddspf.dwFourCC == MAKEFOURCC('D', 'X', '1', '0') ? sizeof(DDSHeaderDXT10) : 0);
+		return false;
 	}
 
-	tex->texture = renderer->createTexture({width, height, 1}, tex->textureFormat, TEXTURE_USAGE_TRANSFER_DST_BIT | TEXTURE_USAGE_SAMPLED_BIT, MEMORY_USAGE_GPU_ONLY, false, tex->mipmapLevels, buffers.size());
+	if (header.dataSize > cookedMeshFile.size() - sizeof(CookedMeshHeader) || header.indexChunkSize > header.dataSize)
+	{
+		printf("%s Failed to load cooked mesh: %s, the file is truncated or corrupt\n", ERR_PREFIX, cookedFile.c_str());
 
-	std::vector<StagingBuffer> mipStagingBuffers(tex->mipmapLevels);
+		return false;
+	}
 
-	for (uint32_t m = 0; m < tex->mipmapLevels; m++)
-		mipStagingBuffers[m] = renderer->createStagingBuffer(getMipSizeCompressed(width, height, m, getFormatBlockSize(tex->textureFormat)));
-	
-	for (uint32_t a = 0; a < uint32_t(buffers.size()); a++)
+	if (header.meshFormat != (uint32_t) meshRes->meshFormat || bool(header.flags & COOKED_MESH_FLAG_INTERLACED) != meshRes->interlaced)
 	{
-		size_t texAccumOffset = firstTexOffset;
-		for (uint32_t m = 0; m < tex->mipmapLevels; m++)
-		{
-			size_t mipSize = getMipSizeCompressed(width, height, m, getFormatBlockSize(tex->textureFormat));
-			renderer->fillStagingBuffer(mipStagingBuffers[m], mipSize, &buffers[a][texAccumOffset]);
+		printf("%s Cooked mesh: %s wasn't cooked in the format the mesh is being loaded in, it'll be loaded through assimp instead\n", WARN_PREFIX, cookedFile.c_str());
 
-			texAccumOffset += mipSize;
-		}
+		return false;
+	}
 
-		CommandBuffer cmdBuffer = renderer->beginSingleTimeCommand(mainThreadTransferCommandPool);
+	meshRes->indexChunkSize = (size_t) header.indexChunkSize;
+	meshRes->vertexStride = header.vertexStride;
+	meshRes->faceCount = header.faceCount;
+	meshRes->uses32bitIndices = (header.flags & COOKED_MESH_FLAG_32BIT_INDICES) != 0;
+	meshRes->vertexDecodeScale = header.vertexDecodeScale;
+	meshRes->vertexDecodeOffset = header.vertexDecodeOffset;
 
-		for (uint32_t m = 0; m < tex->mipmapLevels; m++)
-		{
-			TextureSubresourceRange subresourceRange = {};
-			subresourceRange.baseMipLevel = m;
-			subresourceRange.baseArrayLayer = a;
-			subresourceRange.levelCount = 1;
-			subresourceRange.layerCount = 1;
+	formattedData = cookedMeshFile.data() + sizeof(CookedMeshHeader);
+	formattedDataSize = (size_t) header.dataSize;
 
-			//cmdBuffer->transitionTextureLayout(tex->texture, TEXTURE_LAYOUT_UNDEFINED, TEXTURE_LAYOUT_TRANSFER_DST_OPTIMAL, subresourceRange);
-			cmdBuffer->setTextureLayout(tex->texture, TEXTURE_LAYOUT_UNDEFINED, TEXTURE_LAYOUT_TRANSFER_DST_OPTIMAL, subresourceRange, PIPELINE_STAGE_ALL_COMMANDS_BIT, PIPELINE_STAGE_ALL_COMMANDS_BIT);
-			cmdBuffer->stageBuffer(mipStagingBuffers[m], tex->texture, {m, a, 1}, {0, 0, 0}, {width / uint32_t(std::pow(2, m)), height / uint32_t(std::pow(2, m)), 1});
-			cmdBuffer->setTextureLayout(tex->texture, TEXTURE_LAYOUT_TRANSFER_DST_OPTIMAL, TEXTURE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, subresourceRange, PIPELINE_STAGE_ALL_COMMANDS_BIT, PIPELINE_STAGE_ALL_COMMANDS_BIT);
-		}
-		
-		renderer->endSingleTimeCommand(cmdBuffer, mainThreadTransferCommandPool, QUEUE_TYPE_GRAPHICS);
-	}
+	return true;
+}
 
-	for (size_t i = 0; i < mipStagingBuffers.size(); i++)
-		renderer->destroyStagingBuffer(mipStagingBuffers[i]);
+void ResourceManager::setPipelineRenderPass (RendererRenderPass *renderPass, RendererRenderPass *shadowRenderPass)
+{
+	pipelineRenderPass = renderPass;
+	pipelineShadowRenderPass = shadowRenderPass;
 }
 
-ResourceMeshData ResourceManager::loadRawMeshData (const std::string &file, const std::string &mesh)
+/*
+ * Converts a float to a 16-bit (half precision) float, rounding to nearest. Values too big for a half turn into
+ * infinity, and values too small are flushed to zero.
+ */
+inline uint16_t packHalfFloat (float value)
 {
-	ResourceMeshData meshData = {};
+	uint32_t bits;
+	memcpy(&bits, &value, sizeof(bits));
 
-	std::unique_lock<std::mutex> lock(assimpImporter_mutex);
+	uint16_t sign = (bits >> 16) & 0x8000;
+	int32_t exponent = int32_t((bits >> 23) & 0xFF) - 127 + 15;
+	uint32_t mantissa = bits & 0x7FFFFF;
 
-	std::vector<char> meshFileData = FileLoader::instance()->readFileBuffer(file);
-	const aiScene* scene = assimpImporter.ReadFileFromMemory(meshFileData.data(), meshFileData.size(), aiProcess_CalcTangentSpace | aiProcess_Triangulate | aiProcess_CalcTangentSpace | aiProcess_ImproveCacheLocality);
+	// NaN & infinity
+	if (((bits >> 23) & 0xFF) == 0xFF)
+		return sign | 0x7C00 | (mantissa != 0 ? 0x200 : 0);
 
-	if (!scene)
+	if (exponent >= 31)
+		return sign | 0x7C00;
+
+	// Denormals, or flushed to zero if they're too small for that too
+	if (exponent <= 0)
 	{
-		printf("%s Failed to load file: %s, mesh: %s, with assimp. Returned: %s\n", ERR_PREFIX, file.c_str(), mesh.c_str(), assimpImporter.GetErrorString());
-		assimpImporter_mutex.unlock();
+		if (exponent < -10)
+			return sign;
 
-		return meshData;
+		mantissa |= 0x800000;
+		uint32_t shift = uint32_t(14 - exponent);
+
+		return sign | uint16_t((mantissa + (1 << (shift - 1))) >> shift);
 	}
 
-	for (uint32_t i = 0; i < scene->mNumMeshes; i ++)
+	// Rounding can carry into the exponent, which still gives the right result
+	return sign | uint16_t(((uint32_t(exponent) << 10) | (mantissa >> 13)) + ((mantissa >> 12) & 1));
+}
+
+inline int16_t packSnorm16 (float value)
+{
+	return (int16_t) std::round(std::max(-1.0f, std::min(value, 1.0f)) * 32767.0f);
+}
+
+/*
+ * Octahedral encodes a unit vector into 2 16-bit snorms, decoded in the shader w/ decodeOctahedral().
+ */
+inline void packOctahedral (const svec3 &vec, int16_t *packed)
+{
+	float invL1Norm = 1.0f / std::max(std::abs(vec.x) + std::abs(vec.y) + std::abs(vec.z), 1e-8f);
+	float x = vec.x * invL1Norm, y = vec.y * invL1Norm;
+
+	if (vec.z < 0.0f)
 	{
-		aiMesh* aiSceneMesh = scene->mMeshes[i];
+		float ox = x, oy = y;
 
-		if (strcmp(aiSceneMesh->mName.C_Str(), mesh.c_str()) == 0)
-		{
-			meshData.vertices.resize(aiSceneMesh->mNumVertices);
-			memcpy(meshData.vertices.data(), &aiSceneMesh->mVertices[0].x, aiSceneMesh->mNumVertices * sizeof(glm::vec3));
+		x = (1.0f - std::abs(oy)) * (ox >= 0.0f ? 1.0f : -1.0f);
+		y = (1.0f - std::abs(ox)) * (oy >= 0.0f ? 1.0f : -1.0f);
+	}
 
-			if (aiSceneMesh->HasTextureCoords(0))
-			{
-				meshData.uvs.reserve(aiSceneMesh->mNumVertices);
+	packed[0] = packSnorm16(x);
+	packed[1] = packSnorm16(y);
+}
 
-				for (uint32_t uv = 0; uv < aiSceneMesh->mNumVertices; uv ++)
-				{
-					meshData.uvs.push_back({aiSceneMesh->mTextureCoords[0][uv].x, aiSceneMesh->mTextureCoords[0][uv].y});
-				}
-			}
+/*
+ * Copies one component of every vertex into the interlaced vertex data. Having the component size as a template
+ * parameter lets the compiler turn each copy into a couple of plain (vector) moves instead of a memcpy call.
+ */
+template<size_t ComponentSize>
+inline void interlaceMeshComponent (char *dst, size_t dstStride, const char *src, size_t vertexCount)
+{
+	for (size_t i = 0; i < vertexCount; i ++)
+		memcpy(dst + i * dstStride, src + i * ComponentSize, ComponentSize);
+}
 
-			if (aiSceneMesh->HasNormals())
-			{
-				meshData.normals.resize(aiSceneMesh->mNumVertices);
-				memcpy(meshData.normals.data(), &aiSceneMesh->mNormals[0].x, aiSceneMesh->mNumVertices * sizeof(glm::vec3));
-			}
+inline void interlaceMeshComponent (char *dst, size_t dstStride, const char *src, size_t componentSize, size_t vertexCount)
+{
+	switch (componentSize)
+	{
+		case sizeof(uint32_t):
+			interlaceMeshComponent<sizeof(uint32_t)>(dst, dstStride, src, vertexCount);
+			break;
+		case sizeof(svec2):
+			interlaceMeshComponent<sizeof(svec2)>(dst, dstStride, src, vertexCount);
+			break;
+		case sizeof(svec3):
+			interlaceMeshComponent<sizeof(svec3)>(dst, dstStride, src, vertexCount);
+			break;
+		case sizeof(svec4):
+			interlaceMeshComponent<sizeof(svec4)>(dst, dstStride, src, vertexCount);
+			break;
+		default:
+			for (size_t i = 0; i < vertexCount; i ++)
+				memcpy(dst + i * dstStride, src + i * componentSize, componentSize);
+	}
+}
 
-			if (aiSceneMesh->HasTangentsAndBitangents())
-			{
-				meshData.tangents.resize(aiSceneMesh->mNumVertices);
-				memcpy(meshData.tangents.data(), &aiSceneMesh->mTangents[0].x, aiSceneMesh->mNumVertices * sizeof(glm::vec3));
-			}
+/*
+ * Appends the vertex data to <meshDataArray> (which should already contain the index chunk), w/ each component being
+ * a pair of the source data and the size of the component for one vertex. Components w/ a null source are just left as
+ * zeros, which is why the whole vertex chunk gets cleared when it's allocated.
+ */
+inline void layoutMeshComponents (std::vector<char> &meshDataArray, const std::vector<std::pair<const char*, size_t> > &components, size_t vertexCount, size_t &vertexStride, bool interlaceData)
+{
+	size_t indexChunkSize = meshDataArray.size();
+	size_t vertexSize = 0;
+
+	for (size_t c = 0; c < components.size(); c ++)
+		vertexSize += components[c].second;
+
+	vertexStride = vertexSize;
+
+	meshDataArray.resize(indexChunkSize + vertexSize * vertexCount, 0);
+
+	char *vertexData = meshDataArray.data() + indexChunkSize;
+
+	if (interlaceData)
+	{
+		/*
+		 * Interlaced: IIIIIVUNVUNVUNVUNVUN, so each component is strided through the vertex data. The vertices are done a
+		 * block at a time so that the block stays in the cache while every component is copied into it, otherwise each
+		 * component would be another pass over the whole (possibly 100s of MB) vertex chunk.
+		 */
+		for (size_t blockStart = 0; blockStart < vertexCount; blockStart += MESH_INTERLACE_BLOCK_SIZE)
+		{
+			size_t blockVertexCount = std::min<size_t>(MESH_INTERLACE_BLOCK_SIZE, vertexCount - blockStart);
+			size_t componentOffset = 0;
 
-			if (aiSceneMesh->HasFaces())
+			for (size_t c = 0; c < components.size(); c ++)
 			{
-				meshData.faceCount = aiSceneMesh->mNumFaces;
+				if (components[c].first != nullptr)
+					interlaceMeshComponent(vertexData + blockStart * vertexSize + componentOffset, vertexSize, components[c].first + blockStart * components[c].second, components[c].second, blockVertexCount);
 
-				// If there are more than (2^16)-1 vertices, then we'll have to use 32-bit indices
-				if (aiSceneMesh->mNumVertices > 65535)
-				{
-					meshData.uses32BitIndices = true;
-					meshData.indices_32bit.reserve(aiSceneMesh->mNumFaces * 3);
-
-					for (uint32_t f = 0; f < aiSceneMesh->mNumFaces; f ++)
-					{
-						meshData.indices_32bit.push_back((uint32_t) aiSceneMesh->mFaces[f].mIndices[0]);
-						meshData.indices_32bit.push_back((uint32_t) aiSceneMesh->mFaces[f].mIndices[1]);
-						meshData.indices_32bit.push_back((uint32_t) aiSceneMesh->mFaces[f].mIndices[2]);
-					}
-				}
-				else
-				{
-					meshData.uses32BitIndices = false;
-					meshData.indices_16bit.reserve(aiSceneMesh->mNumFaces * 3);
-
-					for (uint32_t f = 0; f < aiSceneMesh->mNumFaces; f ++)
-					{
-						meshData.indices_16bit.push_back((uint16_t) aiSceneMesh->mFaces[f].mIndices[0]);
-						meshData.indices_16bit.push_back((uint16_t) aiSceneMesh->mFaces[f].mIndices[1]);
-						meshData.indices_16bit.push_back((uint16_t) aiSceneMesh->mFaces[f].mIndices[2]);
-					}
-				}
+				componentOffset += components[c].second;
 			}
 		}
 	}
+	else
+	{
+		// Un-interlaced: IIIIIVVVVVUUUUUNNNNN, so each component is just one big block
+		size_t componentOffset = 0;
 
-	assimpImporter.FreeScene();
-
-	return meshData;
-}
+		for (size_t c = 0; c < components.size(); c ++)
+		{
+			if (components[c].first != nullptr)
+				memcpy(vertexData + componentOffset * vertexCount, components[c].first, components[c].second * vertexCount);
 
-void ResourceManager::setPipelineRenderPass (RendererRenderPass *renderPass, RendererRenderPass *shadowRenderPass)
-{
-	pipelineRenderPass = renderPass;
-	pipelineShadowRenderPass = shadowRenderPass;
+			componentOffset += components[c].second;
+		}
+	}
 }
 
 std::vector<char> ResourceManager::getFormattedMeshData (const ResourceMeshData &data, MeshDataFormat format, size_t &indexChunkSize, size_t &vertexStride, bool interlaceData)
@@ -1446,9 +4172,13 @@ std::vector<char> ResourceManager::getFormattedMeshData (const ResourceMeshData
 
 	// Note that vertices are missing because meshes are always guaranteed to have vertices (nothing else, just vertices)
 	bool requiresIndices = false, requiresUVs = false, requiresNormals = false, requiresTangents = false, requiresBitangents = false;
+	bool packed = false;
 
 	switch (format)
 	{
+		case MESH_DATA_FORMAT_IVUNT_PACKED:
+			packed = true;
+			// Falls through, packed formats have the same components
 		case MESH_DATA_FORMAT_IVUNT:
 		{
 			requiresIndices = true;
@@ -1471,93 +4201,144 @@ std::vector<char> ResourceManager::getFormattedMeshData (const ResourceMeshData
 			break;
 	}
 
-	if (interlaceData)
+	// Because indices don't necessarily correlate to the vertex data, all of them
+	// go sequentially first in the buffer, which is then followed by the vertex data
+	if (requiresIndices)
 	{
-		// Because indices don't necessarily correlate to the vertex data, all of them
-		// go sequentially first in the buffer, which is the followed by the interlaced
-		// vertex data
-		if ((data.uses32BitIndices ? data.indices_32bit.size() > 0 : data.indices_16bit.size() > 0) > 0 && requiresIndices)
+		if (data.uses32BitIndices)
 		{
-			if (data.uses32BitIndices)
-			{
-				meshDataArray.resize(data.indices_32bit.size() * sizeof(data.indices_32bit[0]));
-				memcpy(meshDataArray.data(), data.indices_32bit.data(), data.indices_32bit.size() * sizeof(data.indices_32bit[0]));
-			}
-			else
-			{
-				meshDataArray.resize(data.indices_16bit.size() * sizeof(data.indices_16bit[0]));
-				memcpy(meshDataArray.data(), data.indices_16bit.data(), data.indices_16bit.size() * sizeof(data.indices_16bit[0]));
-			}
+			meshDataArray.resize(data.indices_32bit.size() * sizeof(data.indices_32bit[0]));
+			memcpy(meshDataArray.data(), data.indices_32bit.data(), data.indices_32bit.size() * sizeof(data.indices_32bit[0]));
 		}
+		else
+		{
+			meshDataArray.resize(data.indices_16bit.size() * sizeof(data.indices_16bit[0]));
+			memcpy(meshDataArray.data(), data.indices_16bit.data(), data.indices_16bit.size() * sizeof(data.indices_16bit[0]));
+		}
+	}
 
-		size_t vertexSize = sizeof(data.vertices[0]);
-		size_t interlacedDataStart = meshDataArray.size() * (requiresIndices ? 1 : 0); // I don't trust boolean math :D
-		indexChunkSize = interlacedDataStart;
-
-		if (requiresUVs)
-			vertexSize += sizeof(svec2);
-
-		if (requiresNormals)
-			vertexSize += sizeof(svec3);
+	indexChunkSize = meshDataArray.size();
 
-		if (requiresTangents)
-			vertexSize += sizeof(svec3);
+	// Each component of the vertex data in order, components the mesh doesn't have have a null source
+	std::vector<std::pair<const char*, size_t> > components;
 
-		if (requiresBitangents)
-			vertexSize += sizeof(svec3);
+	/*
+	 * For packed formats each component is quantized into it's own array first, and then those are laid out
+	 * exactly the same as the float components would be.
+	 */
+	if (packed)
+	{
+		size_t vertexCount = data.vertices.size();
+		std::vector<int16_t> packedVertices(vertexCount * 4), packedNormals, packedTangents;
+		std::vector<uint16_t> packedUVs;
 
-		meshDataArray.resize(interlacedDataStart + vertexSize * data.vertices.size());
+		svec4 decodeScale, decodeOffset;
+		getMeshVertexDecodeParams(data, format, decodeScale, decodeOffset);
 
-		vertexStride = vertexSize;
+		for (size_t i = 0; i < vertexCount; i ++)
+		{
+			packedVertices[i * 4 + 0] = packSnorm16((data.vertices[i].x - decodeOffset.x) / decodeScale.x);
+			packedVertices[i * 4 + 1] = packSnorm16((data.vertices[i].y - decodeOffset.y) / decodeScale.y);
+			packedVertices[i * 4 + 2] = packSnorm16((data.vertices[i].z - decodeOffset.z) / decodeScale.z);
+			packedVertices[i * 4 + 3] = 32767;
+		}
 
-		for (size_t i = 0; i < data.vertices.size(); i ++)
+		if (data.uvs.size() > 0)
 		{
-			memcpy(meshDataArray.data() + interlacedDataStart + i * vertexSize, &data.vertices[i].x, sizeof(data.vertices[0]));
-			size_t offset = sizeof(data.vertices[0]);
+			packedUVs.resize(vertexCount * 2);
 
-			if (data.uvs.size() > 0 && requiresUVs)
+			for (size_t i = 0; i < vertexCount; i ++)
 			{
-				memcpy(meshDataArray.data() + interlacedDataStart + i * vertexSize + offset, &data.uvs[i].x, sizeof(data.uvs[0]));
-				offset += sizeof(data.uvs[0]);
-			}
-			else if (requiresUVs)
-			{
-				glm::vec2 zeroVec = glm::vec2(0, 0);
-				memcpy(meshDataArray.data() + interlacedDataStart + i * vertexSize + offset, &zeroVec.x, sizeof(zeroVec));
-				offset += sizeof(zeroVec);
+				packedUVs[i * 2 + 0] = packHalfFloat(data.uvs[i].x);
+				packedUVs[i * 2 + 1] = packHalfFloat(data.uvs[i].y);
 			}
+		}
 
-			if (data.normals.size() > 0 && requiresNormals)
-			{
-				memcpy(meshDataArray.data() + interlacedDataStart + i * vertexSize + offset, &data.normals[i].x, sizeof(data.normals[0]));
-				offset += sizeof(data.normals[0]);
-			}
-			else if (requiresNormals)
-			{
-				glm::vec3 zeroVec = glm::vec3(0, 0, 0);
-				memcpy(meshDataArray.data() + interlacedDataStart + i * vertexSize + offset, &zeroVec.x, sizeof(zeroVec));
-				offset += sizeof(zeroVec);
-			}
+		if (data.normals.size() > 0)
+		{
+			packedNormals.resize(vertexCount * 2);
 
-			if (data.tangents.size() > 0 && requiresTangents)
-			{
-				memcpy(meshDataArray.data() + interlacedDataStart + i * vertexSize + offset, &data.tangents[i].x, sizeof(data.tangents[0]));
-				offset += sizeof(data.tangents[0]);
-			}
-			else if (requiresTangents)
-			{
-				glm::vec3 zeroVec = glm::vec3(0, 0, 0);
-				memcpy(meshDataArray.data() + interlacedDataStart + i * vertexSize + offset, &zeroVec.x, sizeof(zeroVec));
-				offset += sizeof(zeroVec);
-			}
+			for (size_t i = 0; i < vertexCount; i ++)
+				packOctahedral(data.normals[i], &packedNormals[i * 2]);
 		}
+
+		if (data.tangents.size() > 0)
+		{
+			packedTangents.resize(vertexCount * 2);
+
+			for (size_t i = 0; i < vertexCount; i ++)
+				packOctahedral(data.tangents[i], &packedTangents[i * 2]);
+		}
+
+		components.push_back(std::make_pair(reinterpret_cast<const char*>(packedVertices.data()), sizeof(int16_t) * 4));
+		components.push_back(std::make_pair(packedUVs.size() > 0 ? reinterpret_cast<const char*>(packedUVs.data()) : nullptr, sizeof(uint16_t) * 2));
+		components.push_back(std::make_pair(packedNormals.size() > 0 ? reinterpret_cast<const char*>(packedNormals.data()) : nullptr, sizeof(int16_t) * 2));
+		components.push_back(std::make_pair(packedTangents.size() > 0 ? reinterpret_cast<const char*>(packedTangents.data()) : nullptr, sizeof(int16_t) * 2));
+
+		layoutMeshComponents(meshDataArray, components, vertexCount, vertexStride, interlaceData);
+
+		return meshDataArray;
 	}
-	else
+
+	components.push_back(std::make_pair(reinterpret_cast<const char*>(data.vertices.data()), sizeof(data.vertices[0])));
+
+	if (requiresUVs)
+		components.push_back(std::make_pair(data.uvs.size() > 0 ? reinterpret_cast<const char*>(data.uvs.data()) : nullptr, sizeof(svec2)));
+
+	if (requiresNormals)
+		components.push_back(std::make_pair(data.normals.size() > 0 ? reinterpret_cast<const char*>(data.normals.data()) : nullptr, sizeof(svec3)));
+
+	if (requiresTangents)
+		components.push_back(std::make_pair(data.tangents.size() > 0 ? reinterpret_cast<const char*>(data.tangents.data()) : nullptr, sizeof(svec3)));
+
+	if (requiresBitangents)
+		components.push_back(std::make_pair(data.bitangents.size() > 0 ? reinterpret_cast<const char*>(data.bitangents.data()) : nullptr, sizeof(svec3)));
+
+	layoutMeshComponents(meshDataArray, components, data.vertices.size(), vertexStride, interlaceData);
+
+	return meshDataArray;
+}
+
+/*
+ * Gets how the vertex shader should decode a mesh in a given format. For packed formats positions are stored relative
+ * to the mesh's bounding box, so the scale & offset are the half extents & center of the box. Unpacked formats just
+ * get an identity decode.
+ */
+void ResourceManager::getMeshVertexDecodeParams (const ResourceMeshData &data, MeshDataFormat format, svec4 &vertexDecodeScale, svec4 &vertexDecodeOffset)
+{
+	vertexDecodeScale = {1, 1, 1, 0};
+	vertexDecodeOffset = {0, 0, 0, 0};
+
+	if (format != MESH_DATA_FORMAT_IVUNT_PACKED || data.vertices.size() == 0)
+		return;
+
+	glm::vec3 boundsMin = glm::vec3(data.vertices[0].x, data.vertices[0].y, data.vertices[0].z);
+	glm::vec3 boundsMax = boundsMin;
+
+	for (size_t i = 1; i < data.vertices.size(); i ++)
 	{
+		glm::vec3 vertex = glm::vec3(data.vertices[i].x, data.vertices[i].y, data.vertices[i].z);
 
+		boundsMin = glm::min(boundsMin, vertex);
+		boundsMax = glm::max(boundsMax, vertex);
 	}
 
-	return meshDataArray;
+	// Flat meshes would otherwise have a zero scale on one axis
+	glm::vec3 halfExtent = glm::max((boundsMax - boundsMin) * 0.5f, glm::vec3(1e-6f));
+	glm::vec3 center = (boundsMin + boundsMax) * 0.5f;
+
+	vertexDecodeScale = {halfExtent.x, halfExtent.y, halfExtent.z, 1};
+	vertexDecodeOffset = {center.x, center.y, center.z, 0};
+}
+
+void ResourceManager::setRendererMeshFormat (MeshDataFormat format)
+{
+	rendererMeshFormat = format;
+}
+
+MeshDataFormat ResourceManager::getRendererMeshFormat ()
+{
+	return rendererMeshFormat;
 }
 
 RendererTextureView *ResourceManager::getBlackColorTexture()
@@ -32,9 +32,20 @@
 
 #include <common.h>
 #include <Resources/Resources.h>
+#include <Resources/FileView.h>
+#include <Resources/AssetID.h>
+#include <Resources/AssetCacheTable.h>
+#include <Resources/ResourceHandleTable.h>
+#include <Rendering/UploadBatcher.h>
 
 #include <assimp/Importer.hpp>
 
+#include <functional>
+#include <memory>
+#include <deque>
+#include <list>
+#include <condition_variable>
+
 class  Renderer;
 struct RendererCommandPool;
 class  RendererDescriptorPool;
@@ -42,6 +53,105 @@ struct RendererRenderPass;
 struct RendererTexture;
 struct RendererTextureView;
 
+/*
+ * Intermediate data for a texture that's been read from disk (and decoded if need be), but hasn't
+ * been uploaded to the GPU yet. This is what gets passed from a worker thread to the main thread
+ * for async texture loads.
+ */
+typedef struct ResourceTextureStagingData
+{
+		TextureFileFormat format;
+		uint32_t width;
+		uint32_t height;
+		uint32_t mipmapLevels;
+		ResourceFormat textureFormat;
+		size_t firstTexOffset; // DDS only, the offset in each buffer of the first mip level
+
+		std::vector<std::vector<uint8_t> > pngLayers; // Decoded RGBA8 data for each layer
+		std::vector<FileView> ddsBuffers;             // A view of the raw DDS file for each layer
+} ResourceTextureStagingData;
+
+typedef struct MeshCacheKey
+{
+		AssetID file;
+		AssetID mesh;
+		MeshDataFormat format;
+		bool interlaced;
+
+		inline bool operator== (const MeshCacheKey &arg0) const
+		{
+			return file == arg0.file && mesh == arg0.mesh && format == arg0.format && interlaced == arg0.interlaced;
+		}
+} MeshCacheKey;
+
+struct MeshCacheKeyHash
+{
+		inline uint64_t operator() (const MeshCacheKey &key) const
+		{
+			return combineAssetCacheKey(combineAssetCacheKey(key.file, key.mesh), ((uint64_t) key.format << 1) | (key.interlaced ? 1 : 0));
+		}
+};
+
+inline MeshCacheKey getMeshCacheKey (const std::string &file, const std::string &mesh, MeshDataFormat format, bool interlaced)
+{
+	return {AssetIDTable::getAssetID(file), AssetIDTable::getAssetID(mesh), format, interlaced};
+}
+
+/*
+ * All of the defs from one game defs file. Each type of def is kept in one array, so loading a file doesn't need an
+ * allocation for every def (other than the LOD lists of the static mesh defs).
+ */
+typedef struct GameDefs
+{
+		std::vector<MaterialDef> materialDefs;
+		std::vector<PipelineDef> pipelineDefs;
+		std::vector<StaticMeshDef> meshDefs;
+		std::vector<LevelDef> levelDefs;
+} GameDefs;
+
+#define RESOURCE_CACHE_DEFAULT_CPU_BUDGET (16 * 1024 * 1024)
+#define RESOURCE_CACHE_DEFAULT_VRAM_BUDGET (256 * 1024 * 1024)
+#define RESOURCE_CACHE_DEFAULT_DECAY_TIME 60.0
+#define RESOURCE_CACHE_DEFAULT_TEXTURE_STREAMING_BUDGET (512 * 1024 * 1024)
+
+#define TEXTURE_STREAMING_TAIL_SIZE 128          // Mip levels this size (or smaller) are uploaded as soon as a streamed texture is loaded
+#define TEXTURE_STREAMING_MAX_IN_FLIGHT 4         // Mip level changes that can be in progress at once
+#define TEXTURE_STREAMING_FREE_DELAY_FRAMES 3     // How long the replaced texture & descriptor sets are kept around, in case a frame in flight still uses them
+
+// Drawn w/ in place of a material's pipeline while it's still compiling, it has the same vertex & descriptor set layouts as every material pipeline
+#define RESOURCE_FALLBACK_PIPELINE "engine.defaultMaterial"
+
+// How many vertices getFormattedMeshData() interlaces at a time, small enough that a block of even the biggest vertex format stays in the cache
+#define MESH_INTERLACE_BLOCK_SIZE 512
+
+/*
+ * How long & how much of the resources w/o any references left are kept around, in case they get loaded again. The
+ * least recently returned resources are evicted first whenever either budget is exceeded, and anything that's been
+ * unreferenced for longer than decayTime is evicted regardless. Budgets of 0 turn the retention off.
+ */
+typedef struct ResourceCacheConfig
+{
+		size_t cpuBudget;  // Bytes of CPU memory that unreferenced resources can hold on to
+		size_t vramBudget; // Bytes of GPU memory that unreferenced resources can hold on to
+		double decayTime;  // In seconds
+
+		size_t textureStreamingBudget; // Bytes of GPU memory that streamed textures can use, mip levels that aren't needed get dropped to stay under it
+} ResourceCacheConfig;
+
+typedef struct ResourceCacheStats
+{
+		uint64_t hits;          // Loads that found the resource already loaded
+		uint64_t retainedHits;  // Hits on a resource that had no references left, and would've been freed w/o the retention
+		uint64_t misses;        // Loads that had to load the resource
+		uint64_t evictions;     // Unreferenced resources that were actually freed
+		uint32_t retainedCount;
+		size_t retainedCPUSize;
+		size_t retainedVRAMSize;
+		uint32_t streamedTextureCount;
+		uint32_t textureMipStreamsInFlight;
+		size_t streamedTextureVRAMSize;
+} ResourceCacheStats;
+
 /*
  * Manages resources such as meshes, textures, scripts, etc for the game. It
  * makes use of a reference-counter based cache to only load & keep unique
@@ -54,31 +164,85 @@ class ResourceManager
 		virtual ~ResourceManager ();
 
 		ResourceMesh loadMeshImmediate (const std::string &file, const std::string &mesh);
+		ResourceMesh loadMeshAsync (const std::string &file, const std::string &mesh, std::function<void(ResourceMesh)> callback = nullptr);
 		void returnMesh (ResourceMesh mesh);
 
 		ResourceTexture loadTextureImmediate (const std::string &file, TextureFileFormat format = TEXTURE_FILE_FORMAT_MAX_ENUM);
 		ResourceTexture loadTextureArrayImmediate (const std::vector<std::string> &files, TextureFileFormat format = TEXTURE_FILE_FORMAT_MAX_ENUM);
+		ResourceTexture loadTextureAsync (const std::string &file, TextureFileFormat format = TEXTURE_FILE_FORMAT_MAX_ENUM, std::function<void(ResourceTexture)> callback = nullptr);
 		void returnTexture (ResourceTexture tex);
+		void setTextureRequiredSize (ResourceTexture tex, uint32_t requiredSize);
 
 		ResourceMaterial loadMaterialImmediate (const std::string &defUniqueName);
+		ResourceMaterial loadMaterialAsync (const std::string &defUniqueName, std::function<void(ResourceMaterial)> callback = nullptr);
 		ResourceMaterial findMaterial (const std::string &defUniqueName);
-		ResourceMaterial findMaterial (size_t defUniqueNameHash);
+		ResourceMaterial findMaterial (AssetID defUniqueNameID);
 		void returnMaterial (const std::string &defUniqueName);
-		void returnMaterial (size_t defUniqueNameHash);
+		void returnMaterial (AssetID defUniqueNameID);
 
 		ResourceStaticMesh loadStaticMeshImmediate (const std::string &defUniqueName);
+		ResourceStaticMesh loadStaticMeshAsync (const std::string &defUniqueName, std::function<void(ResourceStaticMesh)> callback = nullptr);
 		ResourceStaticMesh findStaticMesh (const std::string &defUniqueName);
-		ResourceStaticMesh findStaticMesh (size_t defUniqueNameHash);
+		ResourceStaticMesh findStaticMesh (AssetID defUniqueNameID);
 		void returnStaticMesh (const std::string &defUniqueName);
-		void returnStaticMesh (size_t defUniqueNameHash);
+		void returnStaticMesh (AssetID defUniqueNameID);
 
 		ResourcePipeline loadPipelineImmediate (const std::string &defUniqueName);
+		ResourcePipeline loadPipelineAsync (const std::string &defUniqueName, std::function<void(ResourcePipeline)> callback = nullptr);
 		ResourcePipeline findPipeline (const std::string &defUniqueName);
-		ResourcePipeline findPipeline (size_t defUniqueNameHash);
+		ResourcePipeline findPipeline (AssetID defUniqueNameID);
 		void returnPipeline (const std::string &defUniqueName);
-		void returnPipeline (size_t defUniqueNameHash);
+		void returnPipeline (AssetID defUniqueNameID);
 
-		void loadGameDefsFile (const std::string &file);
+		ResourcePipeline getMaterialPipeline (ResourceMaterial material);
+
+		/*
+		 * Resolves a resource handle w/ just an array index, instead of going through the caches. Returns nullptr if
+		 * the resource has been freed since the handle was made. Unlike find*(), resources w/o any references left
+		 * that are still being retained resolve fine, since they haven't been freed yet.
+		 */
+		inline ResourceMesh getMesh (ResourceMeshHandle handle)
+		{
+			return meshHandles.get(handle);
+		}
+
+		inline ResourceTexture getTexture (ResourceTextureHandle handle)
+		{
+			return textureHandles.get(handle);
+		}
+
+		inline ResourceMaterial getMaterial (ResourceMaterialHandle handle)
+		{
+			return materialHandles.get(handle);
+		}
+
+		inline ResourceStaticMesh getStaticMesh (ResourceStaticMeshHandle handle)
+		{
+			return staticMeshHandles.get(handle);
+		}
+
+		inline ResourcePipeline getPipeline (ResourcePipelineHandle handle)
+		{
+			return pipelineHandles.get(handle);
+		}
+
+		void processAsyncLoads ();
+		uint32_t getPendingAsyncLoadCount ();
+		void setFrameUploadBudget (size_t budget);
+		size_t getFrameUploadBudget ();
+		UploadBatcherStats getUploadStats ();
+		MeshPoolStats getMeshPoolStats ();
+		uint32_t getAsyncWorkerCount ();
+
+		bool timePNGTextureArrayDecode (const std::vector<std::string> &files, uint32_t maxThreads, double &time);
+		bool stressTestMeshImports (const std::string &file, uint32_t threadCount, uint32_t importsPerThread);
+
+		void setResourceCacheConfig (const ResourceCacheConfig &config);
+		ResourceCacheConfig getResourceCacheConfig ();
+		ResourceCacheStats getResourceCacheStats ();
+		void evictUnreferencedResources ();
+
+		bool loadGameDefsFile (const std::string &file);
 
 		void addLevelDef (const LevelDef &def);
 		void addMaterialDef (const MaterialDef &def);
@@ -90,14 +254,25 @@ class ResourceManager
 		StaticMeshDef *getMeshDef (const std::string &defUniqueName);
 		PipelineDef *getPipelineDef (const std::string &defUniqueName);
 
-		LevelDef *getLevelDef (size_t uniqueNameHash);
-		MaterialDef *getMaterialDef (size_t uniqueNameHash);
-		StaticMeshDef *getMeshDef (size_t uniqueNameHash);
-		PipelineDef *getPipelineDef (size_t uniqueNameHash);
+		LevelDef *getLevelDef (AssetID uniqueNameID);
+		MaterialDef *getMaterialDef (AssetID uniqueNameID);
+		StaticMeshDef *getMeshDef (AssetID uniqueNameID);
+		PipelineDef *getPipelineDef (AssetID uniqueNameID);
 
 		void setPipelineRenderPass (RendererRenderPass *renderPass, RendererRenderPass *shadowRenderPass);
 
+		void setRendererMeshFormat (MeshDataFormat format);
+		MeshDataFormat getRendererMeshFormat ();
+
 		static std::vector<char> getFormattedMeshData (const ResourceMeshData &data, MeshDataFormat format, size_t &indexChunkSize, size_t &vertexStride, bool interlaceData = true);
+		static void getMeshVertexDecodeParams (const ResourceMeshData &data, MeshDataFormat format, svec4 &vertexDecodeScale, svec4 &vertexDecodeOffset);
+
+		uint32_t cookMeshFile (const std::string &file);
+		static std::string getCookedMeshFile (const std::string &file, const std::string &mesh, MeshDataFormat format);
+		static std::string getGeneratedLODMeshName (const std::string &mesh, float triangleRatio, float maxError);
+
+		static bool cookGameDefsFile (const std::string &file);
+		static std::string getCookedGameDefsFile (const std::string &file);
 
 		RendererTextureView *getBlackColorTexture();
 		RendererTextureView *getDitherPatternTexture();
@@ -105,7 +280,8 @@ class ResourceManager
 	private:
 
 		Renderer *renderer;
-		RendererCommandPool *mainThreadTransferCommandPool;
+		UploadBatcher *uploadBatcher;
+		MeshPool *meshPool;
 		RendererDescriptorPool *mainThreadDescriptorPool;
 		RendererRenderPass *pipelineRenderPass;
 		RendererRenderPass *pipelineShadowRenderPass;
@@ -116,62 +292,222 @@ class ResourceManager
 		RendererTextureView *colorBlackTexView;
 		RendererTextureView *ditherTexView;
 
-		std::map<size_t, MaterialDef*> loadedMaterialDefsMap;
+		// The format meshes are loaded in for rendering, and that the material pipelines expect. Has to be set before anything is loaded
+		MeshDataFormat rendererMeshFormat;
+
+		AssetCacheTable<AssetID, MaterialDef*> loadedMaterialDefsMap;
 		//std::vector<MaterialDef*> loadedMaterialDefs;
 
-		std::map<size_t, StaticMeshDef*> loadedMeshDefsMap;
+		AssetCacheTable<AssetID, StaticMeshDef*> loadedMeshDefsMap;
 		//std::vector<MeshDef*> loadedMeshDefs;
 
-		std::map<size_t, LevelDef*> loadedLevelDefsMap;
+		AssetCacheTable<AssetID, LevelDef*> loadedLevelDefsMap;
 		//std::vector<LevelDef*> loadedLevelDefs;
 
-		std::map<size_t, PipelineDef*> loadedPipelineDefsMap;
+		AssetCacheTable<AssetID, PipelineDef*> loadedPipelineDefsMap;
+
+		// The storage for every def that came from a game defs file, the def maps point into these
+		std::vector<std::unique_ptr<GameDefs> > loadedGameDefs;
 
-		std::map<size_t, std::pair<ResourceMaterial, uint32_t> > loadedMaterials;
-		std::map<size_t, std::pair<ResourceStaticMesh, uint32_t> > loadedStaticMeshes;
-		std::map<size_t, std::pair<ResourcePipeline, uint32_t> > loadedPipelines;
+		AssetCacheTable<AssetID, std::pair<ResourceMaterial, uint32_t> > loadedMaterials;
+		AssetCacheTable<AssetID, std::pair<ResourceStaticMesh, uint32_t> > loadedStaticMeshes;
+		AssetCacheTable<AssetID, std::pair<ResourcePipeline, uint32_t> > loadedPipelines;
 
-		// Because I don't know the thread safety of assimp importers, the access is controlled by a mutex for now
-		// TODO Figure out assimp importer thread safety
-		std::mutex assimpImporter_mutex;
-		Assimp::Importer assimpImporter;
+		// The pipelines that were loaded by getMaterialPipeline(), they're all held until the resource manager is deleted
+		std::set<AssetID> requestedMaterialPipelines;
 
 		/*
-		 * Note that at least for now, I'm using maps to do the proper cache lookups. Right now it's
-		 * pretty inefficient because it has to compare a lot of variables. For meshes, it's 2 strings,
-		 * an enum, and a boolean. Definitely will make this lookup faster later on.
-		 *
-		 * TODO Make resource manager cache lookups faster
+		 * An assimp importer can only be used by one thread at a time (it owns the scene it last read), but separate
+		 * importers are independent, so every import borrows one from this pool and gives it back when it's done w/ the scene.
+		 * The pool only grows when every importer is in use, so it ends up w/ about one per thread that imports meshes.
+		 */
+		std::mutex assimpImporterPool_mutex;
+		std::vector<std::unique_ptr<Assimp::Importer> > assimpImporters;
+		std::vector<Assimp::Importer*> freeAssimpImporters;
+
+		std::mutex cookingMeshFiles_mutex; // Controls access of member "cookingMeshFiles"
+		std::condition_variable cookingMeshFiles_cv;
+		std::set<std::string> cookingMeshFiles; // The cooked mesh files that are being written right now, only one thread writes each at a time
+
+		/*
+		 * All of the caches are keyed on interned AssetIDs (see AssetIDTable) instead of the names themselves, so
+		 * a lookup is a hash & an integer compare or two, instead of walking a tree comparing strings.
 		 */
 
+		// Every loaded resource gets a slot in these when it's created, and gives it back right before it's freed
+		ResourceHandleTable<ResourceMeshObject> meshHandles;
+		ResourceHandleTable<ResourceTextureObject> textureHandles;
+		ResourceHandleTable<ResourceMaterialObject> materialHandles;
+		ResourceHandleTable<ResourceStaticMeshObject> staticMeshHandles;
+		ResourceHandleTable<ResourcePipelineObject> pipelineHandles;
+
 		std::mutex loadedMeshes_mutex; // Controls access of member "loadedMeshes"
 
 		/*
-		 * The cache for mesh resources. The key consists of the mesh file, mesh name, data format, and a bool
-		 * of whether it's interlaced or not. The mapped value consists of a pair, the first value being a ptr
+		 * The cache for mesh resources. The key consists of the ids of the mesh file & mesh name, data format,
+		 * and a bool of whether it's interlaced or not. The mapped value consists of a pair, the first value being a ptr
 		 * to the resource, the second being a reference counter. The counter works by incrementing each time
 		 * loadMesh*() is called, and decremented when returnMesh() is called. When the reference counter is
-		 * 0, the meshes is totally unloaded until the next call to loadMesh*(), where it wil have to load it
-		 * all over again. At some point I will add a decay timer so this doesn't happen immediately.
+		 * 0, the mesh is put in the retained resource list (see "retainedResources"), and is only unloaded
+		 * once it's evicted from there.
 		 *
 		 * Note that the access to this member is controlled by "loadedMeshes_mutex"
-		 *
-		 * TODO Implement a decay timer for 0 reference counter cache objects in ResourceManager
 		 */
-		std::map<std::tuple<std::string, std::string, MeshDataFormat, bool>, std::pair<ResourceMesh, uint32_t> > loadedMeshes;
+		AssetCacheTable<MeshCacheKey, std::pair<ResourceMesh, uint32_t>, MeshCacheKeyHash> loadedMeshes;
 
 		std::mutex loadedTextures_mutex; // Controls access of member "loadedTextures"
 
 		/*
-		 * The cache for texture resources. The key is just the file name, and the mapped value consists of a
+		 * The cache for texture resources. The key is just the id of the (first) file name, and the mapped value consists of a
 		 * pair. The first value is the actual texture resource, and the second value is a reference counter.
 		 */
-		std::map<std::string, std::pair<ResourceTexture, uint32_t> > loadedTextures;
+		AssetCacheTable<AssetID, std::pair<ResourceTexture, uint32_t> > loadedTextures;
+
+		typedef enum RetainedResourceType
+		{
+			RETAINED_RESOURCE_TYPE_MESH = 0,
+			RETAINED_RESOURCE_TYPE_TEXTURE,
+			RETAINED_RESOURCE_TYPE_MATERIAL,
+			RETAINED_RESOURCE_TYPE_STATIC_MESH,
+			RETAINED_RESOURCE_TYPE_MAX_ENUM
+		} RetainedResourceType;
+
+		typedef struct RetainedResource
+		{
+				RetainedResourceType type;
+				void *resource;
+				size_t cpuSize;
+				size_t vramSize;
+				std::chrono::steady_clock::time_point returnTime;
+		} RetainedResource;
+
+		std::mutex retainedResources_mutex; // Controls access of members "retainedResources", "retainedResourcesMap", "resourceCacheConfig" and "resourceCacheStats"
 
-		ResourceMeshData loadRawMeshData (const std::string &file, const std::string &mesh);
+		/*
+		 * Resources whose reference counter has hit 0 stay in their cache w/ a count of 0, and are put at the back of this
+		 * list instead of being freed. Loading one again takes it back out of the list, and updateRetainedResources() frees
+		 * them from the front once they go over budget or decay. Materials & static meshes keep their textures & meshes
+		 * referenced while they're retained, so the VRAM of those counts towards the material/static mesh.
+		 *
+		 * Lock order is the resource cache's mutex (if it has one) first, then "retainedResources_mutex".
+		 */
+		std::list<RetainedResource> retainedResources;
+		std::map<void*, std::list<RetainedResource>::iterator> retainedResourcesMap;
+
+		ResourceCacheConfig resourceCacheConfig;
+		ResourceCacheStats resourceCacheStats;
+
+		/*
+		 * A change of the resident mip levels of a streamed texture. The texture's data is read again on a worker thread, and
+		 * a new texture w/ just the levels from "targetMip" down is uploaded & swapped in once it's on the GPU. If the texture is
+		 * evicted in the mean time, then the stream is just cancelled & whatever it's created gets thrown away.
+		 */
+		typedef struct TextureMipStream
+		{
+				ResourceTexture tex;
+				uint32_t targetMip;
+				bool cancelled;
+		} TextureMipStream;
+
+		typedef struct PendingTextureFree
+		{
+				uint32_t framesLeft;
+				RendererTexture *texture;
+				RendererTextureView *textureView;
+				RendererDescriptorSet *descriptorSet;
+		} PendingTextureFree;
+
+		// These are all only touched from the main thread
+		std::set<ResourceTexture> streamedTextures;
+		std::map<ResourceTexture, std::shared_ptr<TextureMipStream> > textureMipStreams;
+		std::deque<PendingTextureFree> pendingTextureFrees;
+		size_t streamedTextureMemorySize;
+
+		std::thread::id mainThreadID;
+
+		/*
+		 * The async loading is split up into two stages. The first stage (file reading, decoding, formatting, etc)
+		 * is pushed to "asyncWorkerJobs" and is executed by the worker threads. Once that's done, the worker pushes the
+		 * second stage (creating the renderer objects & uploading to the GPU) to "mainThreadAsyncTasks", which is then
+		 * executed on the main thread by processAsyncLoads(). This way none of the renderer objects are ever touched
+		 * from multiple threads, and the main thread only has to wait on the actual transfer.
+		 */
+
+		bool asyncWorkersRunning;
+		std::vector<std::thread> asyncWorkerThreads;
+
+		std::mutex asyncWorkerJobs_mutex; // Controls access of member "asyncWorkerJobs" and "asyncWorkersRunning"
+		std::condition_variable asyncWorkerJobs_cv;
+		std::deque<std::function<void()> > asyncWorkerJobs;
+
+		std::mutex mainThreadAsyncTasks_mutex; // Controls access of member "mainThreadAsyncTasks"
+		std::deque<std::function<void()> > mainThreadAsyncTasks;
+
+		std::mutex asyncLoadCallbacks_mutex; // Controls access of member "asyncLoadCallbacks", and the "dataLoaded" flags set by finishAsyncLoad()
+		std::condition_variable asyncLoadFinished_cv; // Notified by finishAsyncLoad(), for waitForAsyncLoad() off the main thread
+
+		/*
+		 * Callbacks waiting on a resource that is still being loaded asynchronously, keyed by the resource object. They're
+		 * all called (on the main thread) as soon as the resource's "dataLoaded" flag is set by finishAsyncLoad().
+		 */
+		std::map<void*, std::vector<std::function<void()> > > asyncLoadCallbacks;
+
+		std::atomic<uint32_t> pendingAsyncLoadCount;
+
+		// Bytes of GPU uploads processAsyncLoads() will queue per call before leaving the rest of the tasks for the next one, 0 for no limit
+		size_t frameUploadBudget;
+
+		void asyncWorkerThreadFunc ();
+		void pushAsyncWorkerJob (const std::function<void()> &job);
+		void pushMainThreadAsyncTask (const std::function<void()> &task);
+		void runMainThreadAsyncTasks ();
+		void runParallelJobs (uint32_t jobCount, const std::function<void(uint32_t)> &job, uint32_t maxThreads = 0);
 
-		void loadPNGTextureData (ResourceTexture tex);
-		void loadDDSTextureData(ResourceTexture tex);
+		void retainResource (RetainedResourceType type, void *resource, size_t cpuSize, size_t vramSize);
+		void countResourceCacheLookup (void *resource, bool hit);
+		void updateRetainedResources (bool evictAll);
+		bool evictRetainedResource (const RetainedResource &retained);
+
+		void addAsyncLoadCallback (void *resource, const std::atomic<bool> &dataLoaded, const std::function<void()> &callback);
+		void finishAsyncLoad (void *resource, std::atomic<bool> &dataLoaded);
+		void waitForAsyncLoad (const std::atomic<bool> &dataLoaded);
+
+		bool checkPipelineDef (PipelineDef *pipeDef);
+		void createPipelineObjects (ResourcePipeline pipe, PipelineDef *pipeDef);
+
+		ResourceMeshData loadRawMeshData (const std::string &file, const std::string &mesh);
+		Assimp::Importer *acquireAssimpImporter ();
+		void releaseAssimpImporter (Assimp::Importer *importer);
+		bool openCookedMeshData (ResourceMesh meshRes, FileView &cookedMeshFile, const char *&formattedData, size_t &formattedDataSize);
+		bool uploadMeshData (ResourceMesh meshRes, const char *formattedData, size_t formattedDataSize);
+		bool writeCookedMeshFile (const std::string &cookedFile, const ResourceMeshData &meshData, MeshDataFormat format, const std::vector<char> &formattedData, size_t indexChunkSize, size_t vertexStride);
+
+		void generateMeshDefLODs (StaticMeshDef &def);
+
+		static bool parseGameDefsText (const char *text, size_t textSize, const std::string &file, GameDefs &defs);
+		static bool readCookedGameDefs (const char *data, size_t dataSize, const std::string &file, GameDefs &defs);
+		static bool writeCookedGameDefsFile (const std::string &cookedFile, const GameDefs &defs);
+		static bool parseGeneratedLODMeshName (const std::string &lodMesh, std::string &mesh, float &triangleRatio, float &maxError);
+
+		void writeMaterialDescriptorSet (ResourceMaterial mat);
+
+		bool readTextureData (const std::vector<std::string> &files, TextureFileFormat format, ResourceTextureStagingData &data);
+		void uploadTextureData (ResourceTexture tex, ResourceTextureStagingData &data);
+
+		bool readPNGTextureData (const std::vector<std::string> &files, ResourceTextureStagingData &data, uint32_t maxThreads = 0);
+		void readDDSTextureData (const std::vector<std::string> &files, ResourceTextureStagingData &data);
+		void uploadPNGTextureData (ResourceTexture tex, ResourceTextureStagingData &data);
+		void uploadDDSTextureData (ResourceTexture tex, ResourceTextureStagingData &data);
+		RendererTexture *uploadDDSTextureMips (ResourceTexture tex, ResourceTextureStagingData &data, uint32_t baseMip);
+
+		void updateTextureStreaming ();
+		void streamTextureMips (ResourceTexture tex, uint32_t targetMip);
+		void swapStreamedTexture (ResourceTexture tex, RendererTexture *newTexture, uint32_t newResidentMip);
+		void stopTextureStreaming (ResourceTexture tex);
+		void updatePendingTextureFrees (bool freeAll);
+
+		static uint32_t getTextureTailMip (ResourceTexture tex);
+		static size_t getDDSTextureMipsSize (ResourceTexture tex, uint32_t baseMip, uint32_t layerCount);
 };
 
 #endif /* RESOURCES_RESOURCEMANAGER_H_ */
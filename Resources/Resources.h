@@ -39,6 +39,41 @@ struct RendererSampler;
 struct RendererPipeline;
 
 #include <Rendering/Renderer/RendererEnums.h>
+#include <Resources/AssetID.h>
+#include <Rendering/MeshPool.h>
+
+/*
+ * A handle to a loaded resource, made of an index into the resource manager's slot array for that type of resource,
+ * and the generation of the slot when the handle was made. A slot's generation changes every time the resource in it
+ * is freed, so a handle to a freed resource resolves to nullptr instead of whatever's been put in the slot since.
+ * Generation 0 is never used, so a zeroed handle is always a null handle.
+ */
+template<typename T>
+struct ResourceHandle
+{
+		uint32_t index;
+		uint32_t generation;
+
+		inline bool isNull () const
+		{
+			return generation == 0;
+		}
+
+		inline bool operator== (const ResourceHandle<T> &arg0) const
+		{
+			return index == arg0.index && generation == arg0.generation;
+		}
+
+		inline bool operator!= (const ResourceHandle<T> &arg0) const
+		{
+			return !operator== (arg0);
+		}
+
+		inline bool operator< (const ResourceHandle<T> &arg0) const
+		{
+			return index < arg0.index || (index == arg0.index && generation < arg0.generation);
+		}
+};
 
 /*
  * Describes what components the data of a mesh must contain. The syntax of the enum describes what
@@ -63,12 +98,20 @@ struct RendererPipeline;
  * D - Bone IDs     (for skinning, represented as an ivec4)
  * W - Bone Weights (for skinning, represented as a vec4)
  *
+ * Formats ending in _PACKED have the same components, but quantized to 20 bytes per vertex instead of 44:
+ *
+ * V - 4x 16-bit snorm, the position relative to the mesh's bounds (w is unused), decoded w/ the mesh's vertexDecodeScale/Offset
+ * U - 2x 16-bit float
+ * N - 2x 16-bit snorm, an octahedral encoded unit vector
+ * T - 2x 16-bit snorm, an octahedral encoded unit vector
+ *
  */
 typedef enum MeshDataFormat
 {
 	MESH_DATA_FORMAT_IVUNT = 0,
 	MESH_DATA_FORMAT_IV,
 	MESH_DATA_FORMAT_V,
+	MESH_DATA_FORMAT_IVUNT_PACKED,
 	MESH_DATA_FORMAT_MAX_ENUM
 } MeshDataFormat;
 
@@ -114,6 +157,35 @@ typedef struct ResourceMeshData
 		std::vector<svec4> boneWeights;
 } ResourceMeshData;
 
+// The separator between the mesh name and the settings in the name of a generated LOD, e.g. "Cube@lod2500_1000"
+#define MESH_GENERATED_LOD_SEPARATOR "@lod"
+
+#define COOKED_MESH_MAGIC_NUM 0x48534D53 // "SMSH" in little endian
+#define COOKED_MESH_VERSION 2
+#define COOKED_MESH_EXTENSION ".smsh"
+
+#define COOKED_MESH_FLAG_32BIT_INDICES 0x1
+#define COOKED_MESH_FLAG_INTERLACED 0x2
+
+/*
+ * The header at the start of a cooked mesh file. Cooked meshes are made offline by ResourceManager::cookMeshFile(),
+ * and the data right after the header is exactly what getFormattedMeshData() would build for the mesh in "meshFormat",
+ * the index chunk and then the vertex data. Loading one is just a copy into a staging buffer, no assimp involved.
+ */
+typedef struct CookedMeshHeader
+{
+		uint32_t magic;
+		uint32_t version;
+		uint32_t meshFormat; // A MeshDataFormat
+		uint32_t flags;
+		uint32_t faceCount;
+		uint32_t vertexStride;
+		uint64_t indexChunkSize;
+		uint64_t dataSize; // The size of the index chunk & vertex data together
+		svec4 vertexDecodeScale;
+		svec4 vertexDecodeOffset;
+} CookedMeshHeader;
+
 /*
  * A mesh resource data struct. Contains all the data needed to render the mesh,
  * and compare w/ other meshes. Do not create this yourself, use the provided
@@ -128,6 +200,8 @@ typedef struct ResourceMeshData
 typedef struct ResourceMeshObject
 {
 		std::atomic<bool> dataLoaded; // Used for multi-threaded resource loading
+		std::atomic<bool> loadFailed; // Set before "dataLoaded" if the mesh couldn't be loaded, in which case it has no data & shouldn't be drawn
+		ResourceHandle<ResourceMeshObject> handle;
 		size_t indexChunkSize; // The size in bytes of the index value chunk at the start of the mesh buffer
 		size_t vertexStride;   // The stride in bytes of each vertex
 		uint32_t faceCount;
@@ -138,10 +212,23 @@ typedef struct ResourceMeshObject
 		bool interlaced;
 		bool uses32bitIndices;
 
+		// How the vertex shader decodes positions, pos = pos * scale.xyz + offset.xyz. scale.w is 1 if normals & tangents are octahedral encoded
+		svec4 vertexDecodeScale;
+		svec4 vertexDecodeOffset;
+
+		/*
+		 * Where the mesh's data is in the mesh pool. The buffers are the pool page's, which are shared w/ the other meshes
+		 * in the page, so the mesh has to be drawn w/ "firstIndex" and "vertexOffset" (in indices & vertices respectively).
+		 */
+		MeshPoolAllocation poolAllocation;
 		RendererBuffer *meshVertexBuffer;
 		RendererBuffer *meshIndexBuffer;
+		uint32_t firstIndex;
+		int32_t vertexOffset;
 } *ResourceMesh;
 
+typedef ResourceHandle<ResourceMeshObject> ResourceMeshHandle;
+
 /*
  * A texture resource data struct. Contains all the data needed to use the texture
  * in rendering & materials. Do not create this yourself, use the provided
@@ -150,35 +237,59 @@ typedef struct ResourceMeshObject
 typedef struct ResourceTextureObject
 {
 		std::atomic<bool> dataLoaded; // Used for multi-threaded texture loading
+		std::atomic<bool> loadFailed; // Set before "dataLoaded" if the texture couldn't be loaded, in which case it has no texture or view
+		ResourceHandle<ResourceTextureObject> handle;
 		std::vector<std::string> files;
 		ResourceFormat textureFormat;
-		uint32_t mipmapLevels;
+		uint32_t width;        // Of mip level 0, even if it isn't resident
+		uint32_t height;
+		uint32_t mipmapLevels; // Of the whole mip chain, even if it isn't all resident
 		uint32_t arrayLayers;
+		size_t memorySize; // Roughly how much VRAM the texture takes up
+
+		/*
+		 * Async loaded DDS textures only have their mip tail uploaded at first, the more detailed mips are streamed in
+		 * later as they're needed (see ResourceManager::setTextureRequiredSize()), and dropped again if we run out of
+		 * texture streaming budget. "texture" only holds the mip levels from "residentMip" down, and it & "textureView"
+		 * get swapped out for new ones whenever that changes, so the view of a streamed texture shouldn't be held on to
+		 * by anything but a material (whose descriptor set gets rewritten w/ the new one).
+		 */
+		bool mipStreamable;
+		uint32_t residentMip;  // The most detailed mip level that's on the GPU
+		uint32_t requestedMip; // The most detailed mip level that's wanted
 
 		RendererTexture *texture;
-		RendererTextureView *textureView; // A view for the whole texture, aka a default view
+		RendererTextureView *textureView; // A view for the whole (resident part of the) texture, aka a default view
 } *ResourceTexture;
 
+typedef ResourceHandle<ResourceTextureObject> ResourceTextureHandle;
+
 /*
  * A pipeline resource for rendering materials.
  */
 typedef struct ResourcePipelineObject
 {
 		std::atomic<bool> dataLoaded; // For multi-threaded loading
+		ResourceHandle<ResourcePipelineObject> handle;
 
 		std::string defUniqueName;
 		RendererPipeline *pipeline;
 		RendererPipeline *depthPipeline;	// For rendering depth (shadow mapping)
 } *ResourcePipeline;
 
+typedef ResourceHandle<ResourcePipelineObject> ResourcePipelineHandle;
+
 #define RESOURCE_DEF_MAX_NAME_LENGTH 64
 #define RESOURCE_DEF_MAX_FILE_LENGTH 128
 #define MATERIAL_DEF_MAX_TEXTURE_NUM 8
 
 typedef struct ResourceMaterialObject
 {
+		std::atomic<bool> dataLoaded; // Set once all of the textures are loaded & the descriptor set is written
 		std::string defUniqueName;
-		size_t pipelineHash;
+		ResourceHandle<ResourceMaterialObject> handle;
+		AssetID pipelineID;
+		ResourceHandle<ResourcePipelineObject> pipelineHandle; // Resolved from pipelineID the first time it's rendered
 		uint8_t usedTextureCount; // The number of valid textures in the textures[..] array
 
 		ResourceTexture textures[MATERIAL_DEF_MAX_TEXTURE_NUM];
@@ -188,8 +299,12 @@ typedef struct ResourceMaterialObject
 
 } *ResourceMaterial;
 
+typedef ResourceHandle<ResourceMaterialObject> ResourceMaterialHandle;
+
 typedef struct ResourceStaticMeshObject
 {
+		std::atomic<bool> dataLoaded; // Set once every mesh LOD is loaded
+		ResourceHandle<ResourceStaticMeshObject> handle;
 		std::string defUniqueName;
 
 		/*
@@ -202,6 +317,8 @@ typedef struct ResourceStaticMeshObject
 
 } *ResourceStaticMesh;
 
+typedef ResourceHandle<ResourceStaticMeshObject> ResourceStaticMeshHandle;
+
 /*
  * The definition for a material. It includes it's unique name, all of the
  * constituent textures, it's material properties, etc.
@@ -299,6 +416,18 @@ typedef struct ResourceStaticMeshDefinition
 		// The list of max LOD dists for each LOD, not necessarily sorted
 		std::vector<float> meshLODMaxDists;
 
+		/*
+		 * Automatic LOD generation. If generatedLODCount is more than 0, then addMeshDef() simplifies that many extra
+		 * LODs from the farthest LOD above, and appends them to the lists. The farthest LOD's range gets split up between
+		 * it and the generated LODs, so the last generated LOD ends up with the old max dist. Any of these left at 0 get
+		 * the default in the comment. The generated meshes are cooked to disk the first time they're loaded (see
+		 * ResourceManager::getGeneratedLODMeshName()), so only the first load pays for the simplification.
+		 */
+		uint32_t generatedLODCount;
+		float generatedLODTriangleRatio; // The ratio of triangles each generated LOD keeps from the one before it, default 0.5
+		float generatedLODMaxError;      // The max error of the first generated LOD, relative to the mesh's size, default 0.01
+		float generatedLODDistRatio;     // The ratio of each LOD's max dist to the next one's, default 0.5
+
 } StaticMeshDef;
 
 typedef struct ResourceLevelDefinition
@@ -308,12 +437,113 @@ typedef struct ResourceLevelDefinition
 		
 } LevelDef;
 
+#define COOKED_GAME_DEFS_MAGIC_NUM 0x46454453 // "SDEF" in little endian
+#define COOKED_GAME_DEFS_VERSION 2
+#define COOKED_GAME_DEFS_EXTENSION ".sdefs"
+#define COOKED_GAME_DEFS_ALIGNMENT 16
+
+/*
+ * The header at the start of a cooked game defs file, made by ResourceManager::cookGameDefsFile(). The rest of the file is
+ * one array for each type of def, then the LOD list that the static mesh defs index into, then a string table of null
+ * terminated strings (only the LOD files & mesh names live there, everything else is already fixed size). Each array starts
+ * on a COOKED_GAME_DEFS_ALIGNMENT boundary. Level defs are stored as is, material & pipeline defs have their own cooked structs
+ * w/ the bools & enums stored as fixed size integers. The sizes of those structs are stored too, and a file cooked by a build
+ * where they differ is rejected instead of being misread.
+ */
+typedef struct CookedGameDefsHeader
+{
+		uint32_t magic;
+		uint32_t version;
+		uint32_t materialDefSize;
+		uint32_t pipelineDefSize;
+		uint32_t levelDefSize;
+		uint32_t materialDefCount;
+		uint32_t pipelineDefCount;
+		uint32_t meshDefCount;
+		uint32_t meshLODCount;
+		uint32_t levelDefCount;
+		uint32_t stringTableSize;
+		uint32_t padding;
+		uint64_t materialDefsOffset;
+		uint64_t pipelineDefsOffset;
+		uint64_t meshDefsOffset;
+		uint64_t meshLODsOffset;
+		uint64_t levelDefsOffset;
+		uint64_t stringTableOffset;
+} CookedGameDefsHeader;
+
+typedef struct CookedGameDefsMaterialDef
+{
+		char uniqueName[RESOURCE_DEF_MAX_NAME_LENGTH];
+		char textureFiles[MATERIAL_DEF_MAX_TEXTURE_NUM][RESOURCE_DEF_MAX_FILE_LENGTH];
+		char pipelineUniqueName[RESOURCE_DEF_MAX_NAME_LENGTH];
+		uint32_t addressMode;
+		uint8_t enableAnisotropy;
+		uint8_t linearFiltering;
+		uint8_t linearMipmapFiltering;
+		uint8_t padding;
+} CookedGameDefsMaterialDef;
+
+typedef struct CookedGameDefsPipelineDef
+{
+		char uniqueName[RESOURCE_DEF_MAX_NAME_LENGTH];
+		char vertexShaderFile[RESOURCE_DEF_MAX_FILE_LENGTH];
+		char tessControlShaderFile[RESOURCE_DEF_MAX_FILE_LENGTH];
+		char tessEvalShaderFile[RESOURCE_DEF_MAX_FILE_LENGTH];
+		char geometryShaderFile[RESOURCE_DEF_MAX_FILE_LENGTH];
+		char fragmentShaderFile[RESOURCE_DEF_MAX_FILE_LENGTH];
+		char shadows_fragmentShaderFile[RESOURCE_DEF_MAX_FILE_LENGTH];
+		uint8_t clockwiseFrontFace;
+		uint8_t backfaceCulling;
+		uint8_t frontfaceCullilng;
+		uint8_t canRenderDepth;
+} CookedGameDefsPipelineDef;
+
+typedef struct CookedGameDefsMeshDef
+{
+		char uniqueName[RESOURCE_DEF_MAX_NAME_LENGTH];
+		uint32_t firstLOD; // Index of this def's first LOD in the LOD list
+		uint32_t lodCount;
+		uint32_t generatedLODCount;
+		float generatedLODTriangleRatio;
+		float generatedLODMaxError;
+		float generatedLODDistRatio;
+} CookedGameDefsMeshDef;
+
+typedef struct CookedGameDefsMeshLOD
+{
+		uint32_t fileOffset; // Offset of the file name in the string table
+		uint32_t meshOffset; // Offset of the mesh name in the string table
+		float maxDist;
+} CookedGameDefsMeshLOD;
+
 #define DDS_MAGIC_NUM 0x20534444
 
 #ifndef DDPF_FOURCC
 #define DDPF_FOURCC 0x4
 #endif
 
+#ifndef MAKEFOURCC
+#define MAKEFOURCC(ch0, ch1, ch2, ch3)                              \
+                ((uint32_t)(uint8_t)(ch0) | ((uint32_t)(uint8_t)(ch1) << 8) |       \
+                ((uint32_t)(uint8_t)(ch2) << 16) | ((uint32_t)(uint8_t)(ch3) << 24 ))
+#endif /* defined(MAKEFOURCC) */
+
+#ifndef DDSD_CAPS
+#define DDSD_CAPS 0x1
+#define DDSD_HEIGHT 0x2
+#define DDSD_WIDTH 0x4
+#define DDSD_PIXELFORMAT 0x1000
+#define DDSD_MIPMAPCOUNT 0x20000
+#define DDSD_LINEARSIZE 0x80000
+#endif
+
+#ifndef DDSCAPS_TEXTURE
+#define DDSCAPS_COMPLEX 0x8
+#define DDSCAPS_TEXTURE 0x1000
+#define DDSCAPS_MIPMAP 0x400000
+#endif
+
 typedef struct
 {
 	uint32_t dwSize;
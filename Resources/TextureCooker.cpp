@@ -0,0 +1,650 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2017 David Allen
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * TextureCooker.cpp
+ */
+
+#include "Resources/TextureCooker.h"
+
+// The interpolation weights for 4-bit BC7 indices, out of 64
+const uint32_t BC7_INDEX_WEIGHTS_4BIT[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+/*
+ * Finds the two ends of the line that best fits a set of points (of 3 or 4 components), by projecting the points onto
+ * their principal axis. The axis is found w/ a few rounds of power iteration on the covariance matrix, which is plenty for 16 points.
+ */
+inline void getPrincipalAxisEndpoints (const float *points, uint32_t pointCount, uint32_t components, float *endpoint0, float *endpoint1)
+{
+	float mean[4] = {0, 0, 0, 0}, covariance[4][4] = {}, axis[4] = {0, 0, 0, 0};
+	float minPoint[4] = {255, 255, 255, 255}, maxPoint[4] = {0, 0, 0, 0};
+
+	for (uint32_t p = 0; p < pointCount; p ++)
+	{
+		for (uint32_t c = 0; c < components; c ++)
+		{
+			mean[c] += points[p * components + c] / float(pointCount);
+			minPoint[c] = std::min(minPoint[c], points[p * components + c]);
+			maxPoint[c] = std::max(maxPoint[c], points[p * components + c]);
+		}
+	}
+
+	for (uint32_t p = 0; p < pointCount; p ++)
+		for (uint32_t i = 0; i < components; i ++)
+			for (uint32_t j = 0; j < components; j ++)
+				covariance[i][j] += (points[p * components + i] - mean[i]) * (points[p * components + j] - mean[j]);
+
+	// Start from the diagonal of the bounding box, it's usually pretty close already
+	for (uint32_t c = 0; c < components; c ++)
+		axis[c] = maxPoint[c] - minPoint[c];
+
+	for (uint32_t iteration = 0; iteration < 8; iteration ++)
+	{
+		float newAxis[4] = {0, 0, 0, 0}, length = 0.0f;
+
+		for (uint32_t i = 0; i < components; i ++)
+		{
+			for (uint32_t j = 0; j < components; j ++)
+				newAxis[i] += covariance[i][j] * axis[j];
+
+			length += newAxis[i] * newAxis[i];
+		}
+
+		if (length < 1e-12f)
+			break;
+
+		for (uint32_t c = 0; c < components; c ++)
+			axis[c] = newAxis[c] / std::sqrt(length);
+	}
+
+	float axisLength = 0.0f;
+
+	for (uint32_t c = 0; c < components; c ++)
+		axisLength += axis[c] * axis[c];
+
+	// Every point is the same
+	if (axisLength < 1e-12f)
+	{
+		for (uint32_t c = 0; c < components; c ++)
+			endpoint0[c] = endpoint1[c] = mean[c];
+
+		return;
+	}
+
+	for (uint32_t c = 0; c < components; c ++)
+		axis[c] /= std::sqrt(axisLength);
+
+	float minT = std::numeric_limits<float>::max(), maxT = -std::numeric_limits<float>::max();
+
+	for (uint32_t p = 0; p < pointCount; p ++)
+	{
+		float t = 0.0f;
+
+		for (uint32_t c = 0; c < components; c ++)
+			t += (points[p * components + c] - mean[c]) * axis[c];
+
+		minT = std::min(minT, t);
+		maxT = std::max(maxT, t);
+	}
+
+	for (uint32_t c = 0; c < components; c ++)
+	{
+		endpoint0[c] = std::max(0.0f, std::min(255.0f, mean[c] + axis[c] * maxT));
+		endpoint1[c] = std::max(0.0f, std::min(255.0f, mean[c] + axis[c] * minT));
+	}
+}
+
+inline uint16_t packRGB565 (const float *color)
+{
+	uint32_t r = uint32_t(color[0] * 31.0f / 255.0f + 0.5f);
+	uint32_t g = uint32_t(color[1] * 63.0f / 255.0f + 0.5f);
+	uint32_t b = uint32_t(color[2] * 31.0f / 255.0f + 0.5f);
+
+	return uint16_t((r << 11) | (g << 5) | b);
+}
+
+inline void unpackRGB565 (uint16_t packed, float *color)
+{
+	uint32_t r = (packed >> 11) & 31, g = (packed >> 5) & 63, b = packed & 31;
+
+	color[0] = float((r << 3) | (r >> 2));
+	color[1] = float((g << 2) | (g >> 4));
+	color[2] = float((b << 3) | (b >> 2));
+}
+
+inline void writeBlockBits (uint8_t *block, uint32_t &bitOffset, uint32_t value, uint32_t bitCount)
+{
+	for (uint32_t b = 0; b < bitCount; b ++, bitOffset ++)
+		if ((value >> b) & 1)
+			block[bitOffset >> 3] |= uint8_t(1 << (bitOffset & 7));
+}
+
+/*
+ * Compresses a 4x4 block of RGBA8 pixels into a BC1 block (alpha is ignored). Always uses the 4 color mode, so
+ * the same block works as the color half of a BC3 block.
+ */
+void TextureCooker::compressBC1Block (const uint8_t *rgba, uint8_t *block)
+{
+	float colors[16 * 3];
+
+	for (uint32_t i = 0; i < 16; i ++)
+		for (uint32_t c = 0; c < 3; c ++)
+			colors[i * 3 + c] = rgba[i * 4 + c];
+
+	float endpoint0[3], endpoint1[3];
+	getPrincipalAxisEndpoints(colors, 16, 3, endpoint0, endpoint1);
+
+	uint16_t color0 = packRGB565(endpoint0), color1 = packRGB565(endpoint1);
+	uint32_t indices = 0;
+
+	// color0 > color1 means the 4 color mode
+	if (color0 < color1)
+		std::swap(color0, color1);
+
+	if (color0 != color1)
+	{
+		float palette[4][3];
+		unpackRGB565(color0, palette[0]);
+		unpackRGB565(color1, palette[1]);
+
+		for (uint32_t c = 0; c < 3; c ++)
+		{
+			palette[2][c] = (2.0f * palette[0][c] + palette[1][c]) / 3.0f;
+			palette[3][c] = (palette[0][c] + 2.0f * palette[1][c]) / 3.0f;
+		}
+
+		for (uint32_t i = 0; i < 16; i ++)
+		{
+			uint32_t bestIndex = 0;
+			float bestError = std::numeric_limits<float>::max();
+
+			for (uint32_t p = 0; p < 4; p ++)
+			{
+				float error = 0.0f;
+
+				for (uint32_t c = 0; c < 3; c ++)
+					error += (colors[i * 3 + c] - palette[p][c]) * (colors[i * 3 + c] - palette[p][c]);
+
+				if (error < bestError)
+				{
+					bestError = error;
+					bestIndex = p;
+				}
+			}
+
+			indices |= bestIndex << (i * 2);
+		}
+	}
+
+	block[0] = uint8_t(color0 & 0xFF);
+	block[1] = uint8_t(color0 >> 8);
+	block[2] = uint8_t(color1 & 0xFF);
+	block[3] = uint8_t(color1 >> 8);
+	memcpy(block + 4, &indices, sizeof(indices));
+}
+
+/*
+ * BC3 is a BC4 block for alpha followed by a BC1 block for color.
+ */
+void TextureCooker::compressBC3Block (const uint8_t *rgba, uint8_t *block)
+{
+	compressBC4Block(rgba, 3, block);
+	compressBC1Block(rgba, block + 8);
+}
+
+/*
+ * Compresses one channel of a 4x4 block of RGBA8 pixels into a BC4 block, always in the 8 value mode.
+ */
+void TextureCooker::compressBC4Block (const uint8_t *rgba, uint32_t channel, uint8_t *block)
+{
+	uint8_t minValue = 255, maxValue = 0;
+
+	for (uint32_t i = 0; i < 16; i ++)
+	{
+		minValue = std::min(minValue, rgba[i * 4 + channel]);
+		maxValue = std::max(maxValue, rgba[i * 4 + channel]);
+	}
+
+	uint64_t indices = 0;
+
+	if (maxValue > minValue)
+	{
+		float palette[8];
+		palette[0] = maxValue;
+		palette[1] = minValue;
+
+		for (uint32_t p = 2; p < 8; p ++)
+			palette[p] = (float(8 - p) * maxValue + float(p - 1) * minValue) / 7.0f;
+
+		for (uint32_t i = 0; i < 16; i ++)
+		{
+			uint32_t bestIndex = 0;
+			float bestError = std::numeric_limits<float>::max();
+
+			for (uint32_t p = 0; p < 8; p ++)
+			{
+				float error = std::abs(float(rgba[i * 4 + channel]) - palette[p]);
+
+				if (error < bestError)
+				{
+					bestError = error;
+					bestIndex = p;
+				}
+			}
+
+			indices |= uint64_t(bestIndex) << (i * 3);
+		}
+	}
+
+	block[0] = maxValue;
+	block[1] = minValue;
+
+	for (uint32_t b = 0; b < 6; b ++)
+		block[2 + b] = uint8_t((indices >> (b * 8)) & 0xFF);
+}
+
+/*
+ * BC5 is just two BC4 blocks, one for red and one for green.
+ */
+void TextureCooker::compressBC5Block (const uint8_t *rgba, uint8_t *block)
+{
+	compressBC4Block(rgba, 0, block);
+	compressBC4Block(rgba, 1, block + 8);
+}
+
+/*
+ * Compresses a 4x4 block of RGBA8 pixels into a BC7 block. Only mode 6 is used (a single subset w/ RGBA endpoints and
+ * 4-bit indices), which handles the smooth color & alpha gradients most of our textures have well, and is a lot simpler &
+ * faster than searching every mode & partition. It's still quite a bit better than BC1/BC3, mostly because of the 16 levels.
+ */
+void TextureCooker::compressBC7Block (const uint8_t *rgba, uint8_t *block)
+{
+	float pixels[16 * 4];
+
+	for (uint32_t i = 0; i < 16 * 4; i ++)
+		pixels[i] = rgba[i];
+
+	float endpointsF[2][4];
+	getPrincipalAxisEndpoints(pixels, 16, 4, endpointsF[0], endpointsF[1]);
+
+	// Each endpoint is 7 bits per channel plus a "p-bit" shared by all of it's channels, pick the p-bit w/ the least error
+	uint32_t endpoints[2][4], pBits[2];
+
+	for (uint32_t e = 0; e < 2; e ++)
+	{
+		float bestError = std::numeric_limits<float>::max();
+
+		for (uint32_t p = 0; p < 2; p ++)
+		{
+			uint32_t quantized[4];
+			float error = 0.0f;
+
+			for (uint32_t c = 0; c < 4; c ++)
+			{
+				quantized[c] = uint32_t(std::max(0.0f, std::min(127.0f, std::floor((endpointsF[e][c] - float(p)) / 2.0f + 0.5f))));
+
+				float value = float((quantized[c] << 1) | p);
+				error += (value - endpointsF[e][c]) * (value - endpointsF[e][c]);
+			}
+
+			if (error < bestError)
+			{
+				bestError = error;
+				pBits[e] = p;
+				memcpy(endpoints[e], quantized, sizeof(quantized));
+			}
+		}
+	}
+
+	uint32_t indices[16];
+	float palette[16][4];
+
+	for (uint32_t p = 0; p < 16; p ++)
+	{
+		for (uint32_t c = 0; c < 4; c ++)
+		{
+			uint32_t value0 = (endpoints[0][c] << 1) | pBits[0];
+			uint32_t value1 = (endpoints[1][c] << 1) | pBits[1];
+
+			palette[p][c] = float(((64 - BC7_INDEX_WEIGHTS_4BIT[p]) * value0 + BC7_INDEX_WEIGHTS_4BIT[p] * value1 + 32) >> 6);
+		}
+	}
+
+	for (uint32_t i = 0; i < 16; i ++)
+	{
+		float bestError = std::numeric_limits<float>::max();
+
+		for (uint32_t p = 0; p < 16; p ++)
+		{
+			float error = 0.0f;
+
+			for (uint32_t c = 0; c < 4; c ++)
+				error += (pixels[i * 4 + c] - palette[p][c]) * (pixels[i * 4 + c] - palette[p][c]);
+
+			if (error < bestError)
+			{
+				bestError = error;
+				indices[i] = p;
+			}
+		}
+	}
+
+	// The first pixel's index has an implied 0 top bit, so if it's set we flip the endpoints (and indices) around
+	if (indices[0] & 8)
+	{
+		std::swap(endpoints[0], endpoints[1]);
+		std::swap(pBits[0], pBits[1]);
+
+		for (uint32_t i = 0; i < 16; i ++)
+			indices[i] = 15 - indices[i];
+	}
+
+	memset(block, 0, 16);
+	uint32_t bitOffset = 0;
+
+	writeBlockBits(block, bitOffset, 1 << 6, 7); // Mode 6
+
+	for (uint32_t c = 0; c < 4; c ++)
+	{
+		writeBlockBits(block, bitOffset, endpoints[0][c], 7);
+		writeBlockBits(block, bitOffset, endpoints[1][c], 7);
+	}
+
+	writeBlockBits(block, bitOffset, pBits[0], 1);
+	writeBlockBits(block, bitOffset, pBits[1], 1);
+
+	for (uint32_t i = 0; i < 16; i ++)
+		writeBlockBits(block, bitOffset, indices[i], i == 0 ? 3 : 4);
+}
+
+inline float srgbToLinear (float value)
+{
+	return value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+}
+
+inline float linearToSRGB (float value)
+{
+	return value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+}
+
+/*
+ * Builds the full mip chain (down to 1x1) for an RGBA8 image w/ a 2x2 box filter. Albedo is filtered in linear space so
+ * the mips don't get darker, and normals are renormalized so they don't get shorter.
+ */
+inline std::vector<std::vector<uint8_t> > generateMipChain (const std::vector<uint8_t> &image, uint32_t width, uint32_t height, TextureCookUsage usage)
+{
+	std::vector<std::vector<uint8_t> > mipChain = {image};
+
+	float srgbToLinearTable[256];
+
+	for (uint32_t i = 0; i < 256; i ++)
+		srgbToLinearTable[i] = srgbToLinear(i / 255.0f);
+
+	while (width > 1 || height > 1)
+	{
+		const std::vector<uint8_t> &src = mipChain.back();
+		uint32_t mipWidth = std::max(width / 2, 1u), mipHeight = std::max(height / 2, 1u);
+		std::vector<uint8_t> mip(mipWidth * mipHeight * 4);
+
+		for (uint32_t y = 0; y < mipHeight; y ++)
+		{
+			for (uint32_t x = 0; x < mipWidth; x ++)
+			{
+				const uint8_t *srcPixels[4] = {
+						&src[((y * 2) * width + (x * 2)) * 4],
+						&src[((y * 2) * width + std::min(x * 2 + 1, width - 1)) * 4],
+						&src[(std::min(y * 2 + 1, height - 1) * width + (x * 2)) * 4],
+						&src[(std::min(y * 2 + 1, height - 1) * width + std::min(x * 2 + 1, width - 1)) * 4]
+				};
+
+				uint8_t *dst = &mip[(y * mipWidth + x) * 4];
+				float sum[4] = {0, 0, 0, 0};
+
+				for (uint32_t p = 0; p < 4; p ++)
+				{
+					for (uint32_t c = 0; c < 3; c ++)
+					{
+						if (usage == TEXTURE_COOK_USAGE_ALBEDO)
+							sum[c] += srgbToLinearTable[srcPixels[p][c]];
+						else if (usage == TEXTURE_COOK_USAGE_NORMAL)
+							sum[c] += srcPixels[p][c] / 127.5f - 1.0f;
+						else
+							sum[c] += srcPixels[p][c] / 255.0f;
+					}
+
+					sum[3] += srcPixels[p][3] / 255.0f;
+				}
+
+				if (usage == TEXTURE_COOK_USAGE_NORMAL)
+				{
+					float length = std::sqrt(sum[0] * sum[0] + sum[1] * sum[1] + sum[2] * sum[2]);
+
+					for (uint32_t c = 0; c < 3; c ++)
+						sum[c] = length > 0.0f ? (sum[c] / length) * 0.5f + 0.5f : 0.5f;
+				}
+				else
+				{
+					for (uint32_t c = 0; c < 3; c ++)
+						sum[c] = usage == TEXTURE_COOK_USAGE_ALBEDO ? linearToSRGB(sum[c] / 4.0f) : sum[c] / 4.0f;
+				}
+
+				sum[3] /= 4.0f;
+
+				for (uint32_t c = 0; c < 4; c ++)
+					dst[c] = uint8_t(std::max(0.0f, std::min(255.0f, sum[c] * 255.0f + 0.5f)));
+			}
+		}
+
+		mipChain.push_back(std::move(mip));
+		width = mipWidth;
+		height = mipHeight;
+	}
+
+	return mipChain;
+}
+
+/*
+ * Compresses a whole mip level, block by block. Blocks that hang off the edge of the image repeat the edge pixels.
+ */
+inline void compressMipLevel (const std::vector<uint8_t> &mip, uint32_t width, uint32_t height, ResourceFormat format, std::vector<char> &output)
+{
+	const size_t blockSize = (format == RESOURCE_FORMAT_BC1_RGBA_UNORM_BLOCK || format == RESOURCE_FORMAT_BC4_UNORM_BLOCK) ? 8 : 16;
+	const uint32_t blocksX = (width + 3) / 4, blocksY = (height + 3) / 4;
+
+	size_t outputOffset = output.size();
+	output.resize(output.size() + blocksX * blocksY * blockSize);
+
+	uint8_t blockPixels[16 * 4];
+
+	for (uint32_t by = 0; by < blocksY; by ++)
+	{
+		for (uint32_t bx = 0; bx < blocksX; bx ++)
+		{
+			for (uint32_t py = 0; py < 4; py ++)
+				for (uint32_t px = 0; px < 4; px ++)
+					memcpy(&blockPixels[(py * 4 + px) * 4], &mip[(std::min(by * 4 + py, height - 1) * width + std::min(bx * 4 + px, width - 1)) * 4], 4);
+
+			uint8_t *block = reinterpret_cast<uint8_t*>(&output[outputOffset]);
+
+			switch (format)
+			{
+				case RESOURCE_FORMAT_BC1_RGBA_UNORM_BLOCK:
+					TextureCooker::compressBC1Block(blockPixels, block);
+					break;
+				case RESOURCE_FORMAT_BC3_UNORM_BLOCK:
+					TextureCooker::compressBC3Block(blockPixels, block);
+					break;
+				case RESOURCE_FORMAT_BC4_UNORM_BLOCK:
+					TextureCooker::compressBC4Block(blockPixels, 0, block);
+					break;
+				case RESOURCE_FORMAT_BC5_UNORM_BLOCK:
+					TextureCooker::compressBC5Block(blockPixels, block);
+					break;
+				case RESOURCE_FORMAT_BC7_UNORM_BLOCK:
+					TextureCooker::compressBC7Block(blockPixels, block);
+					break;
+				default:
+					break;
+			}
+
+			outputOffset += blockSize;
+		}
+	}
+}
+
+/*
+ * Cooks a PNG texture into a DDS file next to it in the working directory (see getCookedTextureFile()), w/ a full mip
+ * chain and in the block compression format for "usage". Albedo & masks are kept in UNORM formats, same as the PNGs are
+ * loaded in, so cooked & uncooked textures look the same. Returns false if the texture couldn't be cooked.
+ */
+bool TextureCooker::cookTextureFile (const std::string &file, TextureCookUsage usage, bool highQuality)
+{
+	FileView pngData = FileLoader::instance()->openFileView(file);
+
+	if (pngData.size() == 0)
+	{
+		printf("%s Failed to cook texture: %s, file couldn't be read\n", ERR_PREFIX, file.c_str());
+
+		return false;
+	}
+
+	std::vector<uint8_t> image;
+	uint32_t width, height;
+
+	unsigned err = lodepng::decode(image, width, height, reinterpret_cast<const unsigned char*>(pngData.data()), pngData.size(), LCT_RGBA, 8);
+
+	if (err)
+	{
+		printf("%s Failed to cook texture: %s, lodepng returned: %u\n", ERR_PREFIX, file.c_str(), err);
+
+		return false;
+	}
+
+	bool hasAlpha = false, isGreyscale = true;
+
+	for (size_t p = 0; p < image.size(); p += 4)
+	{
+		hasAlpha = hasAlpha || image[p + 3] != 255;
+		isGreyscale = isGreyscale && image[p + 0] == image[p + 1] && image[p + 0] == image[p + 2];
+	}
+
+	ResourceFormat format;
+	uint32_t dxgiFormat;
+
+	switch (usage)
+	{
+		case TEXTURE_COOK_USAGE_NORMAL:
+			format = RESOURCE_FORMAT_BC5_UNORM_BLOCK;
+			dxgiFormat = 83; // BC5_UNORM
+			break;
+		case TEXTURE_COOK_USAGE_MASK:
+			format = (isGreyscale && !hasAlpha) ? RESOURCE_FORMAT_BC4_UNORM_BLOCK : RESOURCE_FORMAT_BC7_UNORM_BLOCK;
+			dxgiFormat = (isGreyscale && !hasAlpha) ? 80 : 98; // BC4_UNORM or BC7_UNORM
+			break;
+		case TEXTURE_COOK_USAGE_ALBEDO:
+		default:
+			format = highQuality ? RESOURCE_FORMAT_BC7_UNORM_BLOCK : (hasAlpha ? RESOURCE_FORMAT_BC3_UNORM_BLOCK : RESOURCE_FORMAT_BC1_RGBA_UNORM_BLOCK);
+			dxgiFormat = highQuality ? 98 : (hasAlpha ? 77 : 71); // BC7_UNORM, BC3_UNORM or BC1_UNORM
+			break;
+	}
+
+	std::vector<std::vector<uint8_t> > mipChain = generateMipChain(image, width, height, usage);
+
+	std::vector<char> ddsData(sizeof(uint32_t) + sizeof(DDSHeader) + sizeof(DDSHeaderDXT10));
+
+	for (size_t m = 0; m < mipChain.size(); m ++)
+		compressMipLevel(mipChain[m], std::max(width >> m, 1u), std::max(height >> m, 1u), format, ddsData);
+
+	uint32_t magicNum = DDS_MAGIC_NUM;
+
+	DDSHeader header = {};
+	header.dwSize = sizeof(DDSHeader);
+	header.dwFlags = DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PIXELFORMAT | DDSD_MIPMAPCOUNT | DDSD_LINEARSIZE;
+	header.dwHeight = height;
+	header.dwWidth = width;
+	header.dwPitchOrLinearSize = ((width + 3) / 4) * ((height + 3) / 4) * (format == RESOURCE_FORMAT_BC1_RGBA_UNORM_BLOCK || format == RESOURCE_FORMAT_BC4_UNORM_BLOCK ? 8 : 16);
+	header.dwMipMapCount = (uint32_t) mipChain.size();
+	header.ddspf.dwSize = sizeof(DDSPixelFormat);
+	header.ddspf.dwFlags = DDPF_FOURCC;
+	header.ddspf.dwFourCC = MAKEFOURCC('D', 'X', '1', '0');
+	header.dwCaps = DDSCAPS_TEXTURE | DDSCAPS_COMPLEX | DDSCAPS_MIPMAP;
+
+	DDSHeaderDXT10 header10 = {};
+	header10.dxgiFormat = dxgiFormat;
+	header10.resourceDimension = 3; // D3D10_RESOURCE_DIMENSION_TEXTURE2D
+	header10.arraySize = 1;
+
+	memcpy(&ddsData[0], &magicNum, sizeof(uint32_t));
+	memcpy(&ddsData[sizeof(uint32_t)], &header, sizeof(DDSHeader));
+	memcpy(&ddsData[sizeof(uint32_t) + sizeof(DDSHeader)], &header10, sizeof(DDSHeaderDXT10));
+
+	std::string cookedFile = FileLoader::instance()->getWorkingDir() + getCookedTextureFile(file);
+
+#ifdef _WIN32
+	std::ofstream out(utf8_to_utf16(cookedFile).c_str(), std::ios::out | std::ios::binary);
+#else
+	std::ofstream out(cookedFile, std::ios::out | std::ios::binary);
+#endif
+
+	if (!out.is_open())
+	{
+		printf("%s Failed to open file: %s for writing\n", ERR_PREFIX, cookedFile.c_str());
+
+		return false;
+	}
+
+	out.write(ddsData.data(), ddsData.size());
+	out.close();
+
+	printf("%s Cooked texture: %s (%ux%u, %u mips, %zu bytes -> %zu bytes)\n", INFO_PREFIX, file.c_str(), width, height, (uint32_t) mipChain.size(), image.size(), ddsData.size());
+
+	return true;
+}
+
+/*
+ * Guesses what a texture is used for from it's file name, e.g. "GameData/textures/dirt/dirt-normals.png" is a normal map.
+ * Anything that doesn't look like a normal map or a mask is treated as albedo.
+ */
+TextureCookUsage TextureCooker::getTextureUsageFromName (const std::string &file)
+{
+	std::string name = file.substr(file.find_last_of("/\\") == std::string::npos ? 0 : file.find_last_of("/\\") + 1);
+	std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+
+	if (name.find("normal") != std::string::npos)
+		return TEXTURE_COOK_USAGE_NORMAL;
+
+	const char *maskNames[] = {"rough", "metal", "gloss", "spec", "height", "mask", "-ao.", "_ao."};
+
+	for (size_t i = 0; i < sizeof(maskNames) / sizeof(maskNames[0]); i ++)
+		if (name.find(maskNames[i]) != std::string::npos)
+			return TEXTURE_COOK_USAGE_MASK;
+
+	return TEXTURE_COOK_USAGE_ALBEDO;
+}
+
+/*
+ * Gets the name of the cooked version of a texture, e.g. "GameData/textures/blah.png" turns into "GameData/textures/blah.png.dds".
+ */
+std::string TextureCooker::getCookedTextureFile (const std::string &file)
+{
+	return file + COOKED_TEXTURE_EXTENSION;
+}
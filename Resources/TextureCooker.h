@@ -0,0 +1,68 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2017 David Allen
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * TextureCooker.h
+ */
+
+#ifndef RESOURCES_TEXTURECOOKER_H_
+#define RESOURCES_TEXTURECOOKER_H_
+
+#include <common.h>
+#include <Resources/Resources.h>
+
+#define COOKED_TEXTURE_EXTENSION ".dds"
+
+/*
+ * What a texture is used for, which decides the block compression format it's cooked to.
+ */
+typedef enum TextureCookUsage
+{
+	TEXTURE_COOK_USAGE_ALBEDO = 0, // BC1, or BC3 if it has alpha (BC7 for either if cooked w/ high quality)
+	TEXTURE_COOK_USAGE_NORMAL,     // BC5, only x & y are kept, the shaders rebuild z
+	TEXTURE_COOK_USAGE_MASK,       // BC4 for single channel masks (roughness, ao, etc), BC7 for packed ones
+	TEXTURE_COOK_USAGE_MAX_ENUM
+} TextureCookUsage;
+
+/*
+ * Cooks PNG textures offline into DDS files w/ a full mip chain and block compression. Nothing in here touches the renderer,
+ * so it runs fine on a headless box. ResourceManager loads the cooked version of a PNG instead of the PNG itself whenever
+ * there is one (see getCookedTextureFile()), so the load is just a single copy w/ no decoding or mip generation. Note that
+ * cooked textures aren't checked against their source, so they have to be re-cooked whenever it changes.
+ */
+class TextureCooker
+{
+	public:
+
+		static bool cookTextureFile (const std::string &file, TextureCookUsage usage, bool highQuality = false);
+
+		static TextureCookUsage getTextureUsageFromName (const std::string &file);
+		static std::string getCookedTextureFile (const std::string &file);
+
+		static void compressBC1Block (const uint8_t *rgba, uint8_t *block);
+		static void compressBC3Block (const uint8_t *rgba, uint8_t *block);
+		static void compressBC4Block (const uint8_t *rgba, uint32_t channel, uint8_t *block);
+		static void compressBC5Block (const uint8_t *rgba, uint8_t *block);
+		static void compressBC7Block (const uint8_t *rgba, uint8_t *block);
+};
+
+#endif /* RESOURCES_TEXTURECOOKER_H_ */
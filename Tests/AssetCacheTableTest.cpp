@@ -0,0 +1,317 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2017 David Allen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * AssetCacheTableTest.cpp
+ */
+
+/*
+ * Checks AssetCacheTable against std::map w/ random inserts, erases & lookups, checks that AssetIDTable hands out stable
+ * unique ids, and then benchmarks cache lookups per second w/ several threads sharing one locked cache (the same way the
+ * resource manager uses them), against the old std::map keyed on a tuple of strings.
+ *
+ * Standalone, build & run from the repo root w/ the same include paths as the engine:
+ *   g++ -std=c++14 -O2 -I. Tests/AssetCacheTableTest.cpp Resources/AssetID.cpp -o AssetCacheTableTest -lpthread && ./AssetCacheTableTest
+ *
+ * Returns non-zero if any check fails.
+ */
+
+#include <common.h>
+#include <Resources/AssetID.h>
+#include <Resources/AssetCacheTable.h>
+
+#include <random>
+#include <chrono>
+#include <tuple>
+#include <map>
+#include <set>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <atomic>
+
+#define CHECK(x) if (!(x)) { printf("FAILED: \"%s\" @ line %i\n", #x, __LINE__); return false; }
+
+/*
+ * Only uses the low 3 bits of the key, so nearly everything collides. That makes long probe runs that wrap around the end
+ * of the table, which is where the backward shift erase can go wrong.
+ */
+struct BadAssetCacheKeyHash
+{
+		inline uint64_t operator() (uint64_t key) const
+		{
+			return key & 7;
+		}
+};
+
+template<typename KeyHash>
+bool checkAgainstMap (uint32_t seed, uint32_t opCount, uint64_t keyRange)
+{
+	AssetCacheTable<uint64_t, uint64_t, KeyHash> table;
+	std::map<uint64_t, uint64_t> reference;
+	std::mt19937_64 rng(seed);
+
+	for (uint32_t op = 0; op < opCount; op ++)
+	{
+		uint64_t key = rng() % keyRange + 1;
+
+		switch (rng() % 5)
+		{
+			case 0:
+			case 1:
+			{
+				uint64_t value = rng();
+				table[key] = value;
+				reference[key] = value;
+				break;
+			}
+			case 2:
+				CHECK(table.erase(key) == reference.erase(key));
+				break;
+			case 3:
+			{
+				auto it = table.find(key);
+
+				if (it != table.end())
+				{
+					CHECK(reference.count(key) == 1);
+					table.erase(it);
+					reference.erase(key);
+				}
+				else
+					CHECK(reference.count(key) == 0);
+
+				break;
+			}
+			case 4:
+			{
+				auto it = table.find(key);
+				auto refIt = reference.find(key);
+
+				CHECK((it == table.end()) == (refIt == reference.end()));
+
+				if (it != table.end())
+					CHECK(it->first == key && it->second == refIt->second);
+
+				break;
+			}
+		}
+
+		CHECK(table.size() == reference.size());
+		CHECK(table.size() * 10 <= table.capacity() * 7);
+
+		// Every so often make sure every entry is still reachable, and that nothing extra is left over
+		if (op % 997 == 0)
+		{
+			for (auto refIt = reference.begin(); refIt != reference.end(); refIt ++)
+			{
+				auto it = table.find(refIt->first);
+				CHECK(it != table.end() && it->second == refIt->second);
+			}
+
+			size_t visited = 0;
+			bool allInReference = true;
+
+			table.forEach([&](const std::pair<uint64_t, uint64_t> &entry)
+			{
+				visited ++;
+
+				if (reference.count(entry.first) == 0)
+					allInReference = false;
+			});
+
+			CHECK(visited == reference.size() && allInReference);
+		}
+	}
+
+	// Erase everything, the table should end up empty & still usable
+	for (auto refIt = reference.begin(); refIt != reference.end(); refIt ++)
+		CHECK(table.erase(refIt->first) == 1);
+
+	CHECK(table.size() == 0);
+	CHECK(table.find(1) == table.end());
+
+	table[1] = 2;
+	CHECK(table.size() == 1 && table.find(1)->second == 2);
+
+	return true;
+}
+
+bool checkAssetIDs ()
+{
+	const uint32_t nameCount = 100000;
+
+	std::vector<AssetID> ids(nameCount);
+	std::set<AssetID> uniqueIDs;
+
+	for (uint32_t i = 0; i < nameCount; i ++)
+	{
+		std::string name = "GameData/meshes/test_" + toString(i) + ".fbx";
+		ids[i] = AssetIDTable::getAssetID(name);
+
+		CHECK(ids[i] != ASSET_ID_INVALID);
+		CHECK(ids[i] == AssetIDTable::hashAssetName(name));
+		uniqueIDs.insert(ids[i]);
+	}
+
+	CHECK(uniqueIDs.size() == nameCount);
+	CHECK(AssetIDTable::getCollisionCount() == 0);
+
+	// Interning the same names again has to give back the same ids, w/o adding anything
+	size_t internedCount = AssetIDTable::getInternedCount();
+
+	for (uint32_t i = 0; i < nameCount; i ++)
+	{
+		std::string name = "GameData/meshes/test_" + toString(i) + ".fbx";
+
+		CHECK(AssetIDTable::getAssetID(name) == ids[i]);
+		CHECK(AssetIDTable::getAssetName(ids[i]) == name);
+	}
+
+	CHECK(AssetIDTable::getInternedCount() == internedCount);
+
+	return true;
+}
+
+/*
+ * Runs <threadCount> threads that each do <lookupsPerThread> lookups through <lookup>, and returns the total lookups per second.
+ */
+double benchmarkLookups (uint32_t threadCount, uint32_t lookupsPerThread, const std::function<void(uint32_t, uint32_t)> &lookup)
+{
+	std::vector<std::thread> threads;
+	std::atomic<bool> start(false);
+
+	for (uint32_t t = 0; t < threadCount; t ++)
+	{
+		threads.push_back(std::thread([&, t]()
+		{
+			while (!start)
+				std::this_thread::yield();
+
+			for (uint32_t i = 0; i < lookupsPerThread; i ++)
+				lookup(t, i);
+		}));
+	}
+
+	auto startTime = std::chrono::high_resolution_clock::now();
+	start = true;
+
+	for (size_t t = 0; t < threads.size(); t ++)
+		threads[t].join();
+
+	double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - startTime).count();
+
+	return double(threadCount) * lookupsPerThread / seconds;
+}
+
+void benchmarkContendedLookups ()
+{
+	const uint32_t meshCount = 20000;
+	const uint32_t lookupsPerThread = 500000;
+
+	std::vector<std::string> files(meshCount), meshes(meshCount);
+
+	for (uint32_t i = 0; i < meshCount; i ++)
+	{
+		files[i] = "GameData/meshes/level_" + toString(i / 64) + "/props_" + toString(i / 8) + ".fbx";
+		meshes[i] = "Prop_" + toString(i) + "_LOD0";
+	}
+
+	// The old mesh cache key, compared string by string on every lookup
+	std::mutex oldCache_mutex;
+	std::map<std::tuple<std::string, std::string, uint32_t, bool>, uint32_t> oldCache;
+
+	std::mutex newCache_mutex;
+	AssetCacheTable<AssetID, uint32_t> newCache;
+	std::vector<AssetID> newKeys(meshCount);
+
+	for (uint32_t i = 0; i < meshCount; i ++)
+	{
+		oldCache[std::make_tuple(files[i], meshes[i], 0u, true)] = i;
+
+		newKeys[i] = combineAssetCacheKey(combineAssetCacheKey(AssetIDTable::getAssetID(files[i]), AssetIDTable::getAssetID(meshes[i])), 1);
+		newCache[newKeys[i]] = i;
+	}
+
+	uint32_t maxThreads = std::max<uint32_t>(std::thread::hardware_concurrency(), 1);
+	std::atomic<uint64_t> sink(0);
+
+	printf("%-8s %20s %20s %20s\n", "threads", "std::map lookups/s", "interned lookups/s", "table only lookups/s");
+
+	for (uint32_t threadCount = 1; threadCount <= maxThreads; threadCount *= 2)
+	{
+		double oldRate = benchmarkLookups(threadCount, lookupsPerThread, [&](uint32_t t, uint32_t i)
+		{
+			uint32_t m = (i * 2654435761u + t) % meshCount;
+
+			std::unique_lock<std::mutex> lock(oldCache_mutex);
+			sink += oldCache.find(std::make_tuple(files[m], meshes[m], 0u, true))->second;
+		});
+
+		// Interns the names on every lookup like getMeshCacheKey() does, w/ the ids combined the same way as MeshCacheKeyHash
+		double newRate = benchmarkLookups(threadCount, lookupsPerThread, [&](uint32_t t, uint32_t i)
+		{
+			uint32_t m = (i * 2654435761u + t) % meshCount;
+			AssetID key = combineAssetCacheKey(combineAssetCacheKey(AssetIDTable::getAssetID(files[m]), AssetIDTable::getAssetID(meshes[m])), 1);
+
+			std::unique_lock<std::mutex> lock(newCache_mutex);
+			sink += newCache.find(key)->second;
+		});
+
+		double tableRate = benchmarkLookups(threadCount, lookupsPerThread, [&](uint32_t t, uint32_t i)
+		{
+			uint32_t m = (i * 2654435761u + t) % meshCount;
+
+			std::unique_lock<std::mutex> lock(newCache_mutex);
+			sink += newCache.find(newKeys[m])->second;
+		});
+
+		printf("%-8u %20.0f %20.0f %20.0f\n", threadCount, oldRate, newRate, tableRate);
+	}
+
+	printf("(checksum %llu)\n", (unsigned long long) sink.load());
+}
+
+int main (int argc, char **argv)
+{
+	bool passed = true;
+
+	for (uint32_t seed = 1; seed <= 8; seed ++)
+	{
+		passed = checkAgainstMap<AssetCacheKeyHash<uint64_t> >(seed, 200000, 5000) && passed;
+		passed = checkAgainstMap<BadAssetCacheKeyHash>(seed, 20000, 300) && passed;
+	}
+
+	passed = checkAssetIDs() && passed;
+
+	printf("AssetCacheTable & AssetIDTable checks %s\n", passed ? "passed" : "FAILED");
+
+	if (!passed)
+		return 1;
+
+	if (argc > 1 && std::string(argv[1]) == "--no-bench")
+		return 0;
+
+	benchmarkContendedLookups();
+
+	return 0;
+}
@@ -0,0 +1,229 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2017 David Allen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * MeshFormatBenchmark.cpp
+ */
+
+/*
+ * Benchmarks ResourceManager::getFormattedMeshData() on a multi-million vertex mesh, for the interlaced & un-interlaced
+ * layouts, against the old one memcpy per component per vertex loop. The output of both layouts is also checked against
+ * that loop first, so this doubles as a check that the layouts are right.
+ *
+ * Standalone, build & run from the repo root w/ the same include paths & libs as the engine. The gc-sections flags throw
+ * out the parts of the resource manager this doesn't use, so it doesn't have to link the renderer:
+ *   g++ -std=c++14 -O2 -ffunction-sections -fdata-sections -I. Tests/MeshFormatBenchmark.cpp Resources/ResourceManager.cpp -Wl,--gc-sections -o MeshFormatBenchmark -lpthread
+ *   ./MeshFormatBenchmark [vertex_count]
+ *
+ * Returns non-zero if any check fails.
+ */
+
+#include <common.h>
+#include <Resources/ResourceManager.h>
+
+#include <chrono>
+#include <random>
+
+/*
+ * The old interlacing loop, before the bulk copies. Missing components are left as zeros.
+ */
+std::vector<char> formatMeshDataPerVertex (const ResourceMeshData &data, size_t &vertexStride)
+{
+	std::vector<std::pair<const char*, size_t> > components;
+	components.push_back(std::make_pair(reinterpret_cast<const char*>(data.vertices.data()), sizeof(svec3)));
+	components.push_back(std::make_pair(data.uvs.size() > 0 ? reinterpret_cast<const char*>(data.uvs.data()) : nullptr, sizeof(svec2)));
+	components.push_back(std::make_pair(data.normals.size() > 0 ? reinterpret_cast<const char*>(data.normals.data()) : nullptr, sizeof(svec3)));
+	components.push_back(std::make_pair(data.tangents.size() > 0 ? reinterpret_cast<const char*>(data.tangents.data()) : nullptr, sizeof(svec3)));
+
+	size_t indexChunkSize = data.indices_32bit.size() * sizeof(uint32_t);
+	vertexStride = sizeof(svec3) * 3 + sizeof(svec2);
+
+	std::vector<char> meshDataArray(indexChunkSize + vertexStride * data.vertices.size());
+	memcpy(meshDataArray.data(), data.indices_32bit.data(), indexChunkSize);
+
+	char *vertexData = meshDataArray.data() + indexChunkSize;
+	const svec4 zero = {0, 0, 0, 0};
+
+	for (size_t v = 0; v < data.vertices.size(); v ++)
+	{
+		size_t offset = v * vertexStride;
+
+		for (size_t c = 0; c < components.size(); c ++)
+		{
+			memcpy(vertexData + offset, components[c].first != nullptr ? components[c].first + v * components[c].second : reinterpret_cast<const char*>(&zero), components[c].second);
+			offset += components[c].second;
+		}
+	}
+
+	return meshDataArray;
+}
+
+ResourceMeshData makeTestMesh (size_t vertexCount, bool withUVs)
+{
+	ResourceMeshData data = {};
+	data.uses32BitIndices = true;
+	data.faceCount = (uint32_t) (vertexCount / 3);
+
+	std::mt19937 rng(1234);
+	std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+
+	data.vertices.resize(vertexCount);
+	data.normals.resize(vertexCount);
+	data.tangents.resize(vertexCount);
+	data.indices_32bit.resize(data.faceCount * 3);
+
+	if (withUVs)
+		data.uvs.resize(vertexCount);
+
+	for (size_t i = 0; i < vertexCount; i ++)
+	{
+		data.vertices[i] = {dist(rng), dist(rng), dist(rng)};
+		data.normals[i] = {dist(rng), dist(rng), dist(rng)};
+		data.tangents[i] = {dist(rng), dist(rng), dist(rng)};
+
+		if (withUVs)
+			data.uvs[i] = {dist(rng), dist(rng)};
+	}
+
+	for (size_t i = 0; i < data.indices_32bit.size(); i ++)
+		data.indices_32bit[i] = (uint32_t) i;
+
+	return data;
+}
+
+bool checkLayouts (const ResourceMeshData &data)
+{
+	size_t refStride, indexChunkSize, vertexStride;
+	std::vector<char> reference = formatMeshDataPerVertex(data, refStride);
+
+	std::vector<char> interlaced = ResourceManager::getFormattedMeshData(data, MESH_DATA_FORMAT_IVUNT, indexChunkSize, vertexStride, true);
+
+	if (interlaced != reference || vertexStride != refStride || indexChunkSize != data.indices_32bit.size() * sizeof(uint32_t))
+	{
+		printf("FAILED: the interlaced layout doesn't match the per vertex loop\n");
+
+		return false;
+	}
+
+	std::vector<char> uninterlaced = ResourceManager::getFormattedMeshData(data, MESH_DATA_FORMAT_IVUNT, indexChunkSize, vertexStride, false);
+
+	if (uninterlaced.size() != reference.size() || memcmp(uninterlaced.data(), reference.data(), indexChunkSize) != 0)
+	{
+		printf("FAILED: the un-interlaced layout has the wrong size or indices\n");
+
+		return false;
+	}
+
+	// Un-interlaced, every component is one block of all the vertices, in the same order as in an interlaced vertex
+	size_t vertexCount = data.vertices.size();
+	size_t componentSizes[] = {sizeof(svec3), sizeof(svec2), sizeof(svec3), sizeof(svec3)};
+	size_t blockOffset = indexChunkSize, componentOffset = 0;
+
+	for (size_t c = 0; c < 4; c ++)
+	{
+		for (size_t v = 0; v < vertexCount; v ++)
+		{
+			if (memcmp(&uninterlaced[blockOffset + v * componentSizes[c]], &reference[indexChunkSize + v * refStride + componentOffset], componentSizes[c]) != 0)
+			{
+				printf("FAILED: the un-interlaced layout doesn't match the per vertex loop, component %u vertex %u\n", (uint32_t) c, (uint32_t) v);
+
+				return false;
+			}
+		}
+
+		blockOffset += componentSizes[c] * vertexCount;
+		componentOffset += componentSizes[c];
+	}
+
+	return true;
+}
+
+/*
+ * Returns the best time out of a few runs, in milliseconds.
+ */
+double timeFormatting (const std::function<size_t()> &format)
+{
+	double bestTime = 1e30;
+	size_t checksum = 0;
+
+	for (uint32_t run = 0; run < 5; run ++)
+	{
+		auto startTime = std::chrono::high_resolution_clock::now();
+		checksum += format();
+		bestTime = std::min(bestTime, std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count());
+	}
+
+	if (checksum == 0)
+		printf("(empty output)\n");
+
+	return bestTime;
+}
+
+int main (int argc, char **argv)
+{
+	size_t vertexCount = argc > 1 ? (size_t) atoll(argv[1]) : 4 * 1024 * 1024;
+
+	// A small mesh that's missing it's UVs too, so that the zero filled components are covered
+	if (!checkLayouts(makeTestMesh(999, true)) || !checkLayouts(makeTestMesh(999, false)) || !checkLayouts(makeTestMesh(vertexCount, true)))
+		return 1;
+
+	printf("Layout checks passed\n");
+
+	ResourceMeshData data = makeTestMesh(vertexCount, true);
+	double vertexMB = double(vertexCount * (sizeof(svec3) * 3 + sizeof(svec2))) / (1024.0 * 1024.0);
+
+	double perVertexTime = timeFormatting([&]()
+	{
+		size_t stride;
+
+		return formatMeshDataPerVertex(data, stride).size();
+	});
+
+	double interlacedTime = timeFormatting([&]()
+	{
+		size_t indexChunkSize, stride;
+
+		return ResourceManager::getFormattedMeshData(data, MESH_DATA_FORMAT_IVUNT, indexChunkSize, stride, true).size();
+	});
+
+	double uninterlacedTime = timeFormatting([&]()
+	{
+		size_t indexChunkSize, stride;
+
+		return ResourceManager::getFormattedMeshData(data, MESH_DATA_FORMAT_IVUNT, indexChunkSize, stride, false).size();
+	});
+
+	double packedTime = timeFormatting([&]()
+	{
+		size_t indexChunkSize, stride;
+
+		return ResourceManager::getFormattedMeshData(data, MESH_DATA_FORMAT_IVUNT_PACKED, indexChunkSize, stride, true).size();
+	});
+
+	printf("%u vertices (%.1f MB of vertex data), best of 5:\n", (uint32_t) vertexCount, vertexMB);
+	printf("  %-28s %8.2f ms  %8.1f MB/s\n", "per vertex memcpy (old)", perVertexTime, vertexMB / (perVertexTime / 1000.0));
+	printf("  %-28s %8.2f ms  %8.1f MB/s\n", "IVUNT interlaced", interlacedTime, vertexMB / (interlacedTime / 1000.0));
+	printf("  %-28s %8.2f ms  %8.1f MB/s\n", "IVUNT un-interlaced", uninterlacedTime, vertexMB / (uninterlacedTime / 1000.0));
+	printf("  %-28s %8.2f ms  %8.1f MB/s\n", "IVUNT_PACKED interlaced", packedTime, vertexMB / (packedTime / 1000.0));
+
+	return 0;
+}
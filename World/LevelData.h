@@ -32,6 +32,7 @@
 
 #include <common.h>
 #include <World/SortedOctree.h>
+#include <Resources/Resources.h>
 
 /*
  * The data for a static object. Much of the misc data for stuff like
@@ -51,8 +52,16 @@ typedef struct LevelStaticObject
 
 typedef struct LevelStaticObjectType
 {
-		size_t meshDefUniqueNameHash;
-		size_t materialDefUniqueNameHash;
+		AssetID meshDefUniqueNameID;
+		AssetID materialDefUniqueNameID;
+
+		/*
+		 * Handles to the loaded mesh & material, so the renderer doesn't have to look them up by id every frame. These
+		 * are just a cache, they're filled in (or re-resolved if they've gone stale) by the renderer when needed, and
+		 * aren't part of the type's identity.
+		 */
+		ResourceStaticMeshHandle meshHandle;
+		ResourceMaterialHandle materialHandle;
 
 		// x - bounding sphere radius w/o scaling, y - maximum displayed LOD distance, zw - padding
 		svec4 boundingSphereRadius_maxLodDist_padding;
@@ -64,7 +73,7 @@ typedef struct LevelStaticObjectType
 
 		inline bool operator== (const LevelStaticObjectType &arg0)
 		{
-			return arg0.materialDefUniqueNameHash == this->materialDefUniqueNameHash && arg0.meshDefUniqueNameHash == this->meshDefUniqueNameHash &&
+			return arg0.materialDefUniqueNameID == this->materialDefUniqueNameID && arg0.meshDefUniqueNameID == this->meshDefUniqueNameID &&
 					arg0.boundingSphereRadius_maxLodDist_padding.x == this->boundingSphereRadius_maxLodDist_padding.x &&
 					arg0.boundingSphereRadius_maxLodDist_padding.y == this->boundingSphereRadius_maxLodDist_padding.y; // We only compare these two components, as the rest are padding
 		}
@@ -78,7 +87,7 @@ typedef struct LevelStaticObjectType
 
 inline bool operator== (const LevelStaticObjectType &arg0, const LevelStaticObjectType &arg1)
 {
-	return arg0.materialDefUniqueNameHash == arg1.materialDefUniqueNameHash && arg0.meshDefUniqueNameHash == arg1.meshDefUniqueNameHash &&
+	return arg0.materialDefUniqueNameID == arg1.materialDefUniqueNameID && arg0.meshDefUniqueNameID == arg1.meshDefUniqueNameID &&
 			arg0.boundingSphereRadius_maxLodDist_padding.x == arg1.boundingSphereRadius_maxLodDist_padding.x &&
 			arg0.boundingSphereRadius_maxLodDist_padding.y == arg1.boundingSphereRadius_maxLodDist_padding.y; // We only compare these two components, as the rest are padding
 }
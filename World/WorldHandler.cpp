@@ -32,6 +32,7 @@
 #include <Engine/StarlightEngine.h>
 
 #include <World/Physics/WorldPhysics.h>
+#include <World/WorldStreamer.h>
 
 WorldHandler::WorldHandler(StarlightEngine *enginePtr)
 {
@@ -39,6 +40,7 @@ WorldHandler::WorldHandler(StarlightEngine *enginePtr)
 	activeLevel = nullptr;
 	activeLevelData = nullptr;
 	worldPhysics = nullptr;
+	worldStreamer = nullptr;
 	destroyed = false;
 }
 
@@ -52,10 +54,14 @@ void WorldHandler::init()
 {
 	worldPhysics = new WorldPhysics();
 	worldPhysics->init();
+
+	worldStreamer = new WorldStreamer(engine);
 }
 
 void WorldHandler::destroy()
 {
+	delete worldStreamer;
+
 	worldPhysics->destroy();
 	delete worldPhysics;
 
@@ -70,7 +76,7 @@ void WorldHandler::loadLevel(LevelDef *level)
 	
 	// Load the lookup table for the heightmap
 	{
-		std::ifstream file = FileLoader::instance()->openFileStream(FileLoader::instance()->getWorkingDir() + "GameData/levels/TestLevel/heightmap.hmp");
+		std::ifstream file = FileLoader::instance()->openFileStream("GameData/levels/TestLevel/heightmap.hmp");
 		file.seekg(4 + 4);
 
 		file.read(reinterpret_cast<char*> (&lvlDat->heightmapFileCellCount), 4);
@@ -118,6 +124,10 @@ void WorldHandler::unloadLevel(LevelDef *level)
 	DEBUG_ASSERT(loadedLevels.count(level) > 0);
 
 	LevelData *lvlDat = loadedLevels[level];
+
+	// Anything streamed in for the level has to be given back before it's data goes away
+	if (worldStreamer->getStreamedLevel() == lvlDat)
+		worldStreamer->releaseLevel();
 	
 	worldPhysics->destroyPhysicsScene(lvlDat->physSceneID);
 
@@ -172,7 +182,7 @@ std::unique_ptr<uint16_t> WorldHandler::getCellHeightmapMipData(LevelData *lvlDa
 		return std::unique_ptr<uint16_t>(nullptr);
 	}
 
-	std::ifstream file = FileLoader::instance()->openFileStream(FileLoader::instance()->getWorkingDir() + "GameData/levels/TestLevel/heightmap.hmp");
+	std::ifstream file = FileLoader::instance()->openFileStream("GameData/levels/TestLevel/heightmap.hmp");
 
 	size_t fileSize = file.tellg();
 	file.seekg(fileLookupPos + lookupMipOffset);
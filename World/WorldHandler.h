@@ -36,6 +36,7 @@
 
 class StarlightEngine;
 class WorldPhysics;
+class WorldStreamer;
 
 class WorldHandler
 {
@@ -43,6 +44,7 @@ class WorldHandler
 
 		StarlightEngine *engine;
 		WorldPhysics *worldPhysics;
+		WorldStreamer *worldStreamer;
 
 		WorldHandler (StarlightEngine *enginePtr);
 		virtual ~WorldHandler ();
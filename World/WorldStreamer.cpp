@@ -0,0 +1,445 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2017 David Allen
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * WorldStreamer.cpp
+ */
+
+#include "World/WorldStreamer.h"
+
+#include <Engine/StarlightEngine.h>
+
+#include <Game/API/SEAPI.h>
+
+#include <Input/Window.h>
+
+#include <Resources/ResourceManager.h>
+
+#include <World/WorldHandler.h>
+
+WorldStreamer::WorldStreamer (StarlightEngine *enginePtr)
+{
+	engine = enginePtr;
+	streamedLevel = nullptr;
+	inFlightIOSize = 0;
+	failedRequestCount = 0;
+	lastPrioritizedCameraPosition = glm::vec3(0);
+	lastPrioritizedTime = 0;
+	prioritiesDirty = true;
+
+	streamerConfig.maxInFlightIOSize = WORLD_STREAMER_DEFAULT_MAX_IN_FLIGHT_IO_SIZE;
+	streamerConfig.frameUploadBudget = WORLD_STREAMER_DEFAULT_FRAME_UPLOAD_BUDGET;
+
+	engine->resources->setFrameUploadBudget(streamerConfig.frameUploadBudget);
+}
+
+WorldStreamer::~WorldStreamer ()
+{
+	releaseLevel();
+}
+
+/*
+ * Finishes any requests that are done loading (or failed to), recomputes the priorities if the camera has moved far enough, and then
+ * issues as many of the pending requests as the in-flight cap allows, highest priority first. Should be called once per
+ * frame, after ResourceManager::processAsyncLoads().
+ */
+void WorldStreamer::update ()
+{
+	LevelData *activeLevelData = engine->worldHandler->getActiveLevelData();
+
+	if (activeLevelData != streamedLevel)
+	{
+		releaseLevel();
+
+		streamedLevel = activeLevelData;
+		prioritiesDirty = true;
+	}
+
+	if (streamedLevel == nullptr)
+		return;
+
+	for (size_t i = 0; i < inFlightRequests.size();)
+	{
+		StreamRequest &request = requests[inFlightRequests[i]];
+
+		// The load functions only return nullptr if they couldn't even start the load
+		bool requestLoaded = true, requestFailed = request.resource == nullptr;
+
+		if (request.resource != nullptr && request.type == STREAM_REQUEST_TYPE_MESH)
+		{
+			ResourceMesh mesh = static_cast<ResourceMesh>(request.resource);
+			requestLoaded = mesh->dataLoaded;
+			requestFailed = requestLoaded && mesh->loadFailed;
+		}
+		else if (request.resource != nullptr)
+		{
+			ResourceTexture tex = static_cast<ResourceTexture>(request.resource);
+			requestLoaded = tex->dataLoaded;
+			requestFailed = requestLoaded && tex->loadFailed;
+		}
+
+		if (requestLoaded)
+		{
+			finishRequest(inFlightRequests[i], requestFailed);
+
+			inFlightRequests[i] = inFlightRequests.back();
+			inFlightRequests.pop_back();
+		}
+		else
+		{
+			i ++;
+		}
+	}
+
+	glm::vec3 cameraPosition = engine->api->getMainCameraPosition();
+
+	if (prioritiesDirty || glm::distance(cameraPosition, lastPrioritizedCameraPosition) > WORLD_STREAMER_REPRIORITIZE_DISTANCE || engine->getTime() - lastPrioritizedTime > WORLD_STREAMER_REPRIORITIZE_INTERVAL)
+		updatePriorities(cameraPosition);
+
+	while (pendingRequests.size() > 0)
+	{
+		uint32_t request = pendingRequests.back();
+
+		// There's always at least one request let through, so a file bigger than the whole cap can't stall everything
+		if (inFlightRequests.size() > 0 && inFlightIOSize + requests[request].ioSize > streamerConfig.maxInFlightIOSize)
+			break;
+
+		pendingRequests.pop_back();
+		issueRequest(request);
+	}
+}
+
+void WorldStreamer::releaseLevel ()
+{
+	for (size_t i = 0; i < streamedAssets.size(); i ++)
+	{
+		if (!streamedAssets[i].loaded)
+			continue;
+
+		if (streamedAssets[i].isMaterial)
+			engine->resources->returnMaterial(streamedAssets[i].defUniqueNameID);
+		else
+			engine->resources->returnStaticMesh(streamedAssets[i].defUniqueNameID);
+	}
+
+	// Anything still in flight is waited on by the return*() functions
+	for (size_t i = 0; i < requests.size(); i ++)
+		releaseRequestResource(requests[i]);
+
+	streamedAssets.clear();
+	streamedAssetsMap.clear();
+	requests.clear();
+	pendingRequests.clear();
+	inFlightRequests.clear();
+	inFlightIOSize = 0;
+	failedRequestCount = 0;
+
+	streamedLevel = nullptr;
+}
+
+LevelData *WorldStreamer::getStreamedLevel ()
+{
+	return streamedLevel;
+}
+
+/*
+ * Recomputes the priority of every static mesh & material from the level's cells, adding any that haven't been seen before,
+ * and re-sorts the pending requests by them.
+ */
+void WorldStreamer::updatePriorities (const glm::vec3 &cameraPosition)
+{
+	for (size_t i = 0; i < streamedAssets.size(); i ++)
+		streamedAssets[i].priority = 0;
+
+	for (size_t i = 0; i < streamedLevel->activeStaticObjectCells.size(); i ++)
+		gatherNodePriorities(streamedLevel->activeStaticObjectCells[i], cameraPosition);
+
+	// Highest priority last, and the smaller of two requests w/ the same priority goes first
+	std::sort(pendingRequests.begin(), pendingRequests.end(), [this](uint32_t a, uint32_t b)
+	{
+		float priorityA = streamedAssets[requests[a].asset].priority;
+		float priorityB = streamedAssets[requests[b].asset].priority;
+
+		return priorityA != priorityB ? priorityA < priorityB : requests[a].ioSize > requests[b].ioSize;
+	});
+
+	updateTextureRequiredSizes();
+
+	lastPrioritizedCameraPosition = cameraPosition;
+	lastPrioritizedTime = engine->getTime();
+	prioritiesDirty = false;
+}
+
+void WorldStreamer::gatherNodePriorities (const SortedOctree<LevelStaticObjectType, LevelStaticObject> &node, const glm::vec3 &cameraPosition)
+{
+	/*
+	 * Everything in a node is treated as being at the closest point of the node to the camera, which is plenty close
+	 * enough for ordering loads, and means we don't have to look at every object's position.
+	 */
+	glm::vec3 closestPoint = glm::clamp(cameraPosition, glm::vec3(node.cellBB.min.x, node.cellBB.min.y, node.cellBB.min.z), glm::vec3(node.cellBB.max.x, node.cellBB.max.y, node.cellBB.max.z));
+	float distance = std::max(glm::distance(cameraPosition, closestPoint), WORLD_STREAMER_MIN_DISTANCE);
+
+	for (size_t i = 0; i < node.objectList.size(); i ++)
+	{
+		const LevelStaticObjectType &objType = node.objectList[i].first;
+		const std::vector<LevelStaticObject> &objList = node.objectList[i].second;
+
+		if (objList.size() == 0)
+			continue;
+
+		float maxScale = 0;
+
+		for (size_t o = 0; o < objList.size(); o ++)
+			maxScale = std::max<float>(maxScale, objList[o].position_scale.w);
+
+		float projectedSize = objType.boundingSphereRadius_maxLodDist_padding.x * maxScale / distance;
+
+		uint32_t meshAsset = getStreamedAsset(objType.meshDefUniqueNameID, false);
+		uint32_t materialAsset = getStreamedAsset(objType.materialDefUniqueNameID, true);
+
+		streamedAssets[meshAsset].priority = std::max(streamedAssets[meshAsset].priority, projectedSize);
+		streamedAssets[materialAsset].priority = std::max(streamedAssets[materialAsset].priority, projectedSize);
+	}
+
+	for (int a = 0; a < 8; a ++)
+	{
+		if (node.activeChildren & (1 << a))
+		{
+			gatherNodePriorities(*node.children[a], cameraPosition);
+		}
+	}
+}
+
+/*
+ * Tells the resource manager how many pixels across the textures of every loaded material can end up on screen, so it
+ * knows which mip levels to stream in. Textures shared between materials go w/ the biggest size.
+ */
+void WorldStreamer::updateTextureRequiredSizes ()
+{
+	std::map<ResourceTexture, uint32_t> textureRequiredSizes;
+
+	// A priority is an object's radius over it's distance, so this turns it into how many pixels tall the object is
+	float pixelScale = engine->api->getMainCameraProjMat()[1][1] * engine->mainWindow->getHeight() * WORLD_STREAMER_TEXTURE_SIZE_SCALE;
+
+	for (size_t i = 0; i < streamedAssets.size(); i ++)
+	{
+		ResourceMaterial mat = streamedAssets[i].material;
+
+		if (mat == nullptr || !mat->dataLoaded)
+			continue;
+
+		uint32_t requiredSize = (uint32_t) std::ceil(streamedAssets[i].priority * pixelScale);
+
+		for (uint32_t t = 0; t < mat->usedTextureCount; t ++)
+		{
+			uint32_t &texRequiredSize = textureRequiredSizes[mat->textures[t]];
+			texRequiredSize = std::max(texRequiredSize, requiredSize);
+		}
+	}
+
+	for (auto it = textureRequiredSizes.begin(); it != textureRequiredSizes.end(); it ++)
+		engine->resources->setTextureRequiredSize(it->first, it->second);
+}
+
+/*
+ * Returns the index of a static mesh/material in "streamedAssets", adding it (and queueing it's requests) if
+ * it's the first time it's been seen.
+ */
+uint32_t WorldStreamer::getStreamedAsset (AssetID defUniqueNameID, bool isMaterial)
+{
+	auto it = streamedAssetsMap.find(std::make_pair(defUniqueNameID, isMaterial));
+
+	if (it != streamedAssetsMap.end())
+		return it->second;
+
+	StreamedAsset newAsset = {};
+	newAsset.isMaterial = isMaterial;
+	newAsset.defUniqueNameID = defUniqueNameID;
+	newAsset.priority = 0;
+	newAsset.requestsLeft = 0;
+	newAsset.loaded = false;
+	newAsset.material = nullptr;
+
+	uint32_t asset = (uint32_t) streamedAssets.size();
+	streamedAssets.push_back(newAsset);
+	streamedAssetsMap[std::make_pair(defUniqueNameID, isMaterial)] = asset;
+
+	bool defFound = isMaterial ? addMaterialRequests(asset) : addStaticMeshRequests(asset);
+
+	if (!defFound)
+		printf("%s World streamer couldn't find the %s def \"%s\", it won't be loaded\n", WARN_PREFIX, isMaterial ? "material" : "static mesh", AssetIDTable::getAssetName(defUniqueNameID).c_str());
+	else if (streamedAssets[asset].requestsLeft == 0)
+		finishAsset(asset);
+
+	return asset;
+}
+
+bool WorldStreamer::addStaticMeshRequests (uint32_t asset)
+{
+	StaticMeshDef *def = engine->resources->getMeshDef(streamedAssets[asset].defUniqueNameID);
+
+	if (def == nullptr)
+		return false;
+
+	for (size_t i = 0; i < def->meshLODFiles.size(); i ++)
+	{
+		// Meshes are read from their cooked file if they have one, so that's the size that matters
+		size_t ioSize = FileLoader::instance()->getFileSize(ResourceManager::getCookedMeshFile(def->meshLODFiles[i], def->meshLODNames[i], engine->resources->getRendererMeshFormat()));
+
+		if (ioSize == 0)
+			ioSize = FileLoader::instance()->getFileSize(def->meshLODFiles[i]);
+
+		addRequest(asset, STREAM_REQUEST_TYPE_MESH, def->meshLODFiles[i], def->meshLODNames[i], ioSize);
+	}
+
+	return true;
+}
+
+bool WorldStreamer::addMaterialRequests (uint32_t asset)
+{
+	MaterialDef *def = engine->resources->getMaterialDef(streamedAssets[asset].defUniqueNameID);
+
+	if (def == nullptr)
+		return false;
+
+	for (int i = 0; i < MATERIAL_DEF_MAX_TEXTURE_NUM; i ++)
+	{
+		std::string texFile = std::string(def->textureFiles[i]);
+
+		if (texFile.length() != 0)
+			addRequest(asset, STREAM_REQUEST_TYPE_TEXTURE, texFile, "", FileLoader::instance()->getFileSize(texFile));
+	}
+
+	return true;
+}
+
+void WorldStreamer::addRequest (uint32_t asset, StreamRequestType type, const std::string &file, const std::string &mesh, size_t ioSize)
+{
+	StreamRequest request = {};
+	request.type = type;
+	request.file = file;
+	request.mesh = mesh;
+	request.ioSize = ioSize;
+	request.asset = asset;
+	request.resource = nullptr;
+
+	streamedAssets[asset].requests.push_back((uint32_t) requests.size());
+	streamedAssets[asset].requestsLeft ++;
+
+	pendingRequests.push_back((uint32_t) requests.size());
+	requests.push_back(request);
+
+	prioritiesDirty = true;
+}
+
+void WorldStreamer::issueRequest (uint32_t request)
+{
+	StreamRequest &req = requests[request];
+
+	if (req.type == STREAM_REQUEST_TYPE_MESH)
+		req.resource = engine->resources->loadMeshAsync(req.file, req.mesh);
+	else
+		req.resource = engine->resources->loadTextureAsync(req.file);
+
+	inFlightIOSize += req.ioSize;
+	inFlightRequests.push_back(request);
+}
+
+void WorldStreamer::finishRequest (uint32_t request, bool failed)
+{
+	StreamRequest &req = requests[request];
+
+	if (failed)
+	{
+		printf("%s World streamer failed to load %s \"%s\", the %s \"%s\" will be loaded w/o it\n", WARN_PREFIX, req.type == STREAM_REQUEST_TYPE_MESH ? "mesh" : "texture", req.type == STREAM_REQUEST_TYPE_MESH ? req.mesh.c_str() : req.file.c_str(),
+				streamedAssets[req.asset].isMaterial ? "material" : "static mesh", AssetIDTable::getAssetName(streamedAssets[req.asset].defUniqueNameID).c_str());
+
+		failedRequestCount ++;
+	}
+
+	inFlightIOSize -= req.ioSize;
+	streamedAssets[req.asset].requestsLeft --;
+
+	if (streamedAssets[req.asset].requestsLeft == 0)
+		finishAsset(req.asset);
+}
+
+/*
+ * Loads the static mesh/material itself once all of it's meshes/textures are in. Every load it does is a cache
+ * hit by now, so it's finished on the next processAsyncLoads().
+ */
+void WorldStreamer::finishAsset (uint32_t asset)
+{
+	StreamedAsset &streamedAsset = streamedAssets[asset];
+
+	if (streamedAsset.isMaterial)
+		streamedAsset.material = engine->resources->loadMaterialAsync(AssetIDTable::getAssetName(streamedAsset.defUniqueNameID));
+	else
+		engine->resources->loadStaticMeshAsync(AssetIDTable::getAssetName(streamedAsset.defUniqueNameID));
+
+	streamedAsset.loaded = true;
+
+	// The static mesh/material has it's own references to everything now, so ours aren't needed anymore
+	for (size_t i = 0; i < streamedAsset.requests.size(); i ++)
+		releaseRequestResource(requests[streamedAsset.requests[i]]);
+}
+
+void WorldStreamer::releaseRequestResource (StreamRequest &request)
+{
+	if (request.resource == nullptr)
+		return;
+
+	if (request.type == STREAM_REQUEST_TYPE_MESH)
+		engine->resources->returnMesh(static_cast<ResourceMesh>(request.resource));
+	else
+		engine->resources->returnTexture(static_cast<ResourceTexture>(request.resource));
+
+	request.resource = nullptr;
+}
+
+void WorldStreamer::setConfig (const WorldStreamerConfig &config)
+{
+	streamerConfig = config;
+
+	engine->resources->setFrameUploadBudget(streamerConfig.frameUploadBudget);
+}
+
+WorldStreamerConfig WorldStreamer::getConfig ()
+{
+	return streamerConfig;
+}
+
+WorldStreamerStats WorldStreamer::getStats ()
+{
+	WorldStreamerStats stats = {};
+	stats.streamedAssetCount = (uint32_t) streamedAssets.size();
+	stats.pendingRequestCount = (uint32_t) pendingRequests.size();
+	stats.inFlightRequestCount = (uint32_t) inFlightRequests.size();
+	stats.failedRequestCount = failedRequestCount;
+	stats.inFlightIOSize = inFlightIOSize;
+
+	for (size_t i = 0; i < streamedAssets.size(); i ++)
+		if (streamedAssets[i].loaded)
+			stats.loadedAssetCount ++;
+
+	return stats;
+}
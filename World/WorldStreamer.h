@@ -0,0 +1,155 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2017 David Allen
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * WorldStreamer.h
+ */
+
+#ifndef WORLD_WORLDSTREAMER_H_
+#define WORLD_WORLDSTREAMER_H_
+
+#include <common.h>
+#include <Resources/Resources.h>
+#include <World/LevelData.h>
+
+class StarlightEngine;
+
+#define WORLD_STREAMER_DEFAULT_MAX_IN_FLIGHT_IO_SIZE (64 * 1024 * 1024)
+#define WORLD_STREAMER_DEFAULT_FRAME_UPLOAD_BUDGET (16 * 1024 * 1024)
+#define WORLD_STREAMER_REPRIORITIZE_DISTANCE 8.0f // How far the camera has to move before the priorities are recomputed
+#define WORLD_STREAMER_REPRIORITIZE_INTERVAL 0.5  // In seconds, so objects added to the level get picked up even if the camera is still
+#define WORLD_STREAMER_MIN_DISTANCE 1.0f
+#define WORLD_STREAMER_TEXTURE_SIZE_SCALE 2.0f // Materials usually tile their textures a few times over an object, so ask for a bit more than the object's screen size
+
+typedef struct WorldStreamerConfig
+{
+		size_t maxInFlightIOSize; // Bytes of files that can be being read at once, estimated from the file sizes
+		size_t frameUploadBudget; // Bytes uploaded to the GPU per frame, see ResourceManager::setFrameUploadBudget()
+} WorldStreamerConfig;
+
+typedef struct WorldStreamerStats
+{
+		uint32_t streamedAssetCount; // Static meshes & materials the level uses
+		uint32_t loadedAssetCount;
+		uint32_t pendingRequestCount; // Mesh LOD & texture loads that haven't been issued yet
+		uint32_t inFlightRequestCount;
+		uint32_t failedRequestCount; // Loads that finished w/o any data, the static meshes & materials they were for are still loaded w/o them
+		size_t inFlightIOSize;
+} WorldStreamerStats;
+
+/*
+ * Streams in the static meshes & materials that the active level uses, instead of them all being loaded up front. Each
+ * one is broken up into the loads it actually needs (a mesh per LOD, a texture per material slot), and those are issued
+ * nearest/biggest on screen first, w/ a cap on the bytes being read at once. The priority of a static mesh or material is
+ * the biggest projected size (bounding radius over distance) of any of the cells using it, and is recomputed whenever the
+ * camera moves far enough. Once every load of one is done (or has failed), the static mesh/material itself is loaded, which
+ * just hits the cache, and the renderer picks it up (the renderer already skips anything that isn't loaded yet, or failed to).
+ * Nothing is unloaded until the level changes, even if the camera moves far away from it.
+ *
+ * Everything in here has to be called from the main thread.
+ */
+class WorldStreamer
+{
+	public:
+
+		WorldStreamer (StarlightEngine *enginePtr);
+		virtual ~WorldStreamer ();
+
+		void update ();
+
+		/*
+		 * Returns everything that's been streamed in for the level. Called automatically when the active level changes,
+		 * but has to be done before the level's data is deleted.
+		 */
+		void releaseLevel ();
+
+		LevelData *getStreamedLevel ();
+
+		void setConfig (const WorldStreamerConfig &config);
+		WorldStreamerConfig getConfig ();
+		WorldStreamerStats getStats ();
+
+	private:
+
+		typedef enum StreamRequestType
+		{
+			STREAM_REQUEST_TYPE_MESH = 0,
+			STREAM_REQUEST_TYPE_TEXTURE,
+			STREAM_REQUEST_TYPE_MAX_ENUM
+		} StreamRequestType;
+
+		typedef struct StreamRequest
+		{
+				StreamRequestType type;
+				std::string file;
+				std::string mesh; // Mesh requests only
+				size_t ioSize;
+				uint32_t asset;   // Index in "streamedAssets" of the static mesh/material it's for
+				void *resource;   // The mesh/texture once the request has been issued
+		} StreamRequest;
+
+		typedef struct StreamedAsset
+		{
+				bool isMaterial;
+				AssetID defUniqueNameID;
+				float priority;
+				std::vector<uint32_t> requests;
+				uint32_t requestsLeft;
+				bool loaded; // Whether we've loaded (and hold a reference to) the static mesh/material itself yet
+				ResourceMaterial material; // Only set for loaded materials, used to tell the resource manager how big their textures need to be
+		} StreamedAsset;
+
+		StarlightEngine *engine;
+
+		LevelData *streamedLevel;
+
+		WorldStreamerConfig streamerConfig;
+
+		std::vector<StreamedAsset> streamedAssets;
+		std::map<std::pair<AssetID, bool>, uint32_t> streamedAssetsMap; // Maps a def's id & whether it's a material to it's index in "streamedAssets"
+
+		std::vector<StreamRequest> requests;
+		std::vector<uint32_t> pendingRequests;  // Sorted by priority, highest last so issuing is just a pop
+		std::vector<uint32_t> inFlightRequests;
+		size_t inFlightIOSize;
+		uint32_t failedRequestCount;
+
+		glm::vec3 lastPrioritizedCameraPosition;
+		double lastPrioritizedTime;
+		bool prioritiesDirty;
+
+		void updatePriorities (const glm::vec3 &cameraPosition);
+		void gatherNodePriorities (const SortedOctree<LevelStaticObjectType, LevelStaticObject> &node, const glm::vec3 &cameraPosition);
+		void updateTextureRequiredSizes ();
+
+		uint32_t getStreamedAsset (AssetID defUniqueNameID, bool isMaterial);
+		bool addStaticMeshRequests (uint32_t asset);
+		bool addMaterialRequests (uint32_t asset);
+		void addRequest (uint32_t asset, StreamRequestType type, const std::string &file, const std::string &mesh, size_t ioSize);
+		void finishAsset (uint32_t asset);
+
+		void issueRequest (uint32_t request);
+		void finishRequest (uint32_t request, bool failed);
+		void releaseRequestResource (StreamRequest &request);
+};
+
+#endif /* WORLD_WORLDSTREAMER_H_ */
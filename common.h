@@ -70,6 +70,7 @@
 #include <lodepng.h>
 
 #include <Resources/FileLoader.h>
+#include <Resources/FileView.h>
 
 #define GLM_FORCE_RADIANS
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
@@ -337,7 +338,7 @@ inline std::vector<std::string> split (const std::string &s, char delim)
 	return elems;
 }
 
-inline void writeFile (const std::string &filename, const std::vector<char> &data)
+inline void writeFile (const std::string &filename, const char *data, size_t dataSize)
 {
 	std::ofstream file(filename, std::ios::out | std::ios::binary);
 
@@ -348,10 +349,15 @@ inline void writeFile (const std::string &filename, const std::vector<char> &dat
 		throw std::runtime_error("failed to open file for writing!");
 	}
 
-	file.write(reinterpret_cast<const char*> (data.data()), data.size());
+	file.write(data, dataSize);
 	file.close();
 }
 
+inline void writeFile (const std::string &filename, const std::vector<char> &data)
+{
+	writeFile(filename, data.data(), data.size());
+}
+
 inline void writeFileStr (const std::string &filename, const std::string &data)
 {
 	std::ofstream file(filename, std::ios::out | std::ios::binary);